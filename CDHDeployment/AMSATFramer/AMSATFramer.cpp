@@ -5,67 +5,77 @@
 // ======================================================================
 
 #include "CDHDeployment/AMSATFramer/AMSATFramer.hpp"
+#include "CDHDeployment/AX25/Crc16.hpp"
+#include "CDHDeployment/DebugLog/DebugLog.hpp"
 #include "Fw/Types/Assert.hpp"
+#include "Fw/Types/String.hpp"
 #include <cstring>
-#include <cstdio>
+#include <new>
 
 namespace Svc {
 
-// CRC-16 lookup table for AX.25
-const U16 AMSATFramer::crc16Table[256] = {
-    0x0000, 0xc0c1, 0xc181, 0x0140, 0xc301, 0x03c0, 0x0280, 0xc241,
-    0xc601, 0x06c0, 0x0780, 0xc741, 0x0500, 0xc5c1, 0xc481, 0x0440,
-    0xcc01, 0x0cc0, 0x0d80, 0xcd41, 0x0f00, 0xcfc1, 0xce81, 0x0e40,
-    0x0a00, 0xcac1, 0xcb81, 0x0b40, 0xc901, 0x09c0, 0x0880, 0xc841,
-    0xd801, 0x18c0, 0x1980, 0xd941, 0x1b00, 0xdbc1, 0xda81, 0x1a40,
-    0x1e00, 0xdec1, 0xdf81, 0x1f40, 0xdd01, 0x1dc0, 0x1c80, 0xdc41,
-    0x1400, 0xd4c1, 0xd581, 0x1540, 0xd701, 0x17c0, 0x1680, 0xd641,
-    0xd201, 0x12c0, 0x1380, 0xd341, 0x1100, 0xd1c1, 0xd081, 0x1040,
-    0xf001, 0x30c0, 0x3180, 0xf141, 0x3300, 0xf3c1, 0xf281, 0x3240,
-    0x3600, 0xf6c1, 0xf781, 0x3740, 0xf501, 0x35c0, 0x3480, 0xf441,
-    0x3c00, 0xfcc1, 0xfd81, 0x3d40, 0xff01, 0x3fc0, 0x3e80, 0xfe41,
-    0xfa01, 0x3ac0, 0x3b80, 0xfb41, 0x3900, 0xf9c1, 0xf881, 0x3840,
-    0x2800, 0xe8c1, 0xe981, 0x2940, 0xeb01, 0x2bc0, 0x2a80, 0xea41,
-    0xee01, 0x2ec0, 0x2f80, 0xef41, 0x2d00, 0xedc1, 0xec81, 0x2c40,
-    0xe401, 0x24c0, 0x2580, 0xe541, 0x2700, 0xe7c1, 0xe681, 0x2640,
-    0x2200, 0xe2c1, 0xe381, 0x2340, 0xe101, 0x21c0, 0x2080, 0xe041,
-    0xa001, 0x60c0, 0x6180, 0xa141, 0x6300, 0xa3c1, 0xa281, 0x6240,
-    0x6600, 0xa6c1, 0xa781, 0x6740, 0xa501, 0x65c0, 0x6480, 0xa441,
-    0x6c00, 0xacc1, 0xad81, 0x6d40, 0xaf01, 0x6fc0, 0x6e80, 0xae41,
-    0xaa01, 0x6ac0, 0x6b80, 0xab41, 0x6900, 0xa9c1, 0xa881, 0x6840,
-    0x7800, 0xb8c1, 0xb981, 0x7940, 0xbb01, 0x7bc0, 0x7a80, 0xba41,
-    0xbe01, 0x7ec0, 0x7f80, 0xbf41, 0x7d00, 0xbdc1, 0xbc81, 0x7c40,
-    0xb401, 0x74c0, 0x7580, 0xb541, 0x7700, 0xb7c1, 0xb681, 0x7640,
-    0x7200, 0xb2c1, 0xb381, 0x7340, 0xb101, 0x71c0, 0x7080, 0xb041,
-    0x5000, 0x90c1, 0x9181, 0x5140, 0x9301, 0x53c0, 0x5280, 0x9241,
-    0x9601, 0x56c0, 0x5780, 0x9741, 0x5500, 0x95c1, 0x9481, 0x5440,
-    0x9c01, 0x5cc0, 0x5d80, 0x9d41, 0x5f00, 0x9fc1, 0x9e81, 0x5e40,
-    0x5a00, 0x9ac1, 0x9b81, 0x5b40, 0x9901, 0x59c0, 0x5880, 0x9841,
-    0x8801, 0x48c0, 0x4980, 0x8941, 0x4b00, 0x8bc1, 0x8a81, 0x4a40,
-    0x4e00, 0x8ec1, 0x8f81, 0x4f40, 0x8d01, 0x4dc0, 0x4c80, 0x8c41,
-    0x4400, 0x84c1, 0x8581, 0x4540, 0x8701, 0x47c0, 0x4680, 0x8641,
-    0x8201, 0x42c0, 0x4380, 0x8341, 0x4100, 0x81c1, 0x8081, 0x4040
-};
-
 // ----------------------------------------------------------------------
 // Component construction and destruction
 // ----------------------------------------------------------------------
 
 AMSATFramer::AMSATFramer(const char* const compName)
     : AMSATFramerComponentBase(compName),
-      m_srcSSID(DEFAULT_SRC_SSID),
-      m_destSSID(DEFAULT_DEST_SSID) {
-    strncpy(m_srcCallsign, DEFAULT_SRC_CALL, AX25_CALLSIGN_LEN);
-    m_srcCallsign[AX25_CALLSIGN_LEN] = '\0';
-    strncpy(m_destCallsign, DEFAULT_DEST_CALL, AX25_CALLSIGN_LEN);
-    m_destCallsign[AX25_CALLSIGN_LEN] = '\0';
+      m_firstBorrowedQueue(std::numeric_limits<FwIndexType>::max()),
+      m_packing(NO_MESSAGE),
+      m_readyHead(0),
+      m_readyCount(0),
+      m_segmenting(NO_MESSAGE),
+      m_downstreamReady(false),
+      m_upstreamReady(false),
+      m_pumping(false),
+      m_sending(false),
+      m_sendingSlot(NO_MESSAGE),
+      m_sendRefused(false),
+      m_testPending(false),
+      m_testValue(0),
+      m_nextMessage(0),
+      m_loadStreams(0),
+      m_loadReplaySize(0),
+      m_framesFramed(0),
+      m_bytesFramed(0),
+      m_drops(0),
+      m_messagesSegmented(0),
+      m_packetsPacked(0),
+      m_packedBytes(0),
+      m_packedFrameBytes(0),
+      m_compressionIn(0),
+      m_compressionOut(0),
+      m_lastTlmNs(0) {
+    strncpy(m_source.callsign, DEFAULT_SRC_CALL, AX25_CALLSIGN_LEN);
+    m_source.callsign[AX25_CALLSIGN_LEN] = '\0';
+    m_source.ssid = DEFAULT_SRC_SSID;
+    for (FwSizeType i = 0; i <= MAX_ROUTES; i++) {
+        m_routes[i].sequence.store(0);
+        m_routes[i].set.store(false);
+        m_routes[i].pathLength = 0;
+    }
+    Route& defaultRoute = m_routes[MAX_ROUTES];
+    strncpy(defaultRoute.destination.callsign, DEFAULT_DEST_CALL, AX25_CALLSIGN_LEN);
+    defaultRoute.destination.callsign[AX25_CALLSIGN_LEN] = '\0';
+    defaultRoute.destination.ssid = DEFAULT_DEST_SSID;
+    defaultRoute.set.store(true);
+    memset(m_reserved, 0, sizeof(m_reserved));
+    for (FwSizeType i = 0; i < MAX_PENDING_MESSAGES; i++) {
+        m_pending[i].active = false;
+    }
+    m_load.active = false;
+    m_load.generated = 0;
+    m_load.returned = 0;
+    m_load.skipped = 0;
+    m_load.outstanding = 0;
+    for (FwSizeType i = 0; i < MAX_LOAD_IN_FLIGHT; i++) {
+        m_load.inFlight[i] = nullptr;
+    }
+    this->publishRoute(defaultRoute);
 
-    printf("\n========================================\n");
-    printf("AMSATFramer Component Initialized\n");
-    printf("Source:      %s-%d\n", m_srcCallsign, m_srcSSID);
-    printf("Destination: %s-%d\n", m_destCallsign, m_destSSID);
-    printf("========================================\n\n");
-    fflush(stdout);
+    AMSAT_LOG_INFO("AMSATFramer initialized, source %s-%d, destination %s-%d",
+                   m_source.callsign, m_source.ssid, defaultRoute.destination.callsign,
+                   defaultRoute.destination.ssid);
 }
 
 AMSATFramer::~AMSATFramer() {}
@@ -76,16 +86,30 @@ AMSATFramer::~AMSATFramer() {}
 
 void AMSATFramer::setSourceCallsign(const char* callsign, U8 ssid) {
     FW_ASSERT(callsign != nullptr);
-    strncpy(m_srcCallsign, callsign, AX25_CALLSIGN_LEN);
-    m_srcCallsign[AX25_CALLSIGN_LEN] = '\0';
-    m_srcSSID = ssid & 0x0F;
+    Os::ScopeLock lock(m_routeLock);
+    strncpy(m_source.callsign, callsign, AX25_CALLSIGN_LEN);
+    m_source.callsign[AX25_CALLSIGN_LEN] = '\0';
+    m_source.ssid = ssid & 0x0F;
+    // The source is in every header
+    for (FwSizeType i = 0; i <= MAX_ROUTES; i++) {
+        if (m_routes[i].set.load()) {
+            this->publishRoute(m_routes[i]);
+        }
+    }
 }
 
 void AMSATFramer::setDestCallsign(const char* callsign, U8 ssid) {
     FW_ASSERT(callsign != nullptr);
-    strncpy(m_destCallsign, callsign, AX25_CALLSIGN_LEN);
-    m_destCallsign[AX25_CALLSIGN_LEN] = '\0';
-    m_destSSID = ssid & 0x0F;
+    Os::ScopeLock lock(m_routeLock);
+    Route& route = m_routes[MAX_ROUTES];
+    strncpy(route.destination.callsign, callsign, AX25_CALLSIGN_LEN);
+    route.destination.callsign[AX25_CALLSIGN_LEN] = '\0';
+    route.destination.ssid = ssid & 0x0F;
+    this->publishRoute(route);
+}
+
+void AMSATFramer::setBorrowedQueues(FwIndexType firstQueue) {
+    m_firstBorrowedQueue = firstQueue;
 }
 
 // ----------------------------------------------------------------------
@@ -97,73 +121,180 @@ void AMSATFramer::TEST_SEND_DATA_cmdHandler(
     U32 cmdSeq,
     U32 testValue
 ) {
-    printf("\n========================================\n");
-    printf("TEST_SEND_DATA Command Received\n");
-    printf("Test Value: %u\n", testValue);
-    printf("========================================\n\n");
+    AMSAT_LOG_INFO("TEST_SEND_DATA received, test value %u", testValue);
 
-    // Create test data on stack
-    const FwSizeType testDataSize = 20;
-    U8 testData[20];
-    FwSizeType offset = 0;
-
-    testData[offset++] = 0x01;        // packet type
-    testData[offset++] = 0x50;        // comp id hi
-    testData[offset++] = 0x00;        // comp id lo
-    testData[offset++] = 0x01;        // channel id
-
-    U32 timestamp = 1234567890;
-    testData[offset++] = (timestamp >> 24) & 0xFF;
-    testData[offset++] = (timestamp >> 16) & 0xFF;
-    testData[offset++] = (timestamp >> 8) & 0xFF;
-    testData[offset++] = timestamp & 0xFF;
+    // The frame waits for RadioBridge like any other, and one at a time
+    bool busy = false;
+    {
+        Os::ScopeLock lock(m_segmentLock);
+        busy = m_testPending;
+        if (!busy) {
+            m_testPending = true;
+            m_testValue = testValue;
+        }
+    }
+    if (busy) {
+        this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::BUSY);
+        return;
+    }
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+    this->pumpSegments();
+}
 
-    testData[offset++] = (testValue >> 24) & 0xFF;
-    testData[offset++] = (testValue >> 16) & 0xFF;
-    testData[offset++] = (testValue >> 8) & 0xFF;
-    testData[offset++] = testValue & 0xFF;
+void AMSATFramer::LOAD_START_cmdHandler(
+    FwOpcodeType opCode,
+    U32 cmdSeq,
+    U32 rate,
+    U16 minSize,
+    U16 maxSize,
+    Svc::LoadSizes sizes,
+    AX25::LoadPattern pattern
+) {
+    if ((rate == 0) || (rate > MAX_LOAD_RATE) || (minSize < AX25::LoadHeader::SIZE) || (minSize > maxSize) ||
+        (maxSize > AX25::MAX_SEGMENT_PAYLOAD) || !sizes.isValid() || !pattern.isValid()) {
+        this->log_WARNING_LO_LoadRejected(rate, minSize, maxSize);
+        this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+        return;
+    }
+    Fw::ParamValid valid;
+    const FwIndexType queue = static_cast<FwIndexType>(this->paramGet_LOAD_COM_QUEUE(valid));
 
-    for (; offset < testDataSize; offset++) {
-        testData[offset] = 0xAA;
+    U32 stream = 0;
+    {
+        Os::ScopeLock lock(m_segmentLock);
+        stream = ++m_loadStreams;
+        m_load.active = true;
+        m_load.header.pattern = pattern;
+        m_load.header.stream = stream;
+        m_load.header.sequence = 0;
+        m_load.rate = rate;
+        m_load.minSize = minSize;
+        m_load.maxSize = maxSize;
+        m_load.sizes = sizes;
+        m_load.context = ComCfg::FrameContext();
+        m_load.context.set_comQueueIndex(queue);
+        m_load.credit = 0;
+        m_load.lastNs = Instrumentation::monotonicNs();
+        m_load.due = 0;
+        m_load.random = 0x9E3779B9U ^ stream;
+        m_load.generated = 0;
+        m_load.returned = 0;
+        m_load.skipped = 0;
+        // Frames of an earlier stream still out are no longer counted
+        for (FwSizeType i = 0; i < MAX_LOAD_IN_FLIGHT; i++) {
+            m_load.inFlight[i] = nullptr;
+        }
+        m_load.outstanding = 0;
     }
 
-    // Build AX.25 frame into an allocated buffer
-    const FwSizeType amsatOverhead = 20;
-    const FwSizeType amsatFrameSize = testDataSize + amsatOverhead;
+    AMSAT_LOG_INFO("AMSATFramer: load stream %u at %u frames/s", stream, rate);
+    this->log_ACTIVITY_HI_LoadStarted(stream, rate, minSize, maxSize, sizes, pattern);
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+    this->pumpSegments();
+}
 
-    Fw::Buffer amsatFrame = this->bufferAllocate_out(0, amsatFrameSize);
-    if (amsatFrame.getData() == nullptr) {
-        printf("ERROR: Failed to allocate buffer for AX.25 frame\n");
-        this->log_WARNING_HI_BufferAllocationFailed();
-        this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::EXECUTION_ERROR);
-        return;
+void AMSATFramer::LOAD_STOP_cmdHandler(
+    FwOpcodeType opCode,
+    U32 cmdSeq
+) {
+    U32 stream = 0;
+    U32 generated = 0;
+    U32 returned = 0;
+    U32 skipped = 0;
+    bool wasActive = false;
+    {
+        Os::ScopeLock lock(m_segmentLock);
+        wasActive = m_load.active;
+        m_load.active = false;
+        m_load.due = 0;
+        stream = m_load.header.stream;
+        generated = m_load.generated;
+        returned = m_load.returned;
+        skipped = m_load.skipped;
     }
 
-    U8* framePtr = amsatFrame.getData();
-    FwSizeType frameOffset = 0;
+    // Frames still out keep counting as returned until the next LOAD_START
+    if (wasActive) {
+        this->log_ACTIVITY_HI_LoadStopped(stream, generated, returned, skipped);
+    }
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+}
 
-    framePtr[frameOffset++] = AX25_FLAG; // start flag
-    frameOffset += encodeAddress(&framePtr[frameOffset], m_destCallsign, m_destSSID, false);
-    frameOffset += encodeAddress(&framePtr[frameOffset], m_srcCallsign,  m_srcSSID,  true);
-    framePtr[frameOffset++] = AX25_CONTROL;
-    framePtr[frameOffset++] = AX25_PID;
+void AMSATFramer::ROUTE_SET_cmdHandler(
+    FwOpcodeType opCode,
+    U32 cmdSeq,
+    U8 queue,
+    const Fw::CmdStringArg& destination,
+    U8 ssid,
+    const Fw::CmdStringArg& path
+) {
+    // Decode into a copy so a bad command leaves the route as it was
+    Address target;
+    Address digipeaters[AX25::MAX_DIGIPEATERS];
+    FwSizeType pathLength = 0;
+    bool valid = ((queue < MAX_ROUTES) || (queue == DEFAULT_ROUTE)) && (ssid <= 15) &&
+                 parseAddress(destination.toChar(), strlen(destination.toChar()), target);
 
-    memcpy(&framePtr[frameOffset], testData, testDataSize);
-    frameOffset += testDataSize;
+    // The SSID may come with the callsign ("CALL-N") or as `ssid`, left at 0
+    // otherwise; two different ones are a mistake rather than a choice
+    if (valid && (ssid != 0)) {
+        valid = (target.ssid == 0) || (target.ssid == ssid);
+        target.ssid = ssid;
+    }
 
-    U16 crc = calculateCRC16(&framePtr[1], frameOffset - 1);
-    framePtr[frameOffset++] = static_cast<U8>(crc & 0xFF);
-    framePtr[frameOffset++] = static_cast<U8>((crc >> 8) & 0xFF);
+    // Comma-separated digipeaters, e.g. "WIDE1-1,WIDE2-1"
+    const char* text = path.toChar();
+    const FwSizeType length = strlen(text);
+    FwSizeType start = 0;
+    while (valid && (start < length)) {
+        FwSizeType end = start;
+        while ((end < length) && (text[end] != ',')) {
+            end++;
+        }
+        valid = (pathLength < AX25::MAX_DIGIPEATERS) && parseAddress(&text[start], end - start, digipeaters[pathLength]);
+        pathLength++;
+        start = end + 1;
+        // A trailing comma leaves an empty digipeater
+        valid = valid && !((end < length) && (start == length));
+    }
+    if (!valid) {
+        this->log_WARNING_LO_RouteRejected(queue, destination, ssid, path);
+        this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+        return;
+    }
 
-    framePtr[frameOffset++] = AX25_FLAG; // end flag
-    amsatFrame.setSize(frameOffset);
+    {
+        Os::ScopeLock lock(m_routeLock);
+        Route& route = m_routes[(queue == DEFAULT_ROUTE) ? MAX_ROUTES : queue];
+        route.destination = target;
+        for (FwSizeType i = 0; i < pathLength; i++) {
+            route.path[i] = digipeaters[i];
+        }
+        route.pathLength = pathLength;
+        this->publishRoute(route);
+        route.set.store(true, std::memory_order_release);
+    }
 
-    // Send to RadioBridge
-    ComCfg::FrameContext context;
-    this->dataOut_out(0, amsatFrame, context);
+    AMSAT_LOG_INFO("AMSATFramer: queue %u routed to %s-%u via \"%s\"", queue, target.callsign, target.ssid, text);
+    this->log_ACTIVITY_HI_RouteSet(queue, Fw::String(target.callsign), target.ssid, path);
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+}
 
-    this->log_ACTIVITY_HI_TestDataSent(testValue);
-    this->log_ACTIVITY_LO_FrameCreated(static_cast<U32>(frameOffset));
+void AMSATFramer::ROUTE_CLEAR_cmdHandler(
+    FwOpcodeType opCode,
+    U32 cmdSeq,
+    U8 queue
+) {
+    // The default route is always there
+    if (queue >= MAX_ROUTES) {
+        this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+        return;
+    }
+    {
+        Os::ScopeLock lock(m_routeLock);
+        m_routes[queue].set.store(false, std::memory_order_release);
+    }
+    this->log_ACTIVITY_HI_RouteCleared(queue);
     this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
 }
 
@@ -176,73 +307,849 @@ void AMSATFramer::dataIn_handler(
     Fw::Buffer& data,
     const ComCfg::FrameContext& context
 ) {
-    printf("\n========================================\n");
-    printf("AMSATFramer::dataIn_handler\n");
-    printf("Input size: %lu bytes\n", data.getSize());
-    printf("========================================\n");
-
-    if (data.getSize() < 1) {
-        printf("ERROR: Buffer too small\n");
-        this->log_WARNING_HI_InvalidInputBuffer();
-        this->bufferDeallocate_out(0, data);
+    const U64 startNs = Instrumentation::monotonicNs();
+
+    AMSAT_LOG_DEBUG("AMSATFramer: dataIn %lu bytes", static_cast<unsigned long>(data.getSize()));
+
+    FwSizeType reservedCapacity = 0;
+    const bool reserved = this->releaseReserved(data.getData(), reservedCapacity);
+
+    // Payloads from payloadAllocate already have room for the header and FCS,
+    // so they are framed in place as a single segment
+    if (reserved) {
+        if (data.getSize() < 1) {
+            AMSAT_LOG_WARN("AMSATFramer: input buffer too small");
+            this->log_WARNING_HI_InvalidInputBuffer();
+            this->deallocatePayload(data, reserved);
+            Os::ScopeLock lock(m_segmentLock);
+            m_drops++;
+            this->writeTelemetry();
+            return;
+        }
+        FW_ASSERT(data.getSize() <= reservedCapacity,
+                  static_cast<FwAssertArgType>(data.getSize()),
+                  static_cast<FwAssertArgType>(reservedCapacity));
+        // The headroom fits the longest header; a shorter one starts the frame later
+        RouteHeader route;
+        this->getRoute(context.get_comQueueIndex(), route);
+        U8* framePtr = data.getData() - prefixSize(route);
+        (void)writeHeader(framePtr, route);
+        const FwSizeType frameSize = finishFrame(framePtr, route, data.getSize());
+        {
+            Os::ScopeLock lock(m_segmentLock);
+            this->frameForwarded(startNs, frameSize);
+        }
+        Fw::Buffer amsatFrame(framePtr, frameSize, data.getContext());
+
+        this->log_ACTIVITY_LO_FrameCreated(static_cast<U32>(frameSize));
+        this->dataOut_out(0, amsatFrame, context);
+        AMSAT_LOG_DEBUG("AMSATFramer: %lu byte frame built in place", static_cast<unsigned long>(frameSize));
         return;
     }
 
-    // Build AX.25 frame from incoming buffer
-    const FwSizeType amsatOverhead = 20;
-    const FwSizeType amsatFrameSize = data.getSize() + amsatOverhead;
+    // Anything else is a com buffer owned upstream. Buffer-queue buffers are
+    // split into segment views and go back on dataReturnOut once they have all
+    // been sent; packet-queue buffers are copied into a pack and go back now.
+    RouteHeader route;
+    this->getRoute(context.get_comQueueIndex(), route);
+    Fw::ParamValid valid;
+    const FwSizeType fx25Roots = static_cast<FwSizeType>(this->paramGet_FX25_CHECK_BYTES(valid));
+    const bool fx25 = AX25::Fx25::isSupported(fx25Roots);
+    const FwSizeType stride = fx25 ? segmentStride(fx25Roots, route.size) : AX25::MAX_SEGMENT_PAYLOAD;
 
-    Fw::Buffer amsatFrame = this->bufferAllocate_out(0, amsatFrameSize);
-    if (amsatFrame.getData() == nullptr) {
-        printf("ERROR: Failed to allocate buffer\n");
-        this->log_WARNING_HI_BufferAllocationFailed();
-        this->bufferDeallocate_out(0, data);
+    const bool borrowed = context.get_comQueueIndex() >= m_firstBorrowedQueue;
+    const FwSizeType maxSize =
+        borrowed ? AX25::MAX_SEGMENTS * stride : MAX_STAGED_SIZE - AX25::PACK_RECORD_HEADER;
+    if ((data.getData() == nullptr) || (data.getSize() < 1) || (data.getSize() > maxSize)) {
+        if (data.getSize() > maxSize) {
+            this->log_WARNING_HI_MessageTooLarge(static_cast<U32>(data.getSize()), static_cast<U32>(maxSize));
+        } else {
+            this->log_WARNING_HI_InvalidInputBuffer();
+        }
+        AMSAT_LOG_WARN("AMSATFramer: %lu byte com buffer dropped", static_cast<unsigned long>(data.getSize()));
+        {
+            Os::ScopeLock lock(m_segmentLock);
+            m_drops++;
+            // The sender used up its permission on this buffer, so ask for the next
+            m_upstreamReady = false;
+            this->writeTelemetry();
+        }
+        this->returnMessage(data, context);
+        this->pumpSegments();
         return;
     }
 
-    U8* framePtr = amsatFrame.getData();
-    FwSizeType offset = 0;
+    const FwSizeType mtu = FW_MIN(static_cast<FwSizeType>(this->paramGet_PACK_MTU(valid)), MAX_STAGED_SIZE);
 
-    framePtr[offset++] = AX25_FLAG;
-    offset += encodeAddress(&framePtr[offset], m_destCallsign, m_destSSID, false);
-    offset += encodeAddress(&framePtr[offset], m_srcCallsign,  m_srcSSID,  true);
-    framePtr[offset++] = AX25_CONTROL;
-    framePtr[offset++] = AX25_PID;
+    m_segmentLock.lock();
+    // Messages go out in arrival order, so a buffer-queue buffer or a packet
+    // that would take the pack past the MTU closes it first
+    if ((m_packing != NO_MESSAGE) &&
+        (borrowed || (m_pending[m_packing].size + AX25::packedSize(data.getSize()) > mtu))) {
+        this->closePack();
+    }
+    const FwSizeType slot = (m_packing != NO_MESSAGE) ? m_packing : this->freeSlot();
+    if (slot == NO_MESSAGE) {
+        // Only possible if the sender ignores comStatusOut
+        m_drops++;
+        m_upstreamReady = false;
+        this->writeTelemetry();
+        m_segmentLock.unLock();
+        this->log_WARNING_HI_UnexpectedInput();
+        this->returnMessage(data, context);
+        return;
+    }
 
-    memcpy(&framePtr[offset], data.getData(), data.getSize());
-    offset += data.getSize();
+    PendingMessage& message = m_pending[slot];
+    if (slot != m_packing) {
+        message.buffer = data;
+        message.context = context;
+        message.data = borrowed ? data.getData() : m_staging[slot];
+        message.size = borrowed ? data.getSize() : 0;
+        message.packed = !borrowed;
+        message.compressed = false;
+        message.openedNs = startNs;
+        message.packetBytes = 0;
+        message.route = route;
+        message.stride = stride;
+        message.fx25Roots = fx25 ? fx25Roots : 0;
+        message.count = 0;
+        message.nextIndex = 0;
+        message.outstanding = 0;
+        message.active = true;
+    }
+    if (borrowed) {
+        this->queueMessage(slot);
+    } else {
+        m_packing = slot;
+        AX25::packAppend(m_staging[slot], message.size, data.getData(), data.getSize());
+        message.packetBytes += data.getSize();
+        if (m_load.active && (m_load.header.pattern == AX25::LoadPattern::REPLAY)) {
+            memcpy(m_loadReplay, data.getData(), data.getSize());
+            m_loadReplaySize = data.getSize();
+        }
+        m_packetsPacked++;
+        // Close as soon as not even a one-byte packet would fit
+        if (message.size + AX25::packedSize(1) > mtu) {
+            this->closePack();
+        }
+    }
+    m_upstreamReady = false;
+    const FwSizeType size = message.size;
+    m_segmentLock.unLock();
 
-    U16 crc = calculateCRC16(&framePtr[1], offset - 1);
-    framePtr[offset++] = static_cast<U8>(crc & 0xFF);
-    framePtr[offset++] = static_cast<U8>((crc >> 8) & 0xFF);
+    AMSAT_LOG_DEBUG("AMSATFramer: %lu byte com buffer %s, message now %lu bytes",
+                    static_cast<unsigned long>(data.getSize()), borrowed ? "queued" : "packed",
+                    static_cast<unsigned long>(size));
+    if (!borrowed) {
+        // The copy is what gets sent, so the sender's storage can go back now
+        this->returnMessage(data, context);
+    }
+    this->pumpSegments();
+}
 
-    framePtr[offset++] = AX25_FLAG;
-    amsatFrame.setSize(offset);
+void AMSATFramer::dataReturnIn_handler(
+    FwIndexType portNum,
+    Fw::Buffer& data,
+    const ComCfg::FrameContext& context
+) {
+    // Contiguous frames are ours outright
+    const AX25::FrameView* view = AX25::FrameView::from(data.getData(), data.getSize());
+    if (view == nullptr) {
+        bool loadFrame = false;
+        {
+            Os::ScopeLock lock(m_segmentLock);
+            loadFrame = this->releaseLoadFrame(data.getData());
+        }
+        this->bufferDeallocate_out(0, data);
+        if (loadFrame) {
+            // Room for another load frame
+            this->pumpSegments();
+        }
+        return;
+    }
 
-    this->log_ACTIVITY_LO_FrameCreated(static_cast<U32>(offset));
+    // A segment view: find the message it borrowed from. Packed buffers went
+    // back on dataIn; borrowed ones go back with their last view.
+    bool returnSource = false;
+    Fw::Buffer source;
+    ComCfg::FrameContext sourceContext;
+    {
+        Os::ScopeLock lock(m_segmentLock);
+        FwSizeType slot = NO_MESSAGE;
+        for (FwSizeType i = 0; i < MAX_PENDING_MESSAGES; i++) {
+            const PendingMessage& message = m_pending[i];
+            if (message.active && (view->info >= message.data) && (view->info < message.data + message.size)) {
+                slot = i;
+                break;
+            }
+        }
+        FW_ASSERT(slot != NO_MESSAGE);
 
-    // Forward the AX.25 frame to RadioBridge
-    this->dataOut_out(0, amsatFrame, context);
+        PendingMessage& message = m_pending[slot];
+        FW_ASSERT(message.outstanding > 0);
+        message.outstanding--;
+        returnSource = this->retireMessage(slot, source, sourceContext);
+    }
 
-    // Release the original input buffer
     this->bufferDeallocate_out(0, data);
+    if (returnSource) {
+        this->returnMessage(source, sourceContext);
+    }
 
-    printf("[LIVE MODE] Frame forwarded to RadioBridge\n\n");
+    // A view buffer or message slot came free
+    this->pumpSegments();
 }
 
-void AMSATFramer::dataReturnIn_handler(
+void AMSATFramer::comStatusIn_handler(
     FwIndexType portNum,
-    Fw::Buffer& data,
-    const ComCfg::FrameContext& context
+    Fw::Success& condition
 ) {
-    // RadioBridge has finished with the buffer; release it
-    this->bufferDeallocate_out(0, data);
+    {
+        Os::ScopeLock lock(m_segmentLock);
+        const bool success = (condition == Fw::Success::SUCCESS);
+        m_downstreamReady = success;
+        // FAILURE only comes back while a frame is handed over, and means
+        // RadioBridge returned that frame unsent
+        if (m_sending && !success) {
+            m_sendRefused = true;
+        }
+    }
+    this->pumpSegments();
+}
+
+void AMSATFramer::schedIn_handler(
+    FwIndexType portNum,
+    U32 context
+) {
+    Fw::ParamValid valid;
+    const U64 maxDelayNs = static_cast<U64>(this->paramGet_PACK_MAX_DELAY_MS(valid)) * 1000000ULL;
+    {
+        Os::ScopeLock lock(m_segmentLock);
+        // The deadline is only as fine as this port's rate, so a packet can
+        // wait up to PACK_MAX_DELAY_MS plus one period
+        if ((m_packing != NO_MESSAGE) &&
+            (Instrumentation::monotonicNs() - m_pending[m_packing].openedNs >= maxDelayNs)) {
+            this->closePack();
+        }
+        this->writeTelemetry();
+    }
+    this->pumpSegments();
+}
+
+Fw::Buffer AMSATFramer::payloadAllocate_handler(
+    FwIndexType portNum,
+    FwSizeType size
+) {
+    // Payloads framed in place have to fit a single segment
+    if (size > AX25::MAX_SEGMENT_PAYLOAD) {
+        this->log_WARNING_HI_MessageTooLarge(static_cast<U32>(size), static_cast<U32>(AX25::MAX_SEGMENT_PAYLOAD));
+        return Fw::Buffer();
+    }
+
+    Fw::Buffer buffer = this->bufferAllocate_out(0, size + AX25_HEADROOM + AX25_TAILROOM);
+    if (buffer.getData() == nullptr) {
+        this->log_WARNING_HI_BufferAllocationFailed();
+        return buffer;
+    }
+
+    Os::ScopeLock lock(m_reservedLock);
+    for (FwSizeType i = 0; i < MAX_RESERVED_BUFFERS; i++) {
+        if (m_reserved[i].payload == nullptr) {
+            m_reserved[i].payload = buffer.getData() + AX25_HEADROOM;
+            m_reserved[i].capacity = size;
+            return Fw::Buffer(m_reserved[i].payload, size, buffer.getContext());
+        }
+    }
+
+    // Tracking table full: anything else on dataIn is taken to be a com
+    // buffer owned upstream, so an untracked payload cannot be handed out
+    this->bufferDeallocate_out(0, buffer);
+    return Fw::Buffer();
+}
+
+void AMSATFramer::payloadDeallocate_handler(
+    FwIndexType portNum,
+    Fw::Buffer& fwBuffer
+) {
+    FwSizeType capacity = 0;
+    const bool reserved = this->releaseReserved(fwBuffer.getData(), capacity);
+    this->deallocatePayload(fwBuffer, reserved);
 }
 
 // ----------------------------------------------------------------------
 // Helper functions
 // ----------------------------------------------------------------------
 
+void AMSATFramer::publishRoute(Route& route) {
+    RouteHeader header;
+    FwSizeType offset = 0;
+    offset += encodeAddress(&header.bytes[offset], route.destination.callsign, route.destination.ssid, false);
+    offset += encodeAddress(&header.bytes[offset], m_source.callsign, m_source.ssid, route.pathLength == 0);
+    for (FwSizeType i = 0; i < route.pathLength; i++) {
+        offset += encodeAddress(&header.bytes[offset], route.path[i].callsign, route.path[i].ssid,
+                                i + 1 == route.pathLength);
+    }
+    header.bytes[offset++] = AX25_CONTROL;
+    header.bytes[offset++] = AX25_PID;
+    FW_ASSERT(offset <= AX25::MAX_HEADER_SIZE, static_cast<FwAssertArgType>(offset));
+    header.size = offset;
+
+    // The FCS covers the header first, so its contribution is computed once too
+    header.crc = AX25::Crc16::update(AX25::Crc16::INITIAL, header.bytes, offset);
+
+    // Writers are serialized by m_routeLock, so only readers race with this
+    const U32 sequence = route.sequence.load(std::memory_order_relaxed);
+    route.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&route.header, &header, sizeof(header));
+    route.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void AMSATFramer::getRoute(FwIndexType queue, RouteHeader& header) const {
+    const bool own = (queue >= 0) && (static_cast<FwSizeType>(queue) < MAX_ROUTES) &&
+                     m_routes[queue].set.load(std::memory_order_acquire);
+    const Route& route = m_routes[own ? static_cast<FwSizeType>(queue) : MAX_ROUTES];
+    while (true) {
+        const U32 before = route.sequence.load(std::memory_order_acquire);
+        if ((before & 1U) == 0) {
+            memcpy(&header, &route.header, sizeof(header));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (route.sequence.load(std::memory_order_relaxed) == before) {
+                return;
+            }
+        }
+    }
+}
+
+bool AMSATFramer::parseAddress(const char* text, FwSizeType length, Address& address) {
+    FwSizeType i = 0;
+    while ((i < length) && (text[i] != '-')) {
+        const char c = text[i];
+        if ((i == AX25_CALLSIGN_LEN) || !(((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')))) {
+            return false;
+        }
+        address.callsign[i] = c;
+        i++;
+    }
+    if (i == 0) {
+        return false;
+    }
+    address.callsign[i] = '\0';
+    address.ssid = 0;
+    if (i == length) {
+        return true;
+    }
+
+    // An SSID of one or two digits after the dash
+    FwSizeType digits = 0;
+    U32 ssid = 0;
+    for (i++; i < length; i++, digits++) {
+        if ((text[i] < '0') || (text[i] > '9') || (digits == 2)) {
+            return false;
+        }
+        ssid = ssid * 10 + static_cast<U32>(text[i] - '0');
+    }
+    if ((digits == 0) || (ssid > 15)) {
+        return false;
+    }
+    address.ssid = static_cast<U8>(ssid);
+    return true;
+}
+
+bool AMSATFramer::releaseReserved(const U8* payload, FwSizeType& capacity) {
+    if (payload == nullptr) {
+        return false;
+    }
+    Os::ScopeLock lock(m_reservedLock);
+    for (FwSizeType i = 0; i < MAX_RESERVED_BUFFERS; i++) {
+        if (m_reserved[i].payload == payload) {
+            capacity = m_reserved[i].capacity;
+            m_reserved[i].payload = nullptr;
+            m_reserved[i].capacity = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+void AMSATFramer::deallocatePayload(Fw::Buffer& payload, bool reserved) {
+    if (reserved) {
+        // Return the allocation as it came from the buffer manager
+        Fw::Buffer original(payload.getData() - AX25_HEADROOM,
+                            payload.getSize() + AX25_HEADROOM + AX25_TAILROOM,
+                            payload.getContext());
+        this->bufferDeallocate_out(0, original);
+        return;
+    }
+    this->bufferDeallocate_out(0, payload);
+}
+
+void AMSATFramer::pumpSegments() {
+    m_segmentLock.lock();
+    if (m_pumping) {
+        // The thread already pumping sees the new state before it stops
+        m_segmentLock.unLock();
+        return;
+    }
+    m_pumping = true;
+
+    // RadioBridge may report status from inside dataOut_out, and the sender
+    // may call dataIn from inside comStatusOut_out, so no port is called
+    // with the lock held and nested calls only update state for this loop
+    bool viewsAvailable = true;
+    this->accrueLoad();
+    while (true) {
+        // A TEST_SEND_DATA frame stays pending until RadioBridge takes it
+        if (m_downstreamReady && viewsAvailable && m_testPending) {
+            Fw::Buffer frame = this->nextTestFrame();
+            if (!frame.isValid()) {
+                viewsAvailable = false;  // Retried when a buffer comes back
+                continue;
+            }
+            const U32 value = m_testValue;
+            const FwSizeType frameSize = frame.getSize();
+            m_downstreamReady = false;
+            m_sending = true;
+            m_sendRefused = false;
+
+            m_segmentLock.unLock();
+            this->log_ACTIVITY_LO_FrameCreated(static_cast<U32>(frameSize));
+            this->dataOut_out(0, frame, ComCfg::FrameContext());
+            m_segmentLock.lock();
+
+            m_sending = false;
+            if (!m_sendRefused) {
+                m_testPending = false;
+                m_segmentLock.unLock();
+                this->log_ACTIVITY_HI_TestDataSent(value);
+                m_segmentLock.lock();
+            }
+            continue;
+        }
+
+        // Load frames go first so the stream keeps its rate; RadioBridge
+        // still sends them in the class of LOAD_COM_QUEUE
+        if (m_downstreamReady && viewsAvailable && (m_load.due > 0) &&
+            (m_load.outstanding < MAX_LOAD_IN_FLIGHT)) {
+            Fw::Buffer frame = this->nextLoadFrame();
+            if (!frame.isValid()) {
+                viewsAvailable = false;  // Retried when a buffer comes back
+                continue;
+            }
+            const ComCfg::FrameContext context = m_load.context;
+            m_downstreamReady = false;
+
+            m_segmentLock.unLock();
+            this->dataOut_out(0, frame, context);
+            m_segmentLock.lock();
+            continue;
+        }
+
+        if ((m_segmenting == NO_MESSAGE) && (m_readyCount > 0)) {
+            m_segmenting = m_ready[m_readyHead];
+            m_readyHead = (m_readyHead + 1) % MAX_PENDING_MESSAGES;
+            m_readyCount--;
+        }
+
+        if (m_downstreamReady && viewsAvailable && (m_segmenting != NO_MESSAGE)) {
+            PendingMessage& message = m_pending[m_segmenting];
+            Fw::Buffer frame = this->nextSegment(message);
+            if (!frame.isValid()) {
+                viewsAvailable = false;  // Retried when a view comes back
+                continue;
+            }
+            const ComCfg::FrameContext context = message.context;
+            const FwSizeType slot = m_segmenting;
+            const FwSizeType frameSize = AX25::FrameView::from(frame.getData(), frame.getSize())->sentSize();
+            if (message.nextIndex == message.count) {
+                m_segmenting = NO_MESSAGE;
+            }
+            m_downstreamReady = false;
+            m_sending = true;
+            m_sendingSlot = slot;
+            m_sendRefused = false;
+
+            m_segmentLock.unLock();
+            this->dataOut_out(0, frame, context);
+            m_segmentLock.lock();
+
+            // The view may have come back during the call, refused or already sent
+            m_sending = false;
+            m_sendingSlot = NO_MESSAGE;
+            Fw::Buffer source;
+            ComCfg::FrameContext sourceContext;
+            if (m_sendRefused) {
+                this->resendSegment(slot, frameSize);
+            } else if (this->retireMessage(slot, source, sourceContext)) {
+                m_segmentLock.unLock();
+                this->returnMessage(source, sourceContext);
+                m_segmentLock.lock();
+            }
+            continue;
+        }
+
+        // Ask for the next com buffer once there is a slot to hold it. This
+        // does not wait for RadioBridge, so packs fill while frames are sent.
+        if (m_upstreamReady || (this->freeSlot() == NO_MESSAGE)) {
+            break;
+        }
+        m_upstreamReady = true;
+
+        m_segmentLock.unLock();
+        if (this->isConnected_comStatusOut_OutputPort(0)) {
+            Fw::Success condition(Fw::Success::SUCCESS);
+            this->comStatusOut_out(0, condition);
+        }
+        m_segmentLock.lock();
+    }
+
+    m_pumping = false;
+    m_segmentLock.unLock();
+}
+
+FwSizeType AMSATFramer::segmentStride(FwSizeType roots, FwSizeType headerSize) {
+    // Everything of the frame but the flags and the segment payload
+    const FwSizeType overhead = headerSize + AX25::SegmentHeader::SIZE + 2;
+    return FW_MIN(AX25::MAX_SEGMENT_PAYLOAD, AX25::Fx25::maxBody(roots) - overhead);
+}
+
+FwSizeType AMSATFramer::freeSlot() const {
+    for (FwSizeType i = 0; i < MAX_PENDING_MESSAGES; i++) {
+        if (!m_pending[i].active) {
+            return i;
+        }
+    }
+    return NO_MESSAGE;
+}
+
+void AMSATFramer::queueMessage(FwSizeType slot) {
+    FW_ASSERT(m_readyCount < MAX_PENDING_MESSAGES, static_cast<FwAssertArgType>(m_readyCount));
+    PendingMessage& message = m_pending[slot];
+    message.count = static_cast<U8>(AX25::segmentCount(message.size, message.stride));
+    message.message = AX25::SegmentHeader::number(m_nextMessage, message.count);
+    m_ready[(m_readyHead + m_readyCount) % MAX_PENDING_MESSAGES] = slot;
+    m_readyCount++;
+    m_messagesSegmented++;
+    AMSAT_LOG_DEBUG("AMSATFramer: message %u, %lu bytes in %u segments%s%s", message.message,
+                    static_cast<unsigned long>(message.size), message.count, message.packed ? ", packed" : "",
+                    message.compressed ? ", compressed" : "");
+}
+
+void AMSATFramer::compressPack(FwSizeType slot) {
+    static_assert(MAX_STAGED_SIZE <= AX25::Compressor::MAX_INPUT, "Packs must fit the compressor");
+    Fw::ParamValid valid;
+    if (!this->paramGet_COMPRESSION_ENABLED(valid)) {
+        return;
+    }
+
+    PendingMessage& message = m_pending[slot];
+    U8* pack = m_staging[slot];
+    m_compressionIn += message.size;
+    const FwSizeType size = m_compressor.compress(pack, message.size, m_compressed, sizeof(m_compressed));
+    if (size == 0) {
+        m_compressionOut += message.size;
+        return;
+    }
+    memcpy(pack, m_compressed, size);
+    message.size = size;
+    message.compressed = true;
+    m_compressionOut += size;
+}
+
+void AMSATFramer::closePack() {
+    if (m_packing != NO_MESSAGE) {
+        this->compressPack(m_packing);
+        this->queueMessage(m_packing);
+        m_packing = NO_MESSAGE;
+    }
+}
+
+Fw::Buffer AMSATFramer::nextSegment(PendingMessage& message) {
+    const U64 startNs = Instrumentation::monotonicNs();
+
+    Fw::Buffer buffer = this->bufferAllocate_out(0, sizeof(AX25::FrameView));
+    if (buffer.getData() == nullptr) {
+        return buffer;
+    }
+    buffer.setSize(sizeof(AX25::FrameView));
+    AX25::FrameView* view = new (buffer.getData()) AX25::FrameView();
+
+    const FwSizeType offset = static_cast<FwSizeType>(message.nextIndex) * message.stride;
+    const RouteHeader& route = message.route;
+    view->marker = AX25::FrameView::MARKER;
+    view->prefixSize = static_cast<U8>(prefixSize(route));
+    view->info = message.data + offset;
+    view->infoSize = FW_MIN(message.size - offset, message.stride);
+    view->fx25Size = 0;
+
+    AX25::SegmentHeader segment;
+    segment.message = message.message;
+    segment.packed = message.packed;
+    segment.compressed = message.compressed;
+    segment.index = message.nextIndex;
+    segment.count = message.count;
+    view->prefix[0] = AX25_FLAG;
+    memcpy(&view->prefix[1], route.bytes, route.size);
+    segment.serialize(&view->prefix[1 + route.size]);
+
+    // The FCS is computed over the borrowed info field where it lies
+    U16 crc = AX25::Crc16::update(route.crc, &view->prefix[1 + route.size], AX25::SegmentHeader::SIZE);
+    crc = AX25::Crc16::finish(AX25::Crc16::update(crc, view->info, view->infoSize));
+    view->suffix[0] = static_cast<U8>(crc & 0xFF);
+    view->suffix[1] = static_cast<U8>((crc >> 8) & 0xFF);
+    view->suffix[2] = AX25_FLAG;
+
+    if (message.fx25Roots != 0) {
+        // The body (everything between the flags) in its three pieces
+        const AX25::Fx25::Piece body[] = {
+            {&view->prefix[1], static_cast<FwSizeType>(view->prefixSize) - 1},
+            {view->info, view->infoSize},
+            {view->suffix, AX25::FrameView::SUFFIX_SIZE - 1},
+        };
+        view->fx25Size = AX25::Fx25::encode(message.fx25Roots, body, 3, view->fx25);
+        FW_ASSERT(view->fx25Size > 0, static_cast<FwAssertArgType>(view->infoSize));
+    }
+
+    message.nextIndex++;
+    message.outstanding++;
+    if (message.packed) {
+        m_packedFrameBytes += view->sentSize();
+        if (message.nextIndex == message.count) {
+            m_packedBytes += message.packetBytes;
+        }
+    }
+    this->frameForwarded(startNs, view->sentSize());
+    return buffer;
+}
+
+void AMSATFramer::resendSegment(FwSizeType slot, FwSizeType frameSize) {
+    // The segment goes again before anything else once RadioBridge reports
+    // SUCCESS, so the message is neither cut short nor reordered
+    PendingMessage& message = m_pending[slot];
+    FW_ASSERT(message.nextIndex > 0, static_cast<FwAssertArgType>(slot));
+    FW_ASSERT((m_segmenting == NO_MESSAGE) || (m_segmenting == slot), static_cast<FwAssertArgType>(m_segmenting));
+    message.nextIndex--;
+    m_segmenting = slot;
+
+    // It was not forwarded after all
+    m_framesFramed--;
+    m_bytesFramed -= static_cast<U32>(frameSize);
+    if (message.packed) {
+        m_packedFrameBytes -= frameSize;
+        if (message.nextIndex + 1U == message.count) {
+            m_packedBytes -= message.packetBytes;
+        }
+    }
+}
+
+bool AMSATFramer::retireMessage(FwSizeType slot, Fw::Buffer& source, ComCfg::FrameContext& context) {
+    PendingMessage& message = m_pending[slot];
+    if ((message.outstanding > 0) || (message.nextIndex < message.count) || (slot == m_sendingSlot)) {
+        return false;
+    }
+    message.active = false;
+    source = message.buffer;
+    context = message.context;
+    return !message.packed;
+}
+
+void AMSATFramer::accrueLoad() {
+    if (!m_load.active) {
+        return;
+    }
+    const U64 nowNs = Instrumentation::monotonicNs();
+    m_load.credit += (nowNs - m_load.lastNs) * m_load.rate;
+    m_load.lastNs = nowNs;
+    m_load.due += static_cast<U32>(m_load.credit / 1000000000ULL);
+    m_load.credit %= 1000000000ULL;
+    // Frames owed for longer than a second would only go out as a burst later
+    if (m_load.due > m_load.rate) {
+        m_load.skipped += m_load.due - m_load.rate;
+        m_load.due = m_load.rate;
+    }
+}
+
+FwSizeType AMSATFramer::nextLoadSize() {
+    U32 x = m_load.random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    m_load.random = x;
+
+    switch (m_load.sizes.e) {
+        case LoadSizes::UNIFORM:
+            return m_load.minSize + x % (static_cast<U32>(m_load.maxSize - m_load.minSize) + 1);
+        case LoadSizes::BIMODAL:
+            return ((x & 7) == 0) ? m_load.maxSize : m_load.minSize;
+        default:
+            return m_load.maxSize;
+    }
+}
+
+Fw::Buffer AMSATFramer::nextLoadFrame() {
+    const U64 startNs = Instrumentation::monotonicNs();
+    const FwSizeType size = this->nextLoadSize();
+    RouteHeader route;
+    this->getRoute(m_load.context.get_comQueueIndex(), route);
+    Fw::Buffer frame = this->bufferAllocate_out(0, prefixSize(route) + size + AX25_TAILROOM);
+    if (frame.getData() == nullptr) {
+        return frame;
+    }
+
+    U8* framePtr = frame.getData();
+    U8* payload = framePtr + this->writeHeader(framePtr, route);
+    const Fw::Time now = this->getTime();
+    m_load.header.seconds = now.getSeconds();
+    m_load.header.useconds = now.getUSeconds();
+    m_load.header.serialize(payload);
+    AX25::loadFill(m_load.header, m_loadReplay, m_loadReplaySize, &payload[AX25::LoadHeader::SIZE],
+                   size - AX25::LoadHeader::SIZE);
+    frame.setSize(finishFrame(framePtr, route, size));
+
+    for (FwSizeType i = 0; i < MAX_LOAD_IN_FLIGHT; i++) {
+        if (m_load.inFlight[i] == nullptr) {
+            m_load.inFlight[i] = framePtr;
+            break;
+        }
+    }
+    m_load.outstanding++;
+    m_load.header.sequence++;
+    m_load.due--;
+    m_load.generated++;
+    this->frameForwarded(startNs, frame.getSize());
+    return frame;
+}
+
+bool AMSATFramer::releaseLoadFrame(const U8* frame) {
+    if (m_load.outstanding == 0) {
+        return false;
+    }
+    for (FwSizeType i = 0; i < MAX_LOAD_IN_FLIGHT; i++) {
+        if (m_load.inFlight[i] == frame) {
+            m_load.inFlight[i] = nullptr;
+            m_load.outstanding--;
+            m_load.returned++;
+            return true;
+        }
+    }
+    return false;
+}
+
+Fw::Buffer AMSATFramer::nextTestFrame() {
+    // A telemetry packet with the time and the test value, padded to 20 bytes
+    const FwSizeType testDataSize = 20;
+    U8 testData[20];
+    FwSizeType offset = 0;
+
+    testData[offset++] = 0x01;        // packet type
+    testData[offset++] = 0x50;        // comp id hi
+    testData[offset++] = 0x00;        // comp id lo
+    testData[offset++] = 0x01;        // channel id
+
+    const U32 timestamp = this->getTime().getSeconds();
+    testData[offset++] = (timestamp >> 24) & 0xFF;
+    testData[offset++] = (timestamp >> 16) & 0xFF;
+    testData[offset++] = (timestamp >> 8) & 0xFF;
+    testData[offset++] = timestamp & 0xFF;
+
+    testData[offset++] = (m_testValue >> 24) & 0xFF;
+    testData[offset++] = (m_testValue >> 16) & 0xFF;
+    testData[offset++] = (m_testValue >> 8) & 0xFF;
+    testData[offset++] = m_testValue & 0xFF;
+
+    for (; offset < testDataSize; offset++) {
+        testData[offset] = 0xAA;
+    }
+
+    Fw::Buffer amsatFrame = this->bufferAllocate_out(0, testDataSize + AX25_HEADROOM + AX25_TAILROOM);
+    if (amsatFrame.getData() == nullptr) {
+        return amsatFrame;
+    }
+
+    // Sent as comQueue index 0, on that index's route
+    const ComCfg::FrameContext context;
+    RouteHeader route;
+    this->getRoute(context.get_comQueueIndex(), route);
+
+    U8* framePtr = amsatFrame.getData();
+    const FwSizeType frameOffset = writeHeader(framePtr, route);
+    memcpy(&framePtr[frameOffset], testData, testDataSize);
+    amsatFrame.setSize(finishFrame(framePtr, route, testDataSize));
+    return amsatFrame;
+}
+
+void AMSATFramer::returnMessage(Fw::Buffer& buffer, const ComCfg::FrameContext& context) {
+    if (this->isConnected_dataReturnOut_OutputPort(0)) {
+        this->dataReturnOut_out(0, buffer, context);
+    }
+}
+
+void AMSATFramer::frameForwarded(U64 startNs, FwSizeType frameSize) {
+    m_framingTime.recordSince(startNs);
+    m_framesFramed++;
+    m_bytesFramed += static_cast<U32>(frameSize);
+    this->writeTelemetry();
+}
+
+void AMSATFramer::writeTelemetry() {
+    const U64 nowNs = Instrumentation::monotonicNs();
+    if ((m_lastTlmNs != 0) && (nowNs - m_lastTlmNs < TLM_INTERVAL_NS)) {
+        return;
+    }
+    m_lastTlmNs = nowNs;
+
+    this->tlmWrite_FramingTimeBins(m_framingTime.getBins());
+    this->tlmWrite_FramingTimeMeanUs(m_framingTime.getMeanUs());
+    this->tlmWrite_FramingTimeMaxUs(m_framingTime.getMaxUs());
+    this->tlmWrite_FramesFramed(m_framesFramed);
+    this->tlmWrite_BytesFramed(m_bytesFramed);
+    this->tlmWrite_FramerDrops(m_drops);
+    this->tlmWrite_MessagesSegmented(m_messagesSegmented);
+    this->tlmWrite_PacketsPacked(m_packetsPacked);
+    if (m_packedFrameBytes > 0) {
+        // Packet bytes over the frame bytes (flags, header, FCS included) that carried them
+        this->tlmWrite_PackingEfficiency(
+            static_cast<F32>(100.0 * static_cast<F64>(m_packedBytes) / static_cast<F64>(m_packedFrameBytes)));
+    }
+    if (m_compressionOut > 0) {
+        this->tlmWrite_CompressionRatio(
+            static_cast<F32>(static_cast<F64>(m_compressionIn) / static_cast<F64>(m_compressionOut)));
+    }
+    this->tlmWrite_LoadGenerated(m_load.generated);
+    this->tlmWrite_LoadReturned(m_load.returned);
+    this->tlmWrite_LoadSkipped(m_load.skipped);
+}
+
+FwSizeType AMSATFramer::writeHeader(U8* frame, const RouteHeader& route) {
+    FW_ASSERT(frame != nullptr);
+    frame[0] = AX25_FLAG;
+    memcpy(&frame[1], route.bytes, route.size);
+
+    AX25::SegmentHeader segment;
+    segment.message = AX25::SegmentHeader::SINGLE_MESSAGE;
+    segment.packed = false;
+    segment.compressed = false;
+    segment.index = 0;
+    segment.count = 1;
+    segment.serialize(&frame[1 + route.size]);
+    return prefixSize(route);
+}
+
+FwSizeType AMSATFramer::finishFrame(U8* frame, const RouteHeader& route, FwSizeType payloadSize) {
+    FW_ASSERT(frame != nullptr);
+    FwSizeType offset = prefixSize(route) + payloadSize;
+
+    // Segment header and payload follow the cached address/control/PID header
+    const FwSizeType infoSize = AX25::SegmentHeader::SIZE + payloadSize;
+    U16 crc = AX25::Crc16::finish(AX25::Crc16::update(route.crc, &frame[1 + route.size], infoSize));
+    frame[offset++] = static_cast<U8>(crc & 0xFF);
+    frame[offset++] = static_cast<U8>((crc >> 8) & 0xFF);
+
+    frame[offset++] = AX25_FLAG;
+    return offset;
+}
+
 FwSizeType AMSATFramer::encodeAddress(U8* dest, const char* callsign, U8 ssid, bool isLast) {
     FW_ASSERT(dest != nullptr);
     FW_ASSERT(callsign != nullptr);
@@ -264,14 +1171,4 @@ FwSizeType AMSATFramer::encodeAddress(U8* dest, const char* callsign, U8 ssid, b
     return 7;  // 6 callsign + 1 SSID
 }
 
-U16 AMSATFramer::calculateCRC16(const U8* data, FwSizeType length) {
-    FW_ASSERT(data != nullptr);
-
-    U16 crc = 0xFFFF;
-    for (FwSizeType i = 0; i < length; i++) {
-        crc = static_cast<U16>((crc >> 8) ^ crc16Table[(crc ^ data[i]) & 0xFF]);
-    }
-    return static_cast<U16>(crc ^ 0xFFFF);
-}
-
 }  // namespace Svc
\ No newline at end of file
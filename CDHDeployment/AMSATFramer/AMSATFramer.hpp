@@ -2,7 +2,18 @@
 #define Svc_AMSATFramer_HPP
 
 #include "CDHDeployment/AMSATFramer/AMSATFramerComponentAc.hpp"
+#include "CDHDeployment/AX25/Compression.hpp"
+#include "CDHDeployment/AX25/FrameView.hpp"
+#include "CDHDeployment/AX25/Fx25.hpp"
+#include "CDHDeployment/AX25/LoadPayload.hpp"
+#include "CDHDeployment/AX25/Packing.hpp"
+#include "CDHDeployment/AX25/Segmentation.hpp"
+#include "CDHDeployment/Instrumentation/LatencyHistogram.hpp"
+#include "Fw/Com/ComBuffer.hpp"
 #include "Fw/Types/BasicTypes.hpp"
+#include "Os/Mutex.hpp"
+#include <atomic>
+#include <limits>
 
 namespace Svc {
 
@@ -11,9 +22,21 @@ class AMSATFramer : public AMSATFramerComponentBase {
   AMSATFramer(const char* const compName);
   ~AMSATFramer();
 
+  //! Source address of every route
   void setSourceCallsign(const char* callsign, U8 ssid);
+  //! Destination of the default route, used by comQueue indices without one of their own
   void setDestCallsign(const char* callsign, U8 ssid);
 
+  //! comQueue indices from `firstQueue` up are buffer queues, whose buffers stay
+  //! valid until returned, so their segments borrow the buffer. Packet queue
+  //! buffers are only valid during dataIn and are copied into a pack.
+  void setBorrowedQueues(FwIndexType firstQueue);
+
+  //! Bytes reserved ahead of payloads from payloadAllocate: start flag, the longest address/control/PID and segment header
+  static constexpr FwSizeType AX25_HEADROOM = AX25::FrameView::PREFIX_SIZE;
+  //! Bytes reserved after payloads from payloadAllocate: FCS + end flag
+  static constexpr FwSizeType AX25_TAILROOM = AX25::FrameView::SUFFIX_SIZE;
+
  protected:
   void dataIn_handler(
       FwIndexType portNum,
@@ -27,15 +50,63 @@ class AMSATFramer : public AMSATFramerComponentBase {
       const ComCfg::FrameContext& context
   ) override;
 
+  void comStatusIn_handler(
+      FwIndexType portNum,
+      Fw::Success& condition
+  ) override;
+
+  void schedIn_handler(
+      FwIndexType portNum,
+      U32 context
+  ) override;
+
+  Fw::Buffer payloadAllocate_handler(
+      FwIndexType portNum,
+      FwSizeType size
+  ) override;
+
+  void payloadDeallocate_handler(
+      FwIndexType portNum,
+      Fw::Buffer& fwBuffer
+  ) override;
+
   void TEST_SEND_DATA_cmdHandler(
       FwOpcodeType opCode,
       U32 cmdSeq,
       U32 testValue
   ) override;
 
- private:
-  static const U16 crc16Table[256];
+  void LOAD_START_cmdHandler(
+      FwOpcodeType opCode,
+      U32 cmdSeq,
+      U32 rate,
+      U16 minSize,
+      U16 maxSize,
+      Svc::LoadSizes sizes,
+      AX25::LoadPattern pattern
+  ) override;
+
+  void LOAD_STOP_cmdHandler(
+      FwOpcodeType opCode,
+      U32 cmdSeq
+  ) override;
+
+  void ROUTE_SET_cmdHandler(
+      FwOpcodeType opCode,
+      U32 cmdSeq,
+      U8 queue,
+      const Fw::CmdStringArg& destination,
+      U8 ssid,
+      const Fw::CmdStringArg& path
+  ) override;
+
+  void ROUTE_CLEAR_cmdHandler(
+      FwOpcodeType opCode,
+      U32 cmdSeq,
+      U8 queue
+  ) override;
 
+ private:
   enum : U8 {
     AX25_CONTROL = 0x03,
     AX25_PID     = 0xF0,
@@ -51,13 +122,232 @@ class AMSATFramer : public AMSATFramerComponentBase {
   static constexpr U8  AX25_SSID_RESERVED = 0x60;
   static constexpr U8  AX25_SSID_LAST     = 0x61;
 
-  char m_srcCallsign[AX25_CALLSIGN_LEN + 1];
-  char m_destCallsign[AX25_CALLSIGN_LEN + 1];
-  U8   m_srcSSID;
-  U8   m_destSSID;
+  //! comQueue indices that may have a route of their own
+  static constexpr FwSizeType MAX_ROUTES = 16;
+  //! ROUTE_SET/ROUTE_CLEAR queue number of the default route
+  static constexpr U8 DEFAULT_ROUTE = 0xFF;
+  //! Payload buffers handed out by payloadAllocate that may be outstanding at once
+  static constexpr FwSizeType MAX_RESERVED_BUFFERS = 16;
+  //! Shortest interval between telemetry updates from dataIn
+  static constexpr U64 TLM_INTERVAL_NS = 1000000000ULL;
+  //! Com buffers that may be waiting for their segments to come back
+  static constexpr FwSizeType MAX_PENDING_MESSAGES = 32;
+  static constexpr FwSizeType NO_MESSAGE = MAX_PENDING_MESSAGES;
+  //! Largest pack: one full com buffer with its length, or PACK_MTU if larger
+  static constexpr FwSizeType MAX_STAGED_SIZE = AX25::packedSize(FW_COM_BUFFER_MAX_SIZE);
+  //! Highest LOAD_START rate, frames per second
+  static constexpr U32 MAX_LOAD_RATE = 1000;
+  //! Load frames that may be waiting for RadioBridge at once
+  static constexpr FwSizeType MAX_LOAD_IN_FLIGHT = 16;
+
+  //! A station: callsign and SSID
+  struct Address {
+    char callsign[AX25_CALLSIGN_LEN + 1];
+    U8   ssid;
+  };
+
+  //! Encoded address/control/PID block of a route and the running FCS
+  //! state after it, so frames copy it rather than encode it
+  struct RouteHeader {
+    U8         bytes[AX25::MAX_HEADER_SIZE];
+    FwSizeType size;
+    U16        crc;
+  };
+
+  //! Where frames of one comQueue index go. The addresses are only touched
+  //! under m_routeLock. The header is a seqlock: `sequence` is odd while a
+  //! change is written, and a reader copies the header without a lock and
+  //! copies it again if the sequence was odd or moved meanwhile, however
+  //! long it was held up between the two.
+  struct Route {
+    std::atomic<U32>  sequence;
+    std::atomic<bool> set;
+    Address           destination;
+    Address           path[AX25::MAX_DIGIPEATERS];
+    FwSizeType        pathLength;
+    RouteHeader       header;
+  };
+
+  Address   m_source;
+  //! Routes by comQueue index, then the default route
+  Route     m_routes[MAX_ROUTES + 1];
+  //! Serializes route changes
+  Os::Mutex m_routeLock;
+
+  //! Payload handed out with headroom, so dataIn knows it may frame in place
+  struct ReservedPayload {
+    U8*        payload;
+    FwSizeType capacity;
+  };
+  ReservedPayload m_reserved[MAX_RESERVED_BUFFERS];
+  Os::Mutex       m_reservedLock;
+
+  //! Com buffer, or pack of packet-queue buffers, being sent as segment views;
+  //! kept until every view is returned
+  struct PendingMessage {
+    Fw::Buffer           buffer;
+    ComCfg::FrameContext context;
+    //! Bytes the segments borrow: the buffer itself, or the pack
+    const U8*            data;
+    FwSizeType           size;
+    //! Packed copies; the buffers went back upstream on dataIn
+    bool                 packed;
+    bool                 compressed;
+    //! When the first packet went into the pack
+    U64                  openedNs;
+    //! Packet bytes in the pack, without record lengths or compression
+    FwSizeType           packetBytes;
+    //! Header of the route the message was opened on, so a route change
+    //! never splits a message
+    RouteHeader          route;
+    //! Payload per segment and FX.25 check bytes (0 for none), fixed when the slot opens
+    FwSizeType           stride;
+    FwSizeType           fx25Roots;
+    U16                  message;
+    U8                   count;
+    U8                   nextIndex;
+    U32                  outstanding;
+    bool                 active;
+  };
+  PendingMessage m_pending[MAX_PENDING_MESSAGES];
+  U8             m_staging[MAX_PENDING_MESSAGES][MAX_STAGED_SIZE];
+  //! Compression working memory and output, used under m_segmentLock
+  AX25::Compressor m_compressor;
+  U8             m_compressed[MAX_STAGED_SIZE];
+  //! First comQueue index whose buffers are borrowed rather than staged
+  FwIndexType    m_firstBorrowedQueue;
+  //! Slot of the pack taking packets, NO_MESSAGE if none is open
+  FwSizeType m_packing;
+  //! Slots of complete messages waiting to be segmented, oldest first
+  FwSizeType m_ready[MAX_PENDING_MESSAGES];
+  FwSizeType m_readyHead;
+  FwSizeType m_readyCount;
+  //! Slot of the message being segmented, NO_MESSAGE between messages
+  FwSizeType m_segmenting;
+  //! RadioBridge can take another frame
+  bool       m_downstreamReady;
+  //! SUCCESS went upstream and the next com buffer has not arrived yet
+  bool       m_upstreamReady;
+  //! A thread is in pumpSegments(); others only update state for it
+  bool       m_pumping;
+  //! pumpSegments() is handing a segment or test frame to RadioBridge
+  bool       m_sending;
+  //! Slot of that segment, not retired until the call is over; NO_MESSAGE otherwise
+  FwSizeType m_sendingSlot;
+  //! RadioBridge reported FAILURE during that call: its ring was full and
+  //! the frame came back unsent
+  bool       m_sendRefused;
+  //! TEST_SEND_DATA frame waiting for RadioBridge, and its value
+  bool       m_testPending;
+  U32        m_testValue;
+  //! Number for the next message of several segments
+  std::atomic<U16> m_nextMessage;
+  //! Guards the segmentation state and the statistics below
+  Os::Mutex  m_segmentLock;
+
+  //! Load stream started by LOAD_START, guarded by m_segmentLock
+  struct LoadStream {
+    bool                 active;
+    AX25::LoadHeader     header;
+    U32                  rate;
+    U16                  minSize;
+    U16                  maxSize;
+    LoadSizes            sizes;
+    ComCfg::FrameContext context;
+    //! Frames owed, in frame-nanoseconds, since lastNs
+    U64                  credit;
+    U64                  lastNs;
+    //! Frames owed and not yet built, at most a second's worth
+    U32                  due;
+    //! xorshift32 state for the payload sizes
+    U32                  random;
+    U32                  generated;
+    U32                  returned;
+    U32                  skipped;
+    //! Frames out on dataOut, nullptr for a free entry
+    const U8*            inFlight[MAX_LOAD_IN_FLIGHT];
+    FwSizeType           outstanding;
+  };
+  LoadStream m_load;
+  //! Number of the last stream started
+  U32        m_loadStreams;
+  //! Last packet-queue buffer, for the REPLAY pattern
+  U8         m_loadReplay[FW_COM_BUFFER_MAX_SIZE];
+  FwSizeType m_loadReplaySize;
+
+  //! Framing statistics
+  Instrumentation::LatencyHistogram m_framingTime;
+  U32 m_framesFramed;
+  U32 m_bytesFramed;
+  U32 m_drops;
+  U32 m_messagesSegmented;
+  U32 m_packetsPacked;
+  //! Packet bytes of fully segmented packs and the frame bytes that carried packs
+  U64 m_packedBytes;
+  U64 m_packedFrameBytes;
+  U64 m_compressionIn;
+  U64 m_compressionOut;
+  U64 m_lastTlmNs;
+
+  //! Encode `route`'s header and publish it to readers; m_routeLock must be held
+  void publishRoute(Route& route);
+  //! Copy the header for frames of comQueue index `queue`
+  void getRoute(FwIndexType queue, RouteHeader& header) const;
+  //! Parse CALL or CALL-SSID; false unless 1 to 6 letters and digits and an SSID of 0 to 15
+  static bool parseAddress(const char* text, FwSizeType length, Address& address);
+  //! Opening flag, header and segment header of a frame on `route`
+  static FwSizeType prefixSize(const RouteHeader& route) { return 1 + route.size + AX25::SegmentHeader::SIZE; }
+  //! Forget a reserved payload; true (with its allocated capacity) if it was one of ours
+  bool releaseReserved(const U8* payload, FwSizeType& capacity);
+  //! Return a payload buffer to the buffer manager, undoing the headroom offset if reserved
+  void deallocatePayload(Fw::Buffer& payload, bool reserved);
+  //! Write start flag, the route's header and a single-segment header at `frame`, return bytes written
+  FwSizeType writeHeader(U8* frame, const RouteHeader& route);
+  //! Append FCS over header+payload and the end flag, return total frame size
+  static FwSizeType finishFrame(U8* frame, const RouteHeader& route, FwSizeType payloadSize);
+
+  //! Segment payload that keeps a frame with a `headerSize` byte header
+  //! within the FX.25 code with `roots` check bytes
+  static FwSizeType segmentStride(FwSizeType roots, FwSizeType headerSize);
+
+  //! Send segments while RadioBridge is ready and ask upstream for more while a slot is free
+  void pumpSegments();
+  //! First inactive message slot, NO_MESSAGE if all are in use; m_segmentLock must be held
+  FwSizeType freeSlot() const;
+  //! Number `slot` and queue it for segmenting; m_segmentLock must be held
+  void queueMessage(FwSizeType slot);
+  //! Compress the closed pack in `slot` in place if that makes it smaller; m_segmentLock must be held
+  void compressPack(FwSizeType slot);
+  //! Queue the open pack, if any; m_segmentLock must be held
+  void closePack();
+  //! Build the view of the next segment of `message`; invalid buffer if none could be allocated
+  Fw::Buffer nextSegment(PendingMessage& message);
+  //! Send the last segment of `slot` again, RadioBridge having refused it; m_segmentLock must be held
+  void resendSegment(FwSizeType slot, FwSizeType frameSize);
+  //! Free `slot` once every segment went out and came back; true (with the
+  //! com buffer to return upstream) if it borrowed one. m_segmentLock must be held
+  bool retireMessage(FwSizeType slot, Fw::Buffer& source, ComCfg::FrameContext& context);
+  //! Build the TEST_SEND_DATA frame; invalid buffer if none could be allocated.
+  //! m_segmentLock must be held
+  Fw::Buffer nextTestFrame();
+  //! Add the load frames owed since the last call; m_segmentLock must be held
+  void accrueLoad();
+  //! Payload size of the next load frame
+  FwSizeType nextLoadSize();
+  //! Build the next load frame; invalid buffer if none could be allocated.
+  //! m_segmentLock must be held
+  Fw::Buffer nextLoadFrame();
+  //! Forget a returned load frame; true if `frame` was one. m_segmentLock must be held
+  bool releaseLoadFrame(const U8* frame);
+  //! Return a com buffer upstream
+  void returnMessage(Fw::Buffer& buffer, const ComCfg::FrameContext& context);
+
+  //! Account for a frame about to leave on dataOut; m_segmentLock must be held
+  void frameForwarded(U64 startNs, FwSizeType frameSize);
+  //! Publish statistics if the telemetry interval has passed; m_segmentLock must be held
+  void writeTelemetry();
 
   FwSizeType encodeAddress(U8* dest, const char* callsign, U8 ssid, bool isLast);
-  static U16 calculateCRC16(const U8* data, FwSizeType length);
 };
 
 } // namespace Svc
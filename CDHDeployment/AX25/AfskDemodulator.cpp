@@ -0,0 +1,100 @@
+// ======================================================================
+// \title  AfskDemodulator.cpp
+// \author madisonw
+// \brief  Correlator-bank Bell 202 AFSK demodulator
+// ======================================================================
+
+#include "CDHDeployment/AX25/AfskDemodulator.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace AX25 {
+
+AfskDemodulator::AfskDemodulator(const Config& config) : m_config(config) {
+    FW_ASSERT(config.baudRate > 0);
+    FW_ASSERT(config.sampleRate >= 4 * config.baudRate,
+              static_cast<FwAssertArgType>(config.sampleRate),
+              static_cast<FwAssertArgType>(config.baudRate));
+
+    for (U32 i = 0; i < TABLE_SIZE; i++) {
+        const F64 angle = 2.0 * M_PI * static_cast<F64>(i) / static_cast<F64>(TABLE_SIZE);
+        m_cosTable[i] = static_cast<I16>(std::lround(std::cos(angle) * 32767.0));
+    }
+
+    m_window = (config.sampleRate * config.windowPercent / 100 + config.baudRate / 2) / config.baudRate;
+    FW_ASSERT((m_window > 0) && (m_window <= MAX_WINDOW), static_cast<FwAssertArgType>(m_window));
+
+    // Energies stay below 2^47, so a Q8 gain up to 16 cannot overflow
+    FW_ASSERT((config.spaceGain > 0.0f) && (config.spaceGain <= 16.0f));
+    m_spaceGain = std::lround(config.spaceGain * static_cast<F32>(1U << GAIN_SHIFT));
+
+    m_markStep = static_cast<U32>((static_cast<U64>(config.markFreq) << 32) / config.sampleRate);
+    m_spaceStep = static_cast<U32>((static_cast<U64>(config.spaceFreq) << 32) / config.sampleRate);
+    m_pllStep = static_cast<U32>((static_cast<U64>(config.baudRate) << 32) / config.sampleRate);
+
+    this->reset();
+}
+
+void AfskDemodulator::reset() {
+    m_markPhase = 0;
+    m_spacePhase = 0;
+    memset(m_history, 0, sizeof(m_history));
+    memset(&m_sums, 0, sizeof(m_sums));
+    m_historyIndex = 0;
+    m_pll = 0;
+    m_lastTone = true;
+    m_lastBitTone = true;
+}
+
+void AfskDemodulator::process(const I16* samples, FwSizeType count, HdlcDeframer& deframer) {
+    FW_ASSERT(samples != nullptr);
+
+    // Quadrature is a quarter turn behind the cosine
+    const U32 shift = 32 - TABLE_BITS;
+    const U32 quarter = 1U << 30;
+
+    for (FwSizeType n = 0; n < count; n++) {
+        const I32 x = samples[n];
+
+        Taps taps;
+        taps.markI = (x * m_cosTable[m_markPhase >> shift]) >> 15;
+        taps.markQ = (x * m_cosTable[(m_markPhase - quarter) >> shift]) >> 15;
+        taps.spaceI = (x * m_cosTable[m_spacePhase >> shift]) >> 15;
+        taps.spaceQ = (x * m_cosTable[(m_spacePhase - quarter) >> shift]) >> 15;
+        m_markPhase += m_markStep;
+        m_spacePhase += m_spaceStep;
+
+        // Sliding one-bit integration
+        Taps& oldest = m_history[m_historyIndex];
+        m_sums.markI += taps.markI - oldest.markI;
+        m_sums.markQ += taps.markQ - oldest.markQ;
+        m_sums.spaceI += taps.spaceI - oldest.spaceI;
+        m_sums.spaceQ += taps.spaceQ - oldest.spaceQ;
+        oldest = taps;
+        if (++m_historyIndex == m_window) {
+            m_historyIndex = 0;
+        }
+
+        const I64 markEnergy = static_cast<I64>(m_sums.markI) * m_sums.markI +
+                               static_cast<I64>(m_sums.markQ) * m_sums.markQ;
+        const I64 spaceEnergy = static_cast<I64>(m_sums.spaceI) * m_sums.spaceI +
+                                static_cast<I64>(m_sums.spaceQ) * m_sums.spaceQ;
+        const bool tone = (markEnergy << GAIN_SHIFT) > spaceEnergy * m_spaceGain;
+
+        // Sample when the PLL wraps from positive to negative; transitions
+        // belong halfway between samples, so pull the phase toward zero
+        const I32 previous = m_pll;
+        m_pll = static_cast<I32>(static_cast<U32>(m_pll) + m_pllStep);
+        if ((previous > 0) && (m_pll < 0)) {
+            deframer.pushBit(tone == m_lastBitTone);
+            m_lastBitTone = tone;
+        }
+        if (tone != m_lastTone) {
+            m_pll = static_cast<I32>(static_cast<F32>(m_pll) * PLL_INERTIA);
+            m_lastTone = tone;
+        }
+    }
+}
+
+}  // namespace AX25
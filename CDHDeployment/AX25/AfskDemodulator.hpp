@@ -0,0 +1,93 @@
+// ======================================================================
+// \title  AfskDemodulator.hpp
+// \author madisonw
+// \brief  Correlator-bank Bell 202 AFSK demodulator
+// ======================================================================
+
+#ifndef AX25_AfskDemodulator_HPP
+#define AX25_AfskDemodulator_HPP
+
+#include "CDHDeployment/AX25/HdlcDeframer.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! Turns 16-bit PCM back into NRZI-decoded bits for an HdlcDeframer.
+//!
+//! Four correlators (in-phase and quadrature for the mark and the space tone)
+//! are integrated over a sliding one-bit window; the tone with more energy
+//! wins each sample. A digital PLL nudged by tone transitions picks the
+//! sampling instant, and a bit is 1 when the tone did not change since the
+//! previous bit. Everything runs in integer arithmetic, so long recordings
+//! do not accumulate rounding drift.
+class AfskDemodulator {
+  public:
+    struct Config {
+        U32 sampleRate;
+        U32 baudRate;
+        U32 markFreq;
+        U32 spaceFreq;
+        //! Correlation window as a percentage of a bit; shorter widens the
+        //! tone filters, trading noise for tolerance of off-frequency tones
+        U32 windowPercent;
+        //! Weight of the space energy in the tone decision; above 1 makes up
+        //! for de-emphasized audio, where 2200 Hz arrives weaker than 1200 Hz
+        F32 spaceGain;
+
+        Config()
+            : sampleRate(48000),
+              baudRate(1200),
+              markFreq(1200),
+              spaceFreq(2200),
+              windowPercent(100),
+              spaceGain(1.0f) {}
+    };
+
+    explicit AfskDemodulator(const Config& config = Config());
+
+    //! Clear correlator history and PLL state
+    void reset();
+
+    //! Demodulate `count` samples, pushing recovered bits into `deframer`
+    void process(const I16* samples, FwSizeType count, HdlcDeframer& deframer);
+
+  private:
+    static constexpr U32 TABLE_BITS = 10;
+    static constexpr U32 TABLE_SIZE = 1U << TABLE_BITS;
+    //! Longest correlation window supported (one bit at 300 baud, 48 kHz)
+    static constexpr U32 MAX_WINDOW = 160;
+    //! PLL phase kept after a transition; lower pulls harder toward the bit edge
+    static constexpr F32 PLL_INERTIA = 0.74f;
+    //! Fraction bits of the space gain
+    static constexpr U32 GAIN_SHIFT = 8;
+
+    struct Taps {
+        I32 markI;
+        I32 markQ;
+        I32 spaceI;
+        I32 spaceQ;
+    };
+
+    Config m_config;
+    I16 m_cosTable[TABLE_SIZE];
+
+    U32 m_window;
+    I64 m_spaceGain;
+    U32 m_markStep;
+    U32 m_spaceStep;
+    U32 m_pllStep;
+
+    U32 m_markPhase;
+    U32 m_spacePhase;
+    Taps m_history[MAX_WINDOW];
+    U32 m_historyIndex;
+    Taps m_sums;
+
+    I32 m_pll;
+    bool m_lastTone;
+    bool m_lastBitTone;
+};
+
+}  // namespace AX25
+
+#endif
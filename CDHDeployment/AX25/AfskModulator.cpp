@@ -0,0 +1,55 @@
+// ======================================================================
+// \title  AfskModulator.cpp
+// \author madisonw
+// \brief  Bell 202 AFSK modulator for HDLC-framed AX.25 frames
+// ======================================================================
+
+#include "CDHDeployment/AX25/AfskModulator.hpp"
+#include <cmath>
+
+namespace AX25 {
+
+static_assert(AfskModulator::SAMPLE_RATE % AfskModulator::BAUD_RATE == 0,
+              "Sample rate must be a whole multiple of the baud rate");
+
+AfskModulator::AfskModulator(I16 amplitude) : Modulator(BAUD_RATE, LEAD_FLAGS, 0) {
+    const F64 twoPi = 2.0 * M_PI;
+    for (U32 i = 0; i < SINE_TABLE_SIZE; i++) {
+        F64 value = std::sin(twoPi * static_cast<F64>(i) / static_cast<F64>(SINE_TABLE_SIZE));
+        m_sineTable[i] = static_cast<I16>(std::lround(value * amplitude));
+    }
+
+    // Phase increments per sample for a 32-bit accumulator
+    m_markStep = static_cast<U32>((static_cast<U64>(MARK_FREQ) << 32) / SAMPLE_RATE);
+    m_spaceStep = static_cast<U32>((static_cast<U64>(SPACE_FREQ) << 32) / SAMPLE_RATE);
+
+    this->reset();
+}
+
+void AfskModulator::reset() {
+    Modulator::reset();
+    m_phase = 0;
+    m_mark = true;
+}
+
+Modulator::State AfskModulator::saveState() const {
+    return static_cast<State>(m_phase) | (static_cast<State>(m_mark ? 1 : 0) << 32);
+}
+
+void AfskModulator::restoreState(State state) {
+    m_phase = static_cast<U32>(state);
+    m_mark = ((state >> 32) & 0x01) != 0;
+}
+
+void AfskModulator::renderBit(bool bit, I16* out) {
+    if (!bit) {
+        m_mark = !m_mark;
+    }
+    const U32 step = m_mark ? m_markStep : m_spaceStep;
+    for (U32 i = 0; i < SAMPLES_PER_BIT; i++) {
+        out[i] = m_sineTable[m_phase >> (32 - SINE_TABLE_BITS)];
+        m_phase += step;
+    }
+}
+
+}  // namespace AX25
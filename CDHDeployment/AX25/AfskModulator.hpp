@@ -0,0 +1,59 @@
+// ======================================================================
+// \title  AfskModulator.hpp
+// \author madisonw
+// \brief  Bell 202 AFSK modulator for HDLC-framed AX.25 frames
+// ======================================================================
+
+#ifndef AX25_AfskModulator_HPP
+#define AX25_AfskModulator_HPP
+
+#include "CDHDeployment/AX25/Modulator.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! Renders AX.25 frames as 1200 baud Bell 202 AFSK audio (16-bit PCM).
+//!
+//! Frames are NRZI encoded (a 0 bit toggles the tone, a 1 bit keeps it),
+//! bit stuffed between HDLC flags and sent LSB first. Tones come from a
+//! phase-continuous NCO stepping through a precomputed sine table, so the
+//! rendered audio matches what gen_packets used to write to disk.
+class AfskModulator : public Modulator {
+  public:
+    static constexpr U32 BAUD_RATE = 1200;
+    static constexpr U32 MARK_FREQ = 1200;
+    static constexpr U32 SPACE_FREQ = 2200;
+    static constexpr U32 SAMPLES_PER_BIT = SAMPLE_RATE / BAUD_RATE;
+    //! After a break the first bit may come out wrong (NRZI level, tone
+    //! phase), so one flag absorbs it ahead of the opening flag
+    static constexpr U32 LEAD_FLAGS = 2;
+
+    //! Peak amplitude; half scale matches the gen_packets default and keeps
+    //! the RF gain stage at the same FM deviation as before
+    static constexpr I16 DEFAULT_AMPLITUDE = 16384;
+
+    explicit AfskModulator(I16 amplitude = DEFAULT_AMPLITUDE);
+
+    //! Return the NCO phase and NRZI level to their initial state
+    void reset() override;
+
+    State saveState() const override;
+    void restoreState(State state) override;
+
+  private:
+    static constexpr U32 SINE_TABLE_BITS = 10;
+    static constexpr U32 SINE_TABLE_SIZE = 1U << SINE_TABLE_BITS;
+
+    //! Emit one symbol at the current tone, toggling the tone first for a 0
+    void renderBit(bool bit, I16* out) override;
+
+    I16 m_sineTable[SINE_TABLE_SIZE];
+    U32 m_markStep;
+    U32 m_spaceStep;
+    U32 m_phase;
+    bool m_mark;
+};
+
+}  // namespace AX25
+
+#endif
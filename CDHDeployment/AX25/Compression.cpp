@@ -0,0 +1,192 @@
+// ======================================================================
+// \title  Compression.cpp
+// \author madisonw
+// \brief  LZSS codec for downlink messages, primed with F´ packet headers
+// ======================================================================
+
+#include "CDHDeployment/AX25/Compression.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <cstring>
+
+namespace AX25 {
+
+namespace {
+
+// Start of a telemetry (descriptor 1) or event (descriptor 2) packet from
+// the instance at base id 0xXX00: U16 descriptor, U32 id with the local id
+// left at 0, then the workstation time base (2) and context 0 of its time tag
+#define AX25_TLM_HEADER(base) 0x00, 0x01, 0x00, 0x00, base, 0x00, 0x00, 0x02, 0x00
+#define AX25_LOG_HEADER(base) 0x00, 0x02, 0x00, 0x00, base, 0x00, 0x00, 0x02, 0x00
+
+//! Least used first, so the AMSAT chain sits nearest the data
+const U8 DICTIONARY[] = {
+    // Zero-valued counters and time fractions
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // Instances with events but no downlinked channels
+    AX25_LOG_HEADER(0x0D), AX25_LOG_HEADER(0x45), AX25_LOG_HEADER(0x49), AX25_LOG_HEADER(0x4C),
+    AX25_LOG_HEADER(0x4D), AX25_LOG_HEADER(0x4E),
+    // Instances in CDHDeploymentPackets.fppi: rate groups, command dispatcher
+    // and sequencer, comQueue, file downlink/manager/uplink, health, buffer
+    // manager, system resources, then the AMSAT chain
+    AX25_LOG_HEADER(0x02), AX25_TLM_HEADER(0x02), AX25_LOG_HEADER(0x03), AX25_TLM_HEADER(0x03),
+    AX25_LOG_HEADER(0x04), AX25_TLM_HEADER(0x04), AX25_LOG_HEADER(0x05), AX25_TLM_HEADER(0x05),
+    AX25_LOG_HEADER(0x06), AX25_TLM_HEADER(0x06), AX25_LOG_HEADER(0x07), AX25_TLM_HEADER(0x07),
+    AX25_LOG_HEADER(0x08), AX25_TLM_HEADER(0x08), AX25_LOG_HEADER(0x09), AX25_TLM_HEADER(0x09),
+    AX25_LOG_HEADER(0x0A), AX25_TLM_HEADER(0x0A), AX25_LOG_HEADER(0x20), AX25_TLM_HEADER(0x20),
+    AX25_LOG_HEADER(0x44), AX25_TLM_HEADER(0x44), AX25_LOG_HEADER(0x4A), AX25_TLM_HEADER(0x4A),
+    AX25_LOG_HEADER(0x66), AX25_TLM_HEADER(0x66), AX25_LOG_HEADER(0x51), AX25_TLM_HEADER(0x51),
+    AX25_LOG_HEADER(0x65), AX25_TLM_HEADER(0x65), AX25_LOG_HEADER(0x50), AX25_TLM_HEADER(0x50),
+};
+
+#undef AX25_TLM_HEADER
+#undef AX25_LOG_HEADER
+
+inline FwSizeType hash3(const U8* data) {
+    const U32 key = (static_cast<U32>(data[0]) << 16) | (static_cast<U32>(data[1]) << 8) | data[2];
+    return static_cast<FwSizeType>((key * 2654435761U) >> (32 - 10));
+}
+
+}  // namespace
+
+Compressor::Compressor() {
+    static_assert(sizeof(DICTIONARY) <= MAX_DICTIONARY, "Dictionary does not fit the window");
+    static_assert(WINDOW_SIZE < NO_POSITION, "Window positions must fit the hash chains");
+    static_assert(HASH_BITS == 10, "hash3 assumes 10 hash bits");
+    memcpy(m_window, DICTIONARY, sizeof(DICTIONARY));
+}
+
+FwSizeType Compressor::dictionarySize() {
+    return sizeof(DICTIONARY);
+}
+
+void Compressor::insert(FwSizeType position) {
+    const FwSizeType bucket = hash3(&m_window[position]);
+    m_prev[position] = m_head[bucket];
+    m_head[bucket] = static_cast<U16>(position);
+}
+
+FwSizeType Compressor::compress(const U8* in, FwSizeType size, U8* out, FwSizeType capacity) {
+    FW_ASSERT(in != nullptr);
+    FW_ASSERT(out != nullptr);
+    FW_ASSERT(size <= MAX_INPUT, static_cast<FwAssertArgType>(size));
+
+    const FwSizeType start = sizeof(DICTIONARY);
+    const FwSizeType end = start + size;
+    memcpy(&m_window[start], in, size);
+
+    // The dictionary chains are rebuilt every call: cheaper than keeping a
+    // copy of them, and nothing from a previous message survives
+    for (FwSizeType i = 0; i < HASH_SIZE; i++) {
+        m_head[i] = NO_POSITION;
+    }
+    for (FwSizeType position = 0; position + MIN_MATCH <= start; position++) {
+        this->insert(position);
+    }
+
+    // Stop once the output is no smaller than the input
+    const FwSizeType limit = FW_MIN(capacity, size > 0 ? size - 1 : 0);
+    FwSizeType written = 0;
+    FwSizeType flagOffset = 0;
+    U32 flagBit = 8;
+
+    FwSizeType position = start;
+    while (position < end) {
+        if (flagBit == 8) {
+            if (written >= limit) {
+                return 0;
+            }
+            flagOffset = written++;
+            out[flagOffset] = 0;
+            flagBit = 0;
+        }
+
+        FwSizeType bestLength = 0;
+        FwSizeType bestDistance = 0;
+        const FwSizeType available = FW_MIN(end - position, MAX_MATCH);
+        if (available >= MIN_MATCH) {
+            U16 candidate = m_head[hash3(&m_window[position])];
+            for (FwSizeType chain = 0; (chain < MAX_CHAIN) && (candidate != NO_POSITION); chain++) {
+                const FwSizeType distance = position - candidate;
+                if (distance > MAX_DISTANCE) {
+                    break;
+                }
+                FwSizeType length = 0;
+                while ((length < available) && (m_window[candidate + length] == m_window[position + length])) {
+                    length++;
+                }
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = distance;
+                    if (length == available) {
+                        break;
+                    }
+                }
+                candidate = m_prev[candidate];
+            }
+        }
+
+        if (bestLength >= MIN_MATCH) {
+            if (written + 2 > limit) {
+                return 0;
+            }
+            const U32 code = (static_cast<U32>(bestDistance - 1) << 4) | static_cast<U32>(bestLength - MIN_MATCH);
+            out[written++] = static_cast<U8>(code >> 8);
+            out[written++] = static_cast<U8>(code);
+            out[flagOffset] = static_cast<U8>(out[flagOffset] | (1U << flagBit));
+        } else {
+            if (written + 1 > limit) {
+                return 0;
+            }
+            out[written++] = m_window[position];
+            bestLength = 1;
+        }
+        flagBit++;
+
+        for (FwSizeType i = 0; i < bestLength; i++, position++) {
+            if (position + MIN_MATCH <= end) {
+                this->insert(position);
+            }
+        }
+    }
+    return written;
+}
+
+FwSizeType Compressor::expand(const U8* in, FwSizeType size, U8* out, FwSizeType capacity) {
+    FW_ASSERT(in != nullptr);
+    FW_ASSERT(out != nullptr);
+
+    const FwSizeType dictionary = sizeof(DICTIONARY);
+    FwSizeType read = 0;
+    FwSizeType written = 0;
+    while (read < size) {
+        const U8 flags = in[read++];
+        for (U32 bit = 0; (bit < 8) && (read < size); bit++) {
+            if ((flags & (1U << bit)) == 0) {
+                if (written >= capacity) {
+                    return 0;
+                }
+                out[written++] = in[read++];
+                continue;
+            }
+
+            if (read + 2 > size) {
+                return 0;
+            }
+            const U32 code = (static_cast<U32>(in[read]) << 8) | in[read + 1];
+            read += 2;
+            const FwSizeType distance = (code >> 4) + 1;
+            const FwSizeType length = (code & 0x0F) + MIN_MATCH;
+            if ((distance > written + dictionary) || (written + length > capacity)) {
+                return 0;
+            }
+            // Byte by byte: a match may overlap the bytes it produces
+            for (FwSizeType i = 0; i < length; i++, written++) {
+                out[written] = (distance > written) ? DICTIONARY[dictionary + written - distance]
+                                                    : out[written - distance];
+            }
+        }
+    }
+    return written;
+}
+
+}  // namespace AX25
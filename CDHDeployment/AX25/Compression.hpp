@@ -0,0 +1,70 @@
+// ======================================================================
+// \title  Compression.hpp
+// \author madisonw
+// \brief  LZSS codec for downlink messages, primed with F´ packet headers
+// ======================================================================
+
+#ifndef AX25_Compression_HPP
+#define AX25_Compression_HPP
+
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! LZSS with a preset dictionary.
+//!
+//! Short telemetry and event packets repeat little within themselves but a
+//! lot across packets: the packet descriptor, channel or event id and time
+//! base look the same from one packet to the next. Both ends therefore start
+//! with a dictionary of those headers already in the window, built from the
+//! instances whose channels are listed in CDHDeploymentPackets.fppi.
+//! Changing the dictionary changes the format, so it is only ever appended
+//! to together with a new ground decoder.
+//!
+//! Format: groups of a flag byte followed by up to eight items, flag bit i
+//! (LSB first) telling whether item i is a literal byte (0) or a match (1).
+//! A match is two bytes: distance-1 in the high 12 bits and length-3 in the
+//! low 4, so it reaches 4096 bytes back, into the dictionary if needed, and
+//! copies 3 to 18 bytes.
+class Compressor {
+  public:
+    //! Largest input compress() accepts
+    static constexpr FwSizeType MAX_INPUT = 1024;
+    static constexpr FwSizeType MIN_MATCH = 3;
+    static constexpr FwSizeType MAX_MATCH = MIN_MATCH + 15;
+    static constexpr FwSizeType MAX_DISTANCE = 4096;
+
+    Compressor();
+
+    //! Compress `size` bytes into `out`. Returns the compressed size, or 0
+    //! if the result would not be smaller than the input or `capacity`.
+    FwSizeType compress(const U8* in, FwSizeType size, U8* out, FwSizeType capacity);
+
+    //! Expand `size` compressed bytes into `out`. Returns the expanded size,
+    //! or 0 if the input is malformed or does not fit `capacity`.
+    static FwSizeType expand(const U8* in, FwSizeType size, U8* out, FwSizeType capacity);
+
+    //! Bytes of the preset dictionary
+    static FwSizeType dictionarySize();
+
+  private:
+    static constexpr FwSizeType HASH_BITS = 10;
+    static constexpr FwSizeType HASH_SIZE = 1U << HASH_BITS;
+    static constexpr U16 NO_POSITION = 0xFFFF;
+    //! Candidates compared per position; bounds the worst case on repetitive input
+    static constexpr FwSizeType MAX_CHAIN = 16;
+    static constexpr FwSizeType MAX_DICTIONARY = 512;
+    static constexpr FwSizeType WINDOW_SIZE = MAX_DICTIONARY + MAX_INPUT;
+
+    void insert(FwSizeType position);
+
+    //! Working memory, reused by every call: dictionary followed by the
+    //! input, and hash chains over positions in it
+    U8 m_window[WINDOW_SIZE];
+    U16 m_head[HASH_SIZE];
+    U16 m_prev[WINDOW_SIZE];
+};
+
+}  // namespace AX25
+
+#endif
@@ -0,0 +1,255 @@
+// ======================================================================
+// \title  Crc16.cpp
+// \author madisonw
+// \brief  AX.25 frame check sequence (CRC-16/X.25) shared by TX and RX
+// ======================================================================
+
+#include "CDHDeployment/AX25/Crc16.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AX25_CRC_CLMUL_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__linux__)
+#define AX25_CRC_CLMUL_ARM 1
+#include <arm_neon.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+namespace AX25 {
+
+namespace {
+
+// ----------------------------------------------------------------------
+// Compile-time table generation
+// ----------------------------------------------------------------------
+
+constexpr U16 REFLECTED_POLY = 0x8408;  // x^16 + x^12 + x^5 + 1, bit reversed
+constexpr U32 NORMAL_POLY = 0x11021;    // same polynomial with the x^16 term
+
+constexpr U16 shiftBits(U16 crc, U32 bits) {
+    return (bits == 0) ? crc
+                       : shiftBits(static_cast<U16>((crc & 1) ? ((crc >> 1) ^ REFLECTED_POLY) : (crc >> 1)),
+                                   bits - 1);
+}
+
+//! Entry `index` of slice table `slice`: CRC of byte `index` followed by `slice` zero bytes
+constexpr U16 sliceEntry(U32 slice, U32 index) {
+    return (slice == 0) ? shiftBits(static_cast<U16>(index), 8)
+                        : static_cast<U16>((sliceEntry(slice - 1, index) >> 8) ^
+                                           shiftBits(static_cast<U16>(sliceEntry(slice - 1, index) & 0xFF), 8));
+}
+
+template <U32... I>
+struct IndexList {};
+template <U32 N, U32... I>
+struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+template <U32... I>
+struct MakeIndexList<0, I...> {
+    typedef IndexList<I...> type;
+};
+
+struct SliceTables {
+    U16 entries[8][256];
+};
+
+template <U32... I>
+constexpr SliceTables makeSliceTables(IndexList<I...>) {
+    return SliceTables{{{sliceEntry(0, I)...},
+                        {sliceEntry(1, I)...},
+                        {sliceEntry(2, I)...},
+                        {sliceEntry(3, I)...},
+                        {sliceEntry(4, I)...},
+                        {sliceEntry(5, I)...},
+                        {sliceEntry(6, I)...},
+                        {sliceEntry(7, I)...}}};
+}
+
+constexpr SliceTables TABLES = makeSliceTables(MakeIndexList<256>::type());
+
+static_assert(TABLES.entries[0][1] == 0x1189, "CRC-16/X.25 table generation is broken");
+static_assert(TABLES.entries[0][255] == 0x0F78, "CRC-16/X.25 table generation is broken");
+
+//! x^n mod P(x) in normal (non-reflected) bit order
+constexpr U32 xPowMod(U32 n, U32 remainder = 1) {
+    return (n == 0) ? remainder
+                    : xPowMod(n - 1, ((remainder << 1) & 0x10000) ? ((remainder << 1) ^ NORMAL_POLY)
+                                                                   : (remainder << 1));
+}
+
+//! Place the coefficient of x^d at bit 63 - d, matching reflected 64-bit lanes
+constexpr U64 reflect64(U32 value, U32 bit = 0) {
+    return (bit == 16) ? 0
+                       : ((((value >> bit) & 1) ? (static_cast<U64>(1) << (63 - bit)) : 0) | reflect64(value, bit + 1));
+}
+
+// Folding a 128-bit block forward by 128 bits multiplies its high-degree half
+// by x^192 and its low-degree half by x^128. Reflected carry-less products
+// come out one bit short, so the constants carry one less power of x.
+constexpr U64 FOLD_HIGH = reflect64(xPowMod(191));
+constexpr U64 FOLD_LOW = reflect64(xPowMod(127));
+
+// ----------------------------------------------------------------------
+// Engines
+// ----------------------------------------------------------------------
+
+U16 updateTable(U16 crc, const U8* data, FwSizeType length) {
+    for (FwSizeType i = 0; i < length; i++) {
+        crc = static_cast<U16>((crc >> 8) ^ TABLES.entries[0][(crc ^ data[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+U16 updateSliceBy8(U16 crc, const U8* data, FwSizeType length) {
+    while (length >= 8) {
+        crc = static_cast<U16>(TABLES.entries[7][(crc ^ data[0]) & 0xFF] ^
+                               TABLES.entries[6][((crc >> 8) ^ data[1]) & 0xFF] ^
+                               TABLES.entries[5][data[2]] ^ TABLES.entries[4][data[3]] ^
+                               TABLES.entries[3][data[4]] ^ TABLES.entries[2][data[5]] ^
+                               TABLES.entries[1][data[6]] ^ TABLES.entries[0][data[7]]);
+        data += 8;
+        length -= 8;
+    }
+    return updateTable(crc, data, length);
+}
+
+//! Shortest input worth folding; below this the setup costs more than it saves
+constexpr FwSizeType CLMUL_MIN_LENGTH = 32;
+
+#if defined(AX25_CRC_CLMUL_X86)
+
+__attribute__((target("pclmul,sse4.1"))) U16 updateClmul(U16 crc, const U8* data, FwSizeType length) {
+    if (length < CLMUL_MIN_LENGTH) {
+        return updateSliceBy8(crc, data, length);
+    }
+
+    // Seeding the state into the first two bytes lets folding start from zero
+    const __m128i constants = _mm_set_epi64x(static_cast<long long>(FOLD_LOW), static_cast<long long>(FOLD_HIGH));
+    __m128i accumulator = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    accumulator = _mm_xor_si128(accumulator, _mm_cvtsi32_si128(crc));
+    data += 16;
+    length -= 16;
+
+    while (length >= 16) {
+        const __m128i high = _mm_clmulepi64_si128(accumulator, constants, 0x00);
+        const __m128i low = _mm_clmulepi64_si128(accumulator, constants, 0x11);
+        accumulator = _mm_xor_si128(_mm_xor_si128(high, low), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+        data += 16;
+        length -= 16;
+    }
+
+    // The folded block is congruent to everything consumed so far
+    U8 folded[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(folded), accumulator);
+    crc = updateSliceBy8(0, folded, sizeof(folded));
+    return updateSliceBy8(crc, data, length);
+}
+
+bool clmulSupported() {
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+}
+
+#elif defined(AX25_CRC_CLMUL_ARM)
+
+__attribute__((target("+crypto"))) U16 updateClmul(U16 crc, const U8* data, FwSizeType length) {
+    if (length < CLMUL_MIN_LENGTH) {
+        return updateSliceBy8(crc, data, length);
+    }
+
+    U64 lanes[2];
+    memcpy(lanes, data, sizeof(lanes));
+    lanes[0] ^= crc;
+    data += 16;
+    length -= 16;
+
+    while (length >= 16) {
+        const poly128_t high = vmull_p64(static_cast<poly64_t>(lanes[0]), static_cast<poly64_t>(FOLD_HIGH));
+        const poly128_t low = vmull_p64(static_cast<poly64_t>(lanes[1]), static_cast<poly64_t>(FOLD_LOW));
+        const uint64x2_t product = veorq_u64(vreinterpretq_u64_p128(high), vreinterpretq_u64_p128(low));
+        U64 next[2];
+        memcpy(next, data, sizeof(next));
+        lanes[0] = vgetq_lane_u64(product, 0) ^ next[0];
+        lanes[1] = vgetq_lane_u64(product, 1) ^ next[1];
+        data += 16;
+        length -= 16;
+    }
+
+    U8 folded[16];
+    memcpy(folded, lanes, sizeof(folded));
+    crc = updateSliceBy8(0, folded, sizeof(folded));
+    return updateSliceBy8(crc, data, length);
+}
+
+bool clmulSupported() {
+    return (getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+}
+
+#else
+
+U16 updateClmul(U16 crc, const U8* data, FwSizeType length) {
+    return updateSliceBy8(crc, data, length);
+}
+
+bool clmulSupported() {
+    return false;
+}
+
+#endif
+
+Crc16::Engine detectEngine() {
+    return clmulSupported() ? Crc16::Engine::CLMUL : Crc16::Engine::SLICE_BY_8;
+}
+
+std::atomic<Crc16::Engine>& activeEngine() {
+    static std::atomic<Crc16::Engine> engine(detectEngine());
+    return engine;
+}
+
+}  // namespace
+
+U16 Crc16::update(U16 state, const U8* data, FwSizeType length) {
+    return update(state, data, length, activeEngine().load(std::memory_order_relaxed));
+}
+
+U16 Crc16::update(U16 state, const U8* data, FwSizeType length, Engine engine) {
+    FW_ASSERT((data != nullptr) || (length == 0));
+    switch (engine) {
+        case Engine::TABLE:
+            return updateTable(state, data, length);
+        case Engine::CLMUL:
+            return updateClmul(state, data, length);
+        case Engine::SLICE_BY_8:
+        default:
+            return updateSliceBy8(state, data, length);
+    }
+}
+
+bool Crc16::isSupported(Engine engine) {
+    return (engine != Engine::CLMUL) || clmulSupported();
+}
+
+Crc16::Engine Crc16::getEngine() {
+    return activeEngine().load();
+}
+
+void Crc16::setEngine(Engine engine) {
+    activeEngine().store(isSupported(engine) ? engine : Engine::SLICE_BY_8);
+}
+
+const char* Crc16::engineName(Engine engine) {
+    switch (engine) {
+        case Engine::TABLE:
+            return "table";
+        case Engine::SLICE_BY_8:
+            return "slice-by-8";
+        case Engine::CLMUL:
+            return "clmul";
+        default:
+            return "unknown";
+    }
+}
+
+}  // namespace AX25
@@ -0,0 +1,68 @@
+// ======================================================================
+// \title  Crc16.hpp
+// \author madisonw
+// \brief  AX.25 frame check sequence (CRC-16/X.25) shared by TX and RX
+// ======================================================================
+
+#ifndef AX25_Crc16_HPP
+#define AX25_Crc16_HPP
+
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! CRC-16/X.25 (reflected polynomial 0x8408, init 0xFFFF, final XOR 0xFFFF)
+//! as used for the AX.25 FCS.
+//!
+//! Three engines produce identical results: a byte-at-a-time table, a
+//! slice-by-8 table and a carry-less multiply fold (PCLMULQDQ on x86, PMULL
+//! on ARMv8 with the crypto extension). The fastest engine the CPU supports
+//! is picked at startup; all tables are generated at compile time.
+//!
+//! The running state can be carried across calls, so a frame's FCS can be
+//! accumulated while its header and payload are written:
+//!
+//!     U16 state = Crc16::INITIAL;
+//!     state = Crc16::update(state, header, headerSize);
+//!     state = Crc16::update(state, payload, payloadSize);
+//!     U16 fcs = Crc16::finish(state);
+class Crc16 {
+  public:
+    enum class Engine : U8 {
+        TABLE,       //!< Byte-at-a-time lookup
+        SLICE_BY_8,  //!< Eight bytes per step over eight tables
+        CLMUL        //!< Carry-less multiply folding, 16 bytes per step
+    };
+
+    static constexpr U16 INITIAL = 0xFFFF;
+    static constexpr U16 FINAL_XOR = 0xFFFF;
+    //! CRC of any frame with its FCS appended, used to validate received frames
+    static constexpr U16 GOOD_RESIDUE = 0x0F47;
+
+    //! Advance `state` over `length` bytes with the selected engine
+    static U16 update(U16 state, const U8* data, FwSizeType length);
+
+    //! Advance `state` over `length` bytes with a specific engine
+    static U16 update(U16 state, const U8* data, FwSizeType length, Engine engine);
+
+    //! Apply the final XOR to a running state
+    static U16 finish(U16 state) { return static_cast<U16>(state ^ FINAL_XOR); }
+
+    //! FCS of a complete buffer
+    static U16 compute(const U8* data, FwSizeType length) { return finish(update(INITIAL, data, length)); }
+
+    //! True if the running CPU can execute `engine`
+    static bool isSupported(Engine engine);
+
+    //! Engine used by update() without an explicit engine
+    static Engine getEngine();
+
+    //! Force an engine (e.g. for benchmarking); falls back to SLICE_BY_8 if unsupported
+    static void setEngine(Engine engine);
+
+    static const char* engineName(Engine engine);
+};
+
+}  // namespace AX25
+
+#endif
@@ -0,0 +1,257 @@
+// ======================================================================
+// \title  Dsp.cpp
+// \author madisonw
+// \brief  Vectorized signal processing kernels for the modems
+// ======================================================================
+
+#include "CDHDeployment/AX25/Dsp.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <cmath>
+
+#if defined(__AVX2__)
+#define AX25_DSP_AVX2 1
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__)
+#define AX25_DSP_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define AX25_DSP_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace AX25 {
+
+static_assert(sizeof(Dsp::RfSample) == 16, "RfSample must match rpitx's samplerf_t");
+
+namespace {
+
+#if defined(AX25_DSP_SSE2)
+//! Products of eight taps and eight samples, summed pairwise into four lanes
+inline __m128i dot8(const I16* in, const I16* taps) {
+    return _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)),
+                          _mm_loadu_si128(reinterpret_cast<const __m128i*>(taps)));
+}
+
+inline __m128i sumProducts(const I16* in, const I16* taps, U32 tapCount) {
+    __m128i sum = dot8(in, taps);
+    for (U32 k = 8; k < tapCount; k += 8) {
+        sum = _mm_add_epi32(sum, dot8(&in[k], &taps[k]));
+    }
+    return sum;
+}
+#elif defined(AX25_DSP_NEON)
+inline I32 sumProducts(const I16* in, const I16* taps, U32 tapCount) {
+    int32x4_t sum = vdupq_n_s32(0);
+    for (U32 k = 0; k < tapCount; k += 8) {
+        const int16x8_t x = vld1q_s16(&in[k]);
+        const int16x8_t h = vld1q_s16(&taps[k]);
+        sum = vmlal_s16(sum, vget_low_s16(x), vget_low_s16(h));
+        sum = vmlal_s16(sum, vget_high_s16(x), vget_high_s16(h));
+    }
+    const int32x2_t pairs = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+    return vget_lane_s32(vpadd_s32(pairs, pairs), 0);
+}
+#endif
+
+}  // namespace
+
+void Dsp::fir(const I16* in, FwSizeType count, const I16* taps, U32 tapCount, I32* out) {
+    FW_ASSERT(in != nullptr);
+    FW_ASSERT(taps != nullptr);
+    FW_ASSERT(out != nullptr);
+    FW_ASSERT((tapCount > 0) && (tapCount % TAP_MULTIPLE == 0), static_cast<FwAssertArgType>(tapCount));
+
+    FwSizeType n = 0;
+#if defined(AX25_DSP_SSE2)
+    // Four outputs at a time: transposing the four partial sums adds them
+    // across lanes without SSSE3's horizontal add
+    for (; n + 4 <= count; n += 4) {
+        const __m128i s0 = sumProducts(&in[n], taps, tapCount);
+        const __m128i s1 = sumProducts(&in[n + 1], taps, tapCount);
+        const __m128i s2 = sumProducts(&in[n + 2], taps, tapCount);
+        const __m128i s3 = sumProducts(&in[n + 3], taps, tapCount);
+        const __m128i t0 = _mm_add_epi32(_mm_unpacklo_epi32(s0, s1), _mm_unpackhi_epi32(s0, s1));
+        const __m128i t1 = _mm_add_epi32(_mm_unpacklo_epi32(s2, s3), _mm_unpackhi_epi32(s2, s3));
+        const __m128i sums = _mm_add_epi32(_mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[n]), sums);
+    }
+#elif defined(AX25_DSP_NEON)
+    for (; n < count; n++) {
+        out[n] = sumProducts(&in[n], taps, tapCount);
+    }
+#endif
+    for (; n < count; n++) {
+        I32 sum = 0;
+        for (U32 k = 0; k < tapCount; k++) {
+            sum += static_cast<I32>(in[n + k]) * taps[k];
+        }
+        out[n] = sum;
+    }
+}
+
+F64 Dsp::rootRaisedCosine(F64 t, F64 rollOff) {
+    FW_ASSERT((rollOff > 0.0) && (rollOff <= 1.0));
+    if (t == 0.0) {
+        return 1.0 - rollOff + 4.0 * rollOff / M_PI;
+    }
+    const F64 edge = 4.0 * rollOff * t;
+    if (std::fabs(1.0 - edge * edge) < 1e-9) {
+        // Limit at t = 1 / (4 rollOff)
+        const F64 angle = M_PI / (4.0 * rollOff);
+        return (rollOff / std::sqrt(2.0)) *
+               ((1.0 + 2.0 / M_PI) * std::sin(angle) + (1.0 - 2.0 / M_PI) * std::cos(angle));
+    }
+    return (std::sin(M_PI * t * (1.0 - rollOff)) + edge * std::cos(M_PI * t * (1.0 + rollOff))) /
+           (M_PI * t * (1.0 - edge * edge));
+}
+
+void Dsp::toFloat(const I16* in, FwSizeType count, F32 scale, F32* out) {
+    FW_ASSERT(in != nullptr);
+    FW_ASSERT(out != nullptr);
+
+    FwSizeType n = 0;
+#if defined(AX25_DSP_AVX2)
+    const __m256 factor = _mm256_set1_ps(scale);
+    for (; n + 8 <= count; n += 8) {
+        const __m256i wide =
+            _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[n])));
+        _mm256_storeu_ps(&out[n], _mm256_mul_ps(_mm256_cvtepi32_ps(wide), factor));
+    }
+#elif defined(AX25_DSP_SSE2)
+    const __m128 factor = _mm_set1_ps(scale);
+    for (; n + 8 <= count; n += 8) {
+        // Sign-extend by unpacking into the high halves and shifting back
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[n]));
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(&out[n], _mm_mul_ps(_mm_cvtepi32_ps(low), factor));
+        _mm_storeu_ps(&out[n + 4], _mm_mul_ps(_mm_cvtepi32_ps(high), factor));
+    }
+#elif defined(AX25_DSP_NEON)
+    for (; n + 8 <= count; n += 8) {
+        const int16x8_t x = vld1q_s16(&in[n]);
+        vst1q_f32(&out[n], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), scale));
+        vst1q_f32(&out[n + 4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), scale));
+    }
+#endif
+    for (; n < count; n++) {
+        out[n] = static_cast<F32>(in[n]) * scale;
+    }
+}
+
+void Dsp::scale(F32* data, FwSizeType count, F32 gain) {
+    FW_ASSERT(data != nullptr);
+
+    FwSizeType n = 0;
+#if defined(AX25_DSP_AVX2)
+    const __m256 factor = _mm256_set1_ps(gain);
+    for (; n + 8 <= count; n += 8) {
+        _mm256_storeu_ps(&data[n], _mm256_mul_ps(_mm256_loadu_ps(&data[n]), factor));
+    }
+#elif defined(AX25_DSP_SSE2)
+    const __m128 factor = _mm_set1_ps(gain);
+    for (; n + 4 <= count; n += 4) {
+        _mm_storeu_ps(&data[n], _mm_mul_ps(_mm_loadu_ps(&data[n]), factor));
+    }
+#elif defined(AX25_DSP_NEON)
+    for (; n + 4 <= count; n += 4) {
+        vst1q_f32(&data[n], vmulq_n_f32(vld1q_f32(&data[n]), gain));
+    }
+#endif
+    for (; n < count; n++) {
+        data[n] *= gain;
+    }
+}
+
+F32 Dsp::dot(const F32* a, const F32* b, U32 count) {
+    FW_ASSERT(a != nullptr);
+    FW_ASSERT(b != nullptr);
+    FW_ASSERT(count % TAP_MULTIPLE == 0, static_cast<FwAssertArgType>(count));
+
+    // Eight running sums combined in the same order on every path, so the
+    // scalar fallback matches the vector code to rounding
+    F32 lanes[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+#if defined(AX25_DSP_AVX2)
+    __m256 sum = _mm256_setzero_ps();
+    for (U32 k = 0; k < count; k += 8) {
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(&a[k]), _mm256_loadu_ps(&b[k])));
+    }
+    _mm256_storeu_ps(lanes, sum);
+#elif defined(AX25_DSP_SSE2)
+    __m128 low = _mm_setzero_ps();
+    __m128 high = _mm_setzero_ps();
+    for (U32 k = 0; k < count; k += 8) {
+        low = _mm_add_ps(low, _mm_mul_ps(_mm_loadu_ps(&a[k]), _mm_loadu_ps(&b[k])));
+        high = _mm_add_ps(high, _mm_mul_ps(_mm_loadu_ps(&a[k + 4]), _mm_loadu_ps(&b[k + 4])));
+    }
+    _mm_storeu_ps(lanes, low);
+    _mm_storeu_ps(&lanes[4], high);
+#elif defined(AX25_DSP_NEON)
+    float32x4_t low = vdupq_n_f32(0.0f);
+    float32x4_t high = vdupq_n_f32(0.0f);
+    for (U32 k = 0; k < count; k += 8) {
+        low = vaddq_f32(low, vmulq_f32(vld1q_f32(&a[k]), vld1q_f32(&b[k])));
+        high = vaddq_f32(high, vmulq_f32(vld1q_f32(&a[k + 4]), vld1q_f32(&b[k + 4])));
+    }
+    vst1q_f32(lanes, low);
+    vst1q_f32(&lanes[4], high);
+#else
+    for (U32 k = 0; k < count; k += 8) {
+        for (U32 lane = 0; lane < 8; lane++) {
+            lanes[lane] += a[k + lane] * b[k + lane];
+        }
+    }
+#endif
+    return ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) + ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+}
+
+void Dsp::toRfSamples(const F32* in, FwSizeType count, U32 periodNs, RfSample* out) {
+    FW_ASSERT(in != nullptr);
+    FW_ASSERT(out != nullptr);
+
+    FwSizeType n = 0;
+#if defined(AX25_DSP_AVX2)
+    // Each record is the widened frequency followed by the period and zero
+    // padding, which together read as one 64-bit lane
+    const __m256d period = _mm256_castsi256_pd(_mm256_set1_epi64x(static_cast<long long>(periodNs)));
+    for (; n + 4 <= count; n += 4) {
+        const __m256d frequency = _mm256_cvtps_pd(_mm_loadu_ps(&in[n]));
+        const __m256d even = _mm256_unpacklo_pd(frequency, period);
+        const __m256d odd = _mm256_unpackhi_pd(frequency, period);
+        _mm256_storeu_pd(reinterpret_cast<F64*>(&out[n]), _mm256_permute2f128_pd(even, odd, 0x20));
+        _mm256_storeu_pd(reinterpret_cast<F64*>(&out[n + 2]), _mm256_permute2f128_pd(even, odd, 0x31));
+    }
+#elif defined(AX25_DSP_SSE2)
+    const __m128d period = _mm_castsi128_pd(_mm_set1_epi64x(static_cast<long long>(periodNs)));
+    for (; n + 4 <= count; n += 4) {
+        const __m128 frequency = _mm_loadu_ps(&in[n]);
+        const __m128d low = _mm_cvtps_pd(frequency);
+        const __m128d high = _mm_cvtps_pd(_mm_movehl_ps(frequency, frequency));
+        _mm_storeu_pd(reinterpret_cast<F64*>(&out[n]), _mm_unpacklo_pd(low, period));
+        _mm_storeu_pd(reinterpret_cast<F64*>(&out[n + 1]), _mm_unpackhi_pd(low, period));
+        _mm_storeu_pd(reinterpret_cast<F64*>(&out[n + 2]), _mm_unpacklo_pd(high, period));
+        _mm_storeu_pd(reinterpret_cast<F64*>(&out[n + 3]), _mm_unpackhi_pd(high, period));
+    }
+#elif defined(AX25_DSP_NEON) && defined(__aarch64__)
+    // Doubles need AArch64 NEON; 32-bit ARM takes the scalar loop
+    const float64x2_t period = vreinterpretq_f64_u64(vdupq_n_u64(periodNs));
+    for (; n + 4 <= count; n += 4) {
+        const float32x4_t frequency = vld1q_f32(&in[n]);
+        const float64x2_t low = vcvt_f64_f32(vget_low_f32(frequency));
+        const float64x2_t high = vcvt_high_f64_f32(frequency);
+        F64* record = reinterpret_cast<F64*>(&out[n]);
+        vst1q_f64(record, vzip1q_f64(low, period));
+        vst1q_f64(record + 2, vzip2q_f64(low, period));
+        vst1q_f64(record + 4, vzip1q_f64(high, period));
+        vst1q_f64(record + 6, vzip2q_f64(high, period));
+    }
+#endif
+    for (; n < count; n++) {
+        out[n].frequency = static_cast<F64>(in[n]);
+        out[n].periodNs = periodNs;
+        out[n].padding = 0;
+    }
+}
+
+}  // namespace AX25
@@ -0,0 +1,59 @@
+// ======================================================================
+// \title  Dsp.hpp
+// \author madisonw
+// \brief  Vectorized signal processing kernels for the modems
+// ======================================================================
+
+#ifndef AX25_Dsp_HPP
+#define AX25_Dsp_HPP
+
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! DSP kernels for the modems and the transmit chain, written once with
+//! SIMD and a scalar fallback that gives the same results. The integer
+//! kernels use SSE2 or NEON; the float kernels use AVX2 when the compiler
+//! targets it (e.g. -march=native), otherwise SSE2 or NEON.
+class Dsp {
+  public:
+    //! Filters take tap counts in multiples of this (pad with zero taps)
+    static constexpr U32 TAP_MULTIPLE = 8;
+
+    //! One sample of rpitx's RF mode (its samplerf_t): a frequency offset
+    //! from the carrier in Hz, held for periodNs
+    struct RfSample {
+        F64 frequency;
+        U32 periodNs;
+        U32 padding;
+    };
+
+    //! FIR filter: out[n] = sum of taps[k] * in[n + k] for k < tapCount, so
+    //! `in` holds count + tapCount - 1 samples and out[n] lines up with
+    //! in[n + tapCount - 1]. Products are summed in 32 bits, so Q15 taps
+    //! with gain up to one cannot overflow.
+    static void fir(const I16* in, FwSizeType count, const I16* taps, U32 tapCount, I32* out);
+
+    //! Root-raised-cosine pulse `t` symbol periods from its centre. Used at
+    //! both ends, the pair makes a raised-cosine response with no
+    //! intersymbol interference at the symbol centres.
+    static F64 rootRaisedCosine(F64 t, F64 rollOff);
+
+    //! PCM to float: out[n] = in[n] * scale. A scale of 1/32768 is csdr's
+    //! convert_i16_f; folding a gain into the scale saves a pass.
+    static void toFloat(const I16* in, FwSizeType count, F32 scale, F32* out);
+
+    //! Gain in place: data[n] *= gain, as csdr's gain_ff
+    static void scale(F32* data, FwSizeType count, F32 gain);
+
+    //! Sum of a[k] * b[k] for k < count, a multiple of TAP_MULTIPLE
+    static F32 dot(const F32* a, const F32* b, U32 count);
+
+    //! Frequencies to rpitx RF samples, each held for `periodNs`, as csdr's
+    //! convert_f_samplerf
+    static void toRfSamples(const F32* in, FwSizeType count, U32 periodNs, RfSample* out);
+};
+
+}  // namespace AX25
+
+#endif
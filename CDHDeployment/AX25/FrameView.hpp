@@ -0,0 +1,70 @@
+// ======================================================================
+// \title  FrameView.hpp
+// \author madisonw
+// \brief  AX.25 frame whose info field is borrowed from another buffer
+// ======================================================================
+
+#ifndef AX25_FrameView_HPP
+#define AX25_FrameView_HPP
+
+#include "CDHDeployment/AX25/Fx25.hpp"
+#include "CDHDeployment/AX25/Segmentation.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! Digipeaters a downlink frame may be addressed through
+static constexpr FwSizeType MAX_DIGIPEATERS = 2;
+//! Address/control/PID block: destination, source and digipeaters of 7
+//! bytes each, control and PID
+static constexpr FwSizeType MIN_HEADER_SIZE = 7 + 7 + 2;
+static constexpr FwSizeType MAX_HEADER_SIZE = MIN_HEADER_SIZE + 7 * MAX_DIGIPEATERS;
+
+//! Frame handed from AMSATFramer to RadioBridge without copying its payload.
+//!
+//! AMSATFramer places a FrameView at the start of a small buffer and sends
+//! that buffer on dataOut in place of a contiguous frame. The opening flag,
+//! header, segment header, FCS and closing flag are inline; `info` points
+//! into the com buffer being segmented, which the framer keeps until every
+//! view of it has come back on dataReturnIn. Contiguous frames always start
+//! with the 0x7E flag, which MARKER never matches.
+//!
+//! With FX.25 on, the framer also encodes the frame into `fx25`, and the
+//! block is sent in its place; the other fields still describe the frame.
+//! The header length depends on the digipeater path, so only the first
+//! prefixSize bytes of `prefix` are used.
+struct FrameView {
+    static constexpr U8 MARKER = 0x00;
+    //! Largest opening flag, address/control/PID and segment header
+    static constexpr FwSizeType PREFIX_SIZE = 1 + MAX_HEADER_SIZE + SegmentHeader::SIZE;
+    //! FCS and closing flag
+    static constexpr FwSizeType SUFFIX_SIZE = 3;
+
+    U8 marker;
+    U8 prefixSize;
+    U8 prefix[PREFIX_SIZE];
+    U8 suffix[SUFFIX_SIZE];
+    const U8* info;
+    FwSizeType infoSize;
+    //! FX.25 block (tag, data field, check bytes) to send instead, 0 if plain AX.25
+    FwSizeType fx25Size;
+    U8 fx25[Fx25::MAX_BLOCK_SIZE];
+
+    //! Size of the frame the view describes
+    FwSizeType frameSize() const { return prefixSize + infoSize + SUFFIX_SIZE; }
+
+    //! Bytes sent for the view: the frame, or the FX.25 block between two flags
+    FwSizeType sentSize() const { return (fx25Size > 0) ? fx25Size + 2 : this->frameSize(); }
+
+    //! The view held in a buffer, or nullptr if the buffer holds a contiguous frame
+    static const FrameView* from(const U8* data, FwSizeType size) {
+        if ((data == nullptr) || (size != sizeof(FrameView)) || (data[0] != MARKER)) {
+            return nullptr;
+        }
+        return reinterpret_cast<const FrameView*>(data);
+    }
+};
+
+}  // namespace AX25
+
+#endif
@@ -0,0 +1,215 @@
+// ======================================================================
+// \title  Fx25.cpp
+// \author madisonw
+// \brief  FX.25 forward error correction around HDLC-framed AX.25 frames
+// ======================================================================
+
+#include "CDHDeployment/AX25/Fx25.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <cstring>
+
+namespace AX25 {
+
+namespace {
+
+constexpr U8 HDLC_FLAG = 0x7E;
+
+//! Correlation tags 0x01 to 0x0B of the FX.25 spec, largest data field first
+//! for each number of check bytes
+const Fx25::Code CODES[] = {
+    {0xB74DB7DF8A532F3EULL, 255, 239, 16}, {0x26FF60A600CC8FDEULL, 144, 128, 16},
+    {0xC7DC0508F3D9B09EULL, 80, 64, 16},   {0x8F056EB4369660EEULL, 48, 32, 16},
+    {0x6E260B1AC5835FAEULL, 255, 223, 32}, {0xFF94DC634F1CFF4EULL, 160, 128, 32},
+    {0x1EB7B9CDBC09C00EULL, 96, 64, 32},   {0xDBF869BD2DBB1776ULL, 64, 32, 32},
+    {0x3ADB0C13DEAE2836ULL, 255, 191, 64}, {0xAB69DB6A543188D6ULL, 192, 128, 64},
+    {0x4A4ABEC4A724B796ULL, 128, 64, 64},
+};
+
+//! Bits the data field needs for a body of `size` bytes: two flags and the
+//! body with the most stuffing it could need
+FwSizeType worstCaseBits(FwSizeType size) {
+    return 16 + (size * 8) + (size * 8) / 5;
+}
+
+//! Appends bits LSB first, the order they go on air
+class BitWriter {
+  public:
+    BitWriter(U8* out, FwSizeType capacity) : m_out(out), m_capacity(capacity * 8), m_bits(0), m_ones(0) {
+        memset(out, 0, capacity);
+    }
+
+    void put(bool bit) {
+        FW_ASSERT(m_bits < m_capacity, static_cast<FwAssertArgType>(m_bits));
+        if (bit) {
+            m_out[m_bits / 8] = static_cast<U8>(m_out[m_bits / 8] | (1U << (m_bits % 8)));
+        }
+        m_bits++;
+    }
+
+    void putFlag() {
+        for (U32 bit = 0; bit < 8; bit++) {
+            this->put(((HDLC_FLAG >> bit) & 0x01) != 0);
+        }
+        m_ones = 0;
+    }
+
+    void putStuffed(const U8* data, FwSizeType size) {
+        for (FwSizeType i = 0; i < size; i++) {
+            for (U32 bit = 0; bit < 8; bit++) {
+                const bool one = ((data[i] >> bit) & 0x01) != 0;
+                this->put(one);
+                m_ones = one ? (m_ones + 1) : 0;
+                if (m_ones == 5) {
+                    this->put(false);
+                    m_ones = 0;
+                }
+            }
+        }
+    }
+
+    FwSizeType getBits() const { return m_bits; }
+
+    //! Fill the rest with the flag pattern, continuing where the last flag left off
+    void padWithFlags() {
+        U32 bit = 0;
+        while (m_bits < m_capacity) {
+            this->put(((HDLC_FLAG >> bit) & 0x01) != 0);
+            bit = (bit + 1) % 8;
+        }
+    }
+
+  private:
+    U8* m_out;
+    FwSizeType m_capacity;
+    FwSizeType m_bits;
+    U32 m_ones;
+};
+
+inline U32 popcount64(U64 value) {
+    return static_cast<U32>(__builtin_popcountll(value));
+}
+
+}  // namespace
+
+bool Fx25::isSupported(FwSizeType roots) {
+    return (roots == 16) || (roots == 32) || (roots == 64);
+}
+
+FwSizeType Fx25::maxBody(FwSizeType roots) {
+    FW_ASSERT(isSupported(roots), static_cast<FwAssertArgType>(roots));
+    const FwSizeType dataBits = (ReedSolomon::BLOCK_SIZE - roots) * 8;
+    FwSizeType size = (dataBits - 16) * 5 / 48;
+    while (worstCaseBits(size + 1) <= dataBits) {
+        size++;
+    }
+    while (worstCaseBits(size) > dataBits) {
+        size--;
+    }
+    return size;
+}
+
+const ReedSolomon& Fx25::codec(FwSizeType roots) {
+    FW_ASSERT(isSupported(roots), static_cast<FwAssertArgType>(roots));
+    static const ReedSolomon rs16(16);
+    static const ReedSolomon rs32(32);
+    static const ReedSolomon rs64(64);
+    return (roots == 16) ? rs16 : ((roots == 32) ? rs32 : rs64);
+}
+
+FwSizeType Fx25::encode(FwSizeType roots, const Piece* pieces, FwSizeType count, U8* out) {
+    FW_ASSERT(pieces != nullptr);
+    FW_ASSERT(out != nullptr);
+    FW_ASSERT(isSupported(roots), static_cast<FwAssertArgType>(roots));
+
+    FwSizeType bodySize = 0;
+    for (FwSizeType i = 0; i < count; i++) {
+        bodySize += pieces[i].size;
+    }
+    if (bodySize > maxBody(roots)) {
+        return 0;
+    }
+
+    // Stuff first: the code is picked by the bits actually needed
+    U8* field = &out[TAG_SIZE];
+    BitWriter writer(field, ReedSolomon::BLOCK_SIZE - roots);
+    writer.putFlag();
+    for (FwSizeType i = 0; i < count; i++) {
+        writer.putStuffed(pieces[i].data, pieces[i].size);
+    }
+    writer.putFlag();
+    const FwSizeType neededBytes = (writer.getBits() + 7) / 8;
+    writer.padWithFlags();
+
+    // CODES runs from large to small, so the last fit is the smallest
+    const Code* code = nullptr;
+    for (const Code& candidate : CODES) {
+        if ((candidate.roots == roots) && (candidate.dataSize >= neededBytes)) {
+            code = &candidate;
+        }
+    }
+    FW_ASSERT(code != nullptr, static_cast<FwAssertArgType>(neededBytes));
+
+    for (FwSizeType i = 0; i < TAG_SIZE; i++) {
+        out[i] = static_cast<U8>(code->tag >> (8 * i));
+    }
+    codec(roots).encode(field, code->dataSize, &field[code->dataSize]);
+    return TAG_SIZE + code->blockSize;
+}
+
+const Fx25::Code* Fx25::matchTag(U64 word) {
+    for (const Code& code : CODES) {
+        if (popcount64(word ^ code.tag) <= Fx25Decoder::MAX_TAG_ERRORS) {
+            return &code;
+        }
+    }
+    return nullptr;
+}
+
+Fx25Decoder::Fx25Decoder() : m_tags(0) {
+    this->reset();
+}
+
+void Fx25Decoder::reset() {
+    m_correlator = 0;
+    m_huntBits = 0;
+    m_code = nullptr;
+    m_byte = 0;
+    m_bitCount = 0;
+    m_received = 0;
+    m_dataSize = 0;
+}
+
+void Fx25Decoder::huntTag() {
+    m_code = Fx25::matchTag(m_correlator);
+    if (m_code == nullptr) {
+        return;
+    }
+    m_tags++;
+    m_byte = 0;
+    m_bitCount = 0;
+    m_received = 0;
+}
+
+I32 Fx25Decoder::decode() {
+    FW_ASSERT(m_code != nullptr);
+    const Fx25::Code& code = *m_code;
+    const FwSizeType padEnd = ReedSolomon::BLOCK_SIZE - code.roots;
+    memset(&m_codeword[code.dataSize], 0, padEnd - code.dataSize);
+
+    I32 corrected = Fx25::codec(code.roots).decode(m_codeword);
+    // A correction landing in the zeros that were never sent means the
+    // errors were beyond the code and it settled on the wrong codeword
+    for (FwSizeType i = code.dataSize; (corrected > 0) && (i < padEnd); i++) {
+        if (m_codeword[i] != 0) {
+            corrected = -1;
+        }
+    }
+    m_dataSize = (corrected >= 0) ? code.dataSize : 0;
+
+    m_code = nullptr;
+    m_correlator = 0;
+    m_huntBits = 0;
+    return corrected;
+}
+
+}  // namespace AX25
@@ -0,0 +1,130 @@
+// ======================================================================
+// \title  Fx25.hpp
+// \author madisonw
+// \brief  FX.25 forward error correction around HDLC-framed AX.25 frames
+// ======================================================================
+
+#ifndef AX25_Fx25_HPP
+#define AX25_Fx25_HPP
+
+#include "CDHDeployment/AX25/ReedSolomon.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! FX.25 block building and the code table shared by both ends.
+//!
+//! A block is a 64-bit correlation tag naming the code, the data field and
+//! the Reed-Solomon check bytes, sent LSB first with NRZI but no bit
+//! stuffing. The data field holds the AX.25 frame exactly as HDLC would send
+//! it (flag, bit-stuffed body, flag), padded to the code's data size with
+//! more flag bits, so a receiver without FX.25 still decodes the frame. The
+//! shortened codes are the RS(255, 255 - roots) code with zeros after the
+//! data field, the convention Dire Wolf uses.
+class Fx25 {
+  public:
+    static constexpr FwSizeType TAG_SIZE = 8;
+    //! Largest block: tag plus a full RS(255, k) codeword
+    static constexpr FwSizeType MAX_BLOCK_SIZE = TAG_SIZE + ReedSolomon::BLOCK_SIZE;
+
+    //! One code of the FX.25 table
+    struct Code {
+        U64 tag;
+        U16 blockSize;  //!< Data field plus check bytes
+        U16 dataSize;
+        U16 roots;      //!< Check bytes
+    };
+
+    //! Piece of a frame body (address through FCS, no flags)
+    struct Piece {
+        const U8* data;
+        FwSizeType size;
+    };
+
+    //! Whether `roots` check bytes name FX.25 codes (16, 32 or 64)
+    static bool isSupported(FwSizeType roots);
+
+    //! Largest frame body that fits the largest code with `roots` check
+    //! bytes, however many bits it stuffs
+    static FwSizeType maxBody(FwSizeType roots);
+
+    //! Wrap a frame body held in `count` pieces in the smallest code with
+    //! `roots` check bytes that fits it. `out` takes MAX_BLOCK_SIZE bytes.
+    //! \return block size, 0 if the body does not fit
+    static FwSizeType encode(FwSizeType roots, const Piece* pieces, FwSizeType count, U8* out);
+
+    //! Code whose tag is within the allowed bit errors of `word`, nullptr if none
+    static const Code* matchTag(U64 word);
+
+    //! Codec for `roots` check bytes; built on first use and shared
+    static const ReedSolomon& codec(FwSizeType roots);
+};
+
+//! Finds FX.25 blocks in the decoded bit stream and corrects them.
+//!
+//! Fed the same NRZI-decoded bits as HdlcDeframer. Every bit shifts a
+//! 64-bit correlator compared against each tag; once one matches, the
+//! following data and check bytes are collected and decoded in place.
+class Fx25Decoder {
+  public:
+    //! Tag bits that may be wrong and still match, as in the FX.25 spec
+    static constexpr U32 MAX_TAG_ERRORS = 8;
+
+    Fx25Decoder();
+
+    //! Drop any block in progress and resume hunting for a tag
+    void reset();
+
+    //! Feed one decoded bit
+    //! \return true when a block has been collected; call decode() next
+    bool pushBit(bool bit) {
+        if (m_code == nullptr) {
+            m_correlator = (m_correlator >> 1) | (bit ? (1ULL << 63) : 0);
+            if (++m_huntBits >= 64) {
+                this->huntTag();
+            }
+            return false;
+        }
+        m_byte = static_cast<U8>((m_byte >> 1) | (bit ? 0x80 : 0x00));
+        if (++m_bitCount < 8) {
+            return false;
+        }
+        m_bitCount = 0;
+        // Data bytes go at the front of the codeword, check bytes at the end
+        const FwSizeType index = (m_received < m_code->dataSize)
+                                     ? m_received
+                                     : ReedSolomon::BLOCK_SIZE - m_code->blockSize + m_received;
+        m_codeword[index] = m_byte;
+        return ++m_received == m_code->blockSize;
+    }
+
+    //! Correct the collected block and resume hunting.
+    //! \return bytes corrected, or -1 if the block could not be corrected
+    I32 decode();
+
+    //! Data field of the last block decoded
+    const U8* getData() const { return m_codeword; }
+    FwSizeType getDataSize() const { return m_dataSize; }
+
+    //! Whether a block is being collected
+    bool isCollecting() const { return m_code != nullptr; }
+    //! Tags found so far; identifies the block being collected
+    U32 getTagCount() const { return m_tags; }
+
+  private:
+    void huntTag();
+
+    U64 m_correlator;
+    U32 m_huntBits;
+    const Fx25::Code* m_code;
+    U8 m_byte;
+    U32 m_bitCount;
+    FwSizeType m_received;
+    FwSizeType m_dataSize;
+    U32 m_tags;
+    U8 m_codeword[ReedSolomon::BLOCK_SIZE];
+};
+
+}  // namespace AX25
+
+#endif
@@ -0,0 +1,103 @@
+// ======================================================================
+// \title  G3ruhDemodulator.cpp
+// \author madisonw
+// \brief  9600 baud G3RUH scrambled FSK demodulator
+// ======================================================================
+
+#include "CDHDeployment/AX25/G3ruhDemodulator.hpp"
+#include "CDHDeployment/AX25/Dsp.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace AX25 {
+
+G3ruhDemodulator::G3ruhDemodulator(const Config& config) : m_config(config) {
+    FW_ASSERT(config.baudRate > 0);
+    FW_ASSERT(config.sampleRate >= 4 * config.baudRate,
+              static_cast<FwAssertArgType>(config.sampleRate),
+              static_cast<FwAssertArgType>(config.baudRate));
+    FW_ASSERT(config.meanShift < 16, static_cast<FwAssertArgType>(config.meanShift));
+    static_assert(TAPS % Dsp::TAP_MULTIPLE == 0, "Filter length must suit Dsp::fir");
+
+    // Root-raised-cosine, matched to the transmit filter at the default
+    // roll-off, unity gain at DC, in Q15
+    const U32 length = TAPS - 1;
+    const F64 centre = static_cast<F64>(length - 1) / 2.0;
+    const F64 symbolsPerSample = static_cast<F64>(config.baudRate) / static_cast<F64>(config.sampleRate);
+    F64 taps[TAPS];
+    F64 sum = 0.0;
+    for (U32 k = 0; k < length; k++) {
+        taps[k] = Dsp::rootRaisedCosine((static_cast<F64>(k) - centre) * symbolsPerSample, config.rollOff);
+        sum += taps[k];
+    }
+    for (U32 k = 0; k < length; k++) {
+        m_taps[k] = static_cast<I16>(std::lround(taps[k] / sum * 32767.0));
+    }
+    m_taps[TAPS - 1] = 0;
+
+    m_pllStep = static_cast<U32>((static_cast<U64>(config.baudRate) << 32) / config.sampleRate);
+
+    this->reset();
+}
+
+void G3ruhDemodulator::reset() {
+    memset(m_window, 0, sizeof(m_window));
+    m_pll = 0;
+    m_mean = 0;
+    m_last = 0;
+    m_lastBitLevel = false;
+    m_descrambler.reset();
+}
+
+void G3ruhDemodulator::process(const I16* samples, FwSizeType count, HdlcDeframer& deframer) {
+    FW_ASSERT(samples != nullptr);
+
+    while (count > 0) {
+        const FwSizeType block = FW_MIN(count, static_cast<FwSizeType>(BLOCK));
+        memcpy(&m_window[TAPS - 1], samples, block * sizeof(I16));
+        Dsp::fir(m_window, block, m_taps, TAPS, m_filtered);
+        // Keep the newest samples as history for the next block
+        memmove(m_window, &m_window[block], (TAPS - 1) * sizeof(I16));
+
+        this->sliceBlock(m_filtered, block, deframer);
+        samples += block;
+        count -= block;
+    }
+}
+
+void G3ruhDemodulator::sliceBlock(const I32* filtered, FwSizeType count, HdlcDeframer& deframer) {
+    for (FwSizeType n = 0; n < count; n++) {
+        // Q15 filter output back to sample scale, less the tracked mean
+        const I32 y = filtered[n] >> 15;
+        m_mean += (y - m_mean) >> m_config.meanShift;
+        const I32 value = y - m_mean;
+
+        // Sample when the PLL wraps from positive to negative, halfway
+        // between the zero crossings the PLL is pulled toward
+        const I32 previous = m_pll;
+        m_pll = static_cast<I32>(static_cast<U32>(m_pll) + m_pllStep);
+        if ((previous > 0) && (m_pll < 0)) {
+            // The middle of the bit fell `late` of a sample ago; a sample is
+            // a fifth of a bit at 9600 baud, so interpolate back to it
+            const F32 late = static_cast<F32>(static_cast<U32>(m_pll) - 0x80000000U) / static_cast<F32>(m_pllStep);
+            const F32 middle = static_cast<F32>(value) - late * static_cast<F32>(value - m_last);
+            const bool bit = m_descrambler.descramble(middle > 0.0f);
+            deframer.pushBit(bit == m_lastBitLevel);
+            m_lastBitLevel = bit;
+        }
+
+        if ((value > 0) != (m_last > 0)) {
+            // The crossing lies `fraction` of a sample before now; the PLL
+            // phase then was the error to take out
+            const F32 fraction = static_cast<F32>(value) / static_cast<F32>(value - m_last);
+            const I32 error =
+                static_cast<I32>(static_cast<U32>(m_pll) - static_cast<U32>(fraction * static_cast<F32>(m_pllStep)));
+            const I32 pull = static_cast<I32>(static_cast<F32>(error) * (1.0f - PLL_INERTIA));
+            m_pll = static_cast<I32>(static_cast<U32>(m_pll) - static_cast<U32>(pull));
+        }
+        m_last = value;
+    }
+}
+
+}  // namespace AX25
@@ -0,0 +1,78 @@
+// ======================================================================
+// \title  G3ruhDemodulator.hpp
+// \author madisonw
+// \brief  9600 baud G3RUH scrambled FSK demodulator
+// ======================================================================
+
+#ifndef AX25_G3ruhDemodulator_HPP
+#define AX25_G3ruhDemodulator_HPP
+
+#include "CDHDeployment/AX25/HdlcDeframer.hpp"
+#include "CDHDeployment/AX25/Scrambler.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! Turns G3RUH baseband (FM discriminator output, 16-bit PCM) back into
+//! NRZI-decoded bits for an HdlcDeframer.
+//!
+//! Samples go through the root-raised-cosine half of the pulse shaping
+//! (Dsp::fir, vectorized) a block at a time, which together with the
+//! transmit half leaves no intersymbol interference at the bit centres.
+//! The filtered signal is sliced against its own slowly tracked mean, so a
+//! frequency offset between the radios does not bias the decisions. A
+//! digital PLL recovers the bit clock from the zero crossings, and since a
+//! bit is only a few samples long, both the crossings and the bit centres
+//! are interpolated between samples. Each bit is then descrambled and NRZI
+//! decoded; neither step cares which way up the discriminator is.
+class G3ruhDemodulator {
+  public:
+    struct Config {
+        U32 sampleRate;
+        U32 baudRate;
+        //! Root-raised-cosine roll-off; 0.5 matches G3ruhModulator, less
+        //! narrows the filter against noise at the cost of some ISI
+        F64 rollOff;
+        //! Slicer mean tracks the filtered signal with time constant
+        //! 2^meanShift samples; shorter follows a drifting frequency offset
+        U32 meanShift;
+
+        Config() : sampleRate(48000), baudRate(9600), rollOff(0.5), meanShift(10) {}
+    };
+
+    explicit G3ruhDemodulator(const Config& config = Config());
+
+    //! Clear filter history, clock recovery and descrambler state
+    void reset();
+
+    //! Demodulate `count` samples, pushing recovered bits into `deframer`
+    void process(const I16* samples, FwSizeType count, HdlcDeframer& deframer);
+
+  private:
+    //! Filter length, a multiple of Dsp::TAP_MULTIPLE; the last tap is zero
+    //! so the filter is odd-length and symmetric (over nine bits at 9600 baud)
+    static constexpr U32 TAPS = 48;
+    //! Samples filtered per Dsp::fir call
+    static constexpr U32 BLOCK = 256;
+    //! Share of the PLL phase error left after each zero crossing
+    static constexpr F32 PLL_INERTIA = 0.95f;
+
+    void sliceBlock(const I32* filtered, FwSizeType count, HdlcDeframer& deframer);
+
+    Config m_config;
+    alignas(16) I16 m_taps[TAPS];
+    //! Last TAPS - 1 input samples followed by the block being filtered
+    alignas(16) I16 m_window[TAPS - 1 + BLOCK];
+    alignas(16) I32 m_filtered[BLOCK];
+
+    U32 m_pllStep;
+    I32 m_pll;
+    I32 m_mean;
+    I32 m_last;
+    bool m_lastBitLevel;
+    Scrambler m_descrambler;
+};
+
+}  // namespace AX25
+
+#endif
@@ -0,0 +1,73 @@
+// ======================================================================
+// \title  G3ruhModulator.cpp
+// \author madisonw
+// \brief  9600 baud G3RUH scrambled FSK modulator
+// ======================================================================
+
+#include "CDHDeployment/AX25/G3ruhModulator.hpp"
+#include "CDHDeployment/AX25/Dsp.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace AX25 {
+
+static_assert(G3ruhModulator::SAMPLE_RATE % G3ruhModulator::BAUD_RATE == 0,
+              "Sample rate must be a whole multiple of the baud rate");
+
+G3ruhModulator::G3ruhModulator(I16 amplitude) : Modulator(BAUD_RATE, LEAD_FLAGS, TRAIL_FLAGS) {
+    // Sample j of a bit lies j / SAMPLES_PER_BIT symbols after the centre of
+    // the symbol SPAN / 2 back, so every symbol in the span contributes
+    F64 shape[PATTERNS][SAMPLES_PER_BIT];
+    F64 peak = 0.0;
+    for (U32 pattern = 0; pattern < PATTERNS; pattern++) {
+        for (U32 j = 0; j < SAMPLES_PER_BIT; j++) {
+            F64 sum = 0.0;
+            for (U32 age = 0; age < SPAN; age++) {
+                const F64 t = static_cast<F64>(age) - static_cast<F64>(SPAN / 2) +
+                              static_cast<F64>(j) / static_cast<F64>(SAMPLES_PER_BIT);
+                sum += (((pattern >> age) & 0x01) != 0 ? 1.0 : -1.0) * Dsp::rootRaisedCosine(t, ROLL_OFF);
+            }
+            shape[pattern][j] = sum;
+            peak = std::fmax(peak, std::fabs(sum));
+        }
+    }
+    // Overshoot from neighbouring symbols must not exceed the amplitude
+    const F64 scale = static_cast<F64>(amplitude) / peak;
+    for (U32 pattern = 0; pattern < PATTERNS; pattern++) {
+        for (U32 j = 0; j < SAMPLES_PER_BIT; j++) {
+            m_shape[pattern][j] = static_cast<I16>(std::lround(shape[pattern][j] * scale));
+        }
+    }
+
+    this->reset();
+}
+
+void G3ruhModulator::reset() {
+    Modulator::reset();
+    m_scrambler.reset();
+    m_level = true;
+    m_symbols = 0;
+}
+
+Modulator::State G3ruhModulator::saveState() const {
+    // 17 scrambler bits, then the SPAN symbols, then the NRZI level
+    return static_cast<State>(m_scrambler.getRegister()) | (static_cast<State>(m_symbols) << 17) |
+           (static_cast<State>(m_level ? 1 : 0) << (17 + SPAN));
+}
+
+void G3ruhModulator::restoreState(State state) {
+    m_scrambler.setRegister(static_cast<U32>(state));
+    m_symbols = static_cast<U32>(state >> 17) & (PATTERNS - 1);
+    m_level = ((state >> (17 + SPAN)) & 0x01) != 0;
+}
+
+void G3ruhModulator::renderBit(bool bit, I16* out) {
+    if (!bit) {
+        m_level = !m_level;
+    }
+    const bool symbol = m_scrambler.scramble(m_level);
+    m_symbols = ((m_symbols << 1) | (symbol ? 1U : 0U)) & (PATTERNS - 1);
+    memcpy(out, m_shape[m_symbols], sizeof(m_shape[0]));
+}
+
+}  // namespace AX25
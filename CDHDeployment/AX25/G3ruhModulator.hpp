@@ -0,0 +1,64 @@
+// ======================================================================
+// \title  G3ruhModulator.hpp
+// \author madisonw
+// \brief  9600 baud G3RUH scrambled FSK modulator
+// ======================================================================
+
+#ifndef AX25_G3ruhModulator_HPP
+#define AX25_G3ruhModulator_HPP
+
+#include "CDHDeployment/AX25/Modulator.hpp"
+#include "CDHDeployment/AX25/Scrambler.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! Renders AX.25 frames as 9600 baud G3RUH baseband for direct FM.
+//!
+//! Bits are NRZI encoded (a 0 toggles the level), scrambled and shaped by
+//! a root-raised-cosine FIR filter; G3ruhDemodulator applies the other
+//! half. As in the original G3RUH modem, the filter is precomputed: the
+//! output over one bit depends only on the last SPAN line symbols, so every
+//! symbol pattern has its samples in a table and rendering a bit is one
+//! table row copy.
+class G3ruhModulator : public Modulator {
+  public:
+    static constexpr U32 BAUD_RATE = 9600;
+    static constexpr U32 SAMPLES_PER_BIT = SAMPLE_RATE / BAUD_RATE;
+    //! After a break the descrambler needs 17 bits to resynchronize, so
+    //! three flags absorb it ahead of the opening flag
+    static constexpr U32 LEAD_FLAGS = 4;
+    //! The shaping filter spreads each symbol over the SPAN bits after it,
+    //! so a flag carries the closing flag out before a break
+    static constexpr U32 TRAIL_FLAGS = 1;
+
+    //! Peak amplitude, the same FM deviation the AFSK tones use
+    static constexpr I16 DEFAULT_AMPLITUDE = 16384;
+
+    explicit G3ruhModulator(I16 amplitude = DEFAULT_AMPLITUDE);
+
+    //! Return the scrambler, NRZI level and filter history to their initial state
+    void reset() override;
+
+    State saveState() const override;
+    void restoreState(State state) override;
+
+  private:
+    //! Symbols the shaping filter spans
+    static constexpr U32 SPAN = 8;
+    static constexpr U32 PATTERNS = 1U << SPAN;
+    //! Root-raised-cosine roll-off
+    static constexpr F64 ROLL_OFF = 0.5;
+
+    void renderBit(bool bit, I16* out) override;
+
+    //! m_shape[p]: filter output over one bit for symbol history p, newest symbol in bit 0
+    I16 m_shape[PATTERNS][SAMPLES_PER_BIT];
+    Scrambler m_scrambler;
+    bool m_level;
+    U32 m_symbols;
+};
+
+}  // namespace AX25
+
+#endif
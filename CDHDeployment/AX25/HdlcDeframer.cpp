@@ -0,0 +1,136 @@
+// ======================================================================
+// \title  HdlcDeframer.cpp
+// \author madisonw
+// \brief  Bit-level HDLC deframer for received AX.25 frames
+// ======================================================================
+
+#include "CDHDeployment/AX25/HdlcDeframer.hpp"
+#include "CDHDeployment/AX25/Crc16.hpp"
+#include "Fw/Types/Assert.hpp"
+
+namespace AX25 {
+
+HdlcDeframer::HdlcDeframer(FrameHandler handler, void* context)
+    : m_handler(handler),
+      m_context(context),
+      m_frames(0),
+      m_fcsErrors(0),
+      m_fx25Corrected(0),
+      m_fx25Uncorrectable(0) {
+    FW_ASSERT(handler != nullptr);
+    this->reset();
+}
+
+void HdlcDeframer::reset() {
+    m_raw = 0;
+    m_byte = 0;
+    m_ones = 0;
+    m_bitCount = 0;
+    m_inFrame = false;
+    m_size = 0;
+    m_fx25.reset();
+    m_deliveredTag = 0;
+    m_deliveredSize = 0;
+    m_deliveredFcs = 0;
+}
+
+void HdlcDeframer::flagSeen() {
+    // The first seven bits of the closing flag were shifted in as data, so a
+    // byte-aligned frame leaves exactly seven bits pending
+    if (m_inFrame && (m_bitCount == 7) && (m_size >= MIN_FRAME_SIZE)) {
+        if (Crc16::compute(m_frame, m_size) == Crc16::GOOD_RESIDUE) {
+            if (m_fx25.isCollecting()) {
+                m_deliveredTag = m_fx25.getTagCount();
+                m_deliveredSize = m_size;
+                m_deliveredFcs = static_cast<U16>(m_frame[m_size - 2] | (m_frame[m_size - 1] << 8));
+            }
+            this->deliver(m_frame, m_size);
+        } else {
+            m_fcsErrors++;
+        }
+    }
+
+    // A flag both closes a frame and opens the next one
+    m_inFrame = true;
+    m_size = 0;
+    m_bitCount = 0;
+    m_ones = 0;
+}
+
+void HdlcDeframer::fx25BlockDone() {
+    const U32 tag = m_fx25.getTagCount();
+    const I32 corrected = m_fx25.decode();
+    const FwSizeType size =
+        (corrected < 0) ? 0 : unstuff(m_fx25.getData(), m_fx25.getDataSize(), m_fx25Frame, MAX_FRAME_SIZE);
+    if ((size < MIN_FRAME_SIZE) || (Crc16::compute(m_fx25Frame, size) != Crc16::GOOD_RESIDUE)) {
+        m_fx25Uncorrectable++;
+        return;
+    }
+    if (corrected > 0) {
+        m_fx25Corrected++;
+    }
+
+    // Already delivered if the HDLC path decoded it while the block came in
+    const U16 fcs = static_cast<U16>(m_fx25Frame[size - 2] | (m_fx25Frame[size - 1] << 8));
+    if ((m_deliveredTag == tag) && (m_deliveredSize == size) && (m_deliveredFcs == fcs)) {
+        return;
+    }
+    this->deliver(m_fx25Frame, size);
+}
+
+void HdlcDeframer::deliver(const U8* frame, FwSizeType size) {
+    m_frames++;
+    m_handler(m_context, frame, size - 2);
+}
+
+FwSizeType HdlcDeframer::unstuff(const U8* bits, FwSizeType size, U8* frame, FwSizeType capacity) {
+    FW_ASSERT(bits != nullptr);
+    FW_ASSERT(frame != nullptr);
+
+    U8 raw = 0;
+    U8 byte = 0;
+    U32 ones = 0;
+    U32 bitCount = 0;
+    bool inFrame = false;
+    FwSizeType written = 0;
+    for (FwSizeType i = 0; i < size * 8; i++) {
+        const bool bit = ((bits[i / 8] >> (i % 8)) & 0x01) != 0;
+        raw = static_cast<U8>((raw >> 1) | (bit ? 0x80 : 0x00));
+        if (raw == FLAG) {
+            // As in flagSeen(): seven bits of the closing flag are pending
+            if (inFrame && (written > 0) && (bitCount == 7)) {
+                return written;
+            }
+            inFrame = true;
+            written = 0;
+            bitCount = 0;
+            ones = 0;
+            continue;
+        }
+        if (!inFrame) {
+            continue;
+        }
+        if (bit) {
+            if (++ones >= 7) {
+                return 0;
+            }
+        } else {
+            const bool stuffed = (ones == 5);
+            ones = 0;
+            if (stuffed) {
+                continue;
+            }
+        }
+        byte = static_cast<U8>((byte >> 1) | (bit ? 0x80 : 0x00));
+        if (++bitCount == 8) {
+            if (written == capacity) {
+                return 0;
+            }
+            frame[written++] = byte;
+            bitCount = 0;
+        }
+    }
+    return 0;
+}
+
+}  // namespace AX25
@@ -0,0 +1,128 @@
+// ======================================================================
+// \title  HdlcDeframer.hpp
+// \author madisonw
+// \brief  Bit-level HDLC deframer for received AX.25 frames
+// ======================================================================
+
+#ifndef AX25_HdlcDeframer_HPP
+#define AX25_HdlcDeframer_HPP
+
+#include "CDHDeployment/AX25/Fx25.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! Recovers AX.25 frames from a stream of NRZI-decoded bits.
+//!
+//! Bits arrive LSB first. The deframer hunts for 0x7E flags, drops stuffed
+//! zeros, aborts on seven consecutive ones and checks the FCS of each
+//! candidate with the same CRC as AMSATFramer. Frames that pass are handed
+//! to the handler without flags or FCS.
+//!
+//! The same bits feed an Fx25Decoder. A frame sent in an FX.25 block is
+//! found both ways: unstuffed from the corrected data field, and directly by
+//! the HDLC path if it arrived clean. The handler sees it once.
+class HdlcDeframer {
+  public:
+    //! Address + control + FCS; anything shorter between flags is noise
+    static constexpr FwSizeType MIN_FRAME_SIZE = 17;
+    //! Address (with up to 8 digipeaters) + control + PID + 256 info + FCS
+    static constexpr FwSizeType MAX_FRAME_SIZE = 70 + 2 + 256 + 2;
+
+    //! Called for every frame with a valid FCS
+    typedef void (*FrameHandler)(void* context, const U8* frame, FwSizeType size);
+
+    HdlcDeframer(FrameHandler handler, void* context);
+
+    //! Drop any partial frame and resume flag hunting
+    void reset();
+
+    //! Feed one decoded bit
+    void pushBit(bool bit) {
+        if (m_fx25.pushBit(bit)) {
+            this->fx25BlockDone();
+        }
+        m_raw = static_cast<U8>((m_raw >> 1) | (bit ? 0x80 : 0x00));
+        if (m_raw == FLAG) {
+            this->flagSeen();
+        } else if (bit) {
+            if (++m_ones >= 7) {
+                m_inFrame = false;  // abort sequence
+            } else {
+                this->appendBit(true);
+            }
+        } else {
+            if (m_ones != 5) {
+                this->appendBit(false);
+            }
+            m_ones = 0;
+        }
+    }
+
+    U32 getFrameCount() const { return m_frames; }
+    U32 getFcsErrorCount() const { return m_fcsErrors; }
+    //! FX.25 blocks whose tag was found
+    U32 getFx25BlockCount() const { return m_fx25.getTagCount(); }
+    //! FX.25 blocks that had errors and were corrected
+    U32 getFx25CorrectedCount() const { return m_fx25Corrected; }
+    //! FX.25 blocks with more errors than the code corrects, or no valid frame inside
+    U32 getFx25UncorrectableCount() const { return m_fx25Uncorrectable; }
+
+    //! Unstuff the first frame between flags in bits packed LSB first, as in
+    //! an FX.25 data field. Returns the frame size, FCS included, or 0.
+    static FwSizeType unstuff(const U8* bits, FwSizeType size, U8* frame, FwSizeType capacity);
+
+  private:
+    static constexpr U8 FLAG = 0x7E;
+
+    void appendBit(bool bit) {
+        if (!m_inFrame) {
+            return;
+        }
+        m_byte = static_cast<U8>((m_byte >> 1) | (bit ? 0x80 : 0x00));
+        if (++m_bitCount == 8) {
+            if (m_size == MAX_FRAME_SIZE) {
+                m_inFrame = false;
+                return;
+            }
+            m_frame[m_size++] = m_byte;
+            m_bitCount = 0;
+        }
+    }
+
+    void flagSeen();
+
+    //! Check and deliver the frame inside a collected FX.25 block
+    void fx25BlockDone();
+
+    //! Hand a frame with a good FCS to the handler
+    void deliver(const U8* frame, FwSizeType size);
+
+    FrameHandler m_handler;
+    void* m_context;
+
+    U8 m_raw;
+    U8 m_byte;
+    U32 m_ones;
+    U32 m_bitCount;
+    bool m_inFrame;
+    FwSizeType m_size;
+    U8 m_frame[MAX_FRAME_SIZE];
+
+    Fx25Decoder m_fx25;
+    //! FX.25 block (tag count) being collected when HDLC last delivered a
+    //! frame, and that frame's size and FCS
+    U32 m_deliveredTag;
+    FwSizeType m_deliveredSize;
+    U16 m_deliveredFcs;
+    U8 m_fx25Frame[MAX_FRAME_SIZE];
+
+    U32 m_frames;
+    U32 m_fcsErrors;
+    U32 m_fx25Corrected;
+    U32 m_fx25Uncorrectable;
+};
+
+}  // namespace AX25
+
+#endif
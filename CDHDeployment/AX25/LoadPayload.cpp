@@ -0,0 +1,102 @@
+// ======================================================================
+// \title  LoadPayload.cpp
+// \author madisonw
+// \brief  Payload of the frames AMSATFramer generates for load testing
+// ======================================================================
+
+#include "CDHDeployment/AX25/LoadPayload.hpp"
+#include <cstring>
+
+namespace AX25 {
+
+namespace {
+
+void putU32(U8* out, U32 value) {
+    out[0] = static_cast<U8>(value >> 24);
+    out[1] = static_cast<U8>(value >> 16);
+    out[2] = static_cast<U8>(value >> 8);
+    out[3] = static_cast<U8>(value);
+}
+
+U32 getU32(const U8* in) {
+    return (static_cast<U32>(in[0]) << 24) | (static_cast<U32>(in[1]) << 16) | (static_cast<U32>(in[2]) << 8) |
+           static_cast<U32>(in[3]);
+}
+
+//! Next byte of PRBS-15 (x^15 + x^14 + 1), most significant bit first
+U8 prbsByte(U16& state) {
+    U8 byte = 0;
+    for (U32 bit = 0; bit < 8; bit++) {
+        const U16 next = static_cast<U16>(((state >> 14) ^ (state >> 13)) & 1);
+        state = static_cast<U16>(((state << 1) | next) & 0x7FFF);
+        byte = static_cast<U8>((byte << 1) | next);
+    }
+    return byte;
+}
+
+//! Any nonzero 15-bit state will do; the sequence number picks one
+U16 prbsSeed(U32 sequence) {
+    return static_cast<U16>(sequence % 0x7FFF + 1);
+}
+
+}  // namespace
+
+void LoadHeader::serialize(U8* out) const {
+    out[0] = static_cast<U8>(MAGIC >> 8);
+    out[1] = static_cast<U8>(MAGIC);
+    out[2] = static_cast<U8>(pattern.e);
+    out[3] = 0;
+    putU32(&out[4], stream);
+    putU32(&out[8], sequence);
+    putU32(&out[12], seconds);
+    putU32(&out[16], useconds);
+}
+
+bool LoadHeader::deserialize(const U8* in, FwSizeType size) {
+    if ((size < SIZE) || (static_cast<U16>((in[0] << 8) | in[1]) != MAGIC)) {
+        return false;
+    }
+    pattern = static_cast<LoadPattern::T>(in[2]);
+    stream = getU32(&in[4]);
+    sequence = getU32(&in[8]);
+    seconds = getU32(&in[12]);
+    useconds = getU32(&in[16]);
+    return pattern.isValid();
+}
+
+void loadFill(const LoadHeader& header, const U8* replay, FwSizeType replaySize, U8* out, FwSizeType size) {
+    if ((header.pattern == LoadPattern::REPLAY) && (replaySize > 0)) {
+        for (FwSizeType offset = 0; offset < size; offset += replaySize) {
+            memcpy(&out[offset], replay, FW_MIN(replaySize, size - offset));
+        }
+    } else if (header.pattern == LoadPattern::PRBS) {
+        U16 state = prbsSeed(header.sequence);
+        for (FwSizeType i = 0; i < size; i++) {
+            out[i] = prbsByte(state);
+        }
+    } else {
+        for (FwSizeType i = 0; i < size; i++) {
+            out[i] = static_cast<U8>(header.sequence + i);
+        }
+    }
+}
+
+bool loadCheck(const LoadHeader& header, const U8* body, FwSizeType size) {
+    if (header.pattern == LoadPattern::PRBS) {
+        U16 state = prbsSeed(header.sequence);
+        for (FwSizeType i = 0; i < size; i++) {
+            if (body[i] != prbsByte(state)) {
+                return false;
+            }
+        }
+    } else if (header.pattern == LoadPattern::COUNTER) {
+        for (FwSizeType i = 0; i < size; i++) {
+            if (body[i] != static_cast<U8>(header.sequence + i)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace AX25
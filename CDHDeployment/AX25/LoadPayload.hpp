@@ -0,0 +1,51 @@
+// ======================================================================
+// \title  LoadPayload.hpp
+// \author madisonw
+// \brief  Payload of the frames AMSATFramer generates for load testing
+// ======================================================================
+
+#ifndef AX25_LoadPayload_HPP
+#define AX25_LoadPayload_HPP
+
+#include "CDHDeployment/AX25/LoadPatternEnumAc.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! Header at the start of a load frame's payload, after the segment header.
+//!
+//! Wire format (20 bytes, big endian): magic "LD", pattern, reserved byte,
+//! stream, sequence, then the seconds and microseconds of the time the
+//! frame was built. The magic is not an F´ packet descriptor, so a deframer
+//! discards load frames while a receiver that knows the format can count
+//! them. Each LOAD_START begins a new stream; sequence numbers start at 0
+//! and count every frame built, so gaps at the receiver are frames lost.
+struct LoadHeader {
+    static constexpr FwSizeType SIZE = 20;
+    static constexpr U16 MAGIC = 0x4C44;
+
+    LoadPattern pattern;
+    U32 stream;
+    U32 sequence;
+    U32 seconds;
+    U32 useconds;
+
+    //! Write the header to `out` (SIZE bytes)
+    void serialize(U8* out) const;
+
+    //! Read a header from a payload; false if it is too short or not a load frame
+    bool deserialize(const U8* in, FwSizeType size);
+};
+
+//! Fill the `size` bytes after a load header with `header`'s pattern:
+//! COUNTER counts up from the sequence number, PRBS is PRBS-15 seeded from
+//! it, and REPLAY repeats `replay` (COUNTER if there is none)
+void loadFill(const LoadHeader& header, const U8* replay, FwSizeType replaySize, U8* out, FwSizeType size);
+
+//! Check the bytes after a load header against its pattern; REPLAY bytes
+//! cannot be checked and always pass
+bool loadCheck(const LoadHeader& header, const U8* body, FwSizeType size);
+
+}  // namespace AX25
+
+#endif
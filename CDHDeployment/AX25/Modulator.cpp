@@ -0,0 +1,121 @@
+// ======================================================================
+// \title  Modulator.cpp
+// \author madisonw
+// \brief  HDLC bit framing shared by the downlink modulators
+// ======================================================================
+
+#include "CDHDeployment/AX25/Modulator.hpp"
+#include "Fw/Types/Assert.hpp"
+
+namespace AX25 {
+
+Modulator::Modulator(U32 baudRate, U32 leadFlags, U32 trailFlags)
+    : m_baudRate(baudRate), m_samplesPerBit(0), m_leadFlags(leadFlags), m_trailFlags(trailFlags), m_ones(0) {
+    FW_ASSERT((baudRate > 0) && (SAMPLE_RATE % baudRate == 0), static_cast<FwAssertArgType>(baudRate));
+    FW_ASSERT(leadFlags > 0);
+    m_samplesPerBit = SAMPLE_RATE / baudRate;
+}
+
+Modulator::~Modulator() {}
+
+void Modulator::reset() {
+    m_ones = 0;
+}
+
+FwSizeType Modulator::maxSamples(FwSizeType bodySize, U32 flags) const {
+    // Bit stuffing adds at most one bit for every five payload bits, counting
+    // up to four ones carried over from the previous piece of the body
+    const FwSizeType bodyBits = bodySize * 8;
+    const FwSizeType stuffedBits = bodyBits + ((bodyBits + 4) / 5);
+    return (stuffedBits + static_cast<FwSizeType>(flags) * 8) * m_samplesPerBit;
+}
+
+FwSizeType Modulator::renderFlags(U32 count, I16* out, FwSizeType capacity) {
+    FW_ASSERT(out != nullptr);
+    const FwSizeType needed = static_cast<FwSizeType>(count) * 8 * m_samplesPerBit;
+    if (needed > capacity) {
+        return 0;
+    }
+
+    I16* cursor = out;
+    m_ones = 0;
+    for (U32 flag = 0; flag < count; flag++) {
+        for (U32 bit = 0; bit < 8; bit++) {
+            this->renderBit(((HDLC_FLAG >> bit) & 0x01) != 0, cursor);
+            cursor += m_samplesPerBit;
+        }
+    }
+    return needed;
+}
+
+FwSizeType Modulator::renderBody(const U8* body, FwSizeType size, I16* out, FwSizeType capacity) {
+    FW_ASSERT(body != nullptr);
+    FW_ASSERT(out != nullptr);
+    if (this->maxSamples(size, 0) > capacity) {
+        return 0;
+    }
+
+    I16* cursor = out;
+    for (FwSizeType i = 0; i < size; i++) {
+        const U8 byte = body[i];
+        for (U32 bit = 0; bit < 8; bit++) {
+            const bool one = ((byte >> bit) & 0x01) != 0;
+            this->renderBit(one, cursor);
+            cursor += m_samplesPerBit;
+
+            m_ones = one ? (m_ones + 1) : 0;
+            if (m_ones == 5) {
+                // Stuff a zero so the body never looks like a flag
+                this->renderBit(false, cursor);
+                cursor += m_samplesPerBit;
+                m_ones = 0;
+            }
+        }
+    }
+    return static_cast<FwSizeType>(cursor - out);
+}
+
+FwSizeType Modulator::renderRaw(const U8* data, FwSizeType size, I16* out, FwSizeType capacity) {
+    FW_ASSERT(data != nullptr);
+    FW_ASSERT(out != nullptr);
+    const FwSizeType needed = size * 8 * m_samplesPerBit;
+    if (needed > capacity) {
+        return 0;
+    }
+
+    I16* cursor = out;
+    m_ones = 0;
+    for (FwSizeType i = 0; i < size; i++) {
+        for (U32 bit = 0; bit < 8; bit++) {
+            this->renderBit(((data[i] >> bit) & 0x01) != 0, cursor);
+            cursor += m_samplesPerBit;
+        }
+    }
+    return needed;
+}
+
+FwSizeType Modulator::renderFrame(const U8* frame,
+                                  FwSizeType size,
+                                  U32 txDelayFlags,
+                                  U32 txTailFlags,
+                                  I16* out,
+                                  FwSizeType capacity) {
+    FW_ASSERT(frame != nullptr);
+    if (size < 2 || frame[0] != HDLC_FLAG || frame[size - 1] != HDLC_FLAG) {
+        return 0;
+    }
+
+    // The opening and closing flags of the frame are sent with the padding
+    const U8* body = &frame[1];
+    const FwSizeType bodySize = size - 2;
+    if (this->maxSamples(bodySize, txDelayFlags + txTailFlags + 2) > capacity) {
+        return 0;
+    }
+
+    FwSizeType written = this->renderFlags(txDelayFlags + 1, out, capacity);
+    written += this->renderBody(body, bodySize, &out[written], capacity - written);
+    written += this->renderFlags(txTailFlags + 1, &out[written], capacity - written);
+    return written;
+}
+
+}  // namespace AX25
@@ -0,0 +1,97 @@
+// ======================================================================
+// \title  Modulator.hpp
+// \author madisonw
+// \brief  HDLC bit framing shared by the downlink modulators
+// ======================================================================
+
+#ifndef AX25_Modulator_HPP
+#define AX25_Modulator_HPP
+
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! Renders HDLC-framed AX.25 frames as 16-bit PCM at SAMPLE_RATE.
+//!
+//! Flags, bit stuffing and the LSB-first bit order are the same for every
+//! modulation; a subclass only turns one bit into getSamplesPerBit()
+//! samples, NRZI encoding it along the way.
+class Modulator {
+  public:
+    //! Rate of the transmit sink, whatever the modulation
+    static constexpr U32 SAMPLE_RATE = 48000;
+    static constexpr U8 HDLC_FLAG = 0x7E;
+
+    virtual ~Modulator();
+
+    //! Everything the next bit depends on between frames (NRZI level,
+    //! oscillator phase, scrambler, filter history), packed into one word
+    typedef U64 State;
+
+    //! Return the modulator to the state it keys up in
+    virtual void reset();
+
+    //! Current state, taken between frames (after a flag)
+    virtual State saveState() const = 0;
+
+    //! Carry on as if the rendering that ended in `state` had just been done
+    virtual void restoreState(State state) = 0;
+
+    U32 getBaudRate() const { return m_baudRate; }
+    U32 getSamplesPerBit() const { return m_samplesPerBit; }
+
+    //! Flags a burst opens with: enough for the receiver to find the first
+    //! frame after a break in the waveform (key-up, or a reset mid-carrier)
+    U32 getLeadFlags() const { return m_leadFlags; }
+    //! Flags after a burst's closing flag, so the last frame is on air in
+    //! full before the waveform breaks again
+    U32 getTrailFlags() const { return m_trailFlags; }
+
+    //! Worst-case number of samples needed to render a frame body of
+    //! `bodySize` bytes (with bit stuffing) plus `flags` HDLC flags
+    FwSizeType maxSamples(FwSizeType bodySize, U32 flags) const;
+
+    //! Render `count` HDLC flags (no bit stuffing); ends any body in progress
+    //! \return number of samples written, 0 if `capacity` is too small
+    FwSizeType renderFlags(U32 count, I16* out, FwSizeType capacity);
+
+    //! Render a frame body (address through FCS, without flags) bit stuffed.
+    //! Consecutive calls continue the same body, so a frame held in several
+    //! pieces renders exactly as if it were contiguous.
+    //! \return number of samples written, 0 if `capacity` is too small
+    FwSizeType renderBody(const U8* body, FwSizeType size, I16* out, FwSizeType capacity);
+
+    //! Render bytes as they are, without bit stuffing, e.g. an FX.25 block
+    //! \return number of samples written, 0 if `capacity` is too small
+    FwSizeType renderRaw(const U8* data, FwSizeType size, I16* out, FwSizeType capacity);
+
+    //! Render a complete frame as it leaves AMSATFramer (leading and trailing
+    //! 0x7E included) preceded by `txDelayFlags` and followed by `txTailFlags`
+    //! \return number of samples written, 0 if the frame is malformed or
+    //!         `capacity` is too small
+    FwSizeType renderFrame(const U8* frame,
+                           FwSizeType size,
+                           U32 txDelayFlags,
+                           U32 txTailFlags,
+                           I16* out,
+                           FwSizeType capacity);
+
+  protected:
+    //! `baudRate` must divide SAMPLE_RATE
+    Modulator(U32 baudRate, U32 leadFlags, U32 trailFlags);
+
+    //! Emit one bit (before NRZI) as getSamplesPerBit() samples
+    virtual void renderBit(bool bit, I16* out) = 0;
+
+  private:
+    U32 m_baudRate;
+    U32 m_samplesPerBit;
+    U32 m_leadFlags;
+    U32 m_trailFlags;
+    //! Consecutive one bits in the body so far, for bit stuffing
+    U32 m_ones;
+};
+
+}  // namespace AX25
+
+#endif
@@ -0,0 +1,63 @@
+// ======================================================================
+// \title  Packing.hpp
+// \author madisonw
+// \brief  Several com packets carried in one segmented message
+// ======================================================================
+
+#ifndef AX25_Packing_HPP
+#define AX25_Packing_HPP
+
+#include "Fw/Types/BasicTypes.hpp"
+#include <cstring>
+
+namespace AX25 {
+
+//! Packed message layout: records of a U16 big-endian length followed by
+//! that many bytes of one com packet, back to back to the end of the message.
+static constexpr FwSizeType PACK_RECORD_HEADER = 2;
+
+//! Bytes a packet of `size` bytes takes in a pack
+constexpr FwSizeType packedSize(FwSizeType size) {
+    return PACK_RECORD_HEADER + size;
+}
+
+//! Append one record at `pack[used]`; the caller checks the space
+inline void packAppend(U8* pack, FwSizeType& used, const U8* packet, FwSizeType size) {
+    pack[used] = static_cast<U8>(size >> 8);
+    pack[used + 1] = static_cast<U8>(size);
+    memcpy(&pack[used + PACK_RECORD_HEADER], packet, size);
+    used += packedSize(size);
+}
+
+//! Walks the records of a packed message
+class PackReader {
+  public:
+    PackReader(const U8* pack, FwSizeType size) : m_pack(pack), m_size(size), m_offset(0) {}
+
+    //! Next packet; false at the end, or if a record runs past the message
+    bool next(const U8*& packet, FwSizeType& size) {
+        if (m_offset + PACK_RECORD_HEADER > m_size) {
+            return false;
+        }
+        size = static_cast<FwSizeType>((m_pack[m_offset] << 8) | m_pack[m_offset + 1]);
+        if (m_offset + packedSize(size) > m_size) {
+            m_offset = m_size;
+            return false;
+        }
+        packet = &m_pack[m_offset + PACK_RECORD_HEADER];
+        m_offset += packedSize(size);
+        return true;
+    }
+
+    //! True once every byte has been read as a whole record
+    bool isComplete() const { return m_offset == m_size; }
+
+  private:
+    const U8* m_pack;
+    FwSizeType m_size;
+    FwSizeType m_offset;
+};
+
+}  // namespace AX25
+
+#endif
@@ -0,0 +1,319 @@
+// ======================================================================
+// \title  ReedSolomon.cpp
+// \author madisonw
+// \brief  Reed-Solomon codec over GF(2^8) with the FX.25 parameters
+// ======================================================================
+
+#include "CDHDeployment/AX25/ReedSolomon.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <cstring>
+
+#if defined(__SSE2__)
+#define AX25_RS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define AX25_RS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace AX25 {
+
+namespace {
+
+// ----------------------------------------------------------------------
+// Compile-time field tables
+// ----------------------------------------------------------------------
+
+constexpr U32 FIELD_POLY = 0x11D;  // x^8 + x^4 + x^3 + x^2 + 1
+constexpr U32 NN = 255;
+//! Log of zero
+constexpr U32 A0 = NN;
+
+constexpr U32 gfDouble(U32 x) {
+    return (x & 0x80) ? ((x << 1) ^ FIELD_POLY) : (x << 1);
+}
+
+constexpr U32 alphaPow(U32 n, U32 x = 1) {
+    return (n == 0) ? x : alphaPow(n - 1, gfDouble(x));
+}
+
+constexpr U32 logOf(U32 x, U32 n = 0, U32 power = 1) {
+    return (x == 0) ? A0 : ((power == x) ? n : logOf(x, n + 1, gfDouble(power)));
+}
+
+template <U32... I>
+struct IndexList {};
+template <U32 N, U32... I>
+struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+template <U32... I>
+struct MakeIndexList<0, I...> {
+    typedef IndexList<I...> type;
+};
+
+struct FieldTables {
+    //! alpha^i for i up to twice the field size, so sums of two logs need no reduction
+    U8 exp[2 * NN];
+    U8 log[256];
+};
+
+template <U32... E, U32... L>
+constexpr FieldTables makeFieldTables(IndexList<E...>, IndexList<L...>) {
+    return FieldTables{{static_cast<U8>(alphaPow(E))..., static_cast<U8>(alphaPow(E))...},
+                       {static_cast<U8>(logOf(L))...}};
+}
+
+constexpr FieldTables FIELD = makeFieldTables(MakeIndexList<NN>::type(), MakeIndexList<256>::type());
+
+static_assert(FIELD.exp[8] == 0x1D, "GF(2^8) table generation is broken");
+static_assert(FIELD.log[0x1D] == 8, "GF(2^8) table generation is broken");
+static_assert(FIELD.exp[NN] == 1, "GF(2^8) table generation is broken");
+
+//! x mod 255 without a division
+inline U32 modnn(U32 x) {
+    while (x >= NN) {
+        x -= NN;
+        x = (x >> 8) + (x & NN);
+    }
+    return x;
+}
+
+}  // namespace
+
+ReedSolomon::ReedSolomon(FwSizeType roots) : m_roots(roots) {
+    FW_ASSERT((roots > 0) && (roots <= MAX_ROOTS) && ((roots % 2) == 0), static_cast<FwAssertArgType>(roots));
+
+    // Generator polynomial: product of (x - alpha^i) for i = 1..roots
+    U8 generator[MAX_ROOTS + 1];
+    memset(generator, 0, sizeof(generator));
+    generator[0] = 1;
+    for (FwSizeType i = 0; i < roots; i++) {
+        const U32 root = static_cast<U32>(i) + 1;
+        generator[i + 1] = 1;
+        for (FwSizeType j = i; j > 0; j--) {
+            generator[j] = (generator[j] != 0)
+                               ? static_cast<U8>(generator[j - 1] ^ FIELD.exp[modnn(FIELD.log[generator[j]] + root)])
+                               : generator[j - 1];
+        }
+        generator[0] = FIELD.exp[modnn(FIELD.log[generator[0]] + root)];
+    }
+
+    // After a step, check symbol j is the old symbol j + 1 plus
+    // feedback * generator[roots - 1 - j]
+    memset(m_rows, 0, sizeof(m_rows));
+    for (U32 feedback = 1; feedback < 256; feedback++) {
+        for (FwSizeType j = 0; j < roots; j++) {
+            const U8 coefficient = generator[roots - 1 - j];
+            m_rows[feedback][j] =
+                (coefficient == 0) ? 0 : FIELD.exp[FIELD.log[feedback] + FIELD.log[coefficient]];
+        }
+    }
+}
+
+void ReedSolomon::encode(const U8* data, FwSizeType size, U8* parity) const {
+#if defined(AX25_RS_SSE2) || defined(AX25_RS_NEON)
+    FW_ASSERT(data != nullptr);
+    FW_ASSERT(parity != nullptr);
+    FW_ASSERT(size <= this->getDataSize(), static_cast<FwAssertArgType>(size));
+
+    // Zeros past the check symbols: the last one shifts in a zero, and a
+    // vector step writes back zeros there (zero row entries)
+    alignas(16) U8 state[ROW_STRIDE + 16];
+    memset(state, 0, sizeof(state));
+
+    const FwSizeType dataSize = this->getDataSize();
+    for (FwSizeType i = 0; i < dataSize; i++) {
+        const U8 symbol = (i < size) ? data[i] : 0;
+        const U8* row = m_rows[symbol ^ state[0]];
+#if defined(AX25_RS_SSE2)
+        for (FwSizeType j = 0; j < m_roots; j += 16) {
+            const __m128i shifted = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[j + 1]));
+            const __m128i product = _mm_load_si128(reinterpret_cast<const __m128i*>(&row[j]));
+            _mm_store_si128(reinterpret_cast<__m128i*>(&state[j]), _mm_xor_si128(shifted, product));
+        }
+#else
+        for (FwSizeType j = 0; j < m_roots; j += 16) {
+            vst1q_u8(&state[j], veorq_u8(vld1q_u8(&state[j + 1]), vld1q_u8(&row[j])));
+        }
+#endif
+    }
+    memcpy(parity, state, m_roots);
+#else
+    this->encodeScalar(data, size, parity);
+#endif
+}
+
+void ReedSolomon::encodeScalar(const U8* data, FwSizeType size, U8* parity) const {
+    FW_ASSERT(data != nullptr);
+    FW_ASSERT(parity != nullptr);
+    FW_ASSERT(size <= this->getDataSize(), static_cast<FwAssertArgType>(size));
+
+    // One zero past the check symbols for the last one to shift in
+    U8 state[MAX_ROOTS + 1];
+    memset(state, 0, sizeof(state));
+
+    const FwSizeType dataSize = this->getDataSize();
+    for (FwSizeType i = 0; i < dataSize; i++) {
+        const U8 symbol = (i < size) ? data[i] : 0;
+        const U8* row = m_rows[symbol ^ state[0]];
+        for (FwSizeType j = 0; j < m_roots; j++) {
+            state[j] = static_cast<U8>(state[j + 1] ^ row[j]);
+        }
+    }
+    memcpy(parity, state, m_roots);
+}
+
+I32 ReedSolomon::decode(U8* codeword) const {
+    FW_ASSERT(codeword != nullptr);
+    const FwSizeType roots = m_roots;
+
+    // Clean blocks are the common case, and re-encoding with the vector
+    // encoder finds them faster than the syndromes would
+    U8 parity[MAX_ROOTS];
+    this->encode(codeword, this->getDataSize(), parity);
+    if (memcmp(parity, &codeword[this->getDataSize()], roots) == 0) {
+        return 0;
+    }
+
+    // Syndromes: the codeword evaluated at each root alpha^(i + 1), in log form
+    U32 syndrome[MAX_ROOTS];
+    for (FwSizeType i = 0; i < roots; i++) {
+        syndrome[i] = codeword[0];
+    }
+    for (FwSizeType j = 1; j < NN; j++) {
+        const U8 symbol = codeword[j];
+        for (FwSizeType i = 0; i < roots; i++) {
+            syndrome[i] = (syndrome[i] == 0) ? symbol
+                                             : static_cast<U32>(symbol ^ FIELD.exp[FIELD.log[syndrome[i]] + i + 1]);
+        }
+    }
+    bool errors = false;
+    for (FwSizeType i = 0; i < roots; i++) {
+        errors = errors || (syndrome[i] != 0);
+        syndrome[i] = FIELD.log[syndrome[i]];
+    }
+    if (!errors) {
+        return 0;
+    }
+
+    // Berlekamp-Massey: error locator lambda (polynomial form) and the
+    // correction polynomial b (log form)
+    U8 lambda[MAX_ROOTS + 1];
+    U32 b[MAX_ROOTS + 1];
+    U8 t[MAX_ROOTS + 1];
+    memset(lambda, 0, sizeof(lambda));
+    lambda[0] = 1;
+    b[0] = 0;
+    for (FwSizeType i = 1; i <= roots; i++) {
+        b[i] = A0;
+    }
+
+    FwSizeType degree = 0;  // current length of the LFSR
+    for (FwSizeType r = 1; r <= roots; r++) {
+        U32 discrepancy = 0;
+        for (FwSizeType i = 0; i < r; i++) {
+            if ((lambda[i] != 0) && (syndrome[r - i - 1] != A0)) {
+                discrepancy ^= FIELD.exp[FIELD.log[lambda[i]] + syndrome[r - i - 1]];
+            }
+        }
+        discrepancy = FIELD.log[discrepancy];
+
+        if (discrepancy == A0) {
+            memmove(&b[1], &b[0], roots * sizeof(b[0]));
+            b[0] = A0;
+            continue;
+        }
+
+        t[0] = lambda[0];
+        for (FwSizeType i = 0; i < roots; i++) {
+            t[i + 1] = (b[i] != A0) ? static_cast<U8>(lambda[i + 1] ^ FIELD.exp[modnn(discrepancy + b[i])])
+                                    : lambda[i + 1];
+        }
+        if (2 * degree <= r - 1) {
+            degree = r - degree;
+            for (FwSizeType i = 0; i <= roots; i++) {
+                b[i] = (lambda[i] == 0) ? A0 : modnn(FIELD.log[lambda[i]] + NN - discrepancy);
+            }
+        } else {
+            memmove(&b[1], &b[0], roots * sizeof(b[0]));
+            b[0] = A0;
+        }
+        memcpy(lambda, t, roots + 1);
+    }
+
+    U32 lambdaLog[MAX_ROOTS + 1];
+    FwSizeType lambdaDegree = 0;
+    for (FwSizeType i = 0; i <= roots; i++) {
+        lambdaLog[i] = FIELD.log[lambda[i]];
+        if (lambdaLog[i] != A0) {
+            lambdaDegree = i;
+        }
+    }
+    if (lambdaDegree == 0) {
+        return -1;
+    }
+
+    // Chien search: the roots of lambda give the error locations
+    U32 reg[MAX_ROOTS + 1];
+    memcpy(reg, lambdaLog, sizeof(reg));
+    U32 root[MAX_ROOTS];
+    FwSizeType location[MAX_ROOTS];
+    FwSizeType count = 0;
+    for (U32 i = 1; (i <= NN) && (count < lambdaDegree); i++) {
+        U32 q = 1;
+        for (FwSizeType j = lambdaDegree; j > 0; j--) {
+            if (reg[j] != A0) {
+                reg[j] = modnn(reg[j] + static_cast<U32>(j));
+                q ^= FIELD.exp[reg[j]];
+            }
+        }
+        if (q == 0) {
+            root[count] = i;
+            location[count] = i - 1;
+            count++;
+        }
+    }
+    if (count != lambdaDegree) {
+        return -1;
+    }
+
+    // Error evaluator omega = syndrome * lambda mod x^roots, in log form
+    const FwSizeType omegaDegree = lambdaDegree - 1;
+    U32 omega[MAX_ROOTS];
+    for (FwSizeType i = 0; i <= omegaDegree; i++) {
+        U32 sum = 0;
+        for (FwSizeType j = 0; j <= i; j++) {
+            if ((syndrome[i - j] != A0) && (lambdaLog[j] != A0)) {
+                sum ^= FIELD.exp[syndrome[i - j] + lambdaLog[j]];
+            }
+        }
+        omega[i] = FIELD.log[sum];
+    }
+
+    // Forney: error value = omega(X^-1) / lambda'(X^-1), the first root
+    // being alpha^1 so no extra power of X appears
+    for (FwSizeType e = 0; e < count; e++) {
+        U32 numerator = 0;
+        for (FwSizeType i = 0; i <= omegaDegree; i++) {
+            if (omega[i] != A0) {
+                numerator ^= FIELD.exp[modnn(omega[i] + static_cast<U32>(i) * root[e])];
+            }
+        }
+        // Odd terms of lambda form its formal derivative
+        U32 denominator = 0;
+        const FwSizeType top = FW_MIN(lambdaDegree, roots - 1) & ~static_cast<FwSizeType>(1);
+        for (FwSizeType i = 0; i <= top; i += 2) {
+            if (lambdaLog[i + 1] != A0) {
+                denominator ^= FIELD.exp[modnn(lambdaLog[i + 1] + static_cast<U32>(i) * root[e])];
+            }
+        }
+        if (denominator == 0) {
+            return -1;
+        }
+        if (numerator != 0) {
+            codeword[location[e]] ^= FIELD.exp[modnn(FIELD.log[numerator] + NN - FIELD.log[denominator])];
+        }
+    }
+    return static_cast<I32>(count);
+}
+
+}  // namespace AX25
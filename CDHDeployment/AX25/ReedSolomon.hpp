@@ -0,0 +1,61 @@
+// ======================================================================
+// \title  ReedSolomon.hpp
+// \author madisonw
+// \brief  Reed-Solomon codec over GF(2^8) with the FX.25 parameters
+// ======================================================================
+
+#ifndef AX25_ReedSolomon_HPP
+#define AX25_ReedSolomon_HPP
+
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! RS(255, 255 - roots) over GF(2^8) with field polynomial 0x11D, first
+//! consecutive root alpha^1 and primitive element alpha, the code FX.25
+//! uses (same parameters as Phil Karn's init_rs_char(8, 0x11d, 1, 1, roots)).
+//!
+//! A codeword is the data symbols followed by the check symbols. Shortened
+//! codes are the caller's business: unsent data symbols are zeros.
+//!
+//! Encoding runs one LFSR step per data byte against a table holding every
+//! multiple of the generator polynomial, so a step is a one-byte shift of
+//! the check symbols and an XOR with a table row, done 16 bytes at a time
+//! with SSE2 or NEON. Decoding is Berlekamp-Massey, Chien search and Forney.
+class ReedSolomon {
+  public:
+    static constexpr FwSizeType BLOCK_SIZE = 255;
+    static constexpr FwSizeType MAX_ROOTS = 64;
+
+    //! A code with `roots` check symbols (even, at most MAX_ROOTS)
+    explicit ReedSolomon(FwSizeType roots);
+
+    FwSizeType getRoots() const { return m_roots; }
+    //! Data symbols in a full codeword
+    FwSizeType getDataSize() const { return BLOCK_SIZE - m_roots; }
+
+    //! Compute the check symbols of `size` data bytes followed by zeros up
+    //! to getDataSize(), writing getRoots() bytes to `parity`
+    void encode(const U8* data, FwSizeType size, U8* parity) const;
+
+    //! encode() one check symbol at a time, without vector instructions;
+    //! the reference the vector encoder is tested against
+    void encodeScalar(const U8* data, FwSizeType size, U8* parity) const;
+
+    //! Correct a full BLOCK_SIZE codeword in place.
+    //! \return symbols corrected, or -1 if the errors could not be located
+    I32 decode(U8* codeword) const;
+
+  private:
+    //! Row stride: MAX_ROOTS plus a vector of zeros, so a vector step never
+    //! reads past the row
+    static constexpr FwSizeType ROW_STRIDE = MAX_ROOTS + 16;
+
+    FwSizeType m_roots;
+    //! m_rows[f][j]: f times the generator coefficient that feeds check symbol j
+    alignas(16) U8 m_rows[256][ROW_STRIDE];
+};
+
+}  // namespace AX25
+
+#endif
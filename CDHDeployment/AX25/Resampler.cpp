@@ -0,0 +1,101 @@
+// ======================================================================
+// \title  Resampler.cpp
+// \author madisonw
+// \brief  Polyphase rational resampler for the transmit chain
+// ======================================================================
+
+#include "CDHDeployment/AX25/Resampler.hpp"
+#include "CDHDeployment/AX25/Dsp.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace AX25 {
+
+namespace {
+
+U32 greatestCommonDivisor(U32 a, U32 b) {
+    while (b != 0) {
+        const U32 remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+    return a;
+}
+
+}  // namespace
+
+Resampler::Resampler() : m_interpolation(1), m_decimation(1), m_next(0) {
+    static_assert(TAPS_PER_PHASE % Dsp::TAP_MULTIPLE == 0, "Branch length must suit Dsp::dot");
+}
+
+void Resampler::configure(U32 inputRate, U32 outputRate) {
+    FW_ASSERT((inputRate > 0) && (outputRate > 0),
+              static_cast<FwAssertArgType>(inputRate),
+              static_cast<FwAssertArgType>(outputRate));
+    const U32 divisor = greatestCommonDivisor(inputRate, outputRate);
+    m_interpolation = outputRate / divisor;
+    m_decimation = inputRate / divisor;
+    FW_ASSERT(m_interpolation <= MAX_PHASES, static_cast<FwAssertArgType>(m_interpolation));
+
+    // Windowed-sinc low-pass at the interpolated rate, cut off below the
+    // lower Nyquist rate; Blackman window
+    const U32 phases = m_interpolation;
+    const U32 length = phases * TAPS_PER_PHASE;
+    const F64 centre = static_cast<F64>(length - 1) / 2.0;
+    const F64 cutoff = CUTOFF / (2.0 * static_cast<F64>(std::max(m_interpolation, m_decimation)));
+    std::vector<F64> prototype(length);
+    for (U32 i = 0; i < length; i++) {
+        const F64 x = static_cast<F64>(i) - centre;
+        const F64 sinc = (x == 0.0) ? 2.0 * cutoff : std::sin(2.0 * M_PI * cutoff * x) / (M_PI * x);
+        const F64 w = 2.0 * M_PI * static_cast<F64>(i) / static_cast<F64>(length - 1);
+        prototype[i] = sinc * (0.42 - 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w));
+    }
+
+    m_taps.assign(length, 0.0f);
+    for (U32 p = 0; p < phases; p++) {
+        F64 sum = 0.0;
+        for (U32 k = 0; k < TAPS_PER_PHASE; k++) {
+            sum += prototype[p + k * phases];
+        }
+        for (U32 k = 0; k < TAPS_PER_PHASE; k++) {
+            m_taps[p * TAPS_PER_PHASE + (TAPS_PER_PHASE - 1 - k)] = static_cast<F32>(prototype[p + k * phases] / sum);
+        }
+    }
+
+    m_window.assign(TAPS_PER_PHASE - 1 + BLOCK, 0.0f);
+    this->reset();
+}
+
+void Resampler::reset() {
+    std::fill(m_window.begin(), m_window.end(), 0.0f);
+    m_next = 0;
+}
+
+FwSizeType Resampler::maxOutput(FwSizeType count) const {
+    return (count * m_interpolation + m_decimation - 1) / m_decimation;
+}
+
+FwSizeType Resampler::process(FwSizeType count, F32* out) {
+    FW_ASSERT(out != nullptr);
+    FW_ASSERT(count <= BLOCK, static_cast<FwAssertArgType>(count));
+    FW_ASSERT(!m_taps.empty());
+
+    // Output n uses branch (n M) mod L ending at input (n M) / L
+    const FwSizeType end = count * m_interpolation;
+    FwSizeType produced = 0;
+    while (m_next < end) {
+        const FwSizeType index = m_next / m_interpolation;
+        const FwSizeType phase = m_next % m_interpolation;
+        out[produced++] = Dsp::dot(&m_window[index], &m_taps[phase * TAPS_PER_PHASE], TAPS_PER_PHASE);
+        m_next += m_decimation;
+    }
+    m_next -= end;
+
+    // Keep the newest samples as history for the next block
+    memmove(m_window.data(), &m_window[count], (TAPS_PER_PHASE - 1) * sizeof(F32));
+    return produced;
+}
+
+}  // namespace AX25
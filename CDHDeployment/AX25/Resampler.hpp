@@ -0,0 +1,70 @@
+// ======================================================================
+// \title  Resampler.hpp
+// \author madisonw
+// \brief  Polyphase rational resampler for the transmit chain
+// ======================================================================
+
+#ifndef AX25_Resampler_HPP
+#define AX25_Resampler_HPP
+
+#include "Fw/Types/BasicTypes.hpp"
+#include <vector>
+
+namespace AX25 {
+
+//! Changes the sample rate of a float stream by L/M (the two rates over
+//! their greatest common divisor).
+//!
+//! The anti-aliasing low-pass is split into L branches of TAPS_PER_PHASE
+//! taps, so each output costs one Dsp::dot against the input history no
+//! matter how large L is. Every branch is normalized to unity gain at DC:
+//! the stream is an FM frequency offset, and ripple there would wobble
+//! the carrier.
+//!
+//! Input is written in place into block(), a block at a time, so a
+//! preceding stage can convert straight into the filter history.
+class Resampler {
+  public:
+    //! Input samples per process() call at most
+    static constexpr U32 BLOCK = 512;
+    //! Taps per branch, a multiple of Dsp::TAP_MULTIPLE
+    static constexpr U32 TAPS_PER_PHASE = 32;
+    //! Largest L after reduction; the taps take L * TAPS_PER_PHASE floats
+    static constexpr U32 MAX_PHASES = 1024;
+
+    Resampler();
+
+    //! Design the filter for `inputRate` to `outputRate` and clear the history
+    void configure(U32 inputRate, U32 outputRate);
+
+    //! Clear the filter history
+    void reset();
+
+    //! Most output samples process() produces from `count` inputs
+    FwSizeType maxOutput(FwSizeType count) const;
+
+    //! Where the next block of up to BLOCK input samples is written
+    F32* block() { return &m_window[TAPS_PER_PHASE - 1]; }
+
+    //! Resample the `count` samples just written to block()
+    //! \return number of samples written to `out`
+    FwSizeType process(FwSizeType count, F32* out);
+
+  private:
+    //! Pass band edge as a share of the lower of the two Nyquist rates
+    static constexpr F64 CUTOFF = 0.9;
+
+    U32 m_interpolation;
+    U32 m_decimation;
+    //! Branch p holds taps p, p + L, p + 2L, ... reversed, to line up with
+    //! the oldest-first history
+    std::vector<F32> m_taps;
+    //! TAPS_PER_PHASE - 1 samples of history followed by the block
+    std::vector<F32> m_window;
+    //! Position of the next output in 1/L input samples, from the start of the block
+    FwSizeType m_next;
+};
+
+}  // namespace AX25
+
+#endif
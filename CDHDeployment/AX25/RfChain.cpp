@@ -0,0 +1,59 @@
+// ======================================================================
+// \title  RfChain.cpp
+// \author madisonw
+// \brief  In-process PCM to rpitx RF sample conversion
+// ======================================================================
+
+#include "CDHDeployment/AX25/RfChain.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <cmath>
+
+namespace AX25 {
+
+RfChain::RfChain() : m_scale(0.0f), m_periodNs(0), m_resampling(false) {
+    this->configure();
+}
+
+void RfChain::configure(const Config& config) {
+    FW_ASSERT((config.inputRate > 0) && (config.outputRate > 0),
+              static_cast<FwAssertArgType>(config.inputRate),
+              static_cast<FwAssertArgType>(config.outputRate));
+    m_config = config;
+    // csdr scales PCM to [-1, 1) before the gain; both fold into one factor
+    m_scale = config.deviationHz / 32768.0f;
+    m_periodNs = static_cast<U32>(std::lround(1e9 / static_cast<F64>(config.outputRate)));
+    m_resampling = (config.inputRate != config.outputRate);
+    if (m_resampling) {
+        m_resampler.configure(config.inputRate, config.outputRate);
+        m_frequency.assign(m_resampler.maxOutput(BLOCK), 0.0f);
+    } else {
+        m_frequency.assign(BLOCK, 0.0f);
+    }
+}
+
+void RfChain::reset() {
+    m_resampler.reset();
+}
+
+FwSizeType RfChain::maxOutput() const {
+    return m_frequency.size();
+}
+
+FwSizeType RfChain::process(const I16* pcm, FwSizeType count, Dsp::RfSample* out) {
+    FW_ASSERT(pcm != nullptr);
+    FW_ASSERT(out != nullptr);
+    FW_ASSERT(count <= BLOCK, static_cast<FwAssertArgType>(count));
+
+    if (!m_resampling) {
+        Dsp::toFloat(pcm, count, m_scale, m_frequency.data());
+        Dsp::toRfSamples(m_frequency.data(), count, m_periodNs, out);
+        return count;
+    }
+
+    Dsp::toFloat(pcm, count, m_scale, m_resampler.block());
+    const FwSizeType produced = m_resampler.process(count, m_frequency.data());
+    Dsp::toRfSamples(m_frequency.data(), produced, m_periodNs, out);
+    return produced;
+}
+
+}  // namespace AX25
@@ -0,0 +1,67 @@
+// ======================================================================
+// \title  RfChain.hpp
+// \author madisonw
+// \brief  In-process PCM to rpitx RF sample conversion
+// ======================================================================
+
+#ifndef AX25_RfChain_HPP
+#define AX25_RfChain_HPP
+
+#include "CDHDeployment/AX25/Dsp.hpp"
+#include "CDHDeployment/AX25/Resampler.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+#include <vector>
+
+namespace AX25 {
+
+//! Turns modulator PCM into the frequency samples rpitx transmits in its
+//! RF mode, in place of a `csdr convert_i16_f | csdr gain_ff | csdr
+//! convert_f_samplerf` pipeline.
+//!
+//! The stages run fused over one block at a time, small enough that the
+//! PCM, the frequencies and the RF samples all stay in L1: the PCM is
+//! converted and scaled to a frequency offset in one pass
+//! (Dsp::toFloat), resampled if the output rate differs, and widened into
+//! RF samples (Dsp::toRfSamples).
+class RfChain {
+  public:
+    //! PCM samples per process() call at most
+    static constexpr U32 BLOCK = Resampler::BLOCK;
+
+    struct Config {
+        U32 inputRate;
+        U32 outputRate;
+        //! Deviation at full-scale PCM, the csdr gain_ff of the old chain
+        F32 deviationHz;
+
+        Config() : inputRate(48000), outputRate(48000), deviationHz(7000.0f) {}
+    };
+
+    RfChain();
+
+    //! Set the rates and deviation and clear the resampler history
+    void configure(const Config& config = Config());
+
+    //! Clear the resampler history, e.g. when the transmitter restarts
+    void reset();
+
+    //! RF samples one process() call produces at most
+    FwSizeType maxOutput() const;
+
+    //! Convert up to BLOCK samples of PCM
+    //! \return number of RF samples written to `out`
+    FwSizeType process(const I16* pcm, FwSizeType count, Dsp::RfSample* out);
+
+  private:
+    Config m_config;
+    F32 m_scale;
+    U32 m_periodNs;
+    bool m_resampling;
+    Resampler m_resampler;
+    //! Frequencies of the block at the output rate
+    std::vector<F32> m_frequency;
+};
+
+}  // namespace AX25
+
+#endif
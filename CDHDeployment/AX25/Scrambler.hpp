@@ -0,0 +1,56 @@
+// ======================================================================
+// \title  Scrambler.hpp
+// \author madisonw
+// \brief  G3RUH self-synchronising scrambler shared by TX and RX
+// ======================================================================
+
+#ifndef AX25_Scrambler_HPP
+#define AX25_Scrambler_HPP
+
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace AX25 {
+
+//! The 9600 baud G3RUH scrambler, polynomial 1 + x^12 + x^17.
+//!
+//! Each line bit is the data bit XORed with the line bits 12 and 17 places
+//! back, held in a 17-bit shift register. The descrambler runs the same
+//! register over the received line bits, so it falls into step by itself
+//! 17 bits after it starts, and one wrong line bit costs three data bits.
+//! An instance works in one direction only.
+class Scrambler {
+  public:
+    Scrambler() : m_register(0) {}
+
+    void reset() { m_register = 0; }
+
+    //! The shift register, for saving and restoring a modulator's state
+    U32 getRegister() const { return m_register; }
+    void setRegister(U32 value) { m_register = value & MASK; }
+
+    //! Line bit for one data bit
+    bool scramble(bool bit) {
+        const bool out = bit != this->feedback();
+        this->shift(out);
+        return out;
+    }
+
+    //! Data bit for one line bit
+    bool descramble(bool bit) {
+        const bool out = bit != this->feedback();
+        this->shift(bit);
+        return out;
+    }
+
+  private:
+    static constexpr U32 MASK = (1U << 17) - 1;
+
+    bool feedback() const { return (((m_register >> 11) ^ (m_register >> 16)) & 0x01) != 0; }
+    void shift(bool lineBit) { m_register = ((m_register << 1) | (lineBit ? 1U : 0U)) & MASK; }
+
+    U32 m_register;
+};
+
+}  // namespace AX25
+
+#endif
@@ -0,0 +1,126 @@
+// ======================================================================
+// \title  Segmentation.cpp
+// \author madisonw
+// \brief  Splitting F´ com buffers across AX.25 UI frames and joining them again
+// ======================================================================
+
+#include "CDHDeployment/AX25/Segmentation.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <cstring>
+
+namespace AX25 {
+
+Reassembler::Reassembler(FwSizeType maxMessageSize)
+    : m_data(maxMessageSize), m_complete(0), m_abandoned(0), m_invalid(0) {
+    FW_ASSERT(maxMessageSize > 0);
+    this->reset();
+}
+
+void Reassembler::reset() {
+    m_active = false;
+    m_message = 0;
+    m_count = 0;
+    m_packed = false;
+    m_compressed = false;
+    m_received = 0;
+    m_stride = 0;
+    m_tailHeld = false;
+    m_tailSize = 0;
+    memset(m_seen, 0, sizeof(m_seen));
+    m_messageSize = 0;
+}
+
+void Reassembler::begin(const SegmentHeader& header) {
+    if (m_active && (m_received < m_count)) {
+        m_abandoned++;
+    }
+    this->reset();
+    m_active = true;
+    m_message = header.message;
+    m_count = header.count;
+    m_packed = header.packed;
+    m_compressed = header.compressed;
+}
+
+bool Reassembler::placeTail(const U8* payload, FwSizeType size) {
+    const FwSizeType offset = static_cast<FwSizeType>(m_count - 1U) * m_stride;
+    if ((size > m_stride) || (offset + size > m_data.size())) {
+        return false;
+    }
+    memcpy(&m_data[offset], payload, size);
+    m_messageSize = offset + size;
+    return true;
+}
+
+Reassembler::Status Reassembler::push(const U8* info, FwSizeType size) {
+    FW_ASSERT(info != nullptr);
+
+    SegmentHeader header;
+    if (!header.deserialize(info, size)) {
+        m_invalid++;
+        return Status::INVALID;
+    }
+    const U8* payload = &info[SegmentHeader::SIZE];
+    const FwSizeType payloadSize = size - SegmentHeader::SIZE;
+    const bool last = (header.index + 1U) == header.count;
+
+    // Every segment but the last carries the stride, so it cannot be empty
+    if ((payloadSize > MAX_SEGMENT_PAYLOAD) || (!last && (payloadSize == 0))) {
+        m_invalid++;
+        return Status::INVALID;
+    }
+
+    if (!m_active || (header.count == 1) || (header.message != m_message) || (header.count != m_count) ||
+        (header.packed != m_packed) || (header.compressed != m_compressed)) {
+        this->begin(header);
+    }
+
+    // Repeats, including of a message already completed, are ignored
+    const U64 bit = 1ULL << (header.index % 64);
+    U64& word = m_seen[header.index / 64];
+    if ((word & bit) != 0) {
+        return Status::INCOMPLETE;
+    }
+
+    if (!last) {
+        const FwSizeType stride = (m_stride == 0) ? payloadSize : m_stride;
+        const FwSizeType offset = static_cast<FwSizeType>(header.index) * stride;
+        if ((payloadSize != stride) || (offset + payloadSize > m_data.size())) {
+            m_invalid++;
+            return Status::INVALID;
+        }
+        memcpy(&m_data[offset], payload, payloadSize);
+        m_stride = stride;
+        if (m_tailHeld) {
+            m_tailHeld = false;
+            if (!this->placeTail(m_tail, m_tailSize)) {
+                // The held segment does not belong with this one after all
+                m_invalid++;
+                this->reset();
+                return Status::INVALID;
+            }
+        }
+    } else if ((m_count == 1) || (m_stride != 0)) {
+        if (m_count == 1) {
+            m_stride = MAX_SEGMENT_PAYLOAD;
+        }
+        if (!this->placeTail(payload, payloadSize)) {
+            m_invalid++;
+            return Status::INVALID;
+        }
+    } else {
+        memcpy(m_tail, payload, payloadSize);
+        m_tailSize = payloadSize;
+        m_tailHeld = true;
+    }
+    word |= bit;
+    m_received++;
+
+    if (m_received < m_count) {
+        return Status::INCOMPLETE;
+    }
+    m_complete++;
+    return Status::COMPLETE;
+}
+
+}  // namespace AX25
@@ -0,0 +1,167 @@
+// ======================================================================
+// \title  Segmentation.hpp
+// \author madisonw
+// \brief  Splitting F´ com buffers across AX.25 UI frames and joining them again
+// ======================================================================
+
+#ifndef AX25_Segmentation_HPP
+#define AX25_Segmentation_HPP
+
+#include "Fw/Types/BasicTypes.hpp"
+#include <atomic>
+#include <vector>
+
+namespace AX25 {
+
+//! Largest AX.25 info field
+static constexpr FwSizeType MAX_INFO_SIZE = 256;
+
+//! Header at the start of every downlink/uplink info field.
+//!
+//! Wire format (4 bytes): packed and compressed flags and a 14-bit message
+//! number (big endian), segment index, segment count. Every segment but the
+//! last carries the same payload, the stride: MAX_SEGMENT_PAYLOAD for plain
+//! AX.25, less when the frames have to fit an FX.25 code block (Fx25.hpp).
+//! A packed message holds several com packets, see Packing.hpp; a
+//! compressed one is expanded with Compressor before unpacking.
+//!
+//! Only messages of several segments are numbered. One that fits a single
+//! segment needs no number to be put together, so it always carries
+//! SINGLE_MESSAGE, and a beacon sent again is the same frame byte for byte.
+struct SegmentHeader {
+    static constexpr FwSizeType SIZE = 4;
+    static constexpr U16 PACKED_FLAG = 0x8000;
+    static constexpr U16 COMPRESSED_FLAG = 0x4000;
+    static constexpr U16 MESSAGE_MASK = 0x3FFF;
+    //! Number of every single-segment message, never given to a longer one
+    static constexpr U16 SINGLE_MESSAGE = 0;
+
+    //! Number for a message of `count` segments, taking the next one from
+    //! `counter` if it needs one
+    static U16 number(std::atomic<U16>& counter, FwSizeType count) {
+        if (count == 1) {
+            return SINGLE_MESSAGE;
+        }
+        U16 value = SINGLE_MESSAGE;
+        while (value == SINGLE_MESSAGE) {
+            value = static_cast<U16>(counter.fetch_add(1) & MESSAGE_MASK);
+        }
+        return value;
+    }
+
+    U16 message;
+    bool packed;
+    bool compressed;
+    U8 index;
+    U8 count;
+
+    //! Write the header to `out` (SIZE bytes); the message number wraps at 14 bits
+    void serialize(U8* out) const {
+        const U16 word = static_cast<U16>((message & MESSAGE_MASK) | (packed ? PACKED_FLAG : 0) |
+                                          (compressed ? COMPRESSED_FLAG : 0));
+        out[0] = static_cast<U8>(word >> 8);
+        out[1] = static_cast<U8>(word);
+        out[2] = index;
+        out[3] = count;
+    }
+
+    //! Read a header from an info field; false if it is too short or inconsistent
+    bool deserialize(const U8* in, FwSizeType size) {
+        if (size < SIZE) {
+            return false;
+        }
+        const U16 word = static_cast<U16>((in[0] << 8) | in[1]);
+        message = static_cast<U16>(word & MESSAGE_MASK);
+        packed = (word & PACKED_FLAG) != 0;
+        compressed = (word & COMPRESSED_FLAG) != 0;
+        index = in[2];
+        count = in[3];
+        return (count > 0) && (index < count);
+    }
+};
+
+//! Payload carried by one segment
+static constexpr FwSizeType MAX_SEGMENT_PAYLOAD = MAX_INFO_SIZE - SegmentHeader::SIZE;
+//! Segments per message, bounded by the one-byte count
+static constexpr FwSizeType MAX_SEGMENTS = 255;
+//! Largest message that can be segmented
+static constexpr FwSizeType MAX_MESSAGE_SIZE = MAX_SEGMENTS * MAX_SEGMENT_PAYLOAD;
+
+//! Number of segments needed for a message of `size` bytes (at least one)
+//! with `stride` payload bytes per segment
+inline FwSizeType segmentCount(FwSizeType size, FwSizeType stride = MAX_SEGMENT_PAYLOAD) {
+    return (size == 0) ? 1 : (size + stride - 1) / stride;
+}
+
+//! Rebuilds messages from the info fields of received UI frames.
+//!
+//! Segments of one message are sent back to back, so only one message is
+//! assembled at a time. Segments may arrive in any order and duplicates are
+//! ignored; a segment of a different message abandons the one in progress.
+//! A single-segment message is complete on its own and always delivered, as
+//! its repeat cannot be told from the next message with the same bytes.
+//! The stride is learned from the first segment that is not the last one; a
+//! last segment arriving before that is held until its offset is known.
+class Reassembler {
+  public:
+    enum class Status {
+        INCOMPLETE,  //!< Segment stored, message not complete yet
+        COMPLETE,    //!< Message complete, see getMessage()
+        INVALID      //!< Segment header malformed or inconsistent, dropped
+    };
+
+    //! Buffers messages up to `maxMessageSize` bytes
+    explicit Reassembler(FwSizeType maxMessageSize = MAX_MESSAGE_SIZE);
+
+    //! Forget any partial message
+    void reset();
+
+    //! Add one info field
+    Status push(const U8* info, FwSizeType size);
+
+    //! Message completed by the last push; valid until the next push
+    const U8* getMessage() const { return m_data.data(); }
+    FwSizeType getMessageSize() const { return m_messageSize; }
+    //! Whether the completed message is a pack of com packets
+    bool isPacked() const { return m_packed; }
+    //! Whether the completed message has to be expanded first
+    bool isCompressed() const { return m_compressed; }
+
+    U32 getCompleteCount() const { return m_complete; }
+    //! Partial messages abandoned because a new message started
+    U32 getAbandonedCount() const { return m_abandoned; }
+    U32 getInvalidCount() const { return m_invalid; }
+
+  private:
+    //! Start assembling `header.message`, abandoning the partial one
+    void begin(const SegmentHeader& header);
+
+    //! Copy the last segment to its place once the stride is known; false if it does not fit
+    bool placeTail(const U8* payload, FwSizeType size);
+
+    std::vector<U8> m_data;
+    //! A message has been started; it stays current after completing so repeats are recognised
+    bool m_active;
+    U16 m_message;
+    U8 m_count;
+    bool m_packed;
+    bool m_compressed;
+    U32 m_received;
+    //! Payload of every segment but the last, 0 until one has arrived
+    FwSizeType m_stride;
+    //! Last segment received before the stride was known
+    bool m_tailHeld;
+    FwSizeType m_tailSize;
+    U8 m_tail[MAX_SEGMENT_PAYLOAD];
+    //! One bit per segment already stored
+    U64 m_seen[(MAX_SEGMENTS + 63) / 64];
+    FwSizeType m_messageSize;
+
+    U32 m_complete;
+    U32 m_abandoned;
+    U32 m_invalid;
+};
+
+}  // namespace AX25
+
+#endif
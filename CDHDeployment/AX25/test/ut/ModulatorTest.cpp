@@ -0,0 +1,213 @@
+// ======================================================================
+// \title  ModulatorTest.cpp
+// \author madisonw
+// \brief  Modulator loopback tests: render frames, demodulate them again
+// ======================================================================
+
+#include "CDHDeployment/AX25/AfskDemodulator.hpp"
+#include "CDHDeployment/AX25/AfskModulator.hpp"
+#include "CDHDeployment/AX25/Crc16.hpp"
+#include "CDHDeployment/AX25/G3ruhDemodulator.hpp"
+#include "CDHDeployment/AX25/G3ruhModulator.hpp"
+#include "CDHDeployment/AX25/HdlcDeframer.hpp"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+//! Enough key-up flags for either receiver to lock on
+const U32 TX_DELAY_FLAGS = 32;
+const U32 TX_TAIL_FLAGS = 4;
+const U8 FLAG = AX25::Modulator::HDLC_FLAG;
+
+//! Frames as the deframer hands them over, without FCS
+struct Received {
+    std::vector<std::vector<U8>> frames;
+};
+
+void frameReceived(void* context, const U8* frame, FwSizeType size) {
+    static_cast<Received*>(context)->frames.emplace_back(frame, frame + size);
+}
+
+void putAddress(std::vector<U8>& frame, const char* callsign, U8 ssid, bool last) {
+    const FwSizeType length = strlen(callsign);
+    for (FwSizeType i = 0; i < 6; i++) {
+        frame.push_back(static_cast<U8>(((i < length) ? callsign[i] : ' ') << 1));
+    }
+    frame.push_back(static_cast<U8>(0x60 | ((ssid & 0x0F) << 1) | (last ? 0x01 : 0x00)));
+}
+
+//! A UI frame as AMSATFramer emits it: flag, addresses, control, PID,
+//! info, FCS (low byte first), flag
+std::vector<U8> uiFrame(const std::vector<U8>& info) {
+    std::vector<U8> frame(1, FLAG);
+    putAddress(frame, "CQ", 0, false);
+    putAddress(frame, "N0CALL", 1, true);
+    frame.push_back(0x03);
+    frame.push_back(0xF0);
+    frame.insert(frame.end(), info.begin(), info.end());
+    const U16 fcs = AX25::Crc16::compute(&frame[1], frame.size() - 1);
+    frame.push_back(static_cast<U8>(fcs));
+    frame.push_back(static_cast<U8>(fcs >> 8));
+    frame.push_back(FLAG);
+    return frame;
+}
+
+//! The frame between its flags, without FCS: what the deframer delivers
+std::vector<U8> contents(const std::vector<U8>& frame) {
+    return std::vector<U8>(frame.begin() + 1, frame.end() - 3);
+}
+
+std::vector<U8> text(const char* message) {
+    return std::vector<U8>(message, message + strlen(message));
+}
+
+//! Append one burst as RadioBridge renders it: from a reset modulator,
+//! lead flags, then each frame's body followed by the flag it shares with
+//! the next, then trail flags
+void renderBurst(AX25::Modulator& modulator, const std::vector<std::vector<U8>>& frames, std::vector<I16>& pcm) {
+    FwSizeType size = 0;
+    for (const std::vector<U8>& frame : frames) {
+        size += frame.size();
+    }
+    std::vector<I16> out(modulator.maxSamples(size, modulator.getLeadFlags() + modulator.getTrailFlags() + 1));
+    modulator.reset();
+    FwSizeType used = modulator.renderFlags(modulator.getLeadFlags(), out.data(), out.size());
+    for (const std::vector<U8>& frame : frames) {
+        used += modulator.renderBody(&frame[1], frame.size() - 2, &out[used], out.size() - used);
+        used += modulator.renderFlags(1, &out[used], out.size() - used);
+    }
+    used += modulator.renderFlags(modulator.getTrailFlags(), &out[used], out.size() - used);
+    pcm.insert(pcm.end(), out.begin(), out.begin() + used);
+}
+
+//! Key-up padding, rendered once from reset as RadioBridge hands it to TxSink
+std::vector<I16> keyUp(AX25::Modulator& modulator) {
+    std::vector<I16> pcm(modulator.maxSamples(0, TX_DELAY_FLAGS));
+    modulator.reset();
+    EXPECT_GT(modulator.renderFlags(TX_DELAY_FLAGS, pcm.data(), pcm.size()), 0U);
+    return pcm;
+}
+
+//! Audio as TxSink plays it: key-up padding, the bursts back to back, and
+//! key-down padding, each rendered on its own so the waveform breaks
+//! between them
+std::vector<I16> transmit(AX25::Modulator& modulator, const std::vector<std::vector<std::vector<U8>>>& bursts) {
+    std::vector<I16> pcm = keyUp(modulator);
+    for (const std::vector<std::vector<U8>>& burst : bursts) {
+        renderBurst(modulator, burst, pcm);
+    }
+    std::vector<I16> tail(modulator.maxSamples(0, TX_TAIL_FLAGS));
+    modulator.reset();
+    EXPECT_GT(modulator.renderFlags(TX_TAIL_FLAGS, tail.data(), tail.size()), 0U);
+    pcm.insert(pcm.end(), tail.begin(), tail.end());
+    return pcm;
+}
+
+template <typename Demodulator>
+void expectFrames(const std::vector<I16>& pcm, const std::vector<std::vector<U8>>& frames) {
+    Received received;
+    AX25::HdlcDeframer deframer(frameReceived, &received);
+    Demodulator demodulator;
+    demodulator.process(pcm.data(), pcm.size(), deframer);
+
+    ASSERT_EQ(received.frames.size(), frames.size());
+    for (FwSizeType i = 0; i < frames.size(); i++) {
+        EXPECT_EQ(received.frames[i], contents(frames[i])) << "frame " << i;
+    }
+    EXPECT_EQ(deframer.getFcsErrorCount(), 0U);
+}
+
+//! Send `frames` as bursts of up to `perBurst` frames and decode them all
+template <typename Demodulator>
+void loopback(AX25::Modulator& modulator, const std::vector<std::vector<U8>>& frames, FwSizeType perBurst) {
+    std::vector<std::vector<std::vector<U8>>> bursts;
+    for (FwSizeType i = 0; i < frames.size(); i += perBurst) {
+        bursts.emplace_back(frames.begin() + i, frames.begin() + FW_MIN(i + perBurst, frames.size()));
+    }
+    expectFrames<Demodulator>(transmit(modulator, bursts), frames);
+}
+
+//! Frames that exercise the bit stuffing: runs of ones, all zeros, and
+//! the flag pattern inside the info field
+std::vector<std::vector<U8>> testFrames() {
+    std::vector<std::vector<U8>> frames;
+    frames.push_back(uiFrame(text("AMSAT downlink loopback")));
+    frames.push_back(uiFrame(std::vector<U8>(64, 0xFF)));
+    frames.push_back(uiFrame(std::vector<U8>(64, 0x00)));
+    frames.push_back(uiFrame(std::vector<U8>(32, FLAG)));
+    std::vector<U8> ramp(256);
+    for (FwSizeType i = 0; i < ramp.size(); i++) {
+        ramp[i] = static_cast<U8>(i);
+    }
+    frames.push_back(uiFrame(ramp));
+    return frames;
+}
+
+}  // namespace
+
+TEST(AfskModulator, SingleFrameLoopback) {
+    AX25::AfskModulator modulator;
+    loopback<AX25::AfskDemodulator>(modulator, {uiFrame(text("Hello from orbit"))}, 1);
+}
+
+TEST(AfskModulator, StuffedFramesLoopback) {
+    AX25::AfskModulator modulator;
+    loopback<AX25::AfskDemodulator>(modulator, testFrames(), testFrames().size());
+}
+
+TEST(AfskModulator, BurstsAfterResetLoopback) {
+    // Every burst restarts the modulator while the sink stays keyed
+    AX25::AfskModulator modulator;
+    loopback<AX25::AfskDemodulator>(modulator, testFrames(), 1);
+    loopback<AX25::AfskDemodulator>(modulator, testFrames(), 2);
+}
+
+TEST(AfskModulator, RestoredStateContinuesTheWaveform) {
+    // A frame rendered from a saved state must decode as part of the same
+    // transmission, the way WaveformCache splices cached audio in
+    AX25::AfskModulator modulator;
+    const std::vector<U8> first = uiFrame(text("first"));
+    const std::vector<U8> second = uiFrame(text("second"));
+    std::vector<I16> pcm = keyUp(modulator);
+    renderBurst(modulator, {first}, pcm);
+    const AX25::Modulator::State state = modulator.saveState();
+
+    AX25::AfskModulator other;
+    other.restoreState(state);
+    std::vector<I16> out(other.maxSamples(second.size(), TX_TAIL_FLAGS + 2));
+    const FwSizeType written =
+        other.renderFrame(second.data(), second.size(), 0, TX_TAIL_FLAGS, out.data(), out.size());
+    ASSERT_GT(written, 0U);
+    pcm.insert(pcm.end(), out.begin(), out.begin() + written);
+    expectFrames<AX25::AfskDemodulator>(pcm, {first, second});
+}
+
+TEST(AfskModulator, RejectsMalformedFrames) {
+    AX25::AfskModulator modulator;
+    std::vector<U8> frame = uiFrame(text("no closing flag"));
+    frame.back() = 0x00;
+    std::vector<I16> out(modulator.maxSamples(frame.size(), 2));
+    EXPECT_EQ(modulator.renderFrame(frame.data(), frame.size(), 0, 0, out.data(), out.size()), 0U);
+
+    frame.back() = FLAG;
+    EXPECT_EQ(modulator.renderFrame(frame.data(), frame.size(), 0, 0, out.data(), 16), 0U);
+}
+
+TEST(G3ruhModulator, SingleFrameLoopback) {
+    AX25::G3ruhModulator modulator;
+    loopback<AX25::G3ruhDemodulator>(modulator, {uiFrame(text("Hello from orbit at 9600"))}, 1);
+}
+
+TEST(G3ruhModulator, StuffedFramesLoopback) {
+    AX25::G3ruhModulator modulator;
+    loopback<AX25::G3ruhDemodulator>(modulator, testFrames(), testFrames().size());
+}
+
+TEST(G3ruhModulator, BurstsAfterResetLoopback) {
+    // The descrambler and shaping filter recover within each burst's lead
+    AX25::G3ruhModulator modulator;
+    loopback<AX25::G3ruhDemodulator>(modulator, testFrames(), 1);
+    loopback<AX25::G3ruhDemodulator>(modulator, testFrames(), 2);
+}
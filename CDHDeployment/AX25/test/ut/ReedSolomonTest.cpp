@@ -0,0 +1,229 @@
+// ======================================================================
+// \title  ReedSolomonTest.cpp
+// \author madisonw
+// \brief  Reed-Solomon and FX.25 block tests: encoding, correction, failure
+// ======================================================================
+
+#include "CDHDeployment/AX25/Fx25.hpp"
+#include "CDHDeployment/AX25/ReedSolomon.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+
+typedef std::vector<U8> Bytes;
+
+const FwSizeType ROOT_COUNTS[] = {16, 32, 64};
+//! Random blocks per error count
+const U32 TRIALS = 20;
+
+std::mt19937 s_random(1);
+
+//! Product in GF(2^8) mod 0x11D, bit by bit, independent of the codec's tables
+U8 gfMultiply(U8 a, U8 b) {
+    U32 product = 0;
+    U32 x = a;
+    for (U32 bit = 0; bit < 8; bit++) {
+        if (((b >> bit) & 0x01) != 0) {
+            product ^= x;
+        }
+        x = (x & 0x80) ? ((x << 1) ^ 0x11D) : (x << 1);
+    }
+    return static_cast<U8>(product);
+}
+
+//! Whether `codeword` evaluates to zero at alpha^1 .. alpha^roots
+bool isCodeword(const Bytes& codeword, FwSizeType roots) {
+    U8 root = 1;
+    for (FwSizeType i = 1; i <= roots; i++) {
+        root = gfMultiply(root, 2);
+        U8 sum = 0;
+        for (const U8 symbol : codeword) {
+            sum = static_cast<U8>(gfMultiply(sum, root) ^ symbol);
+        }
+        if (sum != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Bytes randomBytes(FwSizeType size) {
+    Bytes bytes(size);
+    for (U8& byte : bytes) {
+        byte = static_cast<U8>(s_random());
+    }
+    return bytes;
+}
+
+//! A full codeword with random data
+Bytes randomCodeword(const AX25::ReedSolomon& rs) {
+    Bytes codeword = randomBytes(AX25::ReedSolomon::BLOCK_SIZE);
+    rs.encode(codeword.data(), rs.getDataSize(), &codeword[rs.getDataSize()]);
+    return codeword;
+}
+
+//! XOR nonzero values into `count` distinct positions below `limit`
+void corrupt(U8* block, FwSizeType limit, FwSizeType count) {
+    std::vector<FwSizeType> positions(limit);
+    for (FwSizeType i = 0; i < limit; i++) {
+        positions[i] = i;
+    }
+    std::shuffle(positions.begin(), positions.end(), s_random);
+    for (FwSizeType i = 0; i < count; i++) {
+        block[positions[i]] ^= static_cast<U8>(1 + s_random() % 255);
+    }
+}
+
+//! One body size per FX.25 code with `roots` check bytes, found by
+//! growing the body until Fx25::encode picks the next code
+std::vector<FwSizeType> bodyPerCode(FwSizeType roots) {
+    std::vector<FwSizeType> sizes;
+    std::set<const AX25::Fx25::Code*> seen;
+    U8 block[AX25::Fx25::MAX_BLOCK_SIZE];
+    const Bytes body(AX25::Fx25::maxBody(roots), 0x55);
+    for (FwSizeType size = 1; size <= body.size(); size++) {
+        const AX25::Fx25::Piece piece = {body.data(), size};
+        EXPECT_GT(AX25::Fx25::encode(roots, &piece, 1, block), 0U);
+        U64 tag = 0;
+        for (FwSizeType i = 0; i < AX25::Fx25::TAG_SIZE; i++) {
+            tag |= static_cast<U64>(block[i]) << (8 * i);
+        }
+        if (seen.insert(AX25::Fx25::matchTag(tag)).second) {
+            sizes.push_back(size);
+        }
+    }
+    return sizes;
+}
+
+//! Feed a block to `decoder` LSB first, as the deframer does
+bool pushBlock(AX25::Fx25Decoder& decoder, const U8* block, FwSizeType size) {
+    bool done = false;
+    for (FwSizeType i = 0; i < size; i++) {
+        for (U32 bit = 0; bit < 8; bit++) {
+            done = decoder.pushBit(((block[i] >> bit) & 0x01) != 0);
+        }
+    }
+    return done;
+}
+
+}  // namespace
+
+TEST(ReedSolomon, ParityMakesACodeword) {
+    for (const FwSizeType roots : ROOT_COUNTS) {
+        AX25::ReedSolomon rs(roots);
+        for (const FwSizeType size : {FwSizeType(0), FwSizeType(1), rs.getDataSize() / 2, rs.getDataSize()}) {
+            // Shortened: the data symbols not given are zeros
+            Bytes codeword(AX25::ReedSolomon::BLOCK_SIZE, 0);
+            const Bytes data = randomBytes(size);
+            std::copy(data.begin(), data.end(), codeword.begin());
+            rs.encode(codeword.data(), size, &codeword[rs.getDataSize()]);
+            EXPECT_TRUE(isCodeword(codeword, roots)) << "roots " << roots << " size " << size;
+        }
+    }
+}
+
+TEST(ReedSolomon, VectorMatchesScalar) {
+    for (const FwSizeType roots : ROOT_COUNTS) {
+        AX25::ReedSolomon rs(roots);
+        for (U32 trial = 0; trial < 100; trial++) {
+            const FwSizeType size = s_random() % (rs.getDataSize() + 1);
+            const Bytes data = randomBytes(size);
+            U8 vector[AX25::ReedSolomon::MAX_ROOTS];
+            U8 scalar[AX25::ReedSolomon::MAX_ROOTS];
+            rs.encode(data.data(), size, vector);
+            rs.encodeScalar(data.data(), size, scalar);
+            ASSERT_EQ(memcmp(vector, scalar, roots), 0) << "roots " << roots << " size " << size;
+        }
+    }
+}
+
+TEST(ReedSolomon, CleanCodeword) {
+    AX25::ReedSolomon rs(32);
+    Bytes codeword = randomCodeword(rs);
+    const Bytes original = codeword;
+    EXPECT_EQ(rs.decode(codeword.data()), 0);
+    EXPECT_EQ(codeword, original);
+}
+
+TEST(ReedSolomon, CorrectsUpToHalfTheRoots) {
+    for (const FwSizeType roots : ROOT_COUNTS) {
+        AX25::ReedSolomon rs(roots);
+        for (FwSizeType errors = 1; errors <= roots / 2; errors++) {
+            for (U32 trial = 0; trial < TRIALS; trial++) {
+                const Bytes original = randomCodeword(rs);
+                Bytes codeword = original;
+                corrupt(codeword.data(), codeword.size(), errors);
+                ASSERT_EQ(rs.decode(codeword.data()), static_cast<I32>(errors)) << "roots " << roots;
+                ASSERT_EQ(codeword, original) << "roots " << roots << " errors " << errors;
+            }
+        }
+    }
+}
+
+TEST(ReedSolomon, FlagsOneErrorTooMany) {
+    for (const FwSizeType roots : ROOT_COUNTS) {
+        AX25::ReedSolomon rs(roots);
+        for (U32 trial = 0; trial < TRIALS; trial++) {
+            Bytes codeword = randomCodeword(rs);
+            corrupt(codeword.data(), codeword.size(), roots / 2 + 1);
+            EXPECT_EQ(rs.decode(codeword.data()), -1) << "roots " << roots;
+        }
+    }
+}
+
+TEST(Fx25, EveryCodeCorrectsItsErrors) {
+    FwSizeType codes = 0;
+    for (const FwSizeType roots : ROOT_COUNTS) {
+        for (const FwSizeType bodySize : bodyPerCode(roots)) {
+            codes++;
+            const Bytes body = randomBytes(bodySize);
+            const AX25::Fx25::Piece piece = {body.data(), body.size()};
+            U8 clean[AX25::Fx25::MAX_BLOCK_SIZE];
+            const FwSizeType size = AX25::Fx25::encode(roots, &piece, 1, clean);
+            ASSERT_GT(size, 0U);
+            const FwSizeType dataSize = size - AX25::Fx25::TAG_SIZE - roots;
+
+            for (FwSizeType errors = 0; errors <= roots / 2 + 1; errors++) {
+                U8 block[AX25::Fx25::MAX_BLOCK_SIZE];
+                memcpy(block, clean, size);
+                corrupt(&block[AX25::Fx25::TAG_SIZE], size - AX25::Fx25::TAG_SIZE, errors);
+
+                AX25::Fx25Decoder decoder;
+                ASSERT_TRUE(pushBlock(decoder, block, size)) << "roots " << roots << " body " << bodySize;
+                const I32 corrected = decoder.decode();
+                if (errors <= roots / 2) {
+                    ASSERT_EQ(corrected, static_cast<I32>(errors)) << "roots " << roots << " body " << bodySize;
+                    ASSERT_EQ(decoder.getDataSize(), dataSize);
+                    EXPECT_EQ(memcmp(decoder.getData(), &clean[AX25::Fx25::TAG_SIZE], dataSize), 0);
+                } else {
+                    EXPECT_EQ(corrected, -1) << "roots " << roots << " body " << bodySize;
+                    EXPECT_EQ(decoder.getDataSize(), 0U);
+                }
+            }
+        }
+    }
+    // Every tag of the FX.25 table
+    EXPECT_EQ(codes, 11U);
+}
+
+TEST(Fx25, TagToleratesBitErrors) {
+    const Bytes body = randomBytes(40);
+    const AX25::Fx25::Piece piece = {body.data(), body.size()};
+    U8 block[AX25::Fx25::MAX_BLOCK_SIZE];
+    const FwSizeType size = AX25::Fx25::encode(16, &piece, 1, block);
+    ASSERT_GT(size, 0U);
+
+    // Flip bits spread over the tag, one per byte
+    for (U32 bit = 0; bit < AX25::Fx25Decoder::MAX_TAG_ERRORS; bit++) {
+        block[bit] ^= static_cast<U8>(1U << bit);
+    }
+    AX25::Fx25Decoder decoder;
+    ASSERT_TRUE(pushBlock(decoder, block, size));
+    EXPECT_EQ(decoder.decode(), 0);
+    EXPECT_EQ(decoder.getTagCount(), 1U);
+}
@@ -0,0 +1,281 @@
+// ======================================================================
+// \title  SegmentationTest.cpp
+// \author madisonw
+// \brief  Reassembler tests: ordering, repeats, abandoned and malformed segments
+// ======================================================================
+
+#include "CDHDeployment/AX25/Segmentation.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+
+namespace {
+
+typedef std::vector<U8> Bytes;
+
+//! Stride of a frame that has to fit an FX.25 code block
+const FwSizeType FX25_STRIDE = 100;
+
+Bytes message(FwSizeType size, U8 seed) {
+    Bytes data(size);
+    for (FwSizeType i = 0; i < size; i++) {
+        data[i] = static_cast<U8>(seed + i * 7);
+    }
+    return data;
+}
+
+//! Info fields of `data` split with `stride` payload bytes per segment
+std::vector<Bytes> segment(const Bytes& data, U16 number, FwSizeType stride = AX25::MAX_SEGMENT_PAYLOAD,
+                           bool packed = false) {
+    const FwSizeType count = AX25::segmentCount(data.size(), stride);
+    std::vector<Bytes> infos;
+    for (FwSizeType i = 0; i < count; i++) {
+        AX25::SegmentHeader header;
+        header.message = number;
+        header.packed = packed;
+        header.compressed = false;
+        header.index = static_cast<U8>(i);
+        header.count = static_cast<U8>(count);
+        const FwSizeType offset = i * stride;
+        const FwSizeType size = FW_MIN(stride, data.size() - offset);
+        Bytes info(AX25::SegmentHeader::SIZE + size);
+        header.serialize(info.data());
+        std::copy(data.begin() + offset, data.begin() + offset + size, info.begin() + AX25::SegmentHeader::SIZE);
+        infos.push_back(info);
+    }
+    return infos;
+}
+
+AX25::Reassembler::Status push(AX25::Reassembler& reassembler, const Bytes& info) {
+    return reassembler.push(info.data(), info.size());
+}
+
+Bytes completed(const AX25::Reassembler& reassembler) {
+    return Bytes(reassembler.getMessage(), reassembler.getMessage() + reassembler.getMessageSize());
+}
+
+void expectCounts(const AX25::Reassembler& reassembler, U32 complete, U32 abandoned, U32 invalid) {
+    EXPECT_EQ(reassembler.getCompleteCount(), complete);
+    EXPECT_EQ(reassembler.getAbandonedCount(), abandoned);
+    EXPECT_EQ(reassembler.getInvalidCount(), invalid);
+}
+
+}  // namespace
+
+TEST(Reassembler, InOrder) {
+    AX25::Reassembler reassembler;
+    const Bytes data = message(600, 1);
+    const std::vector<Bytes> infos = segment(data, 5);
+    ASSERT_EQ(infos.size(), 3U);
+    EXPECT_EQ(push(reassembler, infos[0]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, infos[1]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, infos[2]), AX25::Reassembler::Status::COMPLETE);
+    EXPECT_EQ(completed(reassembler), data);
+    EXPECT_FALSE(reassembler.isPacked());
+    expectCounts(reassembler, 1, 0, 0);
+}
+
+TEST(Reassembler, SingleSegment) {
+    AX25::Reassembler reassembler;
+    const Bytes data = message(40, 2);
+    EXPECT_EQ(push(reassembler, segment(data, 1, AX25::MAX_SEGMENT_PAYLOAD, true)[0]),
+              AX25::Reassembler::Status::COMPLETE);
+    EXPECT_EQ(completed(reassembler), data);
+    EXPECT_TRUE(reassembler.isPacked());
+
+    // An empty message is one segment without payload
+    EXPECT_EQ(push(reassembler, segment(Bytes(), 2)[0]), AX25::Reassembler::Status::COMPLETE);
+    EXPECT_EQ(reassembler.getMessageSize(), 0U);
+    expectCounts(reassembler, 2, 0, 0);
+}
+
+TEST(Reassembler, RepeatedSingleSegment) {
+    // A message of one segment takes no number, so a beacon is the same
+    // frame every time it is sent, and every copy is delivered
+    const U16 single = AX25::SegmentHeader::SINGLE_MESSAGE;
+    std::atomic<U16> counter(7);
+    EXPECT_EQ(AX25::SegmentHeader::number(counter, 1), single);
+    EXPECT_EQ(counter.load(), 7U);
+
+    AX25::Reassembler reassembler;
+    const Bytes data = message(40, 13);
+    const Bytes beacon = segment(data, single)[0];
+    for (U32 i = 0; i < 3; i++) {
+        EXPECT_EQ(push(reassembler, beacon), AX25::Reassembler::Status::COMPLETE) << "copy " << i;
+        EXPECT_EQ(completed(reassembler), data);
+    }
+
+    // Longer messages are numbered around it, also where the number wraps
+    const U16 highest = AX25::SegmentHeader::MESSAGE_MASK;
+    counter.store(highest);
+    const U16 last = AX25::SegmentHeader::number(counter, 2);
+    const U16 wrapped = AX25::SegmentHeader::number(counter, 2);
+    EXPECT_EQ(last, highest);
+    EXPECT_EQ(wrapped, 1U);
+    const Bytes longer = message(300, 14);
+    const std::vector<Bytes> infos = segment(longer, wrapped);
+    EXPECT_EQ(push(reassembler, infos[0]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, infos[1]), AX25::Reassembler::Status::COMPLETE);
+    EXPECT_EQ(completed(reassembler), longer);
+    EXPECT_EQ(push(reassembler, beacon), AX25::Reassembler::Status::COMPLETE);
+    expectCounts(reassembler, 5, 0, 0);
+}
+
+TEST(Reassembler, TailBeforeStride) {
+    // The last segment is held until a full one gives away the stride
+    AX25::Reassembler reassembler;
+    const Bytes data = message(250, 3);
+    const std::vector<Bytes> infos = segment(data, 9, FX25_STRIDE);
+    ASSERT_EQ(infos.size(), 3U);
+    EXPECT_EQ(push(reassembler, infos[2]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, infos[1]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, infos[0]), AX25::Reassembler::Status::COMPLETE);
+    EXPECT_EQ(completed(reassembler), data);
+    expectCounts(reassembler, 1, 0, 0);
+}
+
+TEST(Reassembler, AnyOrder) {
+    AX25::Reassembler reassembler;
+    const Bytes data = message(1000, 4);
+    const std::vector<Bytes> infos = segment(data, 10, FX25_STRIDE);
+    ASSERT_EQ(infos.size(), 10U);
+    const FwSizeType order[] = {3, 9, 0, 7, 1, 8, 2, 6, 4, 5};
+    for (FwSizeType i = 0; i < FW_NUM_ARRAY_ELEMENTS(order) - 1; i++) {
+        EXPECT_EQ(push(reassembler, infos[order[i]]), AX25::Reassembler::Status::INCOMPLETE) << "segment " << order[i];
+    }
+    EXPECT_EQ(push(reassembler, infos[5]), AX25::Reassembler::Status::COMPLETE);
+    EXPECT_EQ(completed(reassembler), data);
+    expectCounts(reassembler, 1, 0, 0);
+}
+
+TEST(Reassembler, Duplicates) {
+    AX25::Reassembler reassembler;
+    const Bytes data = message(300, 5);
+    const std::vector<Bytes> infos = segment(data, 11, FX25_STRIDE);
+    ASSERT_EQ(infos.size(), 3U);
+    EXPECT_EQ(push(reassembler, infos[2]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, infos[2]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, infos[0]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, infos[0]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, infos[1]), AX25::Reassembler::Status::COMPLETE);
+    EXPECT_EQ(completed(reassembler), data);
+
+    // Repeats of a message already delivered do not deliver it again
+    for (const Bytes& info : infos) {
+        EXPECT_EQ(push(reassembler, info), AX25::Reassembler::Status::INCOMPLETE);
+    }
+    expectCounts(reassembler, 1, 0, 0);
+}
+
+TEST(Reassembler, NewMessageAbandonsPartial) {
+    AX25::Reassembler reassembler;
+    const Bytes first = message(600, 6);
+    const Bytes second = message(500, 7);
+    const std::vector<Bytes> firstInfos = segment(first, 20);
+    const std::vector<Bytes> secondInfos = segment(second, 21);
+
+    // Truncated: the first message loses its last segment
+    EXPECT_EQ(push(reassembler, firstInfos[0]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, firstInfos[1]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, secondInfos[1]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, secondInfos[0]), AX25::Reassembler::Status::COMPLETE);
+    EXPECT_EQ(completed(reassembler), second);
+    expectCounts(reassembler, 1, 1, 0);
+
+    // A complete message is not abandoned by the next one
+    const Bytes third = message(10, 8);
+    EXPECT_EQ(push(reassembler, segment(third, 22)[0]), AX25::Reassembler::Status::COMPLETE);
+    expectCounts(reassembler, 2, 1, 0);
+
+    // The same number with different flags is a different message
+    EXPECT_EQ(push(reassembler, segment(first, 23)[0]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, segment(first, 23, AX25::MAX_SEGMENT_PAYLOAD, true)[1]),
+              AX25::Reassembler::Status::INCOMPLETE);
+    expectCounts(reassembler, 2, 2, 0);
+}
+
+TEST(Reassembler, MalformedHeaders) {
+    AX25::Reassembler reassembler;
+    const Bytes valid = segment(message(600, 9), 30)[0];
+
+    // Shorter than the header
+    EXPECT_EQ(reassembler.push(valid.data(), AX25::SegmentHeader::SIZE - 1), AX25::Reassembler::Status::INVALID);
+
+    // No segments, and an index past the count
+    Bytes info = valid;
+    info[3] = 0;
+    EXPECT_EQ(push(reassembler, info), AX25::Reassembler::Status::INVALID);
+    info[2] = 3;
+    info[3] = 3;
+    EXPECT_EQ(push(reassembler, info), AX25::Reassembler::Status::INVALID);
+
+    // A segment other than the last cut down to its header
+    EXPECT_EQ(reassembler.push(valid.data(), AX25::SegmentHeader::SIZE), AX25::Reassembler::Status::INVALID);
+
+    // Longer than an info field
+    Bytes oversized(AX25::MAX_INFO_SIZE + 1, 0);
+    std::copy(valid.begin(), valid.begin() + AX25::SegmentHeader::SIZE, oversized.begin());
+    EXPECT_EQ(push(reassembler, oversized), AX25::Reassembler::Status::INVALID);
+    expectCounts(reassembler, 0, 0, 5);
+}
+
+TEST(Reassembler, InconsistentStride) {
+    AX25::Reassembler reassembler;
+    const Bytes data = message(300, 10);
+    const std::vector<Bytes> infos = segment(data, 40, FX25_STRIDE);
+    EXPECT_EQ(push(reassembler, infos[0]), AX25::Reassembler::Status::INCOMPLETE);
+
+    // A middle segment truncated in flight no longer matches the stride
+    Bytes truncated = infos[1];
+    truncated.resize(truncated.size() - 1);
+    EXPECT_EQ(push(reassembler, truncated), AX25::Reassembler::Status::INVALID);
+
+    // The intact copy still completes the message
+    EXPECT_EQ(push(reassembler, infos[1]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, infos[2]), AX25::Reassembler::Status::COMPLETE);
+    EXPECT_EQ(completed(reassembler), data);
+    expectCounts(reassembler, 1, 0, 1);
+}
+
+TEST(Reassembler, HeldTailLongerThanStride) {
+    // A last segment longer than the stride learned later cannot belong to
+    // the message: both are dropped and the message starts over
+    AX25::Reassembler reassembler;
+    const Bytes data = message(250, 11);
+    const std::vector<Bytes> wide = segment(data, 50, 200);
+    const std::vector<Bytes> narrow = segment(data, 50, FX25_STRIDE);
+    ASSERT_EQ(wide.size(), 2U);
+    ASSERT_EQ(narrow.size(), 3U);
+    Bytes wideTail = wide[0];
+    wideTail[2] = 2;
+    wideTail[3] = 3;
+    wideTail.resize(AX25::SegmentHeader::SIZE + FX25_STRIDE + 1);
+
+    // Checked on arrival once the stride is known
+    EXPECT_EQ(push(reassembler, narrow[0]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, wideTail), AX25::Reassembler::Status::INVALID);
+    expectCounts(reassembler, 0, 0, 1);
+
+    // Held before the stride is known, the oversized tail is only caught
+    // when the stride arrives
+    reassembler.reset();
+    EXPECT_EQ(push(reassembler, wideTail), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, narrow[1]), AX25::Reassembler::Status::INVALID);
+    expectCounts(reassembler, 0, 0, 2);
+
+    // Everything is forgotten, so the message arrives afresh
+    for (const Bytes& info : narrow) {
+        push(reassembler, info);
+    }
+    EXPECT_EQ(completed(reassembler), data);
+    expectCounts(reassembler, 1, 0, 2);
+}
+
+TEST(Reassembler, MessageTooLarge) {
+    AX25::Reassembler reassembler(500);
+    const std::vector<Bytes> infos = segment(message(600, 12), 60);
+    EXPECT_EQ(push(reassembler, infos[0]), AX25::Reassembler::Status::INCOMPLETE);
+    EXPECT_EQ(push(reassembler, infos[1]), AX25::Reassembler::Status::INVALID);
+    EXPECT_EQ(push(reassembler, infos[2]), AX25::Reassembler::Status::INVALID);
+    expectCounts(reassembler, 0, 0, 2);
+}
@@ -0,0 +1,125 @@
+// ======================================================================
+// \title  AX25BufferPool.cpp
+// \author madisonw
+// \brief  Lock-free fixed-size buffer pool for AX.25 frames
+// ======================================================================
+
+#include "CDHDeployment/AX25BufferPool/AX25BufferPool.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <new>
+
+namespace AX25BufferPool {
+
+AX25BufferPool::AX25BufferPool(const char* const compName)
+    : AX25BufferPoolComponentBase(compName),
+      m_allocator(nullptr),
+      m_memId(0),
+      m_memory(nullptr),
+      m_arena(nullptr),
+      m_next(nullptr),
+      m_count(0),
+      m_freeHead(NO_BUFFER),
+      m_inUse(0),
+      m_highWater(0),
+      m_noBuffers(0),
+      m_oversize(0) {}
+
+AX25BufferPool::~AX25BufferPool() {}
+
+void AX25BufferPool::setup(FwEnumStoreType memId, U32 count, Fw::MemAllocator& allocator) {
+    FW_ASSERT(m_memory == nullptr);
+    FW_ASSERT((count > 0) && (count < NO_BUFFER), static_cast<FwAssertArgType>(count));
+
+    // Arena first, then the free links, plus slack to align the arena
+    const FwSizeType arenaSize = static_cast<FwSizeType>(count) * BUFFER_SIZE;
+    const FwSizeType requested = arenaSize + count * sizeof(std::atomic<U32>) + CACHE_LINE;
+    FwSizeType size = requested;
+    bool recoverable = false;
+    m_memory = allocator.allocate(memId, size, recoverable);
+    FW_ASSERT(m_memory != nullptr);
+    FW_ASSERT(size == requested, static_cast<FwAssertArgType>(size), static_cast<FwAssertArgType>(requested));
+    m_allocator = &allocator;
+    m_memId = memId;
+    m_count = count;
+
+    const PlatformPointerCastType base = reinterpret_cast<PlatformPointerCastType>(m_memory);
+    m_arena = reinterpret_cast<U8*>((base + CACHE_LINE - 1) & ~static_cast<PlatformPointerCastType>(CACHE_LINE - 1));
+    m_next = reinterpret_cast<std::atomic<U32>*>(m_arena + arenaSize);
+
+    // Buffer 0 on top of the stack, each one linked to the next
+    for (U32 i = 0; i < count; i++) {
+        new (&m_next[i]) std::atomic<U32>((i + 1 < count) ? i + 1 : NO_BUFFER);
+    }
+    m_freeHead.store(0);
+
+    this->tlmWrite_TotalBuffers(m_count);
+}
+
+void AX25BufferPool::cleanup() {
+    if (m_memory == nullptr) {
+        return;
+    }
+    FW_ASSERT(m_inUse.load() == 0, static_cast<FwAssertArgType>(m_inUse.load()));
+    m_allocator->deallocate(m_memId, m_memory);
+    m_memory = nullptr;
+    m_arena = nullptr;
+    m_next = nullptr;
+    m_count = 0;
+    m_freeHead.store(NO_BUFFER);
+}
+
+Fw::Buffer AX25BufferPool::bufferGetCallee_handler(FwIndexType portNum, FwSizeType size) {
+    if (size > BUFFER_SIZE) {
+        m_oversize.fetch_add(1, std::memory_order_relaxed);
+        this->log_WARNING_HI_RequestTooLarge(static_cast<U32>(size), static_cast<U32>(BUFFER_SIZE));
+        return Fw::Buffer();
+    }
+
+    U64 head = m_freeHead.load(std::memory_order_acquire);
+    while (true) {
+        const U32 index = headIndex(head);
+        if (index == NO_BUFFER) {
+            m_noBuffers.fetch_add(1, std::memory_order_relaxed);
+            this->log_WARNING_LO_NoBuffersAvailable(static_cast<U32>(size));
+            return Fw::Buffer();
+        }
+        const U64 next = makeHead(head, m_next[index].load(std::memory_order_relaxed));
+        if (m_freeHead.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire)) {
+            const U32 inUse = m_inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+            U32 highWater = m_highWater.load(std::memory_order_relaxed);
+            while ((inUse > highWater) &&
+                   !m_highWater.compare_exchange_weak(highWater, inUse, std::memory_order_relaxed)) {
+            }
+            return Fw::Buffer(&m_arena[static_cast<FwSizeType>(index) * BUFFER_SIZE], size, index);
+        }
+    }
+}
+
+void AX25BufferPool::bufferSendIn_handler(FwIndexType portNum, Fw::Buffer& fwBuffer) {
+    const U32 index = static_cast<U32>(fwBuffer.getContext());
+    FW_ASSERT(index < m_count, static_cast<FwAssertArgType>(index));
+    // A frame built in place starts after whatever headroom its header did not use
+    const U8* base = &m_arena[static_cast<FwSizeType>(index) * BUFFER_SIZE];
+    FW_ASSERT((fwBuffer.getData() >= base) && (fwBuffer.getData() < base + BUFFER_SIZE),
+              static_cast<FwAssertArgType>(index));
+
+    U64 head = m_freeHead.load(std::memory_order_relaxed);
+    while (true) {
+        m_next[index].store(headIndex(head), std::memory_order_relaxed);
+        if (m_freeHead.compare_exchange_weak(head, makeHead(head, index), std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    m_inUse.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void AX25BufferPool::schedIn_handler(FwIndexType portNum, U32 context) {
+    this->tlmWrite_TotalBuffers(m_count);
+    this->tlmWrite_CurrentBuffers(m_inUse.load(std::memory_order_relaxed));
+    this->tlmWrite_HighWater(m_highWater.load(std::memory_order_relaxed));
+    this->tlmWrite_NoBuffers(m_noBuffers.load(std::memory_order_relaxed));
+    this->tlmWrite_OversizeRequests(m_oversize.load(std::memory_order_relaxed));
+}
+
+}  // namespace AX25BufferPool
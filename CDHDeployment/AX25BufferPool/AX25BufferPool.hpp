@@ -0,0 +1,80 @@
+// ======================================================================
+// \title  AX25BufferPool.hpp
+// \author madisonw
+// \brief  Lock-free fixed-size buffer pool for AX.25 frames
+// ======================================================================
+
+#ifndef AX25BufferPool_AX25BufferPool_HPP
+#define AX25BufferPool_AX25BufferPool_HPP
+
+#include "CDHDeployment/AX25/FrameView.hpp"
+#include "CDHDeployment/AX25BufferPool/AX25BufferPoolComponentAc.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+#include "Fw/Types/MemAllocator.hpp"
+#include <atomic>
+
+namespace AX25BufferPool {
+
+//! Buffers for AMSATFramer, kept apart from the F´ com BufferManager bins.
+//!
+//! All buffers live in one contiguous arena, each BUFFER_SIZE bytes and
+//! starting on a cache line. Free buffers form a stack of indices whose head
+//! carries a generation tag, so get and return are a single compare-and-swap
+//! with no lock and no ABA hazard. The buffer context holds the index, which
+//! makes returns O(1) and lets foreign buffers be caught.
+class AX25BufferPool : public AX25BufferPoolComponentBase {
+  public:
+    //! Largest frame: start flag, address/control/PID with a digipeater path,
+    //! 256-byte info field, FCS, end flag
+    static constexpr FwSizeType MAX_FRAME_SIZE = 1 + AX25::MAX_HEADER_SIZE + 256 + 2 + 1;
+    //! Largest request: a contiguous frame, or a segment view carrying an FX.25 block
+    static constexpr FwSizeType MAX_REQUEST_SIZE =
+        (sizeof(AX25::FrameView) > MAX_FRAME_SIZE) ? sizeof(AX25::FrameView) : MAX_FRAME_SIZE;
+    static constexpr FwSizeType CACHE_LINE = 64;
+    //! MAX_REQUEST_SIZE rounded up so every buffer starts on a cache line
+    static constexpr FwSizeType BUFFER_SIZE = (MAX_REQUEST_SIZE + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+
+    AX25BufferPool(const char* const compName);
+    ~AX25BufferPool();
+
+    //! Allocate the arena for `count` buffers; call once before any port is used
+    void setup(FwEnumStoreType memId, U32 count, Fw::MemAllocator& allocator);
+
+    //! Release the arena; every buffer must have been returned
+    void cleanup();
+
+  private:
+    Fw::Buffer bufferGetCallee_handler(FwIndexType portNum, FwSizeType size) override;
+
+    void bufferSendIn_handler(FwIndexType portNum, Fw::Buffer& fwBuffer) override;
+
+    void schedIn_handler(FwIndexType portNum, U32 context) override;
+
+    //! Index marking the end of the free stack
+    static constexpr U32 NO_BUFFER = 0xFFFFFFFFU;
+
+    static U32 headIndex(U64 head) { return static_cast<U32>(head); }
+    static U64 makeHead(U64 previous, U32 index) {
+        return ((previous & 0xFFFFFFFF00000000ULL) + (1ULL << 32)) | index;
+    }
+
+    Fw::MemAllocator* m_allocator;
+    FwEnumStoreType m_memId;
+    void* m_memory;
+    U8* m_arena;
+    //! Next free index below each free buffer
+    std::atomic<U32>* m_next;
+    U32 m_count;
+
+    //! Free stack head: index in the low word, generation tag in the high word
+    std::atomic<U64> m_freeHead;
+
+    std::atomic<U32> m_inUse;
+    std::atomic<U32> m_highWater;
+    std::atomic<U32> m_noBuffers;
+    std::atomic<U32> m_oversize;
+};
+
+}  // namespace AX25BufferPool
+
+#endif
@@ -0,0 +1,248 @@
+// ======================================================================
+// \title  AX25Receiver.cpp
+// \author madisonw
+// \brief  Component that demodulates AFSK or G3RUH audio into AX.25 uplink frames
+// ======================================================================
+
+#include "CDHDeployment/AX25Receiver/AX25Receiver.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <chrono>
+#include <cstring>
+
+namespace AX25Receiver {
+
+static_assert(DecoderCounts::SIZE == DemodulatorBank::MAX_DECODERS, "One telemetry entry per decoder");
+
+AX25Receiver::AX25Receiver(const char* const compName)
+    : AX25ReceiverComponentBase(compName),
+      m_kind(PcmSource::Kind::FILE),
+      m_bank(AX25Receiver::frameReceived, this),
+      m_modulation(AX25::Modulation::AFSK_1200),
+      m_decoders(1),
+      m_samples(BLOCK_SAMPLES),
+      m_samplesProcessed(0),
+      m_packetsUnpacked(0),
+      m_stopping(false) {}
+
+AX25Receiver::~AX25Receiver() {}
+
+void AX25Receiver::configureSource(PcmSource::Kind kind, const char* target) {
+    FW_ASSERT(target != nullptr);
+    m_kind = kind;
+    m_target = target;
+}
+
+void AX25Receiver::startSource(const Os::TaskString& name,
+                               FwTaskPriorityType priority,
+                               FwSizeType stackSize,
+                               U32 decoderWorkers) {
+    FW_ASSERT(!m_target.empty());
+    m_stopping = false;
+    m_bank.startWorkers(decoderWorkers, priority, stackSize);
+    Os::Task::Arguments arguments(name, AX25Receiver::readerTask, this, priority, stackSize);
+    Os::Task::Status status = m_task.start(arguments);
+    FW_ASSERT(status == Os::Task::OP_OK, static_cast<FwAssertArgType>(status));
+}
+
+void AX25Receiver::stopSource() {
+    m_stopping = true;
+    (void)m_task.join();
+    m_bank.stopWorkers();
+}
+
+void AX25Receiver::readerTask(void* receiver) {
+    FW_ASSERT(receiver != nullptr);
+    static_cast<AX25Receiver*>(receiver)->run();
+}
+
+void AX25Receiver::run() {
+    Fw::LogStringArg sourceStr(m_target.c_str());
+    if (!m_source.open(m_kind, m_target.c_str())) {
+        Fw::LogStringArg errorStr(m_source.getError());
+        this->log_WARNING_HI_RX_SOURCE_FAILED(sourceStr, errorStr);
+        return;
+    }
+    this->log_ACTIVITY_HI_RX_SOURCE_OPENED(sourceStr);
+
+    m_bank.reset();
+    m_reassembler.reset();
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point lastTlm = Clock::now();
+    F64 busySeconds = 0.0;
+    F32 realTimeFactor = 0.0f;
+
+    while (!m_stopping) {
+        FwSizeType count = 0;
+        const PcmSource::Status status = m_source.read(m_samples.data(), m_samples.size(), count, READ_TIMEOUT_MS);
+        if (status == PcmSource::Status::END) {
+            break;
+        }
+        if (status == PcmSource::Status::FAILED) {
+            Fw::LogStringArg errorStr(m_source.getError());
+            this->log_WARNING_HI_RX_SOURCE_FAILED(sourceStr, errorStr);
+            break;
+        }
+
+        this->checkModulation();
+        if (count > 0) {
+            // Time spent demodulating only, so a live source that idles
+            // between reads still reports how much headroom is left
+            const Clock::time_point before = Clock::now();
+            m_bank.process(m_samples.data(), count);
+            busySeconds += std::chrono::duration<F64>(Clock::now() - before).count();
+            m_samplesProcessed += count;
+        }
+
+        if (busySeconds > 0.0) {
+            const F64 audioSeconds = static_cast<F64>(m_samplesProcessed) / SAMPLE_RATE;
+            realTimeFactor = static_cast<F32>(audioSeconds / busySeconds);
+        }
+        const Clock::time_point now = Clock::now();
+        if (now - lastTlm >= std::chrono::milliseconds(TLM_INTERVAL_MS)) {
+            this->writeTelemetry(realTimeFactor);
+            lastTlm = now;
+        }
+    }
+
+    m_source.close();
+    this->writeTelemetry(realTimeFactor);
+    if (!m_stopping) {
+        this->log_ACTIVITY_HI_RX_SOURCE_END(m_samplesProcessed, realTimeFactor);
+    }
+}
+
+void AX25Receiver::checkModulation() {
+    Fw::ParamValid valid;
+    const AX25::Modulation modulation = this->paramGet_MODULATION(valid);
+    const U8 decoders = this->paramGet_DECODERS(valid);
+    if ((modulation == m_modulation) && (decoders == m_decoders)) {
+        return;
+    }
+    // Bits from other demodulators would only corrupt the frames in progress
+    m_modulation = modulation;
+    m_decoders = decoders;
+    m_bank.configure(modulation, decoders);
+    this->log_ACTIVITY_HI_RX_MODULATION_CHANGED(modulation, static_cast<U8>(m_bank.getDecoderCount()));
+}
+
+void AX25Receiver::writeTelemetry(F32 realTimeFactor) {
+    const AX25::HdlcDeframer& nominal = m_bank.getNominalDeframer();
+    this->tlmWrite_FramesDecoded(m_bank.getFrameCount());
+    this->tlmWrite_FcsErrors(nominal.getFcsErrorCount());
+    this->tlmWrite_SamplesProcessed(m_samplesProcessed);
+    this->tlmWrite_RealTimeFactor(realTimeFactor);
+    this->tlmWrite_MessagesReassembled(m_reassembler.getCompleteCount());
+    this->tlmWrite_MessagesAbandoned(m_reassembler.getAbandonedCount());
+    this->tlmWrite_SegmentsInvalid(m_reassembler.getInvalidCount());
+    this->tlmWrite_PacketsUnpacked(m_packetsUnpacked);
+    this->tlmWrite_Fx25Blocks(nominal.getFx25BlockCount());
+    this->tlmWrite_Fx25Corrected(nominal.getFx25CorrectedCount());
+    this->tlmWrite_Fx25Uncorrectable(nominal.getFx25UncorrectableCount());
+
+    DecoderCounts wins;
+    DecoderCounts unique;
+    for (U32 i = 0; i < DemodulatorBank::MAX_DECODERS; i++) {
+        const bool running = i < m_bank.getDecoderCount();
+        wins[i] = running ? m_bank.getWins(i) : 0;
+        unique[i] = running ? m_bank.getUnique(i) : 0;
+    }
+    this->tlmWrite_DecoderWins(wins);
+    this->tlmWrite_DecoderUnique(unique);
+    this->tlmWrite_DuplicateFrames(m_bank.getDuplicateCount());
+}
+
+void AX25Receiver::frameReceived(void* receiver, const U8* frame, FwSizeType size) {
+    FW_ASSERT(receiver != nullptr);
+    static_cast<AX25Receiver*>(receiver)->forwardFrame(frame, size);
+}
+
+void AX25Receiver::forwardFrame(const U8* frame, FwSizeType size) {
+    // The address field ends at the first byte with the extension bit set
+    // and is made of 7-byte callsign entries (destination, source, digipeaters)
+    FwSizeType addressLen = 0;
+    while (addressLen < size && (frame[addressLen] & 0x01) == 0) {
+        addressLen++;
+    }
+    addressLen++;
+    if ((addressLen % 7) != 0 || addressLen < 14 || addressLen + 2 > size) {
+        this->log_ACTIVITY_LO_RX_FRAME_IGNORED(0, 0);
+        return;
+    }
+
+    const U8 control = frame[addressLen];
+    const U8 pid = frame[addressLen + 1];
+    if ((control & ~AX25_CONTROL_PF) != AX25_CONTROL_UI || pid != AX25_PID_NO_L3) {
+        this->log_ACTIVITY_LO_RX_FRAME_IGNORED(control, pid);
+        return;
+    }
+
+    const FwSizeType infoOffset = addressLen + 2;
+    const FwSizeType infoSize = size - infoOffset;
+    this->log_ACTIVITY_LO_RX_FRAME_DECODED(static_cast<U32>(infoSize));
+
+    // Each info field is one segment of a message split by the sender
+    const AX25::Reassembler::Status status = m_reassembler.push(&frame[infoOffset], infoSize);
+    if (status == AX25::Reassembler::Status::INVALID) {
+        this->log_WARNING_LO_RX_SEGMENT_INVALID(static_cast<U32>(infoSize));
+        return;
+    }
+    if (status != AX25::Reassembler::Status::COMPLETE) {
+        return;
+    }
+
+    const U8* message = m_reassembler.getMessage();
+    FwSizeType messageSize = m_reassembler.getMessageSize();
+    if (m_reassembler.isCompressed()) {
+        messageSize = AX25::Compressor::expand(message, messageSize, m_expanded, sizeof(m_expanded));
+        if (messageSize == 0) {
+            this->log_WARNING_LO_RX_EXPAND_FAILED(static_cast<U32>(m_reassembler.getMessageSize()));
+            return;
+        }
+        message = m_expanded;
+    }
+
+    if (!m_reassembler.isPacked()) {
+        this->forwardMessage(message, messageSize);
+        return;
+    }
+
+    // A pack carries several com packets, each forwarded on its own
+    AX25::PackReader reader(message, messageSize);
+    const U8* packet = nullptr;
+    FwSizeType packetSize = 0;
+    while (reader.next(packet, packetSize)) {
+        m_packetsUnpacked++;
+        this->forwardMessage(packet, packetSize);
+    }
+    if (!reader.isComplete()) {
+        this->log_WARNING_LO_RX_PACK_INVALID(static_cast<U32>(messageSize));
+    }
+}
+
+void AX25Receiver::forwardMessage(const U8* message, FwSizeType messageSize) {
+    Fw::Buffer buffer = this->bufferAllocate_out(0, messageSize);
+    if (!buffer.isValid() || buffer.getSize() < messageSize) {
+        if (buffer.isValid()) {
+            this->bufferDeallocate_out(0, buffer);
+        }
+        this->log_WARNING_HI_RX_BUFFER_ALLOCATION_FAILED(static_cast<U32>(messageSize));
+        return;
+    }
+
+    memcpy(buffer.getData(), message, messageSize);
+    buffer.setSize(messageSize);
+
+    ComCfg::FrameContext context;
+    this->dataOut_out(0, buffer, context);
+}
+
+void AX25Receiver::dataReturnIn_handler(
+    FwIndexType portNum,
+    Fw::Buffer& fwBuffer,
+    const ComCfg::FrameContext& context
+) {
+    this->bufferDeallocate_out(0, fwBuffer);
+}
+
+}  // namespace AX25Receiver
@@ -0,0 +1,97 @@
+// ======================================================================
+// \title  AX25Receiver.hpp
+// \author madisonw
+// \brief  Component that demodulates AFSK or G3RUH audio into AX.25 uplink frames
+// ======================================================================
+
+#ifndef AX25Receiver_AX25Receiver_HPP
+#define AX25Receiver_AX25Receiver_HPP
+
+#include "CDHDeployment/AX25Receiver/AX25ReceiverComponentAc.hpp"
+#include "CDHDeployment/AX25Receiver/DemodulatorBank.hpp"
+#include "CDHDeployment/AX25Receiver/PcmSource.hpp"
+#include "CDHDeployment/AX25/Compression.hpp"
+#include "CDHDeployment/AX25/Packing.hpp"
+#include "CDHDeployment/AX25/Segmentation.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+#include "Os/Task.hpp"
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace AX25Receiver {
+
+class AX25Receiver : public AX25ReceiverComponentBase {
+  public:
+    AX25Receiver(const char* const compName);
+    ~AX25Receiver();
+
+    //! Select the PCM source (file, FIFO, device or TCP "host:port"); call before startSource
+    void configureSource(PcmSource::Kind kind, const char* target);
+
+    //! Start the reader thread that demodulates the source, and `decoderWorkers`
+    //! threads (at most DemodulatorBank::MAX_WORKERS) that run demodulator
+    //! variants next to it
+    void startSource(const Os::TaskString& name,
+                     FwTaskPriorityType priority,
+                     FwSizeType stackSize,
+                     U32 decoderWorkers = 0);
+
+    //! Stop the reader and decoder threads and wait for them
+    void stopSource();
+
+  private:
+    void dataReturnIn_handler(
+        FwIndexType portNum,
+        Fw::Buffer& fwBuffer,
+        const ComCfg::FrameContext& context
+    ) override;
+
+    //! Rate of the PCM source, matching the demodulator defaults
+    static constexpr U32 SAMPLE_RATE = 48000;
+    //! Samples demodulated per read (100 ms)
+    static constexpr FwSizeType BLOCK_SAMPLES = SAMPLE_RATE / 10;
+    //! Longest a read waits, bounding how long stopSource takes
+    static constexpr U32 READ_TIMEOUT_MS = 100;
+    //! Wall time between telemetry updates while the source is running
+    static constexpr U32 TLM_INTERVAL_MS = 1000;
+
+    //! AX.25 UI frame control field (P/F bit masked) and "no layer 3" PID
+    static constexpr U8 AX25_CONTROL_UI = 0x03;
+    static constexpr U8 AX25_CONTROL_PF = 0x10;
+    static constexpr U8 AX25_PID_NO_L3 = 0xF0;
+
+    static void readerTask(void* receiver);
+    void run();
+
+    static void frameReceived(void* receiver, const U8* frame, FwSizeType size);
+    void forwardFrame(const U8* frame, FwSizeType size);
+    //! Copy one message into a buffer and send it on dataOut
+    void forwardMessage(const U8* message, FwSizeType messageSize);
+
+    void writeTelemetry(F32 realTimeFactor);
+
+    //! Reconfigure the demodulators if the MODULATION or DECODERS parameter changed
+    void checkModulation();
+
+    PcmSource::Kind m_kind;
+    std::string m_target;
+    PcmSource m_source;
+
+    DemodulatorBank m_bank;
+    AX25::Modulation m_modulation;
+    U8 m_decoders;
+    AX25::Reassembler m_reassembler;
+    //! Compressed messages expanded before they are unpacked
+    U8 m_expanded[AX25::Compressor::MAX_INPUT];
+    std::vector<I16> m_samples;
+    U64 m_samplesProcessed;
+    U32 m_packetsUnpacked;
+
+    Os::Task m_task;
+    std::atomic<bool> m_stopping;
+};
+
+}  // namespace AX25Receiver
+
+#endif
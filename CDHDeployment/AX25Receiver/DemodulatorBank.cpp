@@ -0,0 +1,331 @@
+// ======================================================================
+// \title  DemodulatorBank.cpp
+// \author madisonw
+// \brief  Several demodulator variants run side by side on one PCM stream
+// ======================================================================
+
+#include "CDHDeployment/AX25Receiver/DemodulatorBank.hpp"
+#include "CDHDeployment/AX25/Crc16.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <cstring>
+
+namespace AX25Receiver {
+
+namespace {
+
+struct AfskVariant {
+    I32 toneOffset;
+    U32 windowPercent;
+    F32 spaceGain;
+};
+
+//! Most useful first, as DECODERS runs a prefix of the table
+const AfskVariant AFSK_VARIANTS[] = {
+    {0, 100, 1.0f},   // Nominal
+    {0, 100, 2.0f},   // De-emphasized audio, space tone 6 dB down
+    {0, 100, 0.5f},   // Flat audio from a pre-emphasizing transmitter, mark 6 dB down
+    {0, 75, 1.0f},    // Wider tone filters
+    {-50, 75, 1.0f},  // Tones low, as from a drifting AFSK generator, with the wider filters
+    {50, 75, 1.0f},   // Tones high
+    {-50, 75, 2.0f},
+    {50, 75, 2.0f},
+};
+
+struct G3ruhVariant {
+    F64 rollOff;
+    U32 meanShift;
+};
+
+const G3ruhVariant G3RUH_VARIANTS[] = {
+    {0.5, 10},   // Nominal, matched to the transmit filter
+    {0.5, 7},    // Slicer follows the Doppler-shifted offset at the start of a burst
+    {0.35, 10},  // Narrower filter
+    {0.8, 10},   // Wider filter
+};
+
+static_assert(FW_NUM_ARRAY_ELEMENTS(AFSK_VARIANTS) <= DemodulatorBank::MAX_DECODERS, "Too many AFSK variants");
+static_assert(FW_NUM_ARRAY_ELEMENTS(G3RUH_VARIANTS) <= DemodulatorBank::MAX_DECODERS, "Too many G3RUH variants");
+
+}  // namespace
+
+DemodulatorBank::Decoder::Decoder()
+    : deframer(DemodulatorBank::frameReceived, this), position(0), candidateCount(0), wins(0), unique(0) {}
+
+DemodulatorBank::DemodulatorBank(FrameHandler handler, void* context)
+    : m_handler(handler),
+      m_context(context),
+      m_modulation(AX25::Modulation::AFSK_1200),
+      m_decoderCount(1),
+      m_samplesPerBit(1),
+      m_position(0),
+      m_span(nullptr),
+      m_spanCount(0),
+      m_workerCount(0),
+      m_nextLane(1),
+      m_generation(0),
+      m_lanesDone(0),
+      m_stopping(false),
+      m_delivered(0),
+      m_duplicates(0) {
+    FW_ASSERT(handler != nullptr);
+    this->configure(m_modulation, 1);
+}
+
+DemodulatorBank::~DemodulatorBank() {
+    this->stopWorkers();
+}
+
+void DemodulatorBank::startWorkers(U32 count, FwTaskPriorityType priority, FwSizeType stackSize) {
+    FW_ASSERT(m_workerCount == 0);
+    FW_ASSERT(count <= MAX_WORKERS, static_cast<FwAssertArgType>(count));
+    // Set before any worker runs: a worker that starts after the first span
+    // was posted sees the generation already moved and joins in
+    m_workerCount = count;
+    m_nextLane = 1;
+    m_generation = 0;
+    m_stopping = false;
+    for (U32 i = 0; i < count; i++) {
+        Os::TaskString name("RxDecoder");
+        Os::Task::Arguments arguments(name, DemodulatorBank::workerTask, this, priority, stackSize);
+        Os::Task::Status status = m_workers[i].start(arguments);
+        FW_ASSERT(status == Os::Task::OP_OK, static_cast<FwAssertArgType>(status));
+    }
+}
+
+void DemodulatorBank::stopWorkers() {
+    if (m_workerCount == 0) {
+        return;
+    }
+    {
+        Os::ScopeLock lock(m_lock);
+        m_stopping = true;
+        m_spanReady.notifyAll();
+    }
+    for (U32 i = 0; i < m_workerCount; i++) {
+        (void)m_workers[i].join();
+    }
+    m_workerCount = 0;
+}
+
+void DemodulatorBank::configure(AX25::Modulation modulation, U32 decoders) {
+    const bool g3ruh = (modulation == AX25::Modulation::G3RUH_9600);
+    const U32 available = g3ruh ? FW_NUM_ARRAY_ELEMENTS(G3RUH_VARIANTS) : FW_NUM_ARRAY_ELEMENTS(AFSK_VARIANTS);
+    m_modulation = modulation;
+    m_decoderCount = FW_MAX(1U, FW_MIN(decoders, available));
+
+    for (U32 i = 0; i < m_decoderCount; i++) {
+        Decoder& decoder = m_decoders[i];
+        if (g3ruh) {
+            AX25::G3ruhDemodulator::Config config;
+            config.rollOff = G3RUH_VARIANTS[i].rollOff;
+            config.meanShift = G3RUH_VARIANTS[i].meanShift;
+            decoder.g3ruh = AX25::G3ruhDemodulator(config);
+            m_samplesPerBit = config.sampleRate / config.baudRate;
+        } else {
+            AX25::AfskDemodulator::Config config;
+            config.markFreq = static_cast<U32>(static_cast<I32>(config.markFreq) + AFSK_VARIANTS[i].toneOffset);
+            config.spaceFreq = static_cast<U32>(static_cast<I32>(config.spaceFreq) + AFSK_VARIANTS[i].toneOffset);
+            config.windowPercent = AFSK_VARIANTS[i].windowPercent;
+            config.spaceGain = AFSK_VARIANTS[i].spaceGain;
+            decoder.afsk = AX25::AfskDemodulator(config);
+            m_samplesPerBit = config.sampleRate / config.baudRate;
+        }
+        // Wins are per variant, and the variants just changed
+        decoder.wins = 0;
+        decoder.unique = 0;
+    }
+    this->reset();
+}
+
+void DemodulatorBank::reset() {
+    for (U32 i = 0; i < m_decoderCount; i++) {
+        Decoder& decoder = m_decoders[i];
+        decoder.afsk.reset();
+        decoder.g3ruh.reset();
+        decoder.deframer.reset();
+        decoder.candidateCount = 0;
+    }
+    for (Recent& recent : m_recent) {
+        recent.active = false;
+    }
+    m_position = 0;
+}
+
+void DemodulatorBank::process(const I16* samples, FwSizeType count) {
+    FW_ASSERT(samples != nullptr);
+    while (count > 0) {
+        m_span = samples;
+        m_spanCount = FW_MIN(count, SPAN);
+        if (m_workerCount == 0) {
+            this->runLane(0);
+        } else {
+            {
+                Os::ScopeLock lock(m_lock);
+                m_lanesDone = 0;
+                m_generation++;
+                m_spanReady.notifyAll();
+            }
+            this->runLane(0);
+            Os::ScopeLock lock(m_lock);
+            while (m_lanesDone < m_workerCount) {
+                m_spanDone.wait(m_lock);
+            }
+        }
+
+        this->merge();
+        m_position += m_spanCount;
+        samples += m_spanCount;
+        count -= m_spanCount;
+    }
+}
+
+void DemodulatorBank::workerTask(void* bank) {
+    FW_ASSERT(bank != nullptr);
+    DemodulatorBank* self = static_cast<DemodulatorBank*>(bank);
+    self->workerLoop(self->m_nextLane++);
+}
+
+void DemodulatorBank::workerLoop(U32 lane) {
+    U32 seen = 0;
+    for (;;) {
+        {
+            Os::ScopeLock lock(m_lock);
+            while ((m_generation == seen) && !m_stopping) {
+                m_spanReady.wait(m_lock);
+            }
+            if (m_stopping) {
+                return;
+            }
+            seen = m_generation;
+        }
+        this->runLane(lane);
+        Os::ScopeLock lock(m_lock);
+        m_lanesDone++;
+        m_spanDone.notify();
+    }
+}
+
+void DemodulatorBank::runLane(U32 lane) {
+    const U32 lanes = m_workerCount + 1;
+    for (U32 i = lane; i < m_decoderCount; i += lanes) {
+        this->demodulate(m_decoders[i]);
+    }
+}
+
+void DemodulatorBank::demodulate(Decoder& decoder) {
+    decoder.candidateCount = 0;
+    const bool g3ruh = (m_modulation == AX25::Modulation::G3RUH_9600);
+    for (FwSizeType offset = 0; offset < m_spanCount; offset += SLICE) {
+        const FwSizeType count = FW_MIN(m_spanCount - offset, SLICE);
+        decoder.position = m_position + offset + count;
+        if (g3ruh) {
+            decoder.g3ruh.process(&m_span[offset], count, decoder.deframer);
+        } else {
+            decoder.afsk.process(&m_span[offset], count, decoder.deframer);
+        }
+    }
+}
+
+void DemodulatorBank::frameReceived(void* decoder, const U8* frame, FwSizeType size) {
+    FW_ASSERT(decoder != nullptr);
+    Decoder* self = static_cast<Decoder*>(decoder);
+    // A span is too short to fill the candidates, so this only guards the copy
+    if ((self->candidateCount == MAX_CANDIDATES) || (size > AX25::HdlcDeframer::MAX_FRAME_SIZE)) {
+        return;
+    }
+    Candidate& candidate = self->candidates[self->candidateCount++];
+    candidate.position = self->position;
+    candidate.hash = AX25::Crc16::compute(frame, size);
+    candidate.size = size;
+    memcpy(candidate.frame, frame, size);
+}
+
+void DemodulatorBank::merge() {
+    // Candidates of every decoder in stream order; a tie goes to the
+    // variant earlier in the table
+    struct Entry {
+        U32 decoder;
+        const Candidate* candidate;
+    };
+    Entry entries[MAX_DECODERS * MAX_CANDIDATES];
+    U32 entryCount = 0;
+    for (U32 d = 0; d < m_decoderCount; d++) {
+        for (U32 c = 0; c < m_decoders[d].candidateCount; c++) {
+            const Entry entry = {d, &m_decoders[d].candidates[c]};
+            U32 at = entryCount++;
+            while ((at > 0) && (entries[at - 1].candidate->position > entry.candidate->position)) {
+                entries[at] = entries[at - 1];
+                at--;
+            }
+            entries[at] = entry;
+        }
+    }
+
+    const U64 window = static_cast<U64>(DUPLICATE_BITS) * m_samplesPerBit + SLICE;
+    for (U32 e = 0; e < entryCount; e++) {
+        const Candidate& candidate = *entries[e].candidate;
+        const U32 decoderBit = 1U << entries[e].decoder;
+
+        Recent* match = nullptr;
+        for (Recent& recent : m_recent) {
+            if (recent.active && (recent.hash == candidate.hash) && (recent.size == candidate.size) &&
+                (candidate.position <= recent.position + window) &&
+                (memcmp(recent.frame, candidate.frame, candidate.size) == 0)) {
+                match = &recent;
+                break;
+            }
+        }
+        if (match != nullptr) {
+            match->decoders |= decoderBit;
+            m_duplicates++;
+            continue;
+        }
+
+        // A free entry, or else the oldest
+        Recent* slot = &m_recent[0];
+        for (Recent& recent : m_recent) {
+            if (!recent.active) {
+                slot = &recent;
+                break;
+            }
+            if (recent.position < slot->position) {
+                slot = &recent;
+            }
+        }
+        if (slot->active) {
+            this->retire(*slot);
+        }
+        slot->active = true;
+        slot->position = candidate.position;
+        slot->hash = candidate.hash;
+        slot->size = candidate.size;
+        slot->decoders = decoderBit;
+        memcpy(slot->frame, candidate.frame, candidate.size);
+
+        m_decoders[entries[e].decoder].wins++;
+        m_delivered++;
+        m_handler(m_context, candidate.frame, candidate.size);
+    }
+
+    // Every later candidate ends after this span
+    const U64 end = m_position + m_spanCount;
+    for (Recent& recent : m_recent) {
+        if (recent.active && (recent.position + window <= end)) {
+            this->retire(recent);
+        }
+    }
+}
+
+void DemodulatorBank::retire(Recent& recent) {
+    recent.active = false;
+    if ((recent.decoders & (recent.decoders - 1)) != 0) {
+        return;
+    }
+    for (U32 d = 0; d < m_decoderCount; d++) {
+        if (recent.decoders == (1U << d)) {
+            m_decoders[d].unique++;
+        }
+    }
+}
+
+}  // namespace AX25Receiver
@@ -0,0 +1,164 @@
+// ======================================================================
+// \title  DemodulatorBank.hpp
+// \author madisonw
+// \brief  Several demodulator variants run side by side on one PCM stream
+// ======================================================================
+
+#ifndef AX25Receiver_DemodulatorBank_HPP
+#define AX25Receiver_DemodulatorBank_HPP
+
+#include "CDHDeployment/AX25/AfskDemodulator.hpp"
+#include "CDHDeployment/AX25/G3ruhDemodulator.hpp"
+#include "CDHDeployment/AX25/HdlcDeframer.hpp"
+#include "CDHDeployment/AX25/ModulationEnumAc.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+#include "Os/Condition.hpp"
+#include "Os/Mutex.hpp"
+#include "Os/Task.hpp"
+#include <atomic>
+
+namespace AX25Receiver {
+
+//! Diversity receiver: every decoder demodulates the same samples with its
+//! own tone offsets, filter bandwidth or slicer threshold, and a frame is
+//! delivered once, from whichever decoder passed FCS on it first in the
+//! stream. Copies from the other decoders are recognised by their hash and
+//! contents and dropped.
+//!
+//! Samples are demodulated a span at a time. The caller's thread and any
+//! worker tasks started with startWorkers() each take every n-th decoder
+//! of a span, and the frames are merged once all of them are done, so the
+//! frames delivered do not depend on the number of workers.
+class DemodulatorBank {
+  public:
+    //! Variants in the table for either modulation, at most
+    static constexpr U32 MAX_DECODERS = 8;
+    static constexpr U32 MAX_WORKERS = MAX_DECODERS - 1;
+
+    typedef void (*FrameHandler)(void* context, const U8* frame, FwSizeType size);
+
+    DemodulatorBank(FrameHandler handler, void* context);
+    ~DemodulatorBank();
+
+    //! Start `count` worker tasks to run decoders next to the caller's thread
+    void startWorkers(U32 count, FwTaskPriorityType priority, FwSizeType stackSize);
+
+    //! Stop the worker tasks and wait for them
+    void stopWorkers();
+
+    //! Run the first `decoders` variants for `modulation` (at least the
+    //! nominal one) and clear all state
+    void configure(AX25::Modulation modulation, U32 decoders);
+
+    //! Forget partial frames and recently delivered ones
+    void reset();
+
+    //! Demodulate `count` samples with every decoder and deliver new frames
+    void process(const I16* samples, FwSizeType count);
+
+    U32 getDecoderCount() const { return m_decoderCount; }
+
+    //! Frames delivered
+    U32 getFrameCount() const { return m_delivered; }
+    //! Frames dropped because another decoder delivered them already
+    U32 getDuplicateCount() const { return m_duplicates; }
+    //! Frames a decoder delivered first
+    U32 getWins(U32 decoder) const { return m_decoders[decoder].wins; }
+    //! Frames only that decoder decoded
+    U32 getUnique(U32 decoder) const { return m_decoders[decoder].unique; }
+
+    //! Deframer of the nominal decoder, whose FCS and FX.25 counts stand
+    //! for the link; the variants see the same noise
+    const AX25::HdlcDeframer& getNominalDeframer() const { return m_decoders[0].deframer; }
+
+  private:
+    //! Samples every decoder demodulates before the frames are merged
+    static constexpr FwSizeType SPAN = 1200;
+    //! Frames are stamped with the end of the slice their closing flag was in
+    static constexpr FwSizeType SLICE = 64;
+    //! Frames one decoder can complete in a span: two at 9600 baud
+    static constexpr U32 MAX_CANDIDATES = 4;
+    //! Delivered frames remembered to recognise copies
+    static constexpr U32 RECENT = 8;
+    //! Copies of a frame complete within this many bits of each other
+    static constexpr U32 DUPLICATE_BITS = 8;
+
+    struct Candidate {
+        U64 position;
+        U16 hash;
+        FwSizeType size;
+        U8 frame[AX25::HdlcDeframer::MAX_FRAME_SIZE];
+    };
+
+    struct Decoder {
+        Decoder();
+
+        AX25::AfskDemodulator afsk;
+        AX25::G3ruhDemodulator g3ruh;
+        AX25::HdlcDeframer deframer;
+        //! End of the slice being demodulated
+        U64 position;
+        Candidate candidates[MAX_CANDIDATES];
+        U32 candidateCount;
+        U32 wins;
+        U32 unique;
+    };
+
+    struct Recent {
+        bool active;
+        U64 position;
+        U16 hash;
+        FwSizeType size;
+        //! One bit per decoder that decoded the frame
+        U32 decoders;
+        U8 frame[AX25::HdlcDeframer::MAX_FRAME_SIZE];
+    };
+
+    static void workerTask(void* bank);
+    void workerLoop(U32 lane);
+
+    //! Demodulate the span with every decoder of `lane` (0 is the caller's)
+    void runLane(U32 lane);
+    void demodulate(Decoder& decoder);
+    //! Deliver the candidates of the span in stream order, dropping copies
+    void merge();
+    //! Count a remembered frame that can no longer be matched and forget it
+    void retire(Recent& recent);
+
+    static void frameReceived(void* decoder, const U8* frame, FwSizeType size);
+
+    FrameHandler m_handler;
+    void* m_context;
+
+    AX25::Modulation m_modulation;
+    U32 m_decoderCount;
+    U32 m_samplesPerBit;
+    Decoder m_decoders[MAX_DECODERS];
+    Recent m_recent[RECENT];
+
+    //! Samples before the current span
+    U64 m_position;
+    const I16* m_span;
+    FwSizeType m_spanCount;
+
+    Os::Task m_workers[MAX_WORKERS];
+    U32 m_workerCount;
+    //! Lanes handed to workers as they start
+    std::atomic<U32> m_nextLane;
+    Os::Mutex m_lock;
+    //! Workers wait here for the next span
+    Os::ConditionVariable m_spanReady;
+    //! The caller waits here for the workers to finish the span
+    Os::ConditionVariable m_spanDone;
+    //! Spans started, so a worker can tell a new one from a spurious wakeup
+    U32 m_generation;
+    U32 m_lanesDone;
+    bool m_stopping;
+
+    U32 m_delivered;
+    U32 m_duplicates;
+};
+
+}  // namespace AX25Receiver
+
+#endif
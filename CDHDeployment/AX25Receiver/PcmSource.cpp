@@ -0,0 +1,135 @@
+// ======================================================================
+// \title  PcmSource.cpp
+// \author madisonw
+// \brief  Raw 16-bit PCM input from a file, pipe or TCP socket
+// ======================================================================
+
+#include "CDHDeployment/AX25Receiver/PcmSource.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace AX25Receiver {
+
+PcmSource::PcmSource() : m_fd(-1), m_havePending(false), m_pending(0) {}
+
+PcmSource::~PcmSource() {
+    this->close();
+}
+
+bool PcmSource::open(Kind kind, const char* target) {
+    FW_ASSERT(target != nullptr);
+    this->close();
+
+    if (kind == Kind::TCP) {
+        return this->openTcp(target);
+    }
+
+    m_fd = ::open(target, O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0) {
+        m_error = strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool PcmSource::openTcp(const char* target) {
+    const char* colon = strrchr(target, ':');
+    if (colon == nullptr) {
+        m_error = "expected host:port";
+        return false;
+    }
+    const std::string host(target, static_cast<size_t>(colon - target));
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* addresses = nullptr;
+    const int result = getaddrinfo(host.c_str(), colon + 1, &hints, &addresses);
+    if (result != 0) {
+        m_error = gai_strerror(result);
+        return false;
+    }
+
+    for (struct addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+        m_fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+        if (m_fd < 0) {
+            continue;
+        }
+        if (connect(m_fd, address->ai_addr, address->ai_addrlen) == 0) {
+            break;
+        }
+        m_error = strerror(errno);
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    freeaddrinfo(addresses);
+    return m_fd >= 0;
+}
+
+void PcmSource::close() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_havePending = false;
+}
+
+PcmSource::Status PcmSource::read(I16* samples, FwSizeType maxSamples, FwSizeType& count, U32 timeoutMs) {
+    FW_ASSERT(samples != nullptr);
+    FW_ASSERT(maxSamples > 0);
+    count = 0;
+    if (m_fd < 0) {
+        m_error = "source not open";
+        return Status::FAILED;
+    }
+
+    struct pollfd descriptor;
+    descriptor.fd = m_fd;
+    descriptor.events = POLLIN;
+    descriptor.revents = 0;
+    const int ready = poll(&descriptor, 1, static_cast<int>(timeoutMs));
+    if (ready == 0 || (ready < 0 && errno == EINTR)) {
+        return Status::TIMEOUT;
+    }
+    if (ready < 0) {
+        m_error = strerror(errno);
+        return Status::FAILED;
+    }
+
+    // Complete a sample split across reads before reading more
+    U8* bytes = reinterpret_cast<U8*>(samples);
+    FwSizeType offset = 0;
+    if (m_havePending) {
+        bytes[0] = m_pending;
+        offset = 1;
+    }
+
+    const ssize_t got = ::read(m_fd, &bytes[offset], maxSamples * sizeof(I16) - offset);
+    if (got < 0) {
+        if (errno == EINTR || errno == EAGAIN) {
+            return Status::TIMEOUT;
+        }
+        m_error = strerror(errno);
+        return Status::FAILED;
+    }
+    if (got == 0) {
+        return Status::END;
+    }
+
+    const FwSizeType total = offset + static_cast<FwSizeType>(got);
+    count = total / sizeof(I16);
+    m_havePending = (total % sizeof(I16)) != 0;
+    if (m_havePending) {
+        m_pending = bytes[total - 1];
+    }
+    return Status::OK;
+}
+
+}  // namespace AX25Receiver
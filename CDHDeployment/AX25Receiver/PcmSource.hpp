@@ -0,0 +1,59 @@
+// ======================================================================
+// \title  PcmSource.hpp
+// \author madisonw
+// \brief  Raw 16-bit PCM input from a file, pipe or TCP socket
+// ======================================================================
+
+#ifndef AX25Receiver_PcmSource_HPP
+#define AX25Receiver_PcmSource_HPP
+
+#include "Fw/Types/BasicTypes.hpp"
+#include <string>
+
+namespace AX25Receiver {
+
+//! Reads native-endian signed 16-bit mono PCM.
+//!
+//! FILE accepts regular files, named pipes and devices (e.g. /dev/stdin);
+//! TCP connects to "host:port" as a client. Reads wait at most the given
+//! timeout so the reader thread can notice a stop request.
+class PcmSource {
+  public:
+    enum class Kind {
+        FILE,  //!< Path to a file, FIFO or device
+        TCP    //!< "host:port" of a server streaming PCM
+    };
+
+    enum class Status {
+        OK,       //!< Samples were read
+        TIMEOUT,  //!< Nothing arrived within the timeout
+        END,      //!< The writer closed the stream
+        FAILED    //!< Read error, see getError()
+    };
+
+    PcmSource();
+    ~PcmSource();
+
+    //! Open the source; on failure getError() describes why
+    bool open(Kind kind, const char* target);
+
+    void close();
+
+    //! Read up to `maxSamples` samples into `samples`
+    Status read(I16* samples, FwSizeType maxSamples, FwSizeType& count, U32 timeoutMs);
+
+    const char* getError() const { return m_error.c_str(); }
+
+  private:
+    bool openTcp(const char* target);
+
+    int m_fd;
+    //! Odd trailing byte from the previous read, completed by the next one
+    bool m_havePending;
+    U8 m_pending;
+    std::string m_error;
+};
+
+}  // namespace AX25Receiver
+
+#endif
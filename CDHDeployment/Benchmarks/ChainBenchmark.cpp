@@ -0,0 +1,408 @@
+// ======================================================================
+// \title  ChainBenchmark.cpp
+// \author madisonw
+// \brief  End-to-end throughput of AMSATFramer and RadioBridge without a radio
+//
+// Usage: ChainBenchmark [seconds [sink]]
+//
+// Wires AMSATFramer, AX25BufferPool and RadioBridge as the topology does,
+// with RadioBridge writing raw PCM to `sink` (default /dev/null) in place
+// of rpitx, and feeds random com buffers to AMSATFramer for `seconds`
+// (default 2) per run, honouring comStatus as ComQueue does. Each run is
+// one message size and rate, either as packet-queue buffers (packed) or as
+// buffer-queue buffers (segmented). Parameters keep their defaults, so
+// frames are AFSK 1200 without FX.25.
+//
+// Prints one CSV row per run:
+//   mode,message_bytes,target_rate,messages,frames,seconds,frames_per_s,
+//   bytes_per_s,p50_us,p99_us,p999_us,allocs_per_frame
+// target_rate is com buffers per second, 0 for as fast as the chain takes
+// them. frames are those RadioBridge finished with during the run and
+// bytes are com buffer bytes AMSATFramer gave back: packed buffers on
+// arrival, segmented ones once all of their frames were rendered. Latency
+// runs from a frame leaving AMSATFramer to RadioBridge handing it back,
+// i.e. ring, scheduling and modulation. Allocations count operator new
+// anywhere in the process during the run.
+// ======================================================================
+
+#include "CDHDeployment/AMSATFramer/AMSATFramer.hpp"
+#include "CDHDeployment/AX25BufferPool/AX25BufferPool.hpp"
+#include "CDHDeployment/RadioBridge/RadioBridge.hpp"
+#include "CDHDeployment/Top/CDHDeploymentTopologyDefs.hpp"
+#include "Fw/Types/MallocAllocator.hpp"
+#include "Os/Os.hpp"
+#include "Os/Task.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<U64> g_allocations(0);
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* memory = malloc((size > 0) ? size : 1);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    free(memory);
+}
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+//! comQueue indices as in the topology: telemetry is a packet queue, the
+//! file downlink queue past it a buffer queue
+const FwIndexType PACKET_QUEUE = 1;
+const FwIndexType BUFFER_QUEUE = 2;
+//! The topology's chain sizes; the queue depth is radioBridge's in instances.fpp
+const U32 AX25_BUFFER_COUNT = CDHDeployment::AX25_BUFFER_COUNT;
+const FwSizeType RADIO_RING_CAPACITY = CDHDeployment::RADIO_RING_CAPACITY;
+const FwSizeType RADIO_QUEUE_DEPTH = 10;
+//! Com buffers that may be out at once; AMSATFramer holds at most 32
+const FwSizeType MESSAGE_BUFFERS = 40;
+const FwSizeType LARGEST_MESSAGE = 16384;
+//! Frames whose latency is kept per run, and frames in flight at once
+const FwSizeType MAX_SAMPLES = 1 << 22;
+const FwSizeType MAX_IN_FLIGHT = 2 * AX25_BUFFER_COUNT;
+//! Longer than PACK_MAX_DELAY_MS, so the last pack is closed before a drain ends
+const F64 DRAIN_QUIET_S = 1.5;
+const F64 DRAIN_TIMEOUT_S = 30.0;
+
+struct Workload {
+    const char* mode;
+    FwIndexType queue;
+    FwSizeType size;
+    U32 rate;
+};
+
+const Workload WORKLOADS[] = {
+    {"packed", PACKET_QUEUE, 16, 0},
+    {"packed", PACKET_QUEUE, 64, 0},
+    {"packed", PACKET_QUEUE, 128, 0},
+    {"packed", PACKET_QUEUE, FW_COM_BUFFER_MAX_SIZE, 0},
+    {"packed", PACKET_QUEUE, 64, 100},
+    {"segmented", BUFFER_QUEUE, 256, 0},
+    {"segmented", BUFFER_QUEUE, 1024, 0},
+    {"segmented", BUFFER_QUEUE, 4096, 0},
+    {"segmented", BUFFER_QUEUE, LARGEST_MESSAGE, 0},
+    {"segmented", BUFFER_QUEUE, 1024, 10},
+};
+
+//! Owner of the ports the chain's outputs are connected to
+class Harness : public Fw::PassiveComponentBase {
+  public:
+    Harness() : Fw::PassiveComponentBase("ChainBenchmark") {}
+};
+
+//! State shared with the port callbacks, which run on the sender's and on
+//! RadioBridge's thread
+struct Chain {
+    RadioBridge::RadioBridge* bridge;
+    std::atomic<bool> upstreamReady;
+    std::atomic<bool> measuring;
+
+    std::mutex lock;
+    //! Frames between AMSATFramer and RadioBridge: data pointer and send time
+    const U8* inFlight[MAX_IN_FLIGHT];
+    U64 sentNs[MAX_IN_FLIGHT];
+    std::vector<U64> latencyNs;
+    U64 framesOut;
+    U64 framesBack;
+    U64 frames;
+    U64 bytes;
+    Clock::time_point lastFrame;
+    std::vector<U8*> freeMessages;
+};
+
+Chain g_chain;
+
+U64 nowNs() {
+    return static_cast<U64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+
+F64 elapsed(const Clock::time_point& start) {
+    return std::chrono::duration<F64>(Clock::now() - start).count();
+}
+
+//! AMSATFramer.dataOut: note the frame and pass it on to RadioBridge.ringIn
+void frameOut(Fw::PassiveComponentBase* comp, FwIndexType portNum, Fw::Buffer& frame,
+              const ComCfg::FrameContext& context) {
+    {
+        std::lock_guard<std::mutex> guard(g_chain.lock);
+        for (FwSizeType i = 0; i < MAX_IN_FLIGHT; i++) {
+            if (g_chain.inFlight[i] == nullptr) {
+                g_chain.inFlight[i] = frame.getData();
+                g_chain.sentNs[i] = nowNs();
+                break;
+            }
+        }
+        g_chain.framesOut++;
+        g_chain.lastFrame = Clock::now();
+    }
+    g_chain.bridge->get_ringIn_InputPort(0)->invoke(frame, context);
+}
+
+//! Wired in place of RadioBridge.dataReturnOut -> AMSATFramer.dataReturnIn
+Svc::InputComDataWithContextPort* g_framerReturn = nullptr;
+
+//! RadioBridge.dataReturnOut: the frame has been rendered
+void frameBack(Fw::PassiveComponentBase* comp, FwIndexType portNum, Fw::Buffer& frame,
+               const ComCfg::FrameContext& context) {
+    const U64 backNs = nowNs();
+    {
+        std::lock_guard<std::mutex> guard(g_chain.lock);
+        for (FwSizeType i = 0; i < MAX_IN_FLIGHT; i++) {
+            if (g_chain.inFlight[i] == frame.getData()) {
+                g_chain.inFlight[i] = nullptr;
+                if (g_chain.measuring && (g_chain.latencyNs.size() < MAX_SAMPLES)) {
+                    g_chain.latencyNs.push_back(backNs - g_chain.sentNs[i]);
+                }
+                break;
+            }
+        }
+        g_chain.framesBack++;
+        if (g_chain.measuring) {
+            g_chain.frames++;
+        }
+    }
+    g_framerReturn->invoke(frame, context);
+}
+
+//! AMSATFramer.dataReturnOut: a com buffer is free again
+void messageBack(Fw::PassiveComponentBase* comp, FwIndexType portNum, Fw::Buffer& message,
+                 const ComCfg::FrameContext& context) {
+    std::lock_guard<std::mutex> guard(g_chain.lock);
+    g_chain.freeMessages.push_back(message.getData());
+    if (g_chain.measuring) {
+        g_chain.bytes += message.getSize();
+    }
+}
+
+//! AMSATFramer.comStatusOut: another com buffer may be sent
+void statusBack(Fw::PassiveComponentBase* comp, FwIndexType portNum, Fw::Success& condition) {
+    if (condition == Fw::Success::SUCCESS) {
+        g_chain.upstreamReady = true;
+    }
+}
+
+U8* takeMessage() {
+    std::lock_guard<std::mutex> guard(g_chain.lock);
+    if (g_chain.freeMessages.empty()) {
+        return nullptr;
+    }
+    U8* message = g_chain.freeMessages.back();
+    g_chain.freeMessages.pop_back();
+    return message;
+}
+
+//! Send until every frame is back and AMSATFramer has had time to close its pack
+bool drain(Svc::AMSATFramer& framer) {
+    const Clock::time_point start = Clock::now();
+    while (elapsed(start) < DRAIN_TIMEOUT_S) {
+        framer.get_schedIn_InputPort(0)->invoke(0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::lock_guard<std::mutex> guard(g_chain.lock);
+        if ((g_chain.framesBack == g_chain.framesOut) && (g_chain.freeMessages.size() == MESSAGE_BUFFERS) &&
+            (elapsed(g_chain.lastFrame) > DRAIN_QUIET_S)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+F64 percentileUs(std::vector<U64>& samples, F64 fraction) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    const FwSizeType index = FW_MIN(static_cast<FwSizeType>(fraction * samples.size()), samples.size() - 1);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return static_cast<F64>(samples[index]) / 1000.0;
+}
+
+bool run(Svc::AMSATFramer& framer, const Workload& workload, F64 seconds, std::mt19937& random) {
+    std::vector<U64> latencyNs;
+    {
+        std::lock_guard<std::mutex> guard(g_chain.lock);
+        g_chain.latencyNs.clear();
+        g_chain.frames = 0;
+        g_chain.bytes = 0;
+        // Fresh random payloads, so nothing compresses and every frame renders
+        for (U8* message : g_chain.freeMessages) {
+            for (FwSizeType i = 0; i < workload.size; i++) {
+                message[i] = static_cast<U8>(random());
+            }
+        }
+    }
+
+    ComCfg::FrameContext context;
+    context.set_comQueueIndex(workload.queue);
+    U64 messages = 0;
+    const U64 allocations = g_allocations.load();
+    g_chain.measuring = true;
+    const Clock::time_point start = Clock::now();
+    Clock::time_point next = start;
+    while (elapsed(start) < seconds) {
+        if (!g_chain.upstreamReady) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (workload.rate > 0) {
+            if (Clock::now() < next) {
+                std::this_thread::sleep_until(next);
+                continue;
+            }
+            next += std::chrono::nanoseconds(1000000000ULL / workload.rate);
+        }
+        U8* data = takeMessage();
+        if (data == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        g_chain.upstreamReady = false;
+        Fw::Buffer message(data, workload.size);
+        framer.get_dataIn_InputPort(0)->invoke(message, context);
+        messages++;
+    }
+    const F64 duration = elapsed(start);
+    g_chain.measuring = false;
+    const U64 runAllocations = g_allocations.load() - allocations;
+
+    U64 frames = 0;
+    U64 bytes = 0;
+    {
+        std::lock_guard<std::mutex> guard(g_chain.lock);
+        latencyNs.swap(g_chain.latencyNs);
+        frames = g_chain.frames;
+        bytes = g_chain.bytes;
+    }
+    const bool drained = drain(framer);
+    {
+        std::lock_guard<std::mutex> guard(g_chain.lock);
+        g_chain.latencyNs.swap(latencyNs);
+    }
+    std::vector<U64>& samples = g_chain.latencyNs;
+
+    printf("%s,%lu,%u,%llu,%llu,%.3f,%.1f,%.1f,%.1f,%.1f,%.1f,%.3f\n", workload.mode,
+           static_cast<unsigned long>(workload.size), workload.rate, static_cast<unsigned long long>(messages),
+           static_cast<unsigned long long>(frames), duration, static_cast<F64>(frames) / duration,
+           static_cast<F64>(bytes) / duration, percentileUs(samples, 0.5), percentileUs(samples, 0.99),
+           percentileUs(samples, 0.999),
+           (frames > 0) ? static_cast<F64>(runAllocations) / static_cast<F64>(frames) : 0.0);
+    fflush(stdout);
+    if (!drained) {
+        fprintf(stderr, "# %s %lu byte run did not drain\n", workload.mode, static_cast<unsigned long>(workload.size));
+    }
+    return drained;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    F64 seconds = 2.0;
+    const char* sink = "/dev/null";
+    if (argc > 1) {
+        seconds = strtod(argv[1], nullptr);
+    }
+    if (argc > 2) {
+        sink = argv[2];
+    }
+    if (seconds <= 0.0) {
+        fprintf(stderr, "# seconds must be positive\n");
+        return 1;
+    }
+
+    Os::init();
+    Fw::MallocAllocator allocator;
+    Harness harness;
+    Svc::AMSATFramer framer("amsatFramer");
+    AX25BufferPool::AX25BufferPool pool("ax25BufferPool");
+    RadioBridge::RadioBridge bridge("radioBridge");
+    g_chain.bridge = &bridge;
+    g_chain.upstreamReady = false;
+    g_chain.measuring = false;
+    std::fill(g_chain.inFlight, g_chain.inFlight + MAX_IN_FLIGHT, nullptr);
+    g_chain.framesOut = 0;
+    g_chain.framesBack = 0;
+    g_chain.lastFrame = Clock::now();
+    g_chain.latencyNs.reserve(MAX_SAMPLES);
+    g_chain.freeMessages.reserve(MESSAGE_BUFFERS);
+    std::vector<std::vector<U8>> storage(MESSAGE_BUFFERS, std::vector<U8>(LARGEST_MESSAGE));
+    for (std::vector<U8>& message : storage) {
+        g_chain.freeMessages.push_back(message.data());
+    }
+
+    framer.init(0);
+    pool.init(0);
+    bridge.init(RADIO_QUEUE_DEPTH, 0);
+
+    Svc::InputComDataWithContextPort frameOutPort;
+    Svc::InputComDataWithContextPort frameBackPort;
+    Svc::InputComDataWithContextPort messageBackPort;
+    Fw::InputSuccessConditionPort statusBackPort;
+    frameOutPort.init();
+    frameBackPort.init();
+    messageBackPort.init();
+    statusBackPort.init();
+    frameOutPort.addCallComp(&harness, frameOut);
+    frameBackPort.addCallComp(&harness, frameBack);
+    messageBackPort.addCallComp(&harness, messageBack);
+    statusBackPort.addCallComp(&harness, statusBack);
+    g_framerReturn = framer.get_dataReturnIn_InputPort(0);
+
+    // The topology's connections, with the frame path passing through the harness
+    framer.set_bufferAllocate_OutputPort(0, pool.get_bufferGetCallee_InputPort(0));
+    framer.set_bufferDeallocate_OutputPort(0, pool.get_bufferSendIn_InputPort(0));
+    framer.set_dataOut_OutputPort(0, &frameOutPort);
+    framer.set_dataReturnOut_OutputPort(0, &messageBackPort);
+    framer.set_comStatusOut_OutputPort(0, &statusBackPort);
+    bridge.set_dataReturnOut_OutputPort(0, &frameBackPort);
+    bridge.set_comStatusOut_OutputPort(0, framer.get_comStatusIn_InputPort(0));
+
+    pool.setup(0, AX25_BUFFER_COUNT, allocator);
+    framer.setBorrowedQueues(BUFFER_QUEUE);
+    framer.loadParameters();
+    bridge.loadParameters();
+    bridge.configureSink(RadioBridge::TxSink::Kind::FILE, sink);
+    bridge.configureRing(RADIO_RING_CAPACITY);
+    bridge.setQueueClass(PACKET_QUEUE, RadioBridge::TxClass::ROUTINE);
+    bridge.setQueueClass(BUFFER_QUEUE, RadioBridge::TxClass::BULK);
+    bridge.start();
+    Os::TaskString sinkName("TxSink");
+    bridge.startSink(sinkName, Os::Task::TASK_PRIORITY_DEFAULT, Os::Task::TASK_DEFAULT);
+
+    fprintf(stderr, "# %.1f s per run, sink %s\n", seconds, sink);
+    printf("mode,message_bytes,target_rate,messages,frames,seconds,frames_per_s,bytes_per_s,p50_us,p99_us,p999_us,"
+           "allocs_per_frame\n");
+    std::mt19937 random(1);
+    bool drained = true;
+    for (const Workload& workload : WORKLOADS) {
+        drained = run(framer, workload, seconds, random) && drained;
+    }
+
+    bridge.exit();
+    (void)bridge.join();
+    bridge.stopSink();
+    pool.cleanup();
+    return drained ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+// ======================================================================
+// \title  CompressionBenchmark.cpp
+// \author madisonw
+// \brief  Compression ratio and CPU time of the downlink codec
+//
+// Usage: CompressionBenchmark [recording [mtu]]
+//
+// The recording holds com packets as pack records (U16 big-endian length,
+// then the packet), e.g. cut from a GDS recv.bin. Without one, a minute of
+// TlmChan-style telemetry for the instances in CDHDeploymentPackets.fppi
+// is synthesized. Packets are packed to `mtu` (default 252) as AMSATFramer
+// does, and each pack is compressed, expanded and checked.
+//
+// Prints one CSV row per mode (single packets, then packs):
+//   mode,messages,raw_bytes,compressed_bytes,ratio,compress_us,expand_us
+// where the times are per message.
+// ======================================================================
+
+#include "CDHDeployment/AX25/Compression.hpp"
+#include "CDHDeployment/AX25/Packing.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+typedef std::vector<U8> Packet;
+
+//! Timed passes over the messages, to swamp timer resolution
+const U32 REPEATS = 200;
+
+//! Instance base id (high byte) and channel count of each packet in CDHDeploymentPackets.fppi
+struct Source {
+    U8 base;
+    U8 channels;
+};
+const Source SOURCES[] = {
+    {0x02, 2}, {0x03, 2}, {0x04, 2}, {0x05, 1}, {0x06, 5}, {0x07, 2}, {0x08, 3}, {0x09, 2},
+    {0x0A, 3}, {0x20, 1}, {0x44, 5}, {0x4A, 12}, {0x50, 10}, {0x51, 5}, {0x65, 14}, {0x66, 11},
+};
+
+void putU16(Packet& packet, U16 value) {
+    packet.push_back(static_cast<U8>(value >> 8));
+    packet.push_back(static_cast<U8>(value));
+}
+
+void putU32(Packet& packet, U32 value) {
+    putU16(packet, static_cast<U16>(value >> 16));
+    putU16(packet, static_cast<U16>(value));
+}
+
+//! One TlmChan packet per channel per second: descriptor, channel id, time
+//! tag and a U32 value that mostly counts slowly
+void synthesize(std::vector<Packet>& packets) {
+    U32 counter = 0;
+    for (U32 second = 0; second < 60; second++) {
+        for (const Source& source : SOURCES) {
+            for (U8 channel = 0; channel < source.channels; channel++) {
+                Packet packet;
+                putU16(packet, 1);
+                putU32(packet, (static_cast<U32>(source.base) << 8) | channel);
+                putU16(packet, 2);
+                packet.push_back(0);
+                putU32(packet, 1760000000U + second);
+                putU32(packet, static_cast<U32>(rand()) % 1000000U);
+                putU32(packet, ((channel % 3) == 0) ? static_cast<U32>(rand()) : (counter++ / 7));
+                packets.push_back(packet);
+            }
+        }
+    }
+}
+
+bool load(const char* path, std::vector<Packet>& packets) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    std::vector<U8> bytes;
+    U8 chunk[4096];
+    size_t got = 0;
+    while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        bytes.insert(bytes.end(), chunk, chunk + got);
+    }
+    fclose(file);
+
+    AX25::PackReader reader(bytes.data(), bytes.size());
+    const U8* data = nullptr;
+    FwSizeType size = 0;
+    while (reader.next(data, size)) {
+        packets.push_back(Packet(data, data + size));
+    }
+    return reader.isComplete();
+}
+
+void report(const char* mode, const std::vector<Packet>& messages) {
+    static AX25::Compressor compressor;
+    std::vector<U8> out(AX25::Compressor::MAX_INPUT);
+    std::vector<U8> back(AX25::Compressor::MAX_INPUT);
+
+    // Sizes and a round-trip check first, then the timed passes
+    U64 rawBytes = 0;
+    U64 compressedBytes = 0;
+    std::vector<Packet> compressed;
+    for (const Packet& message : messages) {
+        const FwSizeType size = compressor.compress(message.data(), message.size(), out.data(), out.size());
+        rawBytes += message.size();
+        if (size == 0) {
+            compressedBytes += message.size();
+            continue;
+        }
+        compressedBytes += size;
+        compressed.push_back(Packet(out.begin(), out.begin() + size));
+        const FwSizeType expanded = AX25::Compressor::expand(out.data(), size, back.data(), back.size());
+        if ((expanded != message.size()) || (memcmp(back.data(), message.data(), expanded) != 0)) {
+            fprintf(stderr, "# %s: round trip failed\n", mode);
+            exit(1);
+        }
+    }
+
+    volatile FwSizeType sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (U32 pass = 0; pass < REPEATS; pass++) {
+        for (const Packet& message : messages) {
+            sink = compressor.compress(message.data(), message.size(), out.data(), out.size());
+        }
+    }
+    const F64 compressSeconds = std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (U32 pass = 0; pass < REPEATS; pass++) {
+        for (const Packet& message : compressed) {
+            sink = AX25::Compressor::expand(message.data(), message.size(), back.data(), back.size());
+        }
+    }
+    const F64 expandSeconds = std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+    (void)sink;
+
+    printf("%s,%lu,%lu,%lu,%.3f,%.2f,%.2f\n", mode, static_cast<unsigned long>(messages.size()),
+           static_cast<unsigned long>(rawBytes), static_cast<unsigned long>(compressedBytes),
+           static_cast<F64>(rawBytes) / static_cast<F64>(compressedBytes),
+           compressSeconds * 1e6 / static_cast<F64>(REPEATS * messages.size()),
+           compressed.empty() ? 0.0 : expandSeconds * 1e6 / static_cast<F64>(REPEATS * compressed.size()));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<Packet> packets;
+    if (argc > 1) {
+        if (!load(argv[1], packets)) {
+            fprintf(stderr, "# %s is not a sequence of length-prefixed packets\n", argv[1]);
+            return 1;
+        }
+    } else {
+        synthesize(packets);
+    }
+    FwSizeType mtu = 252;
+    if (argc > 2) {
+        mtu = static_cast<FwSizeType>(strtoul(argv[2], nullptr, 0));
+    }
+    if ((mtu < AX25::packedSize(1)) || (mtu > AX25::Compressor::MAX_INPUT)) {
+        fprintf(stderr, "# mtu must be %lu to %lu\n", static_cast<unsigned long>(AX25::packedSize(1)),
+                static_cast<unsigned long>(AX25::Compressor::MAX_INPUT));
+        return 1;
+    }
+
+    // Packed the way AMSATFramer fills packs up to PACK_MTU
+    std::vector<Packet> packs;
+    Packet pack(AX25::Compressor::MAX_INPUT);
+    FwSizeType used = 0;
+    for (const Packet& packet : packets) {
+        if (AX25::packedSize(packet.size()) > AX25::Compressor::MAX_INPUT) {
+            continue;
+        }
+        if ((used > 0) && (used + AX25::packedSize(packet.size()) > mtu)) {
+            packs.push_back(Packet(pack.begin(), pack.begin() + used));
+            used = 0;
+        }
+        AX25::packAppend(pack.data(), used, packet.data(), packet.size());
+    }
+    if (used > 0) {
+        packs.push_back(Packet(pack.begin(), pack.begin() + used));
+    }
+
+    fprintf(stderr, "# %lu packets, %lu byte preset dictionary\n", static_cast<unsigned long>(packets.size()),
+            static_cast<unsigned long>(AX25::Compressor::dictionarySize()));
+    printf("mode,messages,raw_bytes,compressed_bytes,ratio,compress_us,expand_us\n");
+    report("packet", packets);
+    report("pack", packs);
+    return 0;
+}
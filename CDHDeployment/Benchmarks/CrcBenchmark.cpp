@@ -0,0 +1,70 @@
+// ======================================================================
+// \title  CrcBenchmark.cpp
+// \author madisonw
+// \brief  Compares the AX.25 FCS engines on typical frame sizes
+//
+// Prints one CSV row per engine and frame size:
+//   engine,frame_bytes,ns_per_frame,mb_per_s
+// ======================================================================
+
+#include "CDHDeployment/AX25/Crc16.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const FwSizeType FRAME_SIZES[] = {20, 32, 64, 128, 192, 256};
+const AX25::Crc16::Engine ENGINES[] = {AX25::Crc16::Engine::TABLE, AX25::Crc16::Engine::SLICE_BY_8,
+                                       AX25::Crc16::Engine::CLMUL};
+
+//! Enough work per measurement to swamp timer resolution
+const U64 BYTES_PER_RUN = 64ULL * 1024 * 1024;
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    U64 bytesPerRun = BYTES_PER_RUN;
+    if (argc > 1) {
+        bytesPerRun = strtoull(argv[1], nullptr, 0);
+    }
+
+    U8 frame[256];
+    for (FwSizeType i = 0; i < sizeof(frame); i++) {
+        frame[i] = static_cast<U8>(rand());
+    }
+
+    const U16 expected = AX25::Crc16::compute(frame, sizeof(frame));
+    printf("engine,frame_bytes,ns_per_frame,mb_per_s\n");
+
+    for (AX25::Crc16::Engine engine : ENGINES) {
+        if (!AX25::Crc16::isSupported(engine)) {
+            fprintf(stderr, "# %s not supported on this CPU, skipped\n", AX25::Crc16::engineName(engine));
+            continue;
+        }
+        if (AX25::Crc16::finish(AX25::Crc16::update(AX25::Crc16::INITIAL, frame, sizeof(frame), engine)) != expected) {
+            fprintf(stderr, "# %s produced a wrong FCS\n", AX25::Crc16::engineName(engine));
+            return 1;
+        }
+
+        for (FwSizeType size : FRAME_SIZES) {
+            const U64 iterations = bytesPerRun / size;
+            volatile U16 sink = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+            for (U64 i = 0; i < iterations; i++) {
+                sink = AX25::Crc16::update(AX25::Crc16::INITIAL, frame, size, engine);
+            }
+            const auto stop = std::chrono::steady_clock::now();
+            (void)sink;
+
+            const F64 seconds = std::chrono::duration<F64>(stop - start).count();
+            printf("%s,%lu,%.2f,%.1f\n", AX25::Crc16::engineName(engine), static_cast<unsigned long>(size),
+                   seconds * 1e9 / static_cast<F64>(iterations),
+                   static_cast<F64>(iterations * size) / seconds / 1e6);
+        }
+    }
+
+    fprintf(stderr, "# default engine: %s\n", AX25::Crc16::engineName(AX25::Crc16::getEngine()));
+    return 0;
+}
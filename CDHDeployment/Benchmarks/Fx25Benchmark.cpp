@@ -0,0 +1,206 @@
+// ======================================================================
+// \title  Fx25Benchmark.cpp
+// \author madisonw
+// \brief  FX.25 codec throughput and frame recovery under bit errors
+//
+// Usage: Fx25Benchmark [frames]
+//
+// Frames are full downlink segments of random data, sized to the stride
+// AMSATFramer uses for each number of check bytes. Prints two CSV tables:
+//
+//   roots,encode_MBps,decode_MBps,correct_MBps
+// Reed-Solomon throughput over data bytes: encoding, decoding clean blocks
+// and decoding blocks with roots/4 byte errors.
+//
+//   ber,roots,frames,ax25_recovered,fx25_recovered
+// Frames recovered at each bit error rate when sent as plain AX.25 and as
+// FX.25 blocks, with errors injected into the decoded bit stream that
+// HdlcDeframer sees (default 2000 frames per point).
+// ======================================================================
+
+#include "CDHDeployment/AX25/Crc16.hpp"
+#include "CDHDeployment/AX25/Fx25.hpp"
+#include "CDHDeployment/AX25/HdlcDeframer.hpp"
+#include "CDHDeployment/AX25/ReedSolomon.hpp"
+#include "CDHDeployment/AX25/Segmentation.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+typedef std::vector<U8> Bytes;
+
+const FwSizeType ROOTS[] = {16, 32, 64};
+const F64 BIT_ERROR_RATES[] = {0.0, 1e-4, 5e-4, 1e-3, 2e-3, 5e-3, 1e-2};
+//! Address/control/PID, segment header and FCS around the segment payload
+const FwSizeType FRAME_OVERHEAD = 16 + AX25::SegmentHeader::SIZE + 2;
+//! Blocks per timed pass
+const U32 BLOCKS = 20000;
+
+std::mt19937 s_random(1);
+
+//! Frame body (address through FCS) with `payload` random segment payload bytes
+Bytes makeBody(FwSizeType payload) {
+    Bytes body(FRAME_OVERHEAD + payload);
+    for (FwSizeType i = 0; i < body.size() - 2; i++) {
+        body[i] = static_cast<U8>(s_random());
+    }
+    const U16 fcs = AX25::Crc16::compute(body.data(), body.size() - 2);
+    body[body.size() - 2] = static_cast<U8>(fcs);
+    body[body.size() - 1] = static_cast<U8>(fcs >> 8);
+    return body;
+}
+
+//! Plain AX.25 on air: flag, stuffed body, flag, LSB first
+std::vector<bool> hdlcBits(const Bytes& body) {
+    std::vector<bool> bits;
+    for (U32 bit = 0; bit < 8; bit++) {
+        bits.push_back(((0x7E >> bit) & 0x01) != 0);
+    }
+    U32 ones = 0;
+    for (const U8 byte : body) {
+        for (U32 bit = 0; bit < 8; bit++) {
+            const bool one = ((byte >> bit) & 0x01) != 0;
+            bits.push_back(one);
+            ones = one ? (ones + 1) : 0;
+            if (ones == 5) {
+                bits.push_back(false);
+                ones = 0;
+            }
+        }
+    }
+    for (U32 bit = 0; bit < 8; bit++) {
+        bits.push_back(((0x7E >> bit) & 0x01) != 0);
+    }
+    return bits;
+}
+
+//! FX.25 on air: flag, block, flag
+std::vector<bool> fx25Bits(FwSizeType roots, const Bytes& body) {
+    U8 block[AX25::Fx25::MAX_BLOCK_SIZE];
+    const AX25::Fx25::Piece piece = {body.data(), body.size()};
+    const FwSizeType size = AX25::Fx25::encode(roots, &piece, 1, block);
+    if (size == 0) {
+        fprintf(stderr, "# %lu byte body does not fit %lu check bytes\n", static_cast<unsigned long>(body.size()),
+                static_cast<unsigned long>(roots));
+        exit(1);
+    }
+    std::vector<bool> bits;
+    for (U32 bit = 0; bit < 8; bit++) {
+        bits.push_back(((0x7E >> bit) & 0x01) != 0);
+    }
+    for (FwSizeType i = 0; i < size; i++) {
+        for (U32 bit = 0; bit < 8; bit++) {
+            bits.push_back(((block[i] >> bit) & 0x01) != 0);
+        }
+    }
+    for (U32 bit = 0; bit < 8; bit++) {
+        bits.push_back(((0x7E >> bit) & 0x01) != 0);
+    }
+    return bits;
+}
+
+void countFrame(void* context, const U8* frame, FwSizeType size) {
+    (void)frame;
+    (void)size;
+    (*static_cast<U32*>(context))++;
+}
+
+//! Frames recovered from the transmissions, each sent once with its own errors
+U32 recover(const std::vector<std::vector<bool>>& transmissions, F64 ber) {
+    U32 recovered = 0;
+    AX25::HdlcDeframer deframer(countFrame, &recovered);
+    std::bernoulli_distribution flip(ber);
+    for (const std::vector<bool>& bits : transmissions) {
+        deframer.reset();
+        for (const bool bit : bits) {
+            deframer.pushBit((ber > 0.0) && flip(s_random) ? !bit : bit);
+        }
+    }
+    return recovered;
+}
+
+void throughput(FwSizeType roots) {
+    const AX25::ReedSolomon& rs = AX25::Fx25::codec(roots);
+    const FwSizeType dataSize = rs.getDataSize();
+    std::vector<Bytes> clean(64, Bytes(AX25::ReedSolomon::BLOCK_SIZE));
+    for (Bytes& codeword : clean) {
+        for (FwSizeType i = 0; i < dataSize; i++) {
+            codeword[i] = static_cast<U8>(s_random());
+        }
+        rs.encode(codeword.data(), dataSize, &codeword[dataSize]);
+    }
+    std::vector<Bytes> damaged = clean;
+    for (Bytes& codeword : damaged) {
+        for (FwSizeType e = 0; e < roots / 4; e++) {
+            codeword[s_random() % codeword.size()] ^= static_cast<U8>(1 + s_random() % 255);
+        }
+    }
+
+    U8 parity[AX25::ReedSolomon::MAX_ROOTS];
+    auto start = std::chrono::steady_clock::now();
+    for (U32 i = 0; i < BLOCKS; i++) {
+        rs.encode(clean[i % clean.size()].data(), dataSize, parity);
+    }
+    const F64 encodeSeconds = std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+
+    Bytes work(AX25::ReedSolomon::BLOCK_SIZE);
+    F64 seconds[2] = {0.0, 0.0};
+    const std::vector<Bytes>* sets[2] = {&clean, &damaged};
+    for (U32 set = 0; set < 2; set++) {
+        start = std::chrono::steady_clock::now();
+        for (U32 i = 0; i < BLOCKS; i++) {
+            const Bytes& codeword = (*sets[set])[i % sets[set]->size()];
+            memcpy(work.data(), codeword.data(), work.size());
+            if (rs.decode(work.data()) < 0) {
+                fprintf(stderr, "# %lu check bytes: decode failed\n", static_cast<unsigned long>(roots));
+                exit(1);
+            }
+        }
+        seconds[set] = std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const F64 megabytes = static_cast<F64>(BLOCKS) * static_cast<F64>(dataSize) / 1e6;
+    printf("%lu,%.1f,%.1f,%.1f\n", static_cast<unsigned long>(roots), megabytes / encodeSeconds,
+           megabytes / seconds[0], megabytes / seconds[1]);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    U32 frames = 2000;
+    if (argc > 1) {
+        frames = static_cast<U32>(strtoul(argv[1], nullptr, 0));
+    }
+    if (frames == 0) {
+        fprintf(stderr, "# frames must be positive\n");
+        return 1;
+    }
+
+    printf("roots,encode_MBps,decode_MBps,correct_MBps\n");
+    for (const FwSizeType roots : ROOTS) {
+        throughput(roots);
+    }
+
+    printf("ber,roots,frames,ax25_recovered,fx25_recovered\n");
+    for (const FwSizeType roots : ROOTS) {
+        // A full segment at the stride AMSATFramer uses with this code
+        const FwSizeType stride = FW_MIN(AX25::MAX_SEGMENT_PAYLOAD, AX25::Fx25::maxBody(roots) - FRAME_OVERHEAD);
+        std::vector<std::vector<bool>> plain;
+        std::vector<std::vector<bool>> coded;
+        for (U32 i = 0; i < frames; i++) {
+            const Bytes body = makeBody(stride);
+            plain.push_back(hdlcBits(body));
+            coded.push_back(fx25Bits(roots, body));
+        }
+        for (const F64 ber : BIT_ERROR_RATES) {
+            printf("%g,%lu,%u,%u,%u\n", ber, static_cast<unsigned long>(roots), frames, recover(plain, ber),
+                   recover(coded, ber));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+// ======================================================================
+// \title  G3ruhBenchmark.cpp
+// \author madisonw
+// \brief  G3RUH 9600 baud modem throughput and loopback decoding
+//
+// Usage: G3ruhBenchmark [frames]
+//
+// Frames are random 256-byte AX.25 bodies rendered back to back at 48 kHz.
+// Prints two CSV tables:
+//
+//   stage,samples,msamples_per_s,realtime_factor
+// Time to modulate the frames, to low-pass filter them with Dsp::fir alone
+// and to demodulate and deframe them; realtime_factor is audio time over
+// wall time, so anything above 1 keeps up with 9600 baud.
+//
+//   noise_rms,clock_ppm,frames,recovered
+// Frames decoded in loopback with white Gaussian noise added to the
+// baseband and the receiver's sample clock off by clock_ppm
+// (default 200 frames per point).
+// ======================================================================
+
+#include "CDHDeployment/AX25/Crc16.hpp"
+#include "CDHDeployment/AX25/Dsp.hpp"
+#include "CDHDeployment/AX25/G3ruhDemodulator.hpp"
+#include "CDHDeployment/AX25/G3ruhModulator.hpp"
+#include "CDHDeployment/AX25/HdlcDeframer.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+typedef std::vector<I16> Samples;
+
+const FwSizeType BODY_SIZE = 256;
+const F64 NOISE_RMS[] = {0.0, 2000.0, 4000.0, 6000.0, 8000.0};
+//! Receiver sample rates: exact, and 10 Hz fast (about 208 ppm)
+const U32 RX_SAMPLE_RATES[] = {48000, 48010};
+//! Timed passes over the rendered audio
+const U32 PASSES = 10;
+//! Length of the G3ruhDemodulator receive filter
+const U32 FIR_TAPS = 48;
+
+std::mt19937 s_random(1);
+
+//! Key-up and tail flags around the frames, enough for the receiver to lock
+//! on and to flush its filter
+const U32 TX_DELAY_FLAGS = 32;
+const U32 TX_TAIL_FLAGS = 4;
+
+//! All frames with their flags, between key-up and tail flags
+Samples render(AX25::G3ruhModulator& modulator, U32 frames) {
+    Samples pcm(modulator.maxSamples(BODY_SIZE, 1) * frames +
+                modulator.maxSamples(0, TX_DELAY_FLAGS + TX_TAIL_FLAGS));
+    U8 body[BODY_SIZE];
+    modulator.reset();
+    FwSizeType used = modulator.renderFlags(TX_DELAY_FLAGS, pcm.data(), pcm.size());
+    for (U32 frame = 0; frame < frames; frame++) {
+        for (FwSizeType i = 0; i < BODY_SIZE - 2; i++) {
+            body[i] = static_cast<U8>(s_random());
+        }
+        const U16 fcs = AX25::Crc16::compute(body, BODY_SIZE - 2);
+        body[BODY_SIZE - 2] = static_cast<U8>(fcs);
+        body[BODY_SIZE - 1] = static_cast<U8>(fcs >> 8);
+        used += modulator.renderBody(body, BODY_SIZE, &pcm[used], pcm.size() - used);
+        used += modulator.renderFlags(1, &pcm[used], pcm.size() - used);
+    }
+    used += modulator.renderFlags(TX_TAIL_FLAGS, &pcm[used], pcm.size() - used);
+    pcm.resize(used);
+    return pcm;
+}
+
+void countFrame(void* context, const U8* frame, FwSizeType size) {
+    (void)frame;
+    (void)size;
+    (*static_cast<U32*>(context))++;
+}
+
+void report(const char* stage, FwSizeType samples, F64 seconds) {
+    const F64 total = static_cast<F64>(samples) * PASSES;
+    printf("%s,%lu,%.2f,%.1f\n", stage, static_cast<unsigned long>(samples), total / seconds / 1e6,
+           total / AX25::Modulator::SAMPLE_RATE / seconds);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    U32 frames = 200;
+    if (argc > 1) {
+        frames = static_cast<U32>(strtoul(argv[1], nullptr, 0));
+    }
+    if (frames == 0) {
+        fprintf(stderr, "# frames must be positive\n");
+        return 1;
+    }
+
+    AX25::G3ruhModulator modulator;
+    printf("stage,samples,msamples_per_s,realtime_factor\n");
+
+    auto start = std::chrono::steady_clock::now();
+    Samples pcm;
+    for (U32 pass = 0; pass < PASSES; pass++) {
+        pcm = render(modulator, frames);
+    }
+    report("modulate", pcm.size(), std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count());
+
+    // The receive filter on its own, fed the whole capture at once
+    alignas(16) I16 taps[FIR_TAPS];
+    for (I16& tap : taps) {
+        tap = 32767 / FIR_TAPS;
+    }
+    std::vector<I32> filtered(pcm.size());
+    Samples padded(pcm.size() + FIR_TAPS - 1, 0);
+    std::copy(pcm.begin(), pcm.end(), padded.begin() + FIR_TAPS - 1);
+    start = std::chrono::steady_clock::now();
+    for (U32 pass = 0; pass < PASSES; pass++) {
+        AX25::Dsp::fir(padded.data(), pcm.size(), taps, FIR_TAPS, filtered.data());
+    }
+    report("fir", pcm.size(), std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count());
+
+    U32 recovered = 0;
+    AX25::HdlcDeframer deframer(countFrame, &recovered);
+    AX25::G3ruhDemodulator demodulator;
+    start = std::chrono::steady_clock::now();
+    for (U32 pass = 0; pass < PASSES; pass++) {
+        demodulator.reset();
+        deframer.reset();
+        demodulator.process(pcm.data(), pcm.size(), deframer);
+    }
+    report("demodulate", pcm.size(), std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count());
+    if (recovered != frames * PASSES) {
+        fprintf(stderr, "# clean loopback decoded %u of %u frames\n", recovered, frames * PASSES);
+        return 1;
+    }
+
+    printf("noise_rms,clock_ppm,frames,recovered\n");
+    for (const U32 rate : RX_SAMPLE_RATES) {
+        AX25::G3ruhDemodulator::Config config;
+        config.sampleRate = rate;
+        AX25::G3ruhDemodulator receiver(config);
+        const F64 ppm =
+            1e6 * (static_cast<F64>(rate) - AX25::Modulator::SAMPLE_RATE) / AX25::Modulator::SAMPLE_RATE;
+        for (const F64 rms : NOISE_RMS) {
+            std::normal_distribution<F64> noise(0.0, rms);
+            Samples noisy(pcm.size());
+            for (FwSizeType i = 0; i < pcm.size(); i++) {
+                const F64 value = pcm[i] + ((rms > 0.0) ? noise(s_random) : 0.0);
+                noisy[i] = static_cast<I16>(std::fmax(-32768.0, std::fmin(32767.0, value)));
+            }
+            recovered = 0;
+            receiver.reset();
+            deframer.reset();
+            receiver.process(noisy.data(), noisy.size(), deframer);
+            printf("%.0f,%.0f,%u,%u\n", rms, ppm, frames, recovered);
+        }
+    }
+    return 0;
+}
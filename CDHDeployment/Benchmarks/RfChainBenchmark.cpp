@@ -0,0 +1,166 @@
+// ======================================================================
+// \title  RfChainBenchmark.cpp
+// \author madisonw
+// \brief  Throughput of the in-process PCM to rpitx RF sample chain
+//
+// Usage: RfChainBenchmark [seconds]
+//
+// Converts `seconds` of random 48 kHz PCM (default 10) and prints one CSV
+// table:
+//
+//   stage,samples,msamples_per_s,realtime_factor
+// Each Dsp kernel on its own over the whole buffer (convert, gain,
+// resample to 24 kHz and to 44.1 kHz, rf), the three csdr stages run one
+// after another over the whole buffer (unfused), and RfChain running them
+// fused a block at a time, at 48 kHz out and resampling to 24 kHz.
+// samples counts input PCM; realtime_factor is audio time over wall time.
+// ======================================================================
+
+#include "CDHDeployment/AX25/Dsp.hpp"
+#include "CDHDeployment/AX25/Resampler.hpp"
+#include "CDHDeployment/AX25/RfChain.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+const U32 SAMPLE_RATE = 48000;
+const F32 DEVIATION_HZ = 7000.0f;
+const U32 PERIOD_NS = 20833;
+//! Timed passes over the buffer
+const U32 PASSES = 10;
+
+//! Seconds since `start`
+F64 elapsed(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* stage, FwSizeType samples, F64 seconds) {
+    const F64 total = static_cast<F64>(samples) * PASSES;
+    printf("%s,%lu,%.2f,%.1f\n", stage, static_cast<unsigned long>(samples), total / seconds / 1e6,
+           total / SAMPLE_RATE / seconds);
+}
+
+//! Resample the whole buffer a block at a time
+FwSizeType resampleAll(AX25::Resampler& resampler, const std::vector<F32>& in, std::vector<F32>& out) {
+    FwSizeType produced = 0;
+    for (FwSizeType n = 0; n < in.size(); n += AX25::Resampler::BLOCK) {
+        const FwSizeType block = FW_MIN(static_cast<FwSizeType>(AX25::Resampler::BLOCK), in.size() - n);
+        std::copy(&in[n], &in[n] + block, resampler.block());
+        produced += resampler.process(block, &out[produced]);
+    }
+    return produced;
+}
+
+//! Run RfChain over the whole buffer, keeping the last block's output
+FwSizeType chainAll(AX25::RfChain& chain, const std::vector<I16>& pcm, std::vector<AX25::Dsp::RfSample>& out) {
+    FwSizeType produced = 0;
+    for (FwSizeType n = 0; n < pcm.size(); n += AX25::RfChain::BLOCK) {
+        const FwSizeType block = FW_MIN(static_cast<FwSizeType>(AX25::RfChain::BLOCK), pcm.size() - n);
+        produced += chain.process(&pcm[n], block, out.data());
+    }
+    return produced;
+}
+
+void timeResampler(const char* stage, U32 outputRate, const std::vector<F32>& in) {
+    AX25::Resampler resampler;
+    resampler.configure(SAMPLE_RATE, outputRate);
+    std::vector<F32> out(resampler.maxOutput(in.size()) + AX25::Resampler::BLOCK);
+    const auto start = std::chrono::steady_clock::now();
+    for (U32 pass = 0; pass < PASSES; pass++) {
+        resampler.reset();
+        (void)resampleAll(resampler, in, out);
+    }
+    report(stage, in.size(), elapsed(start));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    U32 seconds = 10;
+    if (argc > 1) {
+        seconds = static_cast<U32>(strtoul(argv[1], nullptr, 0));
+    }
+    if (seconds == 0) {
+        fprintf(stderr, "# seconds must be positive\n");
+        return 1;
+    }
+
+    std::mt19937 random(1);
+    std::vector<I16> pcm(static_cast<FwSizeType>(seconds) * SAMPLE_RATE);
+    for (I16& sample : pcm) {
+        sample = static_cast<I16>(random());
+    }
+    std::vector<F32> frequency(pcm.size());
+    std::vector<AX25::Dsp::RfSample> rf(pcm.size());
+
+    printf("stage,samples,msamples_per_s,realtime_factor\n");
+
+    auto start = std::chrono::steady_clock::now();
+    for (U32 pass = 0; pass < PASSES; pass++) {
+        AX25::Dsp::toFloat(pcm.data(), pcm.size(), 1.0f / 32768.0f, frequency.data());
+    }
+    report("convert", pcm.size(), elapsed(start));
+
+    start = std::chrono::steady_clock::now();
+    for (U32 pass = 0; pass < PASSES; pass++) {
+        AX25::Dsp::scale(frequency.data(), frequency.size(), 1.0f);
+    }
+    report("gain", pcm.size(), elapsed(start));
+
+    timeResampler("resample_24000", 24000, frequency);
+    timeResampler("resample_44100", 44100, frequency);
+
+    start = std::chrono::steady_clock::now();
+    for (U32 pass = 0; pass < PASSES; pass++) {
+        AX25::Dsp::toRfSamples(frequency.data(), frequency.size(), PERIOD_NS, rf.data());
+    }
+    report("rf", pcm.size(), elapsed(start));
+
+    // What the csdr pipeline did, minus the pipes: a full pass per stage
+    start = std::chrono::steady_clock::now();
+    for (U32 pass = 0; pass < PASSES; pass++) {
+        AX25::Dsp::toFloat(pcm.data(), pcm.size(), 1.0f / 32768.0f, frequency.data());
+        AX25::Dsp::scale(frequency.data(), frequency.size(), DEVIATION_HZ);
+        AX25::Dsp::toRfSamples(frequency.data(), frequency.size(), PERIOD_NS, rf.data());
+    }
+    report("unfused", pcm.size(), elapsed(start));
+
+    AX25::RfChain chain;
+    std::vector<AX25::Dsp::RfSample> block(chain.maxOutput());
+    start = std::chrono::steady_clock::now();
+    for (U32 pass = 0; pass < PASSES; pass++) {
+        chain.reset();
+        (void)chainAll(chain, pcm, block);
+    }
+    report("fused", pcm.size(), elapsed(start));
+
+    // The fused chain must match the unfused stages it replaces
+    chain.reset();
+    for (FwSizeType n = 0; n < pcm.size(); n += AX25::RfChain::BLOCK) {
+        const FwSizeType count = FW_MIN(static_cast<FwSizeType>(AX25::RfChain::BLOCK), pcm.size() - n);
+        (void)chain.process(&pcm[n], count, block.data());
+        for (FwSizeType i = 0; i < count; i++) {
+            if ((std::fabs(block[i].frequency - rf[n + i].frequency) > 1e-2) || (block[i].periodNs != PERIOD_NS)) {
+                fprintf(stderr, "# fused chain differs at sample %lu\n", static_cast<unsigned long>(n + i));
+                return 1;
+            }
+        }
+    }
+
+    AX25::RfChain::Config config;
+    config.outputRate = 24000;
+    chain.configure(config);
+    block.resize(chain.maxOutput());
+    start = std::chrono::steady_clock::now();
+    for (U32 pass = 0; pass < PASSES; pass++) {
+        chain.reset();
+        (void)chainAll(chain, pcm, block);
+    }
+    report("fused_24000", pcm.size(), elapsed(start));
+    return 0;
+}
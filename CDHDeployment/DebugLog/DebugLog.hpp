@@ -0,0 +1,67 @@
+// ======================================================================
+// \title  DebugLog.hpp
+// \author madisonw
+// \brief  Compile-time leveled diagnostics for the AMSAT chain
+// ======================================================================
+
+#ifndef DebugLog_DebugLog_HPP
+#define DebugLog_DebugLog_HPP
+
+#include "CDHDeployment/DebugLog/RingLogger.hpp"
+
+// Verbosity levels; a statement above AMSAT_LOG_LEVEL compiles to nothing,
+// arguments included
+#define AMSAT_LOG_LEVEL_NONE 0
+#define AMSAT_LOG_LEVEL_ERROR 1
+#define AMSAT_LOG_LEVEL_WARN 2
+#define AMSAT_LOG_LEVEL_INFO 3
+#define AMSAT_LOG_LEVEL_DEBUG 4
+#define AMSAT_LOG_LEVEL_TRACE 5
+
+// Flight (NDEBUG) builds carry no diagnostics unless a level is given explicitly
+#ifndef AMSAT_LOG_LEVEL
+#ifdef NDEBUG
+#define AMSAT_LOG_LEVEL AMSAT_LOG_LEVEL_NONE
+#else
+#define AMSAT_LOG_LEVEL AMSAT_LOG_LEVEL_INFO
+#endif
+#endif
+
+#define AMSAT_LOG_DISCARD() \
+    do {                    \
+    } while (0)
+
+#if AMSAT_LOG_LEVEL >= AMSAT_LOG_LEVEL_ERROR
+#define AMSAT_LOG_ERROR(...) DebugLog::RingLogger::getInstance().log(DebugLog::Level::Error, __VA_ARGS__)
+#else
+#define AMSAT_LOG_ERROR(...) AMSAT_LOG_DISCARD()
+#endif
+
+#if AMSAT_LOG_LEVEL >= AMSAT_LOG_LEVEL_WARN
+#define AMSAT_LOG_WARN(...) DebugLog::RingLogger::getInstance().log(DebugLog::Level::Warning, __VA_ARGS__)
+#else
+#define AMSAT_LOG_WARN(...) AMSAT_LOG_DISCARD()
+#endif
+
+#if AMSAT_LOG_LEVEL >= AMSAT_LOG_LEVEL_INFO
+#define AMSAT_LOG_INFO(...) DebugLog::RingLogger::getInstance().log(DebugLog::Level::Info, __VA_ARGS__)
+#else
+#define AMSAT_LOG_INFO(...) AMSAT_LOG_DISCARD()
+#endif
+
+#if AMSAT_LOG_LEVEL >= AMSAT_LOG_LEVEL_DEBUG
+#define AMSAT_LOG_DEBUG(...) DebugLog::RingLogger::getInstance().log(DebugLog::Level::Debug, __VA_ARGS__)
+#else
+#define AMSAT_LOG_DEBUG(...) AMSAT_LOG_DISCARD()
+#endif
+
+#if AMSAT_LOG_LEVEL >= AMSAT_LOG_LEVEL_TRACE
+#define AMSAT_LOG_TRACE(...) DebugLog::RingLogger::getInstance().log(DebugLog::Level::Trace, __VA_ARGS__)
+#define AMSAT_LOG_HEXDUMP(label, data, size) \
+    DebugLog::RingLogger::getInstance().hexdump(DebugLog::Level::Trace, label, data, size)
+#else
+#define AMSAT_LOG_TRACE(...) AMSAT_LOG_DISCARD()
+#define AMSAT_LOG_HEXDUMP(label, data, size) AMSAT_LOG_DISCARD()
+#endif
+
+#endif
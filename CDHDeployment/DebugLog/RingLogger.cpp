@@ -0,0 +1,139 @@
+// ======================================================================
+// \title  RingLogger.cpp
+// \author madisonw
+// \brief  Non-blocking diagnostic log drained by a background task
+// ======================================================================
+
+#include "CDHDeployment/DebugLog/RingLogger.hpp"
+#include "Fw/Time/TimeInterval.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <cstdarg>
+#include <cstdio>
+
+namespace DebugLog {
+
+namespace {
+const char* const LEVEL_TAGS[] = {"ERROR", "WARN", "INFO", "DEBUG", "TRACE"};
+}
+
+static_assert((RingLogger::LINE_COUNT & (RingLogger::LINE_COUNT - 1)) == 0, "LINE_COUNT must be a power of two");
+
+RingLogger& RingLogger::getInstance() {
+    static RingLogger instance;
+    return instance;
+}
+
+RingLogger::RingLogger() : m_claimPosition(0), m_drainPosition(0), m_drops(0), m_reportedDrops(0), m_running(false) {
+    for (FwSizeType i = 0; i < LINE_COUNT; i++) {
+        m_lines[i].sequence.store(static_cast<U32>(i), std::memory_order_relaxed);
+    }
+}
+
+RingLogger::Line* RingLogger::claim(U32& position) {
+    position = m_claimPosition.load(std::memory_order_relaxed);
+    while (true) {
+        Line& line = m_lines[position & (LINE_COUNT - 1)];
+        const I32 lag = static_cast<I32>(line.sequence.load(std::memory_order_acquire) - position);
+        if (lag == 0) {
+            if (m_claimPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return &line;
+            }
+        } else if (lag < 0) {
+            // The drain task has not caught up with this slot yet
+            m_drops.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = m_claimPosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void RingLogger::publish(Line* line, U32 position) {
+    line->sequence.store(position + 1, std::memory_order_release);
+}
+
+void RingLogger::log(Level level, const char* format, ...) {
+    U32 position = 0;
+    Line* line = this->claim(position);
+    if (line == nullptr) {
+        return;
+    }
+    line->level = level;
+    va_list args;
+    va_start(args, format);
+    (void)vsnprintf(line->text, LINE_SIZE, format, args);
+    va_end(args);
+    this->publish(line, position);
+}
+
+void RingLogger::hexdump(Level level, const char* label, const U8* data, FwSizeType size) {
+    static const char HEX[] = "0123456789ABCDEF";
+    static constexpr FwSizeType BYTES_PER_LINE = 32;
+
+    for (FwSizeType offset = 0; offset < size; offset += BYTES_PER_LINE) {
+        U32 position = 0;
+        Line* line = this->claim(position);
+        if (line == nullptr) {
+            return;
+        }
+        line->level = level;
+        int used = snprintf(line->text, LINE_SIZE, "%s %04lx:", label, static_cast<unsigned long>(offset));
+        FwSizeType cursor = (used < 0) ? 0 : static_cast<FwSizeType>(used);
+        for (FwSizeType i = offset; (i < size) && (i < offset + BYTES_PER_LINE) && (cursor + 4 <= LINE_SIZE); i++) {
+            line->text[cursor++] = ' ';
+            line->text[cursor++] = HEX[data[i] >> 4];
+            line->text[cursor++] = HEX[data[i] & 0x0F];
+        }
+        line->text[(cursor < LINE_SIZE) ? cursor : LINE_SIZE - 1] = '\0';
+        this->publish(line, position);
+    }
+}
+
+void RingLogger::start(const Os::TaskString& name, FwTaskPriorityType priority, FwSizeType stackSize) {
+    m_running = true;
+    Os::Task::Arguments arguments(name, RingLogger::drainTask, this, priority, stackSize);
+    Os::Task::Status status = m_task.start(arguments);
+    FW_ASSERT(status == Os::Task::OP_OK, static_cast<FwAssertArgType>(status));
+}
+
+void RingLogger::stop() {
+    m_running = false;
+    (void)m_task.join();
+    (void)this->drain();
+}
+
+void RingLogger::drainTask(void* logger) {
+    FW_ASSERT(logger != nullptr);
+    RingLogger* self = static_cast<RingLogger*>(logger);
+    while (self->m_running) {
+        if (self->drain() == 0) {
+            Os::Task::delay(Fw::TimeInterval(0, DRAIN_PERIOD_MS * 1000));
+        }
+    }
+}
+
+FwSizeType RingLogger::drain() {
+    FwSizeType written = 0;
+    while (true) {
+        Line& line = m_lines[m_drainPosition & (LINE_COUNT - 1)];
+        if (line.sequence.load(std::memory_order_acquire) != m_drainPosition + 1) {
+            break;
+        }
+        (void)fprintf(stdout, "[%s] %s\n", LEVEL_TAGS[static_cast<U8>(line.level)], line.text);
+        line.sequence.store(m_drainPosition + LINE_COUNT, std::memory_order_release);
+        m_drainPosition++;
+        written++;
+    }
+
+    const U32 drops = m_drops.load(std::memory_order_relaxed);
+    if (drops != m_reportedDrops) {
+        (void)fprintf(stdout, "[WARN] debug log overflowed, %u lines dropped\n", drops - m_reportedDrops);
+        m_reportedDrops = drops;
+    }
+    if (written > 0) {
+        (void)fflush(stdout);
+    }
+    return written;
+}
+
+}  // namespace DebugLog
@@ -0,0 +1,82 @@
+// ======================================================================
+// \title  RingLogger.hpp
+// \author madisonw
+// \brief  Non-blocking diagnostic log drained by a background task
+// ======================================================================
+
+#ifndef DebugLog_RingLogger_HPP
+#define DebugLog_RingLogger_HPP
+
+#include "Fw/Types/BasicTypes.hpp"
+#include "Os/Task.hpp"
+#include <atomic>
+
+namespace DebugLog {
+
+//! Severity of a log line; names avoid the DEBUG/ERROR macros some toolchains define
+enum class Level : U8 { Error, Warning, Info, Debug, Trace };
+
+//! Fixed-size ring of formatted log lines.
+//!
+//! Any thread may log: a writer claims a slot with one compare-and-swap,
+//! formats into it and publishes it, and a line that finds the ring full is
+//! counted and dropped instead of waiting. A low-priority task writes the
+//! lines to stdout, so terminal I/O never runs on the framing or transmit
+//! threads. Use the AMSAT_LOG_* macros from DebugLog.hpp rather than calling
+//! this directly so that disabled levels compile out.
+class RingLogger {
+  public:
+    static constexpr FwSizeType LINE_SIZE = 160;
+    static constexpr FwSizeType LINE_COUNT = 512;
+
+    static RingLogger& getInstance();
+
+    //! Format and queue one line (a newline is added); never blocks
+    void log(Level level, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+    //! Queue `data` as hex, 32 bytes per line, each line prefixed with `label`
+    void hexdump(Level level, const char* label, const U8* data, FwSizeType size);
+
+    //! Start the drain task
+    void start(const Os::TaskString& name, FwTaskPriorityType priority, FwSizeType stackSize);
+
+    //! Write out what is queued and stop the drain task
+    void stop();
+
+    //! Lines dropped because the ring was full
+    U32 getDropCount() const { return m_drops.load(std::memory_order_relaxed); }
+
+  private:
+    //! Pause between drains when the ring is empty
+    static constexpr U32 DRAIN_PERIOD_MS = 50;
+
+    struct Line {
+        //! Slot sequence: equals the claim position when free, position + 1 when filled
+        std::atomic<U32> sequence;
+        Level level;
+        char text[LINE_SIZE];
+    };
+
+    RingLogger();
+
+    //! Claim a free slot, or nullptr (and count a drop) when the ring is full
+    Line* claim(U32& position);
+    void publish(Line* line, U32 position);
+
+    static void drainTask(void* logger);
+    //! Write out every published line; returns how many were written
+    FwSizeType drain();
+
+    Line m_lines[LINE_COUNT];
+    std::atomic<U32> m_claimPosition;
+    U32 m_drainPosition;
+    std::atomic<U32> m_drops;
+    U32 m_reportedDrops;
+
+    Os::Task m_task;
+    std::atomic<bool> m_running;
+};
+
+}  // namespace DebugLog
+
+#endif
@@ -0,0 +1,67 @@
+// ======================================================================
+// \title  LatencyHistogram.cpp
+// \author madisonw
+// \brief  Monotonic timestamps and decade latency histograms
+// ======================================================================
+
+#include "CDHDeployment/Instrumentation/LatencyHistogram.hpp"
+#include <chrono>
+
+namespace Instrumentation {
+
+U64 monotonicNs() {
+    return static_cast<U64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+LatencyHistogram::LatencyHistogram() {
+    this->reset();
+}
+
+void LatencyHistogram::reset() {
+    for (FwSizeType i = 0; i < BIN_COUNT; i++) {
+        m_bins[i] = 0;
+    }
+    m_count = 0;
+    m_totalNs = 0;
+    m_maxNs = 0;
+}
+
+void LatencyHistogram::record(U64 elapsedNs) {
+    // First bin ends at 10 us, each following one is ten times wider
+    FwSizeType bin = 0;
+    U64 edgeNs = 10000;
+    while ((bin < BIN_COUNT - 1) && (elapsedNs >= edgeNs)) {
+        bin++;
+        edgeNs *= 10;
+    }
+    m_bins[bin]++;
+    m_count++;
+    m_totalNs += elapsedNs;
+    if (elapsedNs > m_maxNs) {
+        m_maxNs = elapsedNs;
+    }
+}
+
+LatencyBins LatencyHistogram::getBins() const {
+    LatencyBins bins;
+    for (FwSizeType i = 0; i < BIN_COUNT; i++) {
+        bins[i] = m_bins[i];
+    }
+    return bins;
+}
+
+U32 LatencyHistogram::getMaxUs() const {
+    const U64 maxUs = m_maxNs / 1000;
+    return (maxUs > 0xFFFFFFFFULL) ? 0xFFFFFFFFU : static_cast<U32>(maxUs);
+}
+
+F32 LatencyHistogram::getMeanUs() const {
+    if (m_count == 0) {
+        return 0.0f;
+    }
+    return static_cast<F32>(static_cast<F64>(m_totalNs) / 1000.0 / static_cast<F64>(m_count));
+}
+
+}  // namespace Instrumentation
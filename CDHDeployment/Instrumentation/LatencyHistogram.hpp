@@ -0,0 +1,48 @@
+// ======================================================================
+// \title  LatencyHistogram.hpp
+// \author madisonw
+// \brief  Monotonic timestamps and decade latency histograms
+// ======================================================================
+
+#ifndef Instrumentation_LatencyHistogram_HPP
+#define Instrumentation_LatencyHistogram_HPP
+
+#include "CDHDeployment/Instrumentation/LatencyBinsArrayAc.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace Instrumentation {
+
+//! Nanoseconds on a monotonic clock, comparable across threads
+U64 monotonicNs();
+
+//! Counts samples into decade-wide microsecond bins and tracks the maximum
+//! and mean. Not thread-safe: record and publish from the same thread.
+class LatencyHistogram {
+  public:
+    static constexpr FwSizeType BIN_COUNT = LatencyBins::SIZE;
+
+    LatencyHistogram();
+
+    void record(U64 elapsedNs);
+
+    //! Record the time elapsed since `startNs`
+    void recordSince(U64 startNs) { this->record(monotonicNs() - startNs); }
+
+    void reset();
+
+    //! Bins in the form published as telemetry
+    LatencyBins getBins() const;
+    U32 getCount() const { return m_count; }
+    U32 getMaxUs() const;
+    F32 getMeanUs() const;
+
+  private:
+    U32 m_bins[BIN_COUNT];
+    U32 m_count;
+    U64 m_totalNs;
+    U64 m_maxNs;
+};
+
+}  // namespace Instrumentation
+
+#endif
@@ -19,7 +19,13 @@
  * \brief print command line help message
  */
 void print_usage(const char* app) {
-    (void)printf("Usage: ./%s [options]\n-a\thostname/IP address\n-p\tport_number\n", app);
+    (void)printf(
+        "Usage: ./%s [options]\n-a\thostname/IP address\n-p\tport_number\n"
+        "-t\ttransmit sink command reading raw 48 kHz S16LE PCM (default: rpitx)\n"
+        "-o\twrite transmit PCM to a file instead (e.g. /dev/null)\n"
+        "-r\treceive: demodulate 48 kHz S16LE PCM from a file/FIFO or tcp:host:port\n"
+        "-s\tspool file keeping frames queued out of contact across passes and reboots\n",
+        app);
 }
 
 /**
@@ -36,11 +42,15 @@ int main(int argc, char* argv[]) {
     I32 option = 0;
     CHAR* hostname = nullptr;
     U16 port_number = 0;
+    CHAR* tx_sink_command = nullptr;
+    CHAR* tx_sink_file = nullptr;
+    CHAR* rx_source = nullptr;
+    CHAR* spool_file = nullptr;
 
     Os::init();
 
     // Loop while reading the getopt supplied options
-    while ((option = getopt(argc, argv, "hp:a:")) != -1) {
+    while ((option = getopt(argc, argv, "hp:a:t:o:r:s:")) != -1) {
         switch (option) {
             case 'a':
                 hostname = optarg;
@@ -48,6 +58,18 @@ int main(int argc, char* argv[]) {
             case 'p':
                 port_number = static_cast<U16>(atoi(optarg));
                 break;
+            case 't':
+                tx_sink_command = optarg;
+                break;
+            case 'o':
+                tx_sink_file = optarg;
+                break;
+            case 'r':
+                rx_source = optarg;
+                break;
+            case 's':
+                spool_file = optarg;
+                break;
             case 'h':
             case '?':
             default:
@@ -60,10 +82,16 @@ int main(int argc, char* argv[]) {
     CDHDeployment::TopologyState inputs;
     inputs.hostname = hostname;
     inputs.port = port_number;
+    inputs.txSinkCommand = tx_sink_command;
+    inputs.txSinkFile = tx_sink_file;
+    inputs.rxSource = rx_source;
+    inputs.spoolFile = spool_file;
 
     // Setup program shutdown via Ctrl-C
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
+    // RadioBridge streams audio into child pipelines; a dying child must surface as a write error, not kill us
+    signal(SIGPIPE, SIG_IGN);
 
     (void)printf("Hit Ctrl-C to quit\n");
 
@@ -0,0 +1,105 @@
+// ======================================================================
+// \title  PassScheduler.cpp
+// \author madisonw
+// \brief  Contact window tracking for the pre-rendered downlink
+// ======================================================================
+
+#include "CDHDeployment/PassScheduler/PassScheduler.hpp"
+#include "CDHDeployment/DebugLog/DebugLog.hpp"
+
+namespace PassScheduler {
+
+PassScheduler::PassScheduler(const char* const compName)
+    : PassSchedulerComponentBase(compName), m_phase(PassPhase::CONTINUOUS), m_window(0, 0) {}
+
+PassScheduler::~PassScheduler() {}
+
+void PassScheduler::schedIn_handler(FwIndexType portNum, U32 context) {
+    Fw::ParamValid valid;
+    const PassTable table = this->paramGet_PASS_TABLE(valid);
+    const U32 leadS = this->paramGet_STAGE_LEAD_S(valid);
+    const U32 nowS = this->getTime().getSeconds();
+
+    PassWindow next(0, 0);
+    const U32 upcoming = findNextPass(table, nowS, next);
+
+    // Without a clock the windows mean nothing, so frames go out as they come
+    PassPhase phase = PassPhase::HOLD;
+    U32 secondsLeft = 0;
+    if ((nowS == 0) || !isLoaded(table)) {
+        phase = PassPhase::CONTINUOUS;
+    } else if (upcoming == 0) {
+        // Every pass has ended: hold until the ground loads new ones
+        phase = PassPhase::HOLD;
+    } else if (nowS >= next.get_aos()) {
+        phase = PassPhase::IN_PASS;
+        secondsLeft = next.get_los() - nowS;
+    } else if (next.get_aos() - nowS <= leadS) {
+        phase = PassPhase::STAGING;
+        secondsLeft = next.get_aos() - nowS;
+    } else {
+        phase = PassPhase::HOLD;
+        secondsLeft = next.get_aos() - nowS - leadS;
+    }
+
+    if (phase != m_phase) {
+        if (m_phase == PassPhase::IN_PASS) {
+            this->log_ACTIVITY_HI_PassEnded(m_window.get_los());
+        }
+        if (phase == PassPhase::IN_PASS) {
+            this->log_ACTIVITY_HI_PassStarted(next.get_aos(), next.get_los());
+        } else if (phase == PassPhase::STAGING) {
+            this->log_ACTIVITY_LO_StagingStarted(next.get_aos());
+        }
+        AMSAT_LOG_INFO("PassScheduler: phase %d, %u s left", static_cast<int>(phase.e), secondsLeft);
+        m_phase = phase;
+    }
+    m_window = next;
+
+    if (this->isConnected_passStateOut_OutputPort(0)) {
+        this->passStateOut_out(0, phase, secondsLeft);
+    }
+
+    this->tlmWrite_Phase(phase);
+    this->tlmWrite_NextAos(next.get_aos());
+    this->tlmWrite_NextLos(next.get_los());
+    this->tlmWrite_SecondsLeft(secondsLeft);
+    this->tlmWrite_UpcomingPasses(upcoming);
+}
+
+void PassScheduler::parameterUpdated(FwPrmIdType id) {
+    if (id != PARAMID_PASS_TABLE) {
+        return;
+    }
+    Fw::ParamValid valid;
+    const PassTable table = this->paramGet_PASS_TABLE(valid);
+    PassWindow next(0, 0);
+    this->log_ACTIVITY_HI_PassTableUpdated(findNextPass(table, this->getTime().getSeconds(), next));
+}
+
+U32 PassScheduler::findNextPass(const PassTable& table, U32 nowS, PassWindow& next) {
+    U32 upcoming = 0;
+    for (FwSizeType i = 0; i < PassTable::SIZE; i++) {
+        const PassWindow& window = table[i];
+        // Unused, malformed and finished windows are skipped
+        if ((window.get_los() <= window.get_aos()) || (window.get_los() <= nowS)) {
+            continue;
+        }
+        if ((upcoming == 0) || (window.get_aos() < next.get_aos())) {
+            next = window;
+        }
+        upcoming++;
+    }
+    return upcoming;
+}
+
+bool PassScheduler::isLoaded(const PassTable& table) {
+    for (FwSizeType i = 0; i < PassTable::SIZE; i++) {
+        if (table[i].get_los() != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace PassScheduler
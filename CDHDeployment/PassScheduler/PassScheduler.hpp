@@ -0,0 +1,48 @@
+// ======================================================================
+// \title  PassScheduler.hpp
+// \author madisonw
+// \brief  Contact window tracking for the pre-rendered downlink
+// ======================================================================
+
+#ifndef PassScheduler_PassScheduler_HPP
+#define PassScheduler_PassScheduler_HPP
+
+#include "CDHDeployment/PassScheduler/PassSchedulerComponentAc.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace PassScheduler {
+
+//! Compares the spacecraft clock with PASS_TABLE once a second and reports
+//! the phase on passStateOut.
+//!
+//! With no windows loaded the phase stays CONTINUOUS and the downlink
+//! behaves as if there were no scheduler. Otherwise frames are held until
+//! STAGE_LEAD_S before the next AOS, rendered ahead during STAGING and
+//! sent between AOS and LOS. The table lives in prmDb, so it survives a
+//! reboot and is replaced from the ground with PASS_TABLE_PRM_SET.
+class PassScheduler : public PassSchedulerComponentBase {
+  public:
+    PassScheduler(const char* const compName);
+    ~PassScheduler();
+
+  private:
+    void schedIn_handler(FwIndexType portNum, U32 context) override;
+
+    void parameterUpdated(FwPrmIdType id) override;
+
+    //! Windows that have not ended by `nowS`
+    //! \param next set to the one that starts first, if any
+    //! \return their number
+    static U32 findNextPass(const PassTable& table, U32 nowS, PassWindow& next);
+
+    //! Whether any window is loaded, ended or not
+    static bool isLoaded(const PassTable& table);
+
+    PassPhase m_phase;
+    //! Window of the current or next pass
+    PassWindow m_window;
+};
+
+}  // namespace PassScheduler
+
+#endif
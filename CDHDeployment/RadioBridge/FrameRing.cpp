@@ -0,0 +1,64 @@
+// ======================================================================
+// \title  FrameRing.cpp
+// \author madisonw
+// \brief  Lock-free single-producer/single-consumer ring of frame handles
+// ======================================================================
+
+#include "CDHDeployment/RadioBridge/FrameRing.hpp"
+#include "Fw/Types/Assert.hpp"
+
+namespace RadioBridge {
+
+FrameRing::FrameRing() : m_mask(0), m_head(0), m_highWater(0), m_drops(0), m_tail(0) {}
+
+void FrameRing::setup(FwSizeType capacity) {
+    FW_ASSERT(capacity > 0);
+    FW_ASSERT(capacity <= (1U << 31), static_cast<FwAssertArgType>(capacity));
+    FW_ASSERT(m_slots.empty());
+
+    FwSizeType rounded = 1;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    m_slots.resize(rounded);
+    m_mask = static_cast<U32>(rounded - 1);
+}
+
+bool FrameRing::push(const Fw::Buffer& buffer, const ComCfg::FrameContext& context, U64 enqueuedNs) {
+    FW_ASSERT(!m_slots.empty());
+    const U32 head = m_head.load(std::memory_order_relaxed);
+    const U32 depth = head - m_tail.load(std::memory_order_acquire);
+    if (depth >= m_slots.size()) {
+        m_drops.store(m_drops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Slot& slot = m_slots[head & m_mask];
+    slot.buffer = buffer;
+    slot.context = context;
+    slot.enqueuedNs = enqueuedNs;
+    // Publish the slot contents before the consumer can see the new head
+    m_head.store(head + 1, std::memory_order_release);
+
+    if (depth + 1 > m_highWater.load(std::memory_order_relaxed)) {
+        m_highWater.store(depth + 1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+bool FrameRing::pop(Fw::Buffer& buffer, ComCfg::FrameContext& context, U64& enqueuedNs) {
+    const U32 tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_head.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    const Slot& slot = m_slots[tail & m_mask];
+    buffer = slot.buffer;
+    context = slot.context;
+    enqueuedNs = slot.enqueuedNs;
+    // Release the slot back to the producer only after it has been read
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+}  // namespace RadioBridge
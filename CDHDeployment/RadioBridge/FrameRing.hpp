@@ -0,0 +1,77 @@
+// ======================================================================
+// \title  FrameRing.hpp
+// \author madisonw
+// \brief  Lock-free single-producer/single-consumer ring of frame handles
+// ======================================================================
+
+#ifndef RadioBridge_FrameRing_HPP
+#define RadioBridge_FrameRing_HPP
+
+#include "Fw/Buffer/Buffer.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+#include "config/FrameContextSerializableAc.hpp"
+#include <atomic>
+#include <vector>
+
+namespace RadioBridge {
+
+//! Fixed-capacity ring passing buffer handles from one producer thread to
+//! one consumer thread without locks or serialization.
+//!
+//! Only the Fw::Buffer handle and its FrameContext are copied; the frame
+//! data stays where the producer put it. The producer owns the head index
+//! and the consumer owns the tail index, so each side writes only its own
+//! counter and reads the other with acquire ordering. Capacity is rounded
+//! up to a power of two so the free-running counters can be masked.
+class FrameRing {
+  public:
+    FrameRing();
+
+    //! Allocate the slots; call once before either side uses the ring
+    void setup(FwSizeType capacity);
+
+    //! Producer side: queue a handle with the monotonic time it was queued
+    //! \return false (and count a drop) when the ring is full
+    bool push(const Fw::Buffer& buffer, const ComCfg::FrameContext& context, U64 enqueuedNs);
+
+    //! Consumer side: take the oldest handle and its enqueue time
+    //! \return false when the ring is empty
+    bool pop(Fw::Buffer& buffer, ComCfg::FrameContext& context, U64& enqueuedNs);
+
+    FwSizeType getCapacity() const { return m_slots.size(); }
+    //! Handles currently queued; exact only when called by one of the two sides
+    FwSizeType getDepth() const { return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire); }
+    bool isFull() const { return this->getDepth() >= m_slots.size(); }
+
+    U32 getEnqueueCount() const { return m_head.load(std::memory_order_relaxed); }
+    U32 getDequeueCount() const { return m_tail.load(std::memory_order_relaxed); }
+    U32 getHighWaterMark() const { return m_highWater.load(std::memory_order_relaxed); }
+    U32 getDropCount() const { return m_drops.load(std::memory_order_relaxed); }
+
+  private:
+    //! Keeps the producer and consumer counters on separate cache lines
+    static constexpr FwSizeType CACHE_LINE = 64;
+
+    struct Slot {
+        Fw::Buffer buffer;
+        ComCfg::FrameContext context;
+        U64 enqueuedNs;
+    };
+
+    std::vector<Slot> m_slots;
+    U32 m_mask;
+
+    // Producer-owned
+    std::atomic<U32> m_head;
+    std::atomic<U32> m_highWater;
+    std::atomic<U32> m_drops;
+    U8 m_producerPad[CACHE_LINE];
+
+    // Consumer-owned
+    std::atomic<U32> m_tail;
+    U8 m_consumerPad[CACHE_LINE];
+};
+
+}  // namespace RadioBridge
+
+#endif
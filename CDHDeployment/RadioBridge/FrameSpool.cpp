@@ -0,0 +1,301 @@
+// ======================================================================
+// \title  FrameSpool.cpp
+// \author madisonw
+// \brief  Persistent memory-mapped store-and-forward spool of AX.25 frames
+// ======================================================================
+
+#include "CDHDeployment/RadioBridge/FrameSpool.hpp"
+#include "CDHDeployment/AX25/Crc16.hpp"
+#include "CDHDeployment/DebugLog/DebugLog.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace RadioBridge {
+
+FrameSpool::FrameSpool()
+    : m_fd(-1),
+      m_map(nullptr),
+      m_mapSize(0),
+      m_capacity(0),
+      m_generation(0),
+      m_head{0, 0},
+      m_read{0, 0},
+      m_tail{0, 0},
+      m_peeked(0),
+      m_recovered(0),
+      m_discarded(0) {}
+
+FrameSpool::~FrameSpool() {
+    this->close();
+}
+
+bool FrameSpool::open(const char* path, FwSizeType capacity) {
+    FW_ASSERT(!this->isOpen());
+    FW_ASSERT(path != nullptr);
+    capacity = capacity / ALIGN * ALIGN;
+    FW_ASSERT(capacity >= 2 * MAX_RECORD_SIZE, static_cast<FwAssertArgType>(capacity));
+
+    m_fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        AMSAT_LOG_ERROR("FrameSpool: cannot open %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    // Blocks are reserved up front: a store into a sparse mapping on a
+    // full file system would raise SIGBUS instead of failing
+    const FwSizeType mapSize = HEADER_SIZE + capacity;
+    struct stat status;
+    const bool existing = (fstat(m_fd, &status) == 0) && (static_cast<FwSizeType>(status.st_size) == mapSize);
+    if (!existing) {
+        const int error = posix_fallocate(m_fd, 0, static_cast<off_t>(mapSize));
+        if ((error != 0) || (ftruncate(m_fd, static_cast<off_t>(mapSize)) != 0)) {
+            AMSAT_LOG_ERROR("FrameSpool: cannot size %s to %lu bytes", path, static_cast<unsigned long>(mapSize));
+            ::close(m_fd);
+            m_fd = -1;
+            return false;
+        }
+    }
+
+    void* map = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) {
+        AMSAT_LOG_ERROR("FrameSpool: cannot map %s: %s", path, strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    m_map = static_cast<U8*>(map);
+    m_mapSize = mapSize;
+    m_capacity = capacity;
+
+    if (existing && this->recover()) {
+        AMSAT_LOG_INFO("FrameSpool: %s holds %u frames (%u damaged records discarded)", path, m_recovered,
+                       m_discarded);
+    } else {
+        this->format();
+        AMSAT_LOG_INFO("FrameSpool: %s formatted with %lu bytes", path, static_cast<unsigned long>(capacity));
+    }
+    return true;
+}
+
+void FrameSpool::close() {
+    if (!this->isOpen()) {
+        return;
+    }
+    (void)msync(m_map, m_mapSize, MS_SYNC);
+    (void)munmap(m_map, m_mapSize);
+    (void)::close(m_fd);
+    m_map = nullptr;
+    m_fd = -1;
+}
+
+bool FrameSpool::hasRoom() const {
+    // A record may need a pad of almost its own size to wrap
+    return this->isOpen() && (m_capacity - static_cast<FwSizeType>(m_tail.offset - m_head.offset) >= 2 * MAX_RECORD_SIZE);
+}
+
+bool FrameSpool::append(const Frame& frame) {
+    if (!this->isOpen()) {
+        return false;
+    }
+    const FwSizeType frameSize = frame.sizes[0] + frame.sizes[1] + frame.sizes[2];
+    FW_ASSERT((frameSize >= 2) && (frameSize <= 0xFFFF), static_cast<FwAssertArgType>(frameSize));
+    FW_ASSERT(frame.fx25Size <= 0xFFFF, static_cast<FwAssertArgType>(frame.fx25Size));
+    const FwSizeType size = recordSize(frameSize + frame.fx25Size);
+    if (size > MAX_RECORD_SIZE) {
+        return false;
+    }
+
+    // Records never wrap: one that would leaves a pad to the end
+    U64 offset = m_tail.offset;
+    const FwSizeType toEnd = m_capacity - static_cast<FwSizeType>(offset % m_capacity);
+    const FwSizeType pad = (toEnd < size) ? toEnd : 0;
+    if (offset + pad + size - m_head.offset > m_capacity) {
+        return false;
+    }
+    if (pad >= sizeof(RecordHeader)) {
+        const RecordHeader padding = {PAD_MAGIC, 0, 0, 0, 0, 0};
+        memcpy(this->data() + offset % m_capacity, &padding, sizeof(padding));
+    }
+    offset += pad;
+
+    U8* record = this->data() + offset % m_capacity;
+    U8* payload = record + sizeof(RecordHeader);
+    FwSizeType written = 0;
+    for (U32 i = 0; i < 3; i++) {
+        if (frame.sizes[i] > 0) {
+            memcpy(&payload[written], frame.pieces[i], frame.sizes[i]);
+            written += frame.sizes[i];
+        }
+    }
+    if (frame.fx25Size > 0) {
+        memcpy(&payload[written], frame.fx25, frame.fx25Size);
+    }
+
+    RecordHeader header = {RECORD_MAGIC, m_tail.sequence, static_cast<U16>(frameSize),
+                           static_cast<U16>(frame.fx25Size), 0, 0};
+    header.crc = recordCrc(header, payload);
+    memcpy(record, &header, sizeof(header));
+
+    // The record is complete before the tail that covers it is written
+    std::atomic_thread_fence(std::memory_order_release);
+    m_tail.offset = offset + size;
+    m_tail.sequence++;
+    this->commit();
+    return true;
+}
+
+bool FrameSpool::peek(Record& record) {
+    if (!this->isOpen() || (m_read.offset == m_tail.offset)) {
+        return false;
+    }
+    m_read.offset = this->skipPadding(m_read.offset);
+    FW_ASSERT(m_read.offset < m_tail.offset);
+
+    const U8* source = this->data() + m_read.offset % m_capacity;
+    RecordHeader header;
+    memcpy(&header, source, sizeof(header));
+    record.frame = source + sizeof(RecordHeader);
+    record.frameSize = header.frameSize;
+    record.fx25 = (header.fx25Size > 0) ? record.frame + header.frameSize : nullptr;
+    record.fx25Size = header.fx25Size;
+    m_peeked = recordSize(header.frameSize + header.fx25Size);
+    return true;
+}
+
+void FrameSpool::next() {
+    FW_ASSERT(m_peeked > 0);
+    m_read.offset += m_peeked;
+    m_read.sequence++;
+    m_peeked = 0;
+}
+
+void FrameSpool::release(const Position& position) {
+    if (!this->isOpen()) {
+        return;
+    }
+    FW_ASSERT((position.offset >= m_head.offset) && (position.offset <= m_read.offset),
+              static_cast<FwAssertArgType>(position.offset), static_cast<FwAssertArgType>(m_head.offset));
+    m_head = position;
+    this->commit();
+}
+
+void FrameSpool::sync() {
+    if (this->isOpen()) {
+        (void)msync(m_map, m_mapSize, MS_ASYNC);
+    }
+}
+
+U16 FrameSpool::slotCrc(const Slot& slot) {
+    Slot copy = slot;
+    copy.crc = 0;
+    return AX25::Crc16::compute(reinterpret_cast<const U8*>(&copy), sizeof(copy));
+}
+
+U16 FrameSpool::recordCrc(const RecordHeader& header, const U8* payload) {
+    RecordHeader copy = header;
+    copy.crc = 0;
+    U16 state = AX25::Crc16::update(AX25::Crc16::INITIAL, reinterpret_cast<const U8*>(&copy), sizeof(copy));
+    state = AX25::Crc16::update(state, payload, static_cast<FwSizeType>(header.frameSize) + header.fx25Size);
+    return AX25::Crc16::finish(state);
+}
+
+void FrameSpool::format() {
+    FileHeader* file = this->header();
+    memset(file, 0, sizeof(FileHeader));
+    file->magic = FILE_MAGIC;
+    file->version = FILE_VERSION;
+    file->capacity = m_capacity;
+    m_generation = 0;
+    m_head = {0, 0};
+    m_read = m_head;
+    m_tail = m_head;
+    m_recovered = 0;
+    m_discarded = 0;
+    this->commit();
+    (void)msync(m_map, HEADER_SIZE, MS_SYNC);
+}
+
+bool FrameSpool::recover() {
+    const FileHeader* file = this->header();
+    if ((file->magic != FILE_MAGIC) || (file->version != FILE_VERSION) || (file->capacity != m_capacity)) {
+        return false;
+    }
+
+    const Slot* best = nullptr;
+    for (U32 i = 0; i < 2; i++) {
+        const Slot& slot = file->slots[i];
+        const bool valid = (slotCrc(slot) == slot.crc) && (slot.tail >= slot.head) &&
+                           (slot.tail - slot.head <= m_capacity) &&
+                           (slot.tailSequence - slot.headSequence <= (slot.tail - slot.head) / sizeof(RecordHeader));
+        if (valid && ((best == nullptr) || (slot.generation > best->generation))) {
+            best = &slot;
+        }
+    }
+    if (best == nullptr) {
+        return false;
+    }
+
+    m_generation = best->generation;
+    m_head = {best->head, best->headSequence};
+    m_tail = m_head;
+
+    // Keep every record up to the first one that is not exactly what the
+    // tail says should be there
+    U64 offset = m_head.offset;
+    while (offset < best->tail) {
+        const U64 start = this->skipPadding(offset);
+        if (start >= best->tail) {
+            break;
+        }
+        const U8* source = this->data() + start % m_capacity;
+        RecordHeader header;
+        memcpy(&header, source, sizeof(header));
+        const FwSizeType size = recordSize(static_cast<FwSizeType>(header.frameSize) + header.fx25Size);
+        if ((header.magic != RECORD_MAGIC) || (header.sequence != m_tail.sequence) || (header.frameSize < 2) ||
+            (size > MAX_RECORD_SIZE) || (start % m_capacity + size > m_capacity) || (start + size > best->tail) ||
+            (recordCrc(header, source + sizeof(RecordHeader)) != header.crc)) {
+            break;
+        }
+        offset = start + size;
+        m_tail = {offset, m_tail.sequence + 1};
+    }
+
+    m_recovered = m_tail.sequence - m_head.sequence;
+    m_discarded = best->tailSequence - m_tail.sequence;
+    m_read = m_head;
+    this->commit();
+    return true;
+}
+
+void FrameSpool::commit() {
+    // The slot not holding the latest state is overwritten, so a torn
+    // write only ever loses this update
+    m_generation++;
+    Slot slot;
+    memset(&slot, 0, sizeof(slot));
+    slot.generation = m_generation;
+    slot.head = m_head.offset;
+    slot.tail = m_tail.offset;
+    slot.headSequence = m_head.sequence;
+    slot.tailSequence = m_tail.sequence;
+    slot.crc = slotCrc(slot);
+    memcpy(&this->header()->slots[m_generation % 2], &slot, sizeof(slot));
+}
+
+U64 FrameSpool::skipPadding(U64 offset) const {
+    const FwSizeType toEnd = m_capacity - static_cast<FwSizeType>(offset % m_capacity);
+    if (toEnd < sizeof(RecordHeader)) {
+        return offset + toEnd;
+    }
+    U32 magic = 0;
+    memcpy(&magic, this->data() + offset % m_capacity, sizeof(magic));
+    return (magic == PAD_MAGIC) ? offset + toEnd : offset;
+}
+
+}  // namespace RadioBridge
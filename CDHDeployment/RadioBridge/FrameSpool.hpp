@@ -0,0 +1,174 @@
+// ======================================================================
+// \title  FrameSpool.hpp
+// \author madisonw
+// \brief  Persistent memory-mapped store-and-forward spool of AX.25 frames
+// ======================================================================
+
+#ifndef RadioBridge_FrameSpool_HPP
+#define RadioBridge_FrameSpool_HPP
+
+#include "Fw/Types/BasicTypes.hpp"
+
+namespace RadioBridge {
+
+//! Frames kept in a file while there is no contact, sent at the next one.
+//!
+//! The file is a header page followed by a circular data area, both mapped
+//! into memory, so appending and reading a frame are copies with no system
+//! call. Each record carries a sequence number and a CRC-16 over its header
+//! and bytes. A record that does not fit before the end of the data area
+//! leaves a pad record and starts again at the beginning.
+//!
+//! The head, read and tail positions only ever grow, and are taken modulo
+//! the data area size. The header holds the head and tail twice, in
+//! alternating slots with a generation count and their own CRC, so a crash
+//! in the middle of an update leaves the previous slot intact. On open the
+//! newer valid slot wins and the records from head to tail are checked
+//! again; the tail is cut back to the first bad one.
+//!
+//! Reading moves a separate cursor. The head only moves on release(), once
+//! the frames before it are known to have gone out, so a reboot before
+//! then sends them again rather than losing them.
+class FrameSpool {
+  public:
+    //! Largest record, header included
+    static constexpr FwSizeType MAX_RECORD_SIZE = 4096;
+
+    //! A frame in up to three pieces, plus the FX.25 block sent in its place if any
+    struct Frame {
+        const U8* pieces[3];
+        FwSizeType sizes[3];
+        const U8* fx25;
+        FwSizeType fx25Size;
+    };
+
+    //! A frame in the spool, pointing into the mapping; valid until the
+    //! record is released
+    struct Record {
+        const U8* frame;
+        FwSizeType frameSize;
+        const U8* fx25;
+        FwSizeType fx25Size;
+    };
+
+    //! A place in the spool, for release()
+    struct Position {
+        U64 offset;
+        U32 sequence;
+    };
+
+    FrameSpool();
+    ~FrameSpool();
+
+    //! Map `path`, creating it with a `capacity` byte data area, or recover
+    //! its contents if it already has one of that size
+    //! \return false if the file cannot be created or mapped
+    bool open(const char* path, FwSizeType capacity);
+
+    //! Flush the mapping and close the file
+    void close();
+
+    bool isOpen() const { return m_map != nullptr; }
+
+    //! Whether the next frame of any size fits
+    bool hasRoom() const;
+
+    //! Copy a frame to the tail
+    //! \return false if the spool is closed or the frame does not fit
+    bool append(const Frame& frame);
+
+    //! The frame at the read cursor
+    //! \return false when every frame has been read
+    bool peek(Record& record);
+
+    //! Move the read cursor past the frame peek() returned
+    void next();
+
+    //! The read cursor, to release once the frames read so far are sent
+    Position getReadPosition() const { return m_read; }
+
+    //! Drop the frames before `position` for good
+    void release(const Position& position);
+
+    //! Ask the kernel to write dirty pages back (asynchronously)
+    void sync();
+
+    FwSizeType getCapacity() const { return m_capacity; }
+    //! Bytes and frames appended but not yet read
+    FwSizeType getBacklogBytes() const { return static_cast<FwSizeType>(m_tail.offset - m_read.offset); }
+    U32 getBacklogFrames() const { return m_tail.sequence - m_read.sequence; }
+    //! Frames found intact on open, and records cut off as damaged
+    U32 getRecovered() const { return m_recovered; }
+    U32 getDiscarded() const { return m_discarded; }
+
+  private:
+    struct Slot {
+        U64 generation;
+        U64 head;
+        U64 tail;
+        U32 headSequence;
+        U32 tailSequence;
+        U16 crc;
+        U8 reserved[6];
+    };
+
+    struct FileHeader {
+        U32 magic;
+        U32 version;
+        U64 capacity;
+        Slot slots[2];
+    };
+
+    struct RecordHeader {
+        U32 magic;
+        U32 sequence;
+        U16 frameSize;
+        U16 fx25Size;
+        U16 crc;
+        U16 reserved;
+    };
+
+    static constexpr U32 FILE_MAGIC = 0x53504F4CU;    // "SPOL"
+    static constexpr U32 FILE_VERSION = 1;
+    static constexpr U32 RECORD_MAGIC = 0x46524D45U;  // "FRME"
+    static constexpr U32 PAD_MAGIC = 0x50414444U;     // "PADD"
+    //! Data starts on the page after the header
+    static constexpr FwSizeType HEADER_SIZE = 4096;
+    static constexpr FwSizeType ALIGN = 8;
+
+    static FwSizeType recordSize(FwSizeType payload) {
+        return (sizeof(RecordHeader) + payload + ALIGN - 1) / ALIGN * ALIGN;
+    }
+    static U16 slotCrc(const Slot& slot);
+    static U16 recordCrc(const RecordHeader& header, const U8* payload);
+
+    //! Start an empty spool
+    void format();
+    //! Take the newer valid slot and check the records it covers
+    bool recover();
+    //! Write head and tail to the older slot
+    void commit();
+    //! Offset of the next record header at or after `offset`, skipping pads
+    //! and gaps too short for a header
+    U64 skipPadding(U64 offset) const;
+
+    U8* data() const { return m_map + HEADER_SIZE; }
+    FileHeader* header() const { return reinterpret_cast<FileHeader*>(m_map); }
+
+    int m_fd;
+    U8* m_map;
+    FwSizeType m_mapSize;
+    FwSizeType m_capacity;
+    U64 m_generation;
+    Position m_head;
+    Position m_read;
+    Position m_tail;
+    //! Size of the record peek() returned, 0 if none
+    FwSizeType m_peeked;
+    U32 m_recovered;
+    U32 m_discarded;
+};
+
+}  // namespace RadioBridge
+
+#endif
@@ -1,187 +1,842 @@
 // ======================================================================
 // \title  RadioBridge.cpp
 // \author madisonw
-// \brief  Component that receives AX.25 frames and transmits via direwolf/rpitx
+// \brief  Component that receives AX.25 frames and transmits via rpitx
 // ======================================================================
 
 #include "CDHDeployment/RadioBridge/RadioBridge.hpp"
+#include "CDHDeployment/DebugLog/DebugLog.hpp"
 #include "Fw/Types/Assert.hpp"
-#include <cstdlib>
-#include <fstream>
-#include <cstdio>
-#include <sstream>
-#include <iomanip>
+#include <cstring>
 
 namespace RadioBridge {
 
 RadioBridge::RadioBridge(const char* const compName)
-    : RadioBridgeComponentBase(compName) {
-    printf("\n========================================\n");
-    printf("RadioBridge Component Initialized!\n");
-    printf("Ready to receive AX.25 frames\n");
-    printf("========================================\n\n");
+    : RadioBridgeComponentBase(compName),
+      m_modulator(&m_afsk),
+      m_modulation(AX25::Modulation::AFSK_1200),
+      m_txDelaySamples(0),
+      m_txTailSamples(0),
+      m_burstSamples(0),
+      m_burstFrameSamples(0),
+      m_burstBytes(0),
+      m_burstFrames(0),
+      m_bursts(0),
+      m_framesSent(0),
+      m_bytesSent(0),
+      m_framesDropped(0),
+      m_lastRateNs(0),
+      m_lastRateFrames(0),
+      m_lastRateBytes(0),
+      m_ringWakeup(false),
+      m_ringBlocked(false),
+      m_passPhase(PassScheduler::PassPhase::CONTINUOUS),
+      m_phaseEndNs(0),
+      m_stageAllocator(nullptr),
+      m_stageMemId(0),
+      m_stage(nullptr),
+      m_stageCapacity(0),
+      m_stagedSamples(0),
+      m_stageResize(false),
+      m_stagedFrames(0),
+      m_stageWakeup(false),
+      m_dataBlocked(false),
+      m_burstSpoolEnd{0, 0},
+      m_burstFromSpool(false),
+      m_spoolSpooled(0),
+      m_spoolDrained(0),
+      m_lastRateDrained(0),
+      m_sinkRestarts(0) {
+    for (FwSizeType i = 0; i < MAX_COM_QUEUES; i++) {
+        m_queueClass[i] = TxClass::ROUTINE;
+    }
+    for (FwSizeType i = 0; i < TxScheduler::CLASSES; i++) {
+        m_classFramesSent[i] = 0;
+    }
+    AMSAT_LOG_INFO("RadioBridge initialized, ready to receive AX.25 frames");
 }
 
 RadioBridge::~RadioBridge() {}
 
+void RadioBridge::configureSink(TxSink::Kind kind, const char* target) {
+    FW_ASSERT(target != nullptr);
+    // A short sink leaves room for urgent frames to go ahead of bulk ones
+    m_sink.configure(kind, target, static_cast<FwSizeType>(TX_LEAD_MS) * AX25::Modulator::SAMPLE_RATE / 1000);
+    // Parameters are not loaded yet; the first burst switches if they differ
+    this->applyModulation(m_modulation);
+
+    AMSAT_LOG_INFO("RadioBridge: transmit sink %s", target);
+}
+
+void RadioBridge::applyModulation(AX25::Modulation modulation) {
+    switch (modulation.e) {
+        case AX25::Modulation::G3RUH_9600:
+            m_modulator = &m_g3ruh;
+            break;
+        default:
+            m_modulator = &m_afsk;
+            break;
+    }
+    m_modulation = modulation;
+
+    // Key-up and key-down padding is rendered once per modulation and
+    // replayed by the sink
+    const U32 txDelayFlags = TX_DELAY_MS * m_modulator->getBaudRate() / (8 * 1000);
+    std::vector<I16> txDelay(m_modulator->maxSamples(0, txDelayFlags));
+    std::vector<I16> txTail(m_modulator->maxSamples(0, TX_TAIL_FLAGS));
+    m_modulator->reset();
+    m_txDelaySamples = m_modulator->renderFlags(txDelayFlags, txDelay.data(), txDelay.size());
+    m_modulator->reset();
+    m_txTailSamples = m_modulator->renderFlags(TX_TAIL_FLAGS, txTail.data(), txTail.size());
+    m_sink.setKeyingPadding(txDelay.data(), m_txDelaySamples, txTail.data(), m_txTailSamples);
+}
+
+void RadioBridge::startSink(const Os::TaskString& name, FwTaskPriorityType priority, FwSizeType stackSize) {
+    m_sink.start(name, priority, stackSize);
+
+    // The link is up: let the framer start pulling from comQueue
+    this->sendComStatus(Fw::Success::SUCCESS);
+}
+
+void RadioBridge::stopSink() {
+    m_sink.stop();
+}
+
+void RadioBridge::configureRing(FwSizeType capacity) {
+    m_ring.setup(capacity);
+    m_scheduler.setup(m_ring.getCapacity());
+    AMSAT_LOG_INFO("RadioBridge: transmit ring of %lu frames", static_cast<unsigned long>(m_ring.getCapacity()));
+}
+
+void RadioBridge::configureSpool(const char* path, FwSizeType capacity) {
+    FW_ASSERT(path != nullptr);
+    if (m_spool.open(path, capacity)) {
+        AMSAT_LOG_INFO("RadioBridge: spooling frames out of contact to %s (%u waiting)", path,
+                       m_spool.getBacklogFrames());
+    } else {
+        AMSAT_LOG_ERROR("RadioBridge: no spool, frames out of contact wait in the queues");
+    }
+}
+
+void RadioBridge::configureStage(FwEnumStoreType memId, Fw::MemAllocator& allocator) {
+    FW_ASSERT(m_stageAllocator == nullptr);
+    m_stageAllocator = &allocator;
+    m_stageMemId = memId;
+}
+
+void RadioBridge::cleanupStage() {
+    m_stagedBursts.clear();
+    m_stagedFrames = 0;
+    m_stagedSamples = 0;
+    if (m_stage != nullptr) {
+        m_stageAllocator->deallocate(m_stageMemId, m_stage);
+        m_stage = nullptr;
+    }
+    m_stageCapacity = 0;
+}
+
+void RadioBridge::allocateStage() {
+    FW_ASSERT(m_stagedBursts.empty(), static_cast<FwAssertArgType>(m_stagedBursts.size()));
+    m_stageResize = false;
+    this->cleanupStage();
+    if (m_stageAllocator == nullptr) {
+        return;
+    }
+
+    Fw::ParamValid valid;
+    const FwSizeType requested = this->paramGet_PASS_STAGE_BYTES(valid) / sizeof(I16) * sizeof(I16);
+    if (requested == 0) {
+        return;
+    }
+    FwSizeType size = requested;
+    bool recoverable = false;
+    m_stage = static_cast<I16*>(m_stageAllocator->allocate(m_stageMemId, size, recoverable));
+    FW_ASSERT(m_stage != nullptr);
+    FW_ASSERT(size == requested, static_cast<FwAssertArgType>(size), static_cast<FwAssertArgType>(requested));
+    m_stageCapacity = size / sizeof(I16);
+    AMSAT_LOG_INFO("RadioBridge: pass stage of %lu samples", static_cast<unsigned long>(m_stageCapacity));
+}
+
+void RadioBridge::parametersLoaded() {
+    this->allocateStage();
+}
+
+void RadioBridge::parameterUpdated(FwPrmIdType id) {
+    // Called on the commanding thread; the stage is swapped on this one
+    if (id == PARAMID_PASS_STAGE_BYTES) {
+        m_stageResize = true;
+    }
+}
+
+void RadioBridge::setQueueClass(FwIndexType comQueueIndex, TxClass txClass) {
+    FW_ASSERT((comQueueIndex >= 0) && (static_cast<FwSizeType>(comQueueIndex) < MAX_COM_QUEUES),
+              static_cast<FwAssertArgType>(comQueueIndex));
+    FW_ASSERT(txClass.isValid(), static_cast<FwAssertArgType>(txClass.e));
+    m_queueClass[comQueueIndex] = txClass;
+}
+
 void RadioBridge::dataIn_handler(
     FwIndexType portNum,
     Fw::Buffer& fwBuffer,
     const ComCfg::FrameContext& context
 ) {
-    printf("\n========================================\n");
-    printf("RadioBridge::dataIn_handler CALLED!\n");
-    printf("Received AX.25 frame, size: %lu bytes\n", fwBuffer.getSize());
-    printf("========================================\n");
+    // The message queue does not carry a timestamp, so dwell starts here
+    this->enqueueFrame(fwBuffer, context, Instrumentation::monotonicNs());
+    if (!m_scheduler.isFull()) {
+        this->sendComStatus(Fw::Success::SUCCESS);
+    } else {
+        // Outside a pass nothing leaves the scheduler; hold the sender until it does
+        m_dataBlocked = true;
+    }
+    this->transmitPending();
+}
 
-    if (fwBuffer.getData() == nullptr || fwBuffer.getSize() == 0) {
-        printf("ERROR: Invalid buffer received\n");
-        Fw::LogStringArg errorStr("Invalid buffer");
-        this->log_WARNING_HI_RADIO_TX_FAILED(errorStr);
+void RadioBridge::ringIn_handler(
+    FwIndexType portNum,
+    Fw::Buffer& fwBuffer,
+    const ComCfg::FrameContext& context
+) {
+    // Runs on the sender's thread: only the handle is queued, never the data
+    if (!m_ring.push(fwBuffer, context, Instrumentation::monotonicNs())) {
+        this->log_WARNING_LO_RADIO_RING_OVERFLOW(static_cast<U32>(m_ring.getCapacity()));
         this->dataReturnOut_out(0, fwBuffer, context);
+        this->sendComStatus(Fw::Success::FAILURE);
+        // The sender waits for SUCCESS, which comes once the consumer frees a slot
+        m_ringBlocked = true;
+        if (!m_ring.isFull() && m_ringBlocked.exchange(false)) {
+            this->sendComStatus(Fw::Success::SUCCESS);
+        }
         return;
     }
 
-    this->log_ACTIVITY_LO_FrameReceived(static_cast<U32>(fwBuffer.getSize()));
+    if (!m_ring.isFull()) {
+        this->sendComStatus(Fw::Success::SUCCESS);
+    } else {
+        // Hold the sender until the consumer frees a slot. The consumer may
+        // already have drained the ring before the flag went up, so check
+        // again; whichever side clears the flag reports the status.
+        m_ringBlocked = true;
+        if (!m_ring.isFull() && m_ringBlocked.exchange(false)) {
+            this->sendComStatus(Fw::Success::SUCCESS);
+        }
+    }
 
-    printf("\nReceived AX.25 frame (hex):\n");
-    const U8* data = fwBuffer.getData();
-    for (FwSizeType i = 0; i < fwBuffer.getSize(); i++) {
-        printf("%02X ", data[i]);
-        if ((i + 1) % 16 == 0) printf("\n");
+    if (!m_ringWakeup.exchange(true)) {
+        this->ringReady_internalInterfaceInvoke();
+    }
+}
+
+void RadioBridge::ringReady_internalInterfaceHandler() {
+    // Re-arm before draining so a frame pushed from here on queues a new wake-up
+    m_ringWakeup = false;
+    this->transmitPending();
+    this->writeRingTelemetry();
+}
+
+void RadioBridge::passStateIn_handler(FwIndexType portNum, const PassScheduler::PassPhase& phase, U32 secondsLeft) {
+    const PassScheduler::PassPhase previous = m_passPhase;
+    m_passPhase = phase;
+    m_phaseEndNs = Instrumentation::monotonicNs() + static_cast<U64>(secondsLeft) * 1000000000ULL;
+    if (phase == previous) {
+        this->transmitPending();
+        return;
+    }
+
+    // The open burst goes to the stage at LOS, or at AOS behind what is staged
+    this->flushBurst();
+
+    const F32 stagedSeconds = static_cast<F32>(m_stagedSamples) / static_cast<F32>(AX25::Modulator::SAMPLE_RATE);
+    if ((phase == PassScheduler::PassPhase::IN_PASS) && !m_stagedBursts.empty()) {
+        this->log_ACTIVITY_HI_RADIO_PASS_STAGED(m_stagedFrames, stagedSeconds);
+    } else if ((previous == PassScheduler::PassPhase::IN_PASS) && !m_stagedBursts.empty()) {
+        this->log_ACTIVITY_HI_RADIO_PASS_RETAINED(m_stagedFrames, stagedSeconds);
+    }
+
+    this->sendStaged();
+    this->transmitPending();
+}
+
+void RadioBridge::stageReady_internalInterfaceHandler() {
+    m_stageWakeup = false;
+    if (m_stagedBursts.empty() || !this->canTransmit()) {
+        return;
+    }
+
+    // Audio still on air at LOS would be lost, so it waits for the next
+    // pass; the sink holds up to TX_LEAD_MS ahead of this burst
+    const StagedBurst burst = m_stagedBursts.front();
+    const U64 durationNs =
+        (static_cast<U64>(burst.samples) * 1000000000ULL / AX25::Modulator::SAMPLE_RATE) + TX_LEAD_MS * 1000000ULL;
+    if ((m_passPhase == PassScheduler::PassPhase::IN_PASS) &&
+        (Instrumentation::monotonicNs() + durationNs > m_phaseEndNs)) {
+        return;
+    }
+
+    if (this->writeBurst(&m_stage[burst.offset], burst.samples, burst.frames, burst.bytes, burst.frameSamples) &&
+        burst.fromSpool) {
+        m_spool.release(burst.spoolEnd);
+    }
+    m_stagedSamples -= burst.samples;
+    m_stagedFrames -= burst.frames;
+    m_stagedBursts.pop_front();
+
+    // One burst per message keeps pass updates and telemetry flowing; once
+    // the stage is empty live frames go straight to the sink
+    this->sendStaged();
+    this->transmitPending();
+}
+
+void RadioBridge::sendStaged() {
+    if (m_stageWakeup || m_stagedBursts.empty() || !this->canTransmit()) {
+        return;
+    }
+    m_stageWakeup = true;
+    this->stageReady_internalInterfaceInvoke();
+}
+
+bool RadioBridge::canTransmit() const {
+    return (m_passPhase == PassScheduler::PassPhase::CONTINUOUS) || (m_passPhase == PassScheduler::PassPhase::IN_PASS);
+}
+
+bool RadioBridge::mustStage() const {
+    return !this->canTransmit() || !m_stagedBursts.empty();
+}
+
+bool RadioBridge::mayRender() {
+    // Between passes frames wait in the scheduler, the ring and comQueue,
+    // so the ones rendered ahead of the next pass are the freshest
+    if (m_passPhase == PassScheduler::PassPhase::HOLD) {
+        return false;
+    }
+    if (!this->mustStage()) {
+        return true;
+    }
+    // Room for the burst and one more frame of either modulation, so the
+    // burst fits when it closes
+    const U32 afskFlags = m_afsk.getLeadFlags() + 1 + m_afsk.getTrailFlags();
+    const U32 g3ruhFlags = m_g3ruh.getLeadFlags() + 1 + m_g3ruh.getTrailFlags();
+    const FwSizeType frameSamples =
+        FW_MAX(m_afsk.maxSamples(STAGE_FRAME_BYTES, afskFlags), m_g3ruh.maxSamples(STAGE_FRAME_BYTES, g3ruhFlags));
+    FwSizeType offset = 0;
+    return this->findStageRoom(m_burstSamples + frameSamples, offset);
+}
+
+bool RadioBridge::findStageRoom(FwSizeType count, FwSizeType& offset) const {
+    if (m_stagedBursts.empty()) {
+        offset = 0;
+        return count <= m_stageCapacity;
+    }
+    const FwSizeType head = m_stagedBursts.front().offset;
+    const FwSizeType tail = m_stagedBursts.back().offset + m_stagedBursts.back().samples;
+    if (tail > head) {
+        // Free space after the tail, else before the head
+        if (m_stageCapacity - tail >= count) {
+            offset = tail;
+            return true;
+        }
+        offset = 0;
+        return count <= head;
+    }
+    // Wrapped: free space is between the tail and the head
+    offset = tail;
+    return count <= head - tail;
+}
+
+void RadioBridge::enqueueFrame(Fw::Buffer& fwBuffer, const ComCfg::FrameContext& context, U64 enqueuedNs) {
+    m_queueDwell.recordSince(enqueuedNs);
+
+    const FwIndexType queue = context.get_comQueueIndex();
+    const TxClass txClass = ((queue >= 0) && (static_cast<FwSizeType>(queue) < MAX_COM_QUEUES))
+                                ? m_queueClass[queue]
+                                : TxClass(TxClass::ROUTINE);
+
+    // Airtime at the current baud rate, ignoring bit stuffing; only the
+    // shares between classes depend on it
+    FrameParts frame;
+    TxScheduler::Frame entry;
+    entry.buffer = fwBuffer;
+    entry.context = context;
+    entry.enqueuedNs = enqueuedNs;
+    entry.airtimeUs = getFrameParts(fwBuffer, frame)
+                          ? static_cast<U32>(static_cast<U64>(frame.sentSize()) * 8 * 1000000 /
+                                             m_modulator->getBaudRate())
+                          : 0;
+    if (!m_scheduler.push(txClass, entry)) {
+        // Callers only queue while there is room, so this is a sender ignoring comStatusOut
+        Fw::LogStringArg errorStr("Transmit queue full");
+        this->log_WARNING_HI_RADIO_TX_FAILED(errorStr);
+        this->dataReturnOut_out(0, fwBuffer, context);
+        m_framesDropped++;
+    }
+}
+
+void RadioBridge::drainRing() {
+    Fw::Buffer fwBuffer;
+    ComCfg::FrameContext context;
+    U64 enqueuedNs = 0;
+    while (!m_scheduler.isFull() && m_ring.pop(fwBuffer, context, enqueuedNs)) {
+        if (m_ringBlocked.exchange(false)) {
+            this->sendComStatus(Fw::Success::SUCCESS);
+        }
+        this->enqueueFrame(fwBuffer, context, enqueuedNs);
+    }
+}
+
+void RadioBridge::transmitPending() {
+    Fw::ParamValid valid;
+    const TxClassCounts weights = this->paramGet_CLASS_WEIGHTS(valid);
+    const TxClassCounts airtimePercent = this->paramGet_CLASS_AIRTIME_PERCENT(valid);
+    U32 classWeights[TxScheduler::CLASSES];
+    U32 classAirtime[TxScheduler::CLASSES];
+    for (FwSizeType i = 0; i < TxScheduler::CLASSES; i++) {
+        classWeights[i] = weights[i];
+        classAirtime[i] = airtimePercent[i];
+    }
+    m_scheduler.configure(classWeights, classAirtime);
+
+    // A new PASS_STAGE_BYTES applies once the staged audio has gone out
+    if (m_stageResize && m_stagedBursts.empty()) {
+        this->allocateStage();
+    }
+
+    // Frames that arrive while a burst is written to the sink join the
+    // classes before the next pick, so an urgent one goes next
+    TxScheduler::Frame frame;
+    TxClass txClass;
+    FrameSpool::Record record;
+    while (true) {
+        this->drainRing();
+        if (!this->mayRender()) {
+            this->spoolPending();
+            break;
+        }
+
+        // Spooled frames are older than anything queued but urgent ones
+        if ((m_scheduler.getDepth(TxClass::URGENT) == 0) && m_spool.peek(record)) {
+            this->sendSpooled(record);
+            continue;
+        }
+
+        if (!this->popFrame(frame, txClass)) {
+            break;
+        }
+        m_classWait[txClass.e].recordSince(frame.enqueuedNs);
+        m_classFramesSent[txClass.e]++;
+        this->handleFrame(frame.buffer, frame.context, frame.enqueuedNs);
+        if (this->burstReady()) {
+            this->flushBurst();
+        }
     }
-    printf("\n\n");
+}
 
-    this->log_ACTIVITY_LO_RADIO_TX_STARTED();
+bool RadioBridge::popFrame(TxScheduler::Frame& frame, TxClass& txClass) {
+    if (!m_scheduler.pop(Instrumentation::monotonicNs(), frame, txClass)) {
+        return false;
+    }
+    if (m_dataBlocked) {
+        m_dataBlocked = false;
+        this->sendComStatus(Fw::Success::SUCCESS);
+    }
+    return true;
+}
 
-    if (transmitAX25Frame(data, fwBuffer.getSize())) {
-        this->log_ACTIVITY_HI_RADIO_TX_SUCCESS();
-        printf("[RadioBridge] Transmission successful!\n\n");
+void RadioBridge::spoolPending() {
+    // Copy the frames to the spool and hand the buffers back, so comQueue
+    // keeps moving instead of overflowing; once the spool is full they
+    // wait in the queues as they would without one
+    TxScheduler::Frame frame;
+    TxClass txClass;
+    while (m_spool.hasRoom()) {
+        this->drainRing();
+        if (!this->popFrame(frame, txClass)) {
+            break;
+        }
+        FrameParts parts;
+        if (getFrameParts(frame.buffer, parts)) {
+            const FrameSpool::Frame spooled = {{parts.head, parts.info, parts.tail},
+                                               {parts.headSize, parts.infoSize, parts.tailSize},
+                                               parts.fx25,
+                                               parts.fx25Size};
+            if (m_spool.append(spooled)) {
+                m_spoolSpooled++;
+            } else {
+                Fw::LogStringArg errorStr("Frame too large to spool");
+                this->log_WARNING_HI_RADIO_TX_FAILED(errorStr);
+                m_framesDropped++;
+            }
+        }
+        this->dataReturnOut_out(0, frame.buffer, frame.context);
+    }
+}
+
+void RadioBridge::sendSpooled(const FrameSpool::Record& record) {
+    const FrameParts frame = {record.frame, record.frameSize - 1, nullptr, 0, &record.frame[record.frameSize - 1], 1,
+                              record.fx25, record.fx25Size};
+    // Time spent on disk is not queueing latency; it is counted from here
+    this->addFrame(frame, Instrumentation::monotonicNs());
+    m_spool.next();
+    m_spoolDrained++;
+
+    // The record is released once the burst carrying it has gone out
+    m_burstSpoolEnd = m_spool.getReadPosition();
+    m_burstFromSpool = true;
+    if (this->burstReady()) {
+        this->flushBurst();
+    }
+}
+
+void RadioBridge::schedIn_handler(FwIndexType portNum, U32 context) {
+    const U64 nowNs = Instrumentation::monotonicNs();
+    if (m_lastRateNs != 0) {
+        const F32 seconds = static_cast<F32>(nowNs - m_lastRateNs) / 1e9f;
+        this->tlmWrite_FramesPerSecond(static_cast<F32>(m_framesSent - m_lastRateFrames) / seconds);
+        this->tlmWrite_BytesPerSecond(static_cast<F32>(m_bytesSent - m_lastRateBytes) / seconds);
+        this->tlmWrite_SpoolDrainRate(static_cast<F32>(m_spoolDrained - m_lastRateDrained) / seconds);
+    }
+    m_lastRateNs = nowNs;
+    m_lastRateFrames = m_framesSent;
+    m_lastRateBytes = m_bytesSent;
+    m_lastRateDrained = m_spoolDrained;
+
+    this->tlmWrite_QueueDwellBins(m_queueDwell.getBins());
+    this->tlmWrite_QueueDwellMeanUs(m_queueDwell.getMeanUs());
+    this->tlmWrite_QueueDwellMaxUs(m_queueDwell.getMaxUs());
+    this->tlmWrite_ModulationTimeBins(m_modulationTime.getBins());
+    this->tlmWrite_ModulationTimeMeanUs(m_modulationTime.getMeanUs());
+    this->tlmWrite_ModulationTimeMaxUs(m_modulationTime.getMaxUs());
+    this->tlmWrite_SinkWriteTimeBins(m_sinkWriteTime.getBins());
+    this->tlmWrite_SinkWriteTimeMeanUs(m_sinkWriteTime.getMeanUs());
+    this->tlmWrite_SinkWriteTimeMaxUs(m_sinkWriteTime.getMaxUs());
+    this->tlmWrite_EndToEndLatencyBins(m_endToEndLatency.getBins());
+    this->tlmWrite_EndToEndLatencyMeanUs(m_endToEndLatency.getMeanUs());
+    this->tlmWrite_EndToEndLatencyMaxUs(m_endToEndLatency.getMaxUs());
+    this->tlmWrite_FramesDropped(m_framesDropped);
+    this->tlmWrite_WaveformCacheHits(m_waveforms.getHits());
+    this->tlmWrite_WaveformCacheMisses(m_waveforms.getMisses());
+    this->tlmWrite_WaveformCacheEvictions(m_waveforms.getEvictions());
+    this->tlmWrite_WaveformCacheBytes(static_cast<U32>(m_waveforms.getBytes()));
+    this->tlmWrite_WaveformCacheSavedMs(static_cast<F32>(m_waveforms.getSavedNs()) / 1e6f);
+
+    TxClassCounts depth;
+    TxClassCounts airtimeMs;
+    TxClassTimes waitMeanUs;
+    TxClassCounts waitMaxUs;
+    for (FwSizeType i = 0; i < TxScheduler::CLASSES; i++) {
+        const TxClass txClass = static_cast<TxClass::T>(i);
+        depth[i] = static_cast<U32>(m_scheduler.getDepth(txClass));
+        airtimeMs[i] = static_cast<U32>(m_scheduler.getAirtimeUs(txClass) / 1000);
+        waitMeanUs[i] = m_classWait[i].getMeanUs();
+        waitMaxUs[i] = m_classWait[i].getMaxUs();
+    }
+    this->tlmWrite_ClassDepth(depth);
+    this->tlmWrite_ClassFramesSent(TxClassCounts(m_classFramesSent[0], m_classFramesSent[1], m_classFramesSent[2]));
+    this->tlmWrite_ClassAirtimeMs(airtimeMs);
+    this->tlmWrite_ClassWaitMeanUs(waitMeanUs);
+    this->tlmWrite_ClassWaitMaxUs(waitMaxUs);
+
+    this->tlmWrite_CurrentPassPhase(m_passPhase);
+    this->tlmWrite_StagedFrames(m_stagedFrames);
+    this->tlmWrite_StagedSeconds(static_cast<F32>(m_stagedSamples) / static_cast<F32>(AX25::Modulator::SAMPLE_RATE));
+
+    // Dirty spool pages go back to the file once a second rather than per frame
+    m_spool.sync();
+    this->tlmWrite_SpoolCapacity(static_cast<U32>(m_spool.getCapacity()));
+    this->tlmWrite_SpoolBacklogBytes(static_cast<U32>(m_spool.getBacklogBytes()));
+    this->tlmWrite_SpoolBacklogFrames(m_spool.getBacklogFrames());
+    this->tlmWrite_SpoolFramesSpooled(m_spoolSpooled);
+    this->writeRingTelemetry();
+}
+
+void RadioBridge::sendComStatus(Fw::Success::T status) {
+    if (this->isConnected_comStatusOut_OutputPort(0)) {
+        Fw::Success condition(status);
+        this->comStatusOut_out(0, condition);
+    }
+}
+
+void RadioBridge::writeRingTelemetry() {
+    this->tlmWrite_RingEnqueued(m_ring.getEnqueueCount());
+    this->tlmWrite_RingDequeued(m_ring.getDequeueCount());
+    this->tlmWrite_RingHighWater(m_ring.getHighWaterMark());
+    this->tlmWrite_RingDropped(m_ring.getDropCount());
+}
+
+bool RadioBridge::getFrameParts(const Fw::Buffer& fwBuffer, FrameParts& frame) {
+    const U8* data = fwBuffer.getData();
+    if (data == nullptr || fwBuffer.getSize() == 0) {
+        return false;
+    }
+    const AX25::FrameView* view = AX25::FrameView::from(data, fwBuffer.getSize());
+    if (view != nullptr) {
+        frame = {view->prefix, view->prefixSize, view->info, view->infoSize,
+                 view->suffix, AX25::FrameView::SUFFIX_SIZE,
+                 (view->fx25Size > 0) ? view->fx25 : nullptr, view->fx25Size};
     } else {
-        Fw::LogStringArg errorStr("RF transmission failed");
+        frame = {data, fwBuffer.getSize() - 1, nullptr, 0, &data[fwBuffer.getSize() - 1], 1, nullptr, 0};
+    }
+    return true;
+}
+
+void RadioBridge::handleFrame(Fw::Buffer& fwBuffer, const ComCfg::FrameContext& context, U64 enqueuedNs) {
+    AMSAT_LOG_DEBUG("RadioBridge: received %lu byte AX.25 frame", static_cast<unsigned long>(fwBuffer.getSize()));
+
+    FrameParts frame;
+    if (!getFrameParts(fwBuffer, frame)) {
+        AMSAT_LOG_WARN("RadioBridge: invalid buffer received");
+        Fw::LogStringArg errorStr("Invalid buffer");
         this->log_WARNING_HI_RADIO_TX_FAILED(errorStr);
-        printf("[RadioBridge] Transmission failed!\n\n");
+        this->dataReturnOut_out(0, fwBuffer, context);
+        m_framesDropped++;
+        return;
     }
 
+    this->addFrame(frame, enqueuedNs);
+
+    // The audio is already copied into the burst, so the frame goes back now
     this->dataReturnOut_out(0, fwBuffer, context);
 }
 
-bool RadioBridge::transmitAX25Frame(const U8* data, FwSizeType size) {
-    printf("\n========== TRANSMITTING AX.25 FRAME ==========\n");
-    printf("Frame size: %lu bytes\n", size);
+void RadioBridge::addFrame(const FrameParts& frame, U64 enqueuedNs) {
+    this->log_ACTIVITY_LO_FrameReceived(static_cast<U32>(frame.size()));
+    AMSAT_LOG_HEXDUMP("RadioBridge: frame", frame.head, frame.headSize);
+    if (frame.infoSize > 0) {
+        AMSAT_LOG_HEXDUMP("RadioBridge: borrowed info field", frame.info, frame.infoSize);
+    }
+
+    // A frame that would push the burst past its byte budget opens the next one
+    Fw::ParamValid valid;
+    const U32 maxBytes = this->paramGet_BURST_MAX_BYTES(valid);
+    if ((m_burstFrames > 0) && (m_burstBytes + frame.sentSize() > maxBytes)) {
+        this->flushBurst();
+    }
 
+    if (transmitAX25Frame(frame)) {
+        m_burstEnqueuedNs.push_back(enqueuedNs);
+    } else {
+        Fw::LogStringArg errorStr("Malformed AX.25 frame");
+        this->log_WARNING_HI_RADIO_TX_FAILED(errorStr);
+        AMSAT_LOG_WARN("RadioBridge: frame dropped");
+        m_framesDropped++;
+    }
+}
+
+bool RadioBridge::transmitAX25Frame(const FrameParts& frame) {
+    const FwSizeType size = frame.size();
     if (size < 20) {
-        printf("ERROR: Frame too small to be valid AX.25\n");
+        AMSAT_LOG_WARN("RadioBridge: %lu byte frame too small to be valid AX.25", static_cast<unsigned long>(size));
         return false;
     }
 
-    if (data[0] != 0x7E || data[size-1] != 0x7E) {
-        printf("ERROR: Invalid frame flags\n");
+    if (frame.head[0] != 0x7E || frame.tail[frame.tailSize - 1] != 0x7E) {
+        AMSAT_LOG_WARN("RadioBridge: invalid frame flags");
         return false;
     }
 
+#if AMSAT_LOG_LEVEL >= AMSAT_LOG_LEVEL_DEBUG
+    // Address decoding allocates, so it only exists in builds that print it
+    const U8* data = frame.head;
     std::string destCall = decodeCallsign(&data[1]);
     U8 destSSID = (data[7] >> 1) & 0x0F;
     std::string srcCall = decodeCallsign(&data[8]);
     U8 srcSSID = (data[14] >> 1) & 0x0F;
+    AMSAT_LOG_DEBUG("RadioBridge: %s-%d > %s-%d, info field %lu bytes", srcCall.c_str(), srcSSID,
+                    destCall.c_str(), destSSID, static_cast<unsigned long>(size - 20));
+#endif
+
+    // A new burst is where the modulation and the cache budget may change
+    if (m_burstFrames == 0) {
+        Fw::ParamValid valid;
+        const AX25::Modulation modulation = this->paramGet_MODULATION(valid);
+        if (modulation != m_modulation) {
+            this->applyModulation(modulation);
+            this->log_ACTIVITY_HI_RADIO_MODULATION_CHANGED(modulation);
+        }
+        m_waveforms.setBudget(this->paramGet_WAVEFORM_CACHE_BYTES(valid));
+    }
 
-    printf("Parsed addresses:\n");
-    printf("  Source:      %s-%d\n", srcCall.c_str(), srcSSID);
-    printf("  Destination: %s-%d\n", destCall.c_str(), destSSID);
-
-    FwSizeType infoStart = 17;
-    FwSizeType infoEnd = size - 3;
-    FwSizeType infoLen = infoEnd - infoStart;
-
-    printf("Info field: %lu bytes\n", infoLen);
+    // Render straight into the burst; the buffer only grows, so steady state
+    // transmission does not allocate. Key-up/key-down padding is added by the sink.
+    // Each piece is bounded on its own, as the modulator checks them one at a time.
+    const FwSizeType bodySize = size - 2;
+    const FwSizeType capacity = m_burstSamples +
+                                m_modulator->maxSamples(0, m_modulator->getLeadFlags() + 1 +
+                                                               m_modulator->getTrailFlags()) +
+                                m_modulator->maxSamples(frame.headSize - 1, 0) +
+                                m_modulator->maxSamples(frame.infoSize, 0) +
+                                m_modulator->maxSamples(frame.tailSize - 1, 0) +
+                                m_modulator->maxSamples(frame.fx25Size, 0);
+    if (m_pcm.size() < capacity) {
+        m_pcm.resize(capacity);
+    }
 
-    std::stringstream infoHex;
-    for (FwSizeType i = infoStart; i < infoEnd; i++) {
-        infoHex << std::hex << std::setw(2) << std::setfill('0') 
-                << static_cast<int>(data[i]);
+    const U64 renderStartNs = Instrumentation::monotonicNs();
+
+    // Consecutive frames share the flag between them, so only the first frame
+    // of a burst renders opening flags. Whatever the sink plays before the
+    // burst (key-up padding, another burst, audio staged a pass ago) breaks
+    // the waveform, so every burst starts from reset behind enough flags for
+    // the receiver to recover.
+    if (m_burstFrames == 0) {
+        this->log_ACTIVITY_LO_RADIO_TX_STARTED();
+        m_burstStart = std::chrono::steady_clock::now();
+        m_modulator->reset();
+        m_burstSamples = m_modulator->renderFlags(m_modulator->getLeadFlags(), m_pcm.data(), m_pcm.size());
     }
+    const FwSizeType frameStart = m_burstFrameSamples;
+    this->renderFrame(frame);
+    const FwSizeType bodySamples = m_burstFrameSamples - frameStart;
+    FW_ASSERT(bodySamples > 0, static_cast<FwAssertArgType>(bodySize));
+    m_modulationTime.recordSince(renderStartNs);
 
-    std::stringstream packet;
-    packet << srcCall;
-    if (srcSSID > 0) packet << "-" << static_cast<int>(srcSSID);
-    packet << ">";
-    packet << destCall;
-    if (destSSID > 0) packet << "-" << static_cast<int>(destSSID);
-    packet << ":";
-    packet << infoHex.str();
+    m_burstBytes += frame.sentSize();
+    m_burstFrames++;
 
-    std::string packetStr = packet.str();
-    printf("Direwolf packet format: %s\n", packetStr.c_str());
+    AMSAT_LOG_DEBUG("RadioBridge: modulated %lu samples (%.2f s of audio), burst now %u frames",
+                    static_cast<unsigned long>(bodySamples),
+                    static_cast<F64>(bodySamples) / AX25::Modulator::SAMPLE_RATE, m_burstFrames);
 
-    const char* textFile = "/tmp/ax25_packet.txt";
-    std::ofstream outfile(textFile);
-    if (!outfile.is_open()) {
-        printf("ERROR: Failed to open text file\n");
-        return false;
+    return true;
+}
+
+void RadioBridge::renderFrame(const FrameParts& frame) {
+    WaveformCache::Key key;
+    key.modulation = static_cast<U8>(m_modulation.e);
+    key.raw = (frame.fx25 != nullptr);
+    if (key.raw) {
+        key.pieces[0] = frame.fx25;
+        key.sizes[0] = frame.fx25Size;
+        key.sizes[1] = 0;
+        key.sizes[2] = 0;
+    } else {
+        key.pieces[0] = &frame.head[1];
+        key.sizes[0] = frame.headSize - 1;
+        key.pieces[1] = frame.info;
+        key.sizes[1] = frame.infoSize;
+        key.pieces[2] = frame.tail;
+        key.sizes[2] = frame.tailSize - 1;
     }
-    outfile << packetStr << std::endl;
-    outfile.close();
-
-    printf("Wrote packet to %s\n", textFile);
-
-    // Generate AFSK audio
-    std::string genCmd = 
-        "gen_packets -o /tmp/ax25_audio.wav " + std::string(textFile) + 
-        " -r 48000 2>&1";
-    
-    printf("Generating audio: %s\n", genCmd.c_str());
-    int genResult = system(genCmd.c_str());
-    
-    if (genResult != 0) {
-        printf("ERROR: Audio generation failed with code %d\n", genResult);
+
+    // Only the first frame of a burst starts from a state the cache can replay
+    FwSizeType bodySamples = 0;
+    m_burstSamples += m_waveforms.render(*m_modulator, key, m_burstFrames == 0, &m_pcm[m_burstSamples],
+                                         m_pcm.size() - m_burstSamples, bodySamples);
+    m_burstFrameSamples += bodySamples;
+}
+
+bool RadioBridge::burstReady() {
+    if (m_burstFrames == 0) {
         return false;
     }
 
-    std::ifstream audioCheck("/tmp/ax25_audio.wav", std::ios::binary | std::ios::ate);
-    if (!audioCheck.is_open()) {
-        printf("ERROR: Audio file not created\n");
-        return false;
+    // Rendering ahead: nobody is waiting, so only the size limits apply
+    Fw::ParamValid valid;
+    const bool sizeLimit = (m_burstSamples >= static_cast<FwSizeType>(TX_LEAD_MS) * AX25::Modulator::SAMPLE_RATE / 1000) ||
+                           (m_burstBytes >= this->paramGet_BURST_MAX_BYTES(valid));
+    if (this->mustStage()) {
+        return sizeLimit;
     }
-    std::streamsize audioSize = audioCheck.tellg();
-    audioCheck.close();
-    
-    printf("Generated audio file: %ld bytes\n", audioSize);
-    
-    if (audioSize < 100) {
-        printf("WARNING: Audio file suspiciously small\n");
-        return false;
+
+    // Nothing else waiting: collecting longer would only add latency
+    if ((this->m_queue.getMessagesAvailable() == 0) && (m_ring.getDepth() == 0) && (m_scheduler.getDepth() == 0) &&
+        (m_spool.getBacklogFrames() == 0)) {
+        return true;
     }
 
-    // Transmit via csdr + rpitx pipeline for RF transmission
-    std::string txCmd =
-        "cat /tmp/ax25_audio.wav | "
-        "csdr convert_i16_f | "
-        "csdr gain_ff 7000 | "
-        "csdr convert_f_samplerf 20833 | "
-        "sudo /usr/local/bin/rpitx -i- -m RF -f 434.9e6 > /dev/null 2>&1";
+    // A longer burst would hold back urgent frames that arrive meanwhile
+    if (sizeLimit) {
+        return true;
+    }
+    const U32 maxDelayMs = this->paramGet_BURST_MAX_DELAY_MS(valid);
+    return (std::chrono::steady_clock::now() - m_burstStart) >= std::chrono::milliseconds(maxDelayMs);
+}
 
-    printf("Transmitting RF on 434.9 MHz via GPIO pin 4...\n");
-    printf("Command: %s\n", txCmd.c_str());
-    
-    int txResult = system(txCmd.c_str());
+void RadioBridge::flushBurst() {
+    if (m_burstFrames == 0) {
+        return;
+    }
 
-    if (txResult == 0) {
-        printf("RF transmission completed successfully\n");
-    } else {
-        printf("RF transmission failed with code: %d\n", txResult);
-        printf("Falling back to audio playback for testing...\n");
-        
-        // Fallback to audio playback if RF fails
-        int audioResult = system("play -q /tmp/ax25_audio.wav 2>&1");
-        if (audioResult == 0) {
-            printf("Audio playback completed (RF unavailable)\n");
-            return true;
+    // The waveform breaks again after the burst
+    m_burstSamples += m_modulator->renderFlags(m_modulator->getTrailFlags(), &m_pcm[m_burstSamples],
+                                               m_pcm.size() - m_burstSamples);
+
+    if (this->mustStage()) {
+        this->stageBurst();
+    } else if (this->writeBurst(m_pcm.data(), m_burstSamples, m_burstFrames, m_burstBytes, m_burstFrameSamples)) {
+        // From here only audio already queued in the sink is ahead of the burst
+        const U64 nowNs = Instrumentation::monotonicNs();
+        for (FwSizeType i = 0; i < m_burstEnqueuedNs.size(); i++) {
+            m_endToEndLatency.record(nowNs - m_burstEnqueuedNs[i]);
+        }
+        if (m_burstFromSpool) {
+            m_spool.release(m_burstSpoolEnd);
         }
     }
 
-    printf("==============================================\n\n");
+    m_burstSamples = 0;
+    m_burstFrameSamples = 0;
+    m_burstBytes = 0;
+    m_burstFrames = 0;
+    m_burstEnqueuedNs.clear();
+    m_burstFromSpool = false;
+}
+
+void RadioBridge::stageBurst() {
+    FwSizeType offset = 0;
+    if (!this->findStageRoom(m_burstSamples, offset)) {
+        // mayRender keeps room for a frame, so only one over STAGE_FRAME_BYTES gets here
+        Fw::LogStringArg errorStr("Pass stage full");
+        this->log_WARNING_HI_RADIO_TX_FAILED(errorStr);
+        m_framesDropped += m_burstFrames;
+        return;
+    }
+    memcpy(&m_stage[offset], m_pcm.data(), m_burstSamples * sizeof(I16));
+    const StagedBurst burst = {offset, m_burstSamples, m_burstFrameSamples, m_burstBytes, m_burstFrames,
+                               m_burstFromSpool, m_burstSpoolEnd};
+    m_stagedBursts.push_back(burst);
+    m_stagedSamples += m_burstSamples;
+    m_stagedFrames += m_burstFrames;
+    AMSAT_LOG_DEBUG("RadioBridge: burst of %u frames staged, %lu samples staged in total", m_burstFrames,
+                    static_cast<unsigned long>(m_stagedSamples));
+}
 
-    return (txResult == 0);
+bool RadioBridge::writeBurst(const I16* samples,
+                             FwSizeType count,
+                             U32 frames,
+                             FwSizeType bytes,
+                             FwSizeType frameSamples) {
+    // Hand the audio to the long-lived sink; it blocks only while the ring is full
+    const U64 writeStartNs = Instrumentation::monotonicNs();
+    const bool written = m_sink.write(samples, count);
+    m_sinkWriteTime.recordSince(writeStartNs);
+
+    if (written) {
+        m_framesSent += frames;
+        m_bytesSent += static_cast<U32>(bytes);
+
+        // Airtime of one keyed transmission: key-up padding, the burst and the tail
+        const FwSizeType airtime = m_txDelaySamples + count + m_txTailSamples;
+        const F32 efficiency = 100.0f * static_cast<F32>(frameSamples) / static_cast<F32>(airtime);
+
+        m_bursts++;
+        this->tlmWrite_BurstsSent(m_bursts);
+        this->tlmWrite_BurstFrames(frames);
+        this->tlmWrite_BurstAirtimeEfficiency(efficiency);
+        this->log_ACTIVITY_HI_RADIO_TX_SUCCESS(frames, efficiency);
+        AMSAT_LOG_DEBUG("RadioBridge: burst of %u frames queued (%.2f s of audio)", frames,
+                        static_cast<F64>(count) / AX25::Modulator::SAMPLE_RATE);
+    } else {
+        Fw::LogStringArg errorStr("Transmit sink is stopped");
+        this->log_WARNING_HI_RADIO_TX_FAILED(errorStr);
+        m_framesDropped += frames;
+        AMSAT_LOG_ERROR("RadioBridge: transmit sink stopped, burst of %u frames dropped", frames);
+    }
+
+    const U32 restarts = m_sink.getRestartCount();
+    if (restarts != m_sinkRestarts) {
+        m_sinkRestarts = restarts;
+        this->log_WARNING_LO_RADIO_SINK_RESTARTED(restarts);
+    }
+    return written;
 }
 
 std::string RadioBridge::decodeCallsign(const U8* encoded) {
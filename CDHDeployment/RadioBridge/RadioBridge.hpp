@@ -2,8 +2,22 @@
 #define RadioBridge_RadioBridge_HPP
 
 #include "CDHDeployment/RadioBridge/RadioBridgeComponentAc.hpp"
+#include "CDHDeployment/AX25/AfskModulator.hpp"
+#include "CDHDeployment/AX25/FrameView.hpp"
+#include "CDHDeployment/AX25/G3ruhModulator.hpp"
+#include "CDHDeployment/RadioBridge/FrameRing.hpp"
+#include "CDHDeployment/RadioBridge/FrameSpool.hpp"
+#include "CDHDeployment/RadioBridge/TxScheduler.hpp"
+#include "CDHDeployment/RadioBridge/TxSink.hpp"
+#include "CDHDeployment/RadioBridge/WaveformCache.hpp"
+#include "CDHDeployment/Instrumentation/LatencyHistogram.hpp"
 #include "Fw/Types/BasicTypes.hpp"
+#include "Fw/Types/MemAllocator.hpp"
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <string>
+#include <vector>
 
 namespace RadioBridge {
 
@@ -11,17 +25,268 @@ class RadioBridge : public RadioBridgeComponentBase {
   public:
     RadioBridge(const char* const compName);
     ~RadioBridge();
-    
+
+    //! Default sink: rpitx in RF mode, fed frequency samples converted from
+    //! the PCM in process (TxSink::Kind::RPITX)
+    static constexpr const char* DEFAULT_SINK_COMMAND =
+        "sudo /usr/local/bin/rpitx -i- -m RF -f 434.9e6 > /dev/null 2>&1";
+
+    //! Select the transmit sink (command pipeline or raw PCM file); call before startSink
+    void configureSink(TxSink::Kind kind, const char* target);
+
+    //! Start the sink writer thread; the sink process is launched once and kept open
+    void startSink(const Os::TaskString& name, FwTaskPriorityType priority, FwSizeType stackSize);
+
+    //! Flush queued audio and stop the sink writer thread
+    void stopSink();
+
+    //! Size the lock-free ring behind ringIn (rounded up to a power of two) and
+    //! the priority queues frames wait in; call before either input port is used
+    void configureRing(FwSizeType capacity);
+
+    //! Keep frames that cannot be sent in a memory-mapped spool file with a
+    //! `capacity` byte data area, recovering frames a previous run left
+    //! there; without one they wait in the queues. Call before startSink.
+    void configureSpool(const char* path, FwSizeType capacity);
+
+    //! Take the audio staged ahead of a pass from `allocator`: PASS_STAGE_BYTES
+    //! of it once parameters are loaded, and again when the parameter changes
+    //! and the stage is empty. Without it frames wait in the queues out of
+    //! contact. Call before loadParameters.
+    void configureStage(FwEnumStoreType memId, Fw::MemAllocator& allocator);
+
+    //! Return the stage memory, dropping audio still staged
+    void cleanupStage();
+
+    //! Send frames from ComQueue queue `comQueueIndex` in `txClass`; unmapped queues are ROUTINE
+    void setQueueClass(FwIndexType comQueueIndex, TxClass txClass);
+
   private:
     void dataIn_handler(
         FwIndexType portNum,
         Fw::Buffer& fwBuffer,
         const ComCfg::FrameContext& context
     ) override;
-    
-    bool transmitAX25Frame(const U8* data, FwSizeType size);
-    
+
+    void ringIn_handler(
+        FwIndexType portNum,
+        Fw::Buffer& fwBuffer,
+        const ComCfg::FrameContext& context
+    ) override;
+
+    void schedIn_handler(FwIndexType portNum, U32 context) override;
+
+    void parametersLoaded() override;
+
+    void parameterUpdated(FwPrmIdType id) override;
+
+    void ringReady_internalInterfaceHandler() override;
+
+    void passStateIn_handler(FwIndexType portNum, const PassScheduler::PassPhase& phase, U32 secondsLeft) override;
+
+    void stageReady_internalInterfaceHandler() override;
+
+    //! Queue a frame in its priority class
+    void enqueueFrame(Fw::Buffer& fwBuffer, const ComCfg::FrameContext& context, U64 enqueuedNs);
+
+    //! Move frames from the ring into the priority classes while there is room
+    void drainRing();
+
+    //! Send waiting frames in scheduled order until none are left, or
+    //! until the pass phase or the stage budget says to stop rendering
+    void transmitPending();
+
+    //! Whether the pass phase and stage budget allow rendering another frame
+    bool mayRender();
+
+    //! Replace the stage with one of PASS_STAGE_BYTES; the stage must be empty
+    void allocateStage();
+
+    //! Where `count` contiguous samples fit in the stage
+    //! \return false if they do not fit
+    bool findStageRoom(FwSizeType count, FwSizeType& offset) const;
+
+    //! Take the next frame from the scheduler and release a blocked dataIn sender
+    bool popFrame(TxScheduler::Frame& frame, TxClass& txClass);
+
+    //! Move queued frames into the spool while it has room
+    void spoolPending();
+
+    //! Render the frame at the spool's read cursor into the burst
+    void sendSpooled(const FrameSpool::Record& record);
+
+    //! Whether audio may go to the sink now
+    bool canTransmit() const;
+
+    //! Whether a finished burst goes to the stage: before AOS, and during a
+    //! pass until the audio staged ahead of it has gone out
+    bool mustStage() const;
+
+    //! Queue a stageReady message unless one is pending or nothing can be sent
+    void sendStaged();
+
+    //! Render one frame into the burst and hand the buffer back
+    void handleFrame(Fw::Buffer& fwBuffer, const ComCfg::FrameContext& context, U64 enqueuedNs);
+
+    //! Tell the upstream sender whether it may send again
+    void sendComStatus(Fw::Success::T status);
+
+    //! Publish the ring counters
+    void writeRingTelemetry();
+
+    //! A frame as three consecutive pieces: contiguous frames use only head
+    //! and tail, segment views borrow info from AMSATFramer's com buffer
+    struct FrameParts {
+        const U8* head;  //!< Opening flag onwards
+        FwSizeType headSize;
+        const U8* info;
+        FwSizeType infoSize;
+        const U8* tail;  //!< Up to and including the closing flag
+        FwSizeType tailSize;
+        const U8* fx25;  //!< FX.25 block sent in place of the frame, nullptr if none
+        FwSizeType fx25Size;
+
+        FwSizeType size() const { return headSize + infoSize + tailSize; }
+        //! Bytes on air: the frame, or the FX.25 block between two flags
+        FwSizeType sentSize() const { return (fx25 != nullptr) ? fx25Size + 2 : this->size(); }
+    };
+
+    //! Split a buffer from AMSATFramer into its pieces
+    //! \return false if the buffer holds no data
+    static bool getFrameParts(const Fw::Buffer& fwBuffer, FrameParts& frame);
+
+    //! Render a frame's body and closing flag at the end of the burst, from
+    //! the waveform cache when the same frame opened an earlier burst
+    void renderFrame(const FrameParts& frame);
+
+    //! Add a frame to the burst, opening the next one if it would not fit
+    void addFrame(const FrameParts& frame, U64 enqueuedNs);
+
+    //! Validate a frame and append its audio to the current burst
+    bool transmitAX25Frame(const FrameParts& frame);
+
+    //! Whether the burst should go out now rather than wait for queued frames
+    bool burstReady();
+
+    //! Close the burst: hand it to the sink as one transmission, or append
+    //! it to the stage when mustStage()
+    void flushBurst();
+
+    //! Copy the burst's audio behind the staged bursts
+    void stageBurst();
+
+    //! Write rendered audio to the sink and publish its statistics
+    //! \return true if the sink took it
+    bool writeBurst(const I16* samples, FwSizeType count, U32 frames, FwSizeType bytes, FwSizeType frameSamples);
+
+    //! Render with `modulation` from now on and give the sink matching keying padding
+    void applyModulation(AX25::Modulation modulation);
+
     std::string decodeCallsign(const U8* encoded);
+
+    //! Time spent sending flags at key-up to let the receiver settle
+    static constexpr U32 TX_DELAY_MS = 200;
+    //! HDLC flags sent after the last queued frame before the transmitter drops
+    static constexpr U32 TX_TAIL_FLAGS = 3;
+    //! Audio committed ahead of the air: the sink holds at most this much
+    //! and a burst closes once it is this long, which bounds how long an
+    //! urgent frame waits behind frames already rendered
+    static constexpr U32 TX_LEAD_MS = 1000;
+    //! ComQueue queues that can be mapped to a class
+    static constexpr FwSizeType MAX_COM_QUEUES = 16;
+    //! Frame mayRender keeps room for in the stage; AMSATFramer's frames and
+    //! FX.25 blocks are smaller
+    static constexpr FwSizeType STAGE_FRAME_BYTES = 512;
+
+    AX25::AfskModulator m_afsk;
+    AX25::G3ruhModulator m_g3ruh;
+    //! Modulator of the current modulation; only changes between bursts
+    AX25::Modulator* m_modulator;
+    AX25::Modulation m_modulation;
+    //! Reusable burst PCM buffer, grown to the largest burst seen so far
+    std::vector<I16> m_pcm;
+    FwSizeType m_txDelaySamples;
+    FwSizeType m_txTailSamples;
+
+    //! Burst being collected: frames share HDLC flags and one key-up
+    FwSizeType m_burstSamples;
+    FwSizeType m_burstFrameSamples;
+    FwSizeType m_burstBytes;
+    U32 m_burstFrames;
+    std::chrono::steady_clock::time_point m_burstStart;
+    //! Enqueue time of each frame in the burst, for end-to-end latency
+    std::vector<U64> m_burstEnqueuedNs;
+    U32 m_bursts;
+
+    Instrumentation::LatencyHistogram m_queueDwell;
+    Instrumentation::LatencyHistogram m_modulationTime;
+    Instrumentation::LatencyHistogram m_sinkWriteTime;
+    Instrumentation::LatencyHistogram m_endToEndLatency;
+    U32 m_framesSent;
+    U32 m_bytesSent;
+    U32 m_framesDropped;
+    //! Counters at the previous schedIn, for the per-second rates
+    U64 m_lastRateNs;
+    U32 m_lastRateFrames;
+    U32 m_lastRateBytes;
+
+    TxScheduler m_scheduler;
+    TxClass m_queueClass[MAX_COM_QUEUES];
+    U32 m_classFramesSent[TxScheduler::CLASSES];
+    //! Time from a frame being queued to it being scheduled, per class
+    Instrumentation::LatencyHistogram m_classWait[TxScheduler::CLASSES];
+
+    FrameRing m_ring;
+    //! A ringReady message is queued and will drain the ring
+    std::atomic<bool> m_ringWakeup;
+    //! The ring filled up and the sender is waiting for a SUCCESS status
+    std::atomic<bool> m_ringBlocked;
+
+    //! Audio of recently rendered frames, replayed for identical ones
+    WaveformCache m_waveforms;
+
+    //! A burst rendered ahead of a pass
+    struct StagedBurst {
+        FwSizeType offset;  //!< First sample in the stage
+        FwSizeType samples;
+        FwSizeType frameSamples;
+        FwSizeType bytes;
+        U32 frames;
+        //! Spool position to release once the burst is sent
+        bool fromSpool;
+        FrameSpool::Position spoolEnd;
+    };
+    //! Phase from PassScheduler; CONTINUOUS while it has reported nothing
+    PassScheduler::PassPhase m_passPhase;
+    //! When the current phase ends, so a staged burst is not started past LOS
+    U64 m_phaseEndNs;
+    //! Staged audio as a ring of whole bursts: the oldest starts the ring, a
+    //! burst that does not fit before the end starts again at sample 0
+    Fw::MemAllocator* m_stageAllocator;
+    FwEnumStoreType m_stageMemId;
+    I16* m_stage;
+    FwSizeType m_stageCapacity;
+    FwSizeType m_stagedSamples;
+    //! PASS_STAGE_BYTES changed; the stage is reallocated once it is empty
+    std::atomic<bool> m_stageResize;
+    std::deque<StagedBurst> m_stagedBursts;
+    U32 m_stagedFrames;
+    //! A stageReady message is queued
+    bool m_stageWakeup;
+    //! The scheduler filled up from dataIn and the sender waits for a SUCCESS status
+    bool m_dataBlocked;
+
+    //! Frames kept across contacts and reboots
+    FrameSpool m_spool;
+    //! Spool position after the burst's last spooled frame
+    FrameSpool::Position m_burstSpoolEnd;
+    bool m_burstFromSpool;
+    U32 m_spoolSpooled;
+    U32 m_spoolDrained;
+    U32 m_lastRateDrained;
+
+    TxSink m_sink;
+    U32 m_sinkRestarts;
 };
 
 } // namespace RadioBridge
@@ -0,0 +1,124 @@
+// ======================================================================
+// \title  TxScheduler.cpp
+// \author madisonw
+// \brief  Priority classes and airtime sharing for frames awaiting transmission
+// ======================================================================
+
+#include "CDHDeployment/RadioBridge/TxScheduler.hpp"
+#include "Fw/Types/Assert.hpp"
+
+namespace RadioBridge {
+
+TxScheduler::TxScheduler() : m_capacity(0), m_count(0), m_current(0), m_lastRefillNs(0) {
+    for (FwSizeType i = 0; i < CLASSES; i++) {
+        m_queues[i].head = 0;
+        m_queues[i].count = 0;
+        m_weights[i] = 1;
+        m_airtimePercent[i] = 100;
+        m_deficitUs[i] = 0;
+        m_tokensUs[i] = BUCKET_US;
+        m_airtimeUs[i] = 0;
+    }
+}
+
+void TxScheduler::setup(FwSizeType capacity) {
+    FW_ASSERT(capacity > 0);
+    for (FwSizeType i = 0; i < CLASSES; i++) {
+        m_queues[i].slots.resize(capacity);
+    }
+    m_capacity = capacity;
+}
+
+void TxScheduler::configure(const U32 weights[CLASSES], const U32 airtimePercent[CLASSES]) {
+    for (FwSizeType i = 0; i < CLASSES; i++) {
+        m_weights[i] = FW_MAX(weights[i], 1U);
+        m_airtimePercent[i] = FW_MIN(airtimePercent[i], 100U);
+    }
+}
+
+bool TxScheduler::push(TxClass txClass, const Frame& frame) {
+    FW_ASSERT(txClass.isValid(), static_cast<FwAssertArgType>(txClass.e));
+    if (this->isFull()) {
+        return false;
+    }
+    Queue& queue = m_queues[txClass.e];
+    queue.slots[(queue.head + queue.count) % m_capacity] = frame;
+    queue.count++;
+    m_count++;
+    return true;
+}
+
+bool TxScheduler::pop(U64 nowNs, Frame& frame, TxClass& txClass) {
+    if (m_count == 0) {
+        return false;
+    }
+    this->refill(nowNs);
+
+    FwSizeType chosen = TxClass::URGENT;
+    if ((m_queues[chosen].count == 0) || !this->withinBudget(chosen)) {
+        bool eligible[CLASSES];
+        bool any = false;
+        for (FwSizeType i = 0; i < CLASSES; i++) {
+            eligible[i] = (m_queues[i].count > 0) && this->withinBudget(i);
+            any = any || eligible[i];
+        }
+        if (!any) {
+            for (FwSizeType i = 0; i < CLASSES; i++) {
+                eligible[i] = (m_queues[i].count > 0);
+            }
+        }
+        chosen = this->nextFairShare(eligible);
+    }
+
+    Queue& queue = m_queues[chosen];
+    frame = queue.slots[queue.head];
+    queue.head = (queue.head + 1) % m_capacity;
+    queue.count--;
+    m_count--;
+    if (queue.count == 0) {
+        // An idle class does not save up a deficit for later
+        m_deficitUs[chosen] = 0;
+    }
+
+    m_tokensUs[chosen] -= frame.airtimeUs;
+    m_airtimeUs[chosen] += frame.airtimeUs;
+    txClass = static_cast<TxClass::T>(chosen);
+    return true;
+}
+
+void TxScheduler::refill(U64 nowNs) {
+    if ((m_lastRefillNs != 0) && (nowNs > m_lastRefillNs)) {
+        const I64 elapsedUs = static_cast<I64>((nowNs - m_lastRefillNs) / 1000);
+        for (FwSizeType i = 0; i < CLASSES; i++) {
+            const I64 limit = BUCKET_US * m_airtimePercent[i] / 100;
+            m_tokensUs[i] = FW_MIN(m_tokensUs[i] + elapsedUs * m_airtimePercent[i] / 100, limit);
+        }
+    }
+    m_lastRefillNs = nowNs;
+}
+
+bool TxScheduler::withinBudget(FwSizeType index) const {
+    // A frame may overdraw the bucket; the class then waits for it to refill
+    return (m_airtimePercent[index] >= 100) || (m_tokensUs[index] > 0);
+}
+
+FwSizeType TxScheduler::nextFairShare(const bool eligible[CLASSES]) {
+    // Each visit that cannot afford the head frame tops the deficit up by
+    // the class's quantum and moves on; a class keeps the turn while it can
+    // afford its next frame
+    while (true) {
+        const FwSizeType index = m_current;
+        if (eligible[index]) {
+            const Queue& queue = m_queues[index];
+            const I64 airtimeUs = queue.slots[queue.head].airtimeUs;
+            if (m_deficitUs[index] >= airtimeUs) {
+                m_deficitUs[index] -= airtimeUs;
+                return index;
+            }
+            m_deficitUs[index] += QUANTUM_US * m_weights[index];
+        }
+        m_current = (m_current + 1) % CLASSES;
+    }
+}
+
+}  // namespace RadioBridge
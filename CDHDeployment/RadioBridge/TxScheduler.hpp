@@ -0,0 +1,94 @@
+// ======================================================================
+// \title  TxScheduler.hpp
+// \author madisonw
+// \brief  Priority classes and airtime sharing for frames awaiting transmission
+// ======================================================================
+
+#ifndef RadioBridge_TxScheduler_HPP
+#define RadioBridge_TxScheduler_HPP
+
+#include "CDHDeployment/RadioBridge/TxClassEnumAc.hpp"
+#include "Fw/Buffer/Buffer.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+#include "config/FrameContextSerializableAc.hpp"
+#include <vector>
+
+namespace RadioBridge {
+
+//! Holds frames in one FIFO per TxClass and decides which goes next.
+//!
+//! URGENT goes first whenever it has a frame and is within its airtime
+//! budget. Otherwise the classes within budget share the link by weighted
+//! deficit round robin, counted in airtime rather than frames so a class
+//! of long frames gets no more than its weight. Budgets are token buckets
+//! refilled at a percentage of real time. When every waiting class is over
+//! budget they share by weight regardless, so the link never idles with
+//! frames waiting.
+class TxScheduler {
+  public:
+    static constexpr FwSizeType CLASSES = TxClass::NUM_CONSTANTS;
+
+    struct Frame {
+        Fw::Buffer buffer;
+        ComCfg::FrameContext context;
+        U64 enqueuedNs;
+        //! Estimated time on air
+        U32 airtimeUs;
+    };
+
+    TxScheduler();
+
+    //! Allocate room for `capacity` frames in each class, `capacity` in total
+    void setup(FwSizeType capacity);
+
+    //! Set each class's weight (0 counts as 1) and airtime percentage
+    void configure(const U32 weights[CLASSES], const U32 airtimePercent[CLASSES]);
+
+    //! Queue a frame in `txClass`
+    //! \return false when the scheduler is full
+    bool push(TxClass txClass, const Frame& frame);
+
+    //! Take the frame that goes next at `nowNs` and charge its airtime
+    //! \return false when no frame is waiting
+    bool pop(U64 nowNs, Frame& frame, TxClass& txClass);
+
+    FwSizeType getDepth() const { return m_count; }
+    FwSizeType getDepth(TxClass txClass) const { return m_queues[txClass.e].count; }
+    bool isFull() const { return m_count >= m_capacity; }
+    //! Airtime charged to a class so far
+    U64 getAirtimeUs(TxClass txClass) const { return m_airtimeUs[txClass.e]; }
+
+  private:
+    //! Airtime a weight of one adds to a class's deficit each round
+    static constexpr I64 QUANTUM_US = 100 * 1000;
+    //! Airtime a full budget bucket holds, at 100%
+    static constexpr I64 BUCKET_US = 10 * 1000 * 1000;
+
+    struct Queue {
+        std::vector<Frame> slots;
+        FwSizeType head;
+        FwSizeType count;
+    };
+
+    //! Add the airtime earned since the last call to every bucket
+    void refill(U64 nowNs);
+    bool withinBudget(FwSizeType index) const;
+    //! Next class by weighted deficit round robin among `eligible`
+    FwSizeType nextFairShare(const bool eligible[CLASSES]);
+
+    Queue m_queues[CLASSES];
+    FwSizeType m_capacity;
+    FwSizeType m_count;
+
+    U32 m_weights[CLASSES];
+    U32 m_airtimePercent[CLASSES];
+    I64 m_deficitUs[CLASSES];
+    I64 m_tokensUs[CLASSES];
+    U64 m_airtimeUs[CLASSES];
+    FwSizeType m_current;
+    U64 m_lastRefillNs;
+};
+
+}  // namespace RadioBridge
+
+#endif
@@ -0,0 +1,312 @@
+// ======================================================================
+// \title  TxSink.cpp
+// \author madisonw
+// \brief  Long-lived PCM sink fed by a dedicated writer thread
+// ======================================================================
+
+#include "CDHDeployment/RadioBridge/TxSink.hpp"
+#include "CDHDeployment/DebugLog/DebugLog.hpp"
+#include "Fw/Time/TimeInterval.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace RadioBridge {
+
+TxSink::TxSink()
+    : m_kind(Kind::FILE),
+      m_head(0),
+      m_tail(0),
+      m_count(0),
+      m_stopping(false),
+      m_paddingChanged(false),
+      m_fd(-1),
+      m_child(-1),
+      m_keyed(false),
+      m_restarts(0),
+      m_keyUps(0),
+      m_samplesWritten(0) {}
+
+TxSink::~TxSink() {
+    this->closeSink();
+}
+
+void TxSink::configure(Kind kind, const char* target, FwSizeType capacitySamples) {
+    FW_ASSERT(target != nullptr);
+    FW_ASSERT(capacitySamples > 0);
+    m_kind = kind;
+    m_target = target;
+    m_ring.assign(capacitySamples, 0);
+    if (kind == Kind::RPITX) {
+        m_rf.configure();
+        m_rfSamples.assign(m_rf.maxOutput(), AX25::Dsp::RfSample());
+    }
+}
+
+void TxSink::setKeyingPadding(const I16* txDelay,
+                              FwSizeType txDelaySamples,
+                              const I16* txTail,
+                              FwSizeType txTailSamples) {
+    Os::ScopeLock lock(m_lock);
+    m_nextTxDelay.assign(txDelay, txDelay + txDelaySamples);
+    m_nextTxTail.assign(txTail, txTail + txTailSamples);
+    m_paddingChanged = true;
+}
+
+void TxSink::start(const Os::TaskString& name, FwTaskPriorityType priority, FwSizeType stackSize) {
+    FW_ASSERT(!m_ring.empty());
+    Os::Task::Arguments arguments(name, TxSink::writerTask, this, priority, stackSize);
+    Os::Task::Status status = m_task.start(arguments);
+    FW_ASSERT(status == Os::Task::OP_OK, static_cast<FwAssertArgType>(status));
+}
+
+void TxSink::stop() {
+    {
+        Os::ScopeLock lock(m_lock);
+        m_stopping = true;
+        m_dataReady.notify();
+        m_spaceReady.notify();
+    }
+    (void)m_task.join();
+}
+
+bool TxSink::write(const I16* samples, FwSizeType count) {
+    FW_ASSERT(samples != nullptr);
+    const FwSizeType capacity = m_ring.size();
+
+    Os::ScopeLock lock(m_lock);
+    while (count > 0) {
+        while (m_count == capacity && !m_stopping) {
+            m_spaceReady.wait(m_lock);
+        }
+        if (m_stopping) {
+            return false;
+        }
+
+        // Copy up to the end of the ring, then wrap on the next pass
+        FwSizeType chunk = FW_MIN(count, capacity - m_count);
+        chunk = FW_MIN(chunk, capacity - m_head);
+        memcpy(&m_ring[m_head], samples, chunk * sizeof(I16));
+        m_head = (m_head + chunk) % capacity;
+        m_count += chunk;
+        samples += chunk;
+        count -= chunk;
+        m_dataReady.notify();
+    }
+    return true;
+}
+
+void TxSink::writerTask(void* sink) {
+    FW_ASSERT(sink != nullptr);
+    static_cast<TxSink*>(sink)->run();
+}
+
+void TxSink::run() {
+    while (true) {
+        {
+            Os::ScopeLock lock(m_lock);
+            while (m_count == 0 && !m_stopping) {
+                m_dataReady.wait(m_lock);
+            }
+            if (m_count == 0 && m_stopping) {
+                break;
+            }
+            if (m_paddingChanged && !m_keyed) {
+                m_txDelay.swap(m_nextTxDelay);
+                m_txTail.swap(m_nextTxTail);
+                m_paddingChanged = false;
+            }
+        }
+
+        // Give up on whatever is still queued if the sink fails while stopping
+        bool ok = this->ensureOpen();
+        if (ok && !m_keyed) {
+            ok = this->writeAll(m_txDelay.data(), m_txDelay.size());
+            if (ok) {
+                m_keyed = true;
+                m_keyUps++;
+            }
+        }
+        ok = ok && this->drainRing();
+        if (!ok) {
+            if (this->isStopping()) {
+                break;
+            }
+            Os::Task::delay(Fw::TimeInterval(RESTART_BACKOFF_MS / 1000, (RESTART_BACKOFF_MS % 1000) * 1000));
+            continue;
+        }
+
+        // Hold the transmission open briefly so the next frame joins this one
+        Os::Task::delay(Fw::TimeInterval(0, HOLD_TIME_MS * 1000));
+        bool idle = false;
+        {
+            Os::ScopeLock lock(m_lock);
+            idle = (m_count == 0);
+        }
+        if (idle && this->writeAll(m_txTail.data(), m_txTail.size())) {
+            m_keyed = false;
+        }
+    }
+
+    if (m_keyed) {
+        (void)this->writeAll(m_txTail.data(), m_txTail.size());
+        m_keyed = false;
+    }
+    this->closeSink();
+}
+
+bool TxSink::isStopping() {
+    Os::ScopeLock lock(m_lock);
+    return m_stopping;
+}
+
+bool TxSink::ensureOpen() {
+    // Reap a command that exited on its own so it gets restarted
+    if (m_child > 0) {
+        int status = 0;
+        if (waitpid(m_child, &status, WNOHANG) == m_child) {
+            AMSAT_LOG_WARN("TxSink: '%s' exited with status %d, restarting", m_target.c_str(), status);
+            m_child = -1;
+            this->closeSink();
+            m_restarts++;
+        }
+    }
+    if (m_fd >= 0) {
+        return true;
+    }
+
+    if (m_kind == Kind::FILE) {
+        m_fd = open(m_target.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (m_fd < 0) {
+            AMSAT_LOG_ERROR("TxSink: failed to open %s: %s", m_target.c_str(), strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        AMSAT_LOG_ERROR("TxSink: failed to create pipe: %s", strerror(errno));
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[0], STDIN_FILENO);
+    posix_spawn_file_actions_addclose(&actions, fds[0]);
+    posix_spawn_file_actions_addclose(&actions, fds[1]);
+
+    char shell[] = "/bin/sh";
+    char flag[] = "-c";
+    char* const argv[] = {shell, flag, const_cast<char*>(m_target.c_str()), nullptr};
+    pid_t child = -1;
+    const int result = posix_spawn(&child, shell, &actions, nullptr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    (void)close(fds[0]);
+
+    if (result != 0) {
+        AMSAT_LOG_ERROR("TxSink: failed to start '%s': %s", m_target.c_str(), strerror(result));
+        (void)close(fds[1]);
+        return false;
+    }
+
+    (void)fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    m_fd = fds[1];
+    m_child = child;
+    AMSAT_LOG_INFO("TxSink: started '%s' (pid %d)", m_target.c_str(), static_cast<int>(child));
+    return true;
+}
+
+void TxSink::closeSink() {
+    if (m_fd >= 0) {
+        (void)close(m_fd);
+        m_fd = -1;
+    }
+    if (m_child > 0) {
+        int status = 0;
+        (void)waitpid(m_child, &status, 0);
+        m_child = -1;
+    }
+    m_keyed = false;
+    // A restarted transmitter starts from silence
+    m_rf.reset();
+}
+
+bool TxSink::writeAll(const I16* samples, FwSizeType count) {
+    if (m_kind != Kind::RPITX) {
+        if (!this->writeBytes(reinterpret_cast<const U8*>(samples), count * sizeof(I16))) {
+            return false;
+        }
+        m_samplesWritten += count;
+        return true;
+    }
+
+    // Convert a block at a time so the RF samples never leave the cache
+    FwSizeType remaining = count;
+    while (remaining > 0) {
+        const FwSizeType block = FW_MIN(remaining, static_cast<FwSizeType>(AX25::RfChain::BLOCK));
+        const FwSizeType produced = m_rf.process(samples, block, m_rfSamples.data());
+        if (!this->writeBytes(reinterpret_cast<const U8*>(m_rfSamples.data()),
+                              produced * sizeof(AX25::Dsp::RfSample))) {
+            return false;
+        }
+        samples += block;
+        remaining -= block;
+    }
+    m_samplesWritten += count;
+    return true;
+}
+
+bool TxSink::writeBytes(const U8* bytes, FwSizeType size) {
+    FwSizeType remaining = size;
+    while (remaining > 0) {
+        const ssize_t written = ::write(m_fd, bytes, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // The reader went away; drop the connection and start over
+            AMSAT_LOG_ERROR("TxSink: write to '%s' failed: %s", m_target.c_str(), strerror(errno));
+            this->closeSink();
+            m_restarts++;
+            return false;
+        }
+        bytes += written;
+        remaining -= static_cast<FwSizeType>(written);
+    }
+    return true;
+}
+
+bool TxSink::drainRing() {
+    const FwSizeType capacity = m_ring.size();
+    while (true) {
+        FwSizeType start = 0;
+        FwSizeType chunk = 0;
+        {
+            Os::ScopeLock lock(m_lock);
+            if (m_count == 0) {
+                return true;
+            }
+            start = m_tail;
+            chunk = FW_MIN(m_count, capacity - m_tail);
+        }
+
+        // The producer never touches the occupied region, so write unlocked
+        if (!this->writeAll(&m_ring[start], chunk)) {
+            return false;
+        }
+
+        Os::ScopeLock lock(m_lock);
+        m_tail = (m_tail + chunk) % capacity;
+        m_count -= chunk;
+        m_spaceReady.notify();
+    }
+}
+
+}  // namespace RadioBridge
@@ -0,0 +1,120 @@
+// ======================================================================
+// \title  TxSink.hpp
+// \author madisonw
+// \brief  Long-lived PCM sink fed by a dedicated writer thread
+// ======================================================================
+
+#ifndef RadioBridge_TxSink_HPP
+#define RadioBridge_TxSink_HPP
+
+#include "CDHDeployment/AX25/RfChain.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+#include "Os/Condition.hpp"
+#include "Os/Mutex.hpp"
+#include "Os/Task.hpp"
+#include <atomic>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace RadioBridge {
+
+//! Streams PCM to a transmitter pipeline that is started once and kept open.
+//!
+//! Producers copy PCM into a ring and return; a writer thread drains the ring
+//! into either a shell command's stdin or a plain file such as /dev/null for
+//! hardware-free throughput testing. For rpitx the writer converts the PCM
+//! to RF samples itself (AX25::RfChain) rather than piping it through csdr.
+//! The writer sends the TXDELAY padding when it keys up and the TXTAIL
+//! padding once the ring has stayed empty for the hold time, so back-to-back
+//! frames go out as one continuous transmission. A command sink that dies is
+//! restarted.
+class TxSink {
+  public:
+    enum class Kind {
+        COMMAND,  //!< Shell command reading raw S16LE PCM on stdin
+        FILE,     //!< File (or device) the raw PCM is written to
+        RPITX     //!< Shell command reading rpitx RF-mode samples on stdin
+    };
+
+    //! Default ring capacity: ten seconds of 48 kHz audio
+    static constexpr FwSizeType DEFAULT_CAPACITY = 10 * 48000;
+
+    TxSink();
+    ~TxSink();
+
+    //! Select the sink; must be called before start()
+    void configure(Kind kind, const char* target, FwSizeType capacitySamples = DEFAULT_CAPACITY);
+
+    //! PCM written at key-up and before key-down. May be called while the
+    //! sink runs: a transmission in progress keeps its padding and the new
+    //! padding applies from the next key-up.
+    void setKeyingPadding(const I16* txDelay, FwSizeType txDelaySamples, const I16* txTail, FwSizeType txTailSamples);
+
+    //! Start the writer thread
+    void start(const Os::TaskString& name, FwTaskPriorityType priority, FwSizeType stackSize);
+
+    //! Stop the writer thread once the ring has drained and wait for it
+    void stop();
+
+    //! Queue PCM for transmission, blocking while the ring is full
+    //! \return false when the sink is stopping and the samples were dropped
+    bool write(const I16* samples, FwSizeType count);
+
+    U32 getRestartCount() const { return m_restarts.load(); }
+    U32 getKeyUpCount() const { return m_keyUps.load(); }
+    U64 getSamplesWritten() const { return m_samplesWritten.load(); }
+
+  private:
+    //! Time the ring may stay empty before the transmission is closed out
+    static constexpr U32 HOLD_TIME_MS = 100;
+    //! Delay before restarting a sink that failed or exited
+    static constexpr U32 RESTART_BACKOFF_MS = 1000;
+
+    static void writerTask(void* sink);
+    void run();
+
+    bool isStopping();
+    bool ensureOpen();
+    void closeSink();
+    bool writeAll(const I16* samples, FwSizeType count);
+    bool writeBytes(const U8* bytes, FwSizeType size);
+    bool drainRing();
+
+    Kind m_kind;
+    std::string m_target;
+
+    //! PCM to RF samples for Kind::RPITX, only touched by the writer
+    AX25::RfChain m_rf;
+    std::vector<AX25::Dsp::RfSample> m_rfSamples;
+
+    std::vector<I16> m_ring;
+    FwSizeType m_head;
+    FwSizeType m_tail;
+    FwSizeType m_count;
+    bool m_stopping;
+    Os::Mutex m_lock;
+    Os::ConditionVariable m_dataReady;
+    Os::ConditionVariable m_spaceReady;
+
+    //! Padding of the current transmission, only touched by the writer
+    std::vector<I16> m_txDelay;
+    std::vector<I16> m_txTail;
+    //! Padding for the next key-up, handed over under m_lock
+    std::vector<I16> m_nextTxDelay;
+    std::vector<I16> m_nextTxTail;
+    bool m_paddingChanged;
+
+    Os::Task m_task;
+    int m_fd;
+    pid_t m_child;
+    bool m_keyed;
+
+    std::atomic<U32> m_restarts;
+    std::atomic<U32> m_keyUps;
+    std::atomic<U64> m_samplesWritten;
+};
+
+}  // namespace RadioBridge
+
+#endif
@@ -0,0 +1,197 @@
+// ======================================================================
+// \title  WaveformCache.cpp
+// \author madisonw
+// \brief  LRU cache of rendered frame audio for repeated transmissions
+// ======================================================================
+
+#include "CDHDeployment/RadioBridge/WaveformCache.hpp"
+#include "CDHDeployment/Instrumentation/LatencyHistogram.hpp"
+#include "Fw/Types/Assert.hpp"
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+namespace RadioBridge {
+
+namespace {
+
+const U64 FNV_OFFSET = 14695981039346656037ULL;
+const U64 FNV_PRIME = 1099511628211ULL;
+
+U64 fnv1a(U64 hash, const U8* data, FwSizeType size) {
+    for (FwSizeType i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+}  // namespace
+
+WaveformCache::WaveformCache()
+    : m_doorkeeperNext(0), m_budget(0), m_bytes(0), m_hits(0), m_misses(0), m_evictions(0), m_savedNs(0) {
+    memset(m_doorkeeper, 0, sizeof(m_doorkeeper));
+}
+
+void WaveformCache::setBudget(FwSizeType bytes) {
+    m_budget = bytes;
+    this->evictTo(bytes);
+}
+
+FwSizeType WaveformCache::render(AX25::Modulator& modulator,
+                                 const Key& key,
+                                 bool burstStart,
+                                 I16* out,
+                                 FwSizeType capacity,
+                                 FwSizeType& bodySamples) {
+    FW_ASSERT(out != nullptr);
+    const bool cached = burstStart && (m_budget > 0);
+    const AX25::Modulator::State startState = modulator.saveState();
+    if (cached) {
+        const Entry* entry = this->find(key, startState);
+        if (entry != nullptr) {
+            FW_ASSERT(entry->samples.size() <= capacity, static_cast<FwAssertArgType>(entry->samples.size()),
+                      static_cast<FwAssertArgType>(capacity));
+            memcpy(out, entry->samples.data(), entry->samples.size() * sizeof(I16));
+            bodySamples = entry->bodySamples;
+            modulator.restoreState(entry->endState);
+            return entry->samples.size();
+        }
+    }
+
+    // The pieces render as one bit-stuffed body between the flags. An FX.25
+    // block already holds the stuffed frame and its flags, and goes as it is.
+    const U64 startNs = Instrumentation::monotonicNs();
+    FwSizeType count = 0;
+    for (U32 i = 0; i < MAX_PIECES; i++) {
+        if (key.sizes[i] == 0) {
+            continue;
+        }
+        count += key.raw ? modulator.renderRaw(key.pieces[i], key.sizes[i], &out[count], capacity - count)
+                         : modulator.renderBody(key.pieces[i], key.sizes[i], &out[count], capacity - count);
+    }
+    bodySamples = count;
+    count += modulator.renderFlags(1, &out[count], capacity - count);
+
+    if (cached) {
+        this->insert(key, startState, out, count, bodySamples, modulator.saveState(),
+                     Instrumentation::monotonicNs() - startNs);
+    }
+    return count;
+}
+
+const WaveformCache::Entry* WaveformCache::find(const Key& key, AX25::Modulator::State startState) {
+    const auto found = m_index.find(hash(key));
+    if ((found == m_index.end()) || !matches(*found->second, key, startState)) {
+        m_misses++;
+        return nullptr;
+    }
+
+    m_lru.splice(m_lru.begin(), m_lru, found->second);
+    m_hits++;
+    m_savedNs += found->second->entry.renderNs;
+    return &found->second->entry;
+}
+
+void WaveformCache::insert(const Key& key,
+                           AX25::Modulator::State startState,
+                           const I16* samples,
+                           FwSizeType count,
+                           FwSizeType bodySamples,
+                           AX25::Modulator::State endState,
+                           U64 renderNs) {
+    FW_ASSERT(samples != nullptr);
+    const U64 keyHash = hash(key);
+    if (!this->admit(keyHash)) {
+        return;
+    }
+
+    Stored stored;
+    stored.hash = keyHash;
+    stored.modulation = key.modulation;
+    stored.raw = key.raw;
+    stored.startState = startState;
+    for (U32 i = 0; i < MAX_PIECES; i++) {
+        if (key.sizes[i] > 0) {
+            stored.bytes.insert(stored.bytes.end(), key.pieces[i], key.pieces[i] + key.sizes[i]);
+        }
+    }
+    stored.entry.samples.assign(samples, samples + count);
+    stored.entry.bodySamples = bodySamples;
+    stored.entry.endState = endState;
+    stored.entry.renderNs = renderNs;
+
+    const FwSizeType size = footprint(stored);
+    if (size > m_budget) {
+        return;
+    }
+
+    // A hash collision with a different frame replaces the older one
+    const auto found = m_index.find(keyHash);
+    if (found != m_index.end()) {
+        this->erase(found->second);
+    }
+    this->evictTo(m_budget - size);
+
+    m_lru.push_front(std::move(stored));
+    m_index[keyHash] = m_lru.begin();
+    m_bytes += size;
+}
+
+U64 WaveformCache::hash(const Key& key) {
+    const U8 header[2] = {key.modulation, static_cast<U8>(key.raw ? 1 : 0)};
+    U64 value = fnv1a(FNV_OFFSET, header, sizeof(header));
+    for (U32 i = 0; i < MAX_PIECES; i++) {
+        if (key.sizes[i] > 0) {
+            value = fnv1a(value, key.pieces[i], key.sizes[i]);
+        }
+    }
+    return value;
+}
+
+bool WaveformCache::matches(const Stored& stored, const Key& key, AX25::Modulator::State startState) {
+    if ((stored.modulation != key.modulation) || (stored.raw != key.raw) || (stored.startState != startState)) {
+        return false;
+    }
+    FwSizeType offset = 0;
+    for (U32 i = 0; i < MAX_PIECES; i++) {
+        if (key.sizes[i] == 0) {
+            continue;
+        }
+        if ((offset + key.sizes[i] > stored.bytes.size()) ||
+            (memcmp(&stored.bytes[offset], key.pieces[i], key.sizes[i]) != 0)) {
+            return false;
+        }
+        offset += key.sizes[i];
+    }
+    return offset == stored.bytes.size();
+}
+
+FwSizeType WaveformCache::footprint(const Stored& stored) {
+    return sizeof(Stored) + stored.bytes.size() + stored.entry.samples.size() * sizeof(I16);
+}
+
+bool WaveformCache::admit(U64 hash) {
+    for (U32 i = 0; i < DOORKEEPER_SIZE; i++) {
+        if (m_doorkeeper[i] == hash) {
+            return true;
+        }
+    }
+    m_doorkeeper[m_doorkeeperNext] = hash;
+    m_doorkeeperNext = (m_doorkeeperNext + 1) % DOORKEEPER_SIZE;
+    return false;
+}
+
+void WaveformCache::erase(Lru::iterator it) {
+    m_bytes -= footprint(*it);
+    m_index.erase(it->hash);
+    m_lru.erase(it);
+}
+
+void WaveformCache::evictTo(FwSizeType bytes) {
+    while ((m_bytes > bytes) && !m_lru.empty()) {
+        this->erase(std::prev(m_lru.end()));
+        m_evictions++;
+    }
+}
+
+}  // namespace RadioBridge
@@ -0,0 +1,134 @@
+// ======================================================================
+// \title  WaveformCache.hpp
+// \author madisonw
+// \brief  LRU cache of rendered frame audio for repeated transmissions
+// ======================================================================
+
+#ifndef RadioBridge_WaveformCache_HPP
+#define RadioBridge_WaveformCache_HPP
+
+#include "CDHDeployment/AX25/Modulator.hpp"
+#include "Fw/Types/BasicTypes.hpp"
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace RadioBridge {
+
+//! Rendered audio of recently sent frames, so a byte-identical frame (a
+//! beacon, a repeated status frame) is copied instead of modulated again.
+//!
+//! The rendering of a frame depends on its bytes, the modulation and the
+//! modulator state it starts from. Only the frame opening a burst is looked
+//! up: every burst starts from a reset modulator behind its lead flags, so
+//! that state is the same each time, while a later frame starts wherever
+//! the one before it left off. An entry replays exactly the samples the
+//! modulator would have produced and hands back the state it would have
+//! ended in. Lookups go through a 64-bit FNV-1a hash of the modulation and
+//! bytes; a hit still compares the bytes and the start state.
+//!
+//! Entries are evicted least recently used first to stay within a memory
+//! budget. A frame is only stored the second time it is seen (recorded in
+//! a small ring of recent hashes), so a stream of one-off frames such as a
+//! file downlink does not push the beacons out.
+class WaveformCache {
+  public:
+    //! Pieces of a frame rendered back to back, as RadioBridge holds them
+    static constexpr U32 MAX_PIECES = 3;
+
+    //! What a rendering depends on
+    struct Key {
+        U8 modulation;
+        //! Rendered without bit stuffing (an FX.25 block)
+        bool raw;
+        const U8* pieces[MAX_PIECES];
+        FwSizeType sizes[MAX_PIECES];
+    };
+
+    WaveformCache();
+
+    //! Bytes of audio and frame data the cache may hold; shrinking evicts
+    //! at once, and a budget of 0 turns the cache off
+    void setBudget(FwSizeType bytes);
+
+    //! Render the frame of `key` and its closing flag into `out` with
+    //! `modulator`, or copy them from the cache and leave `modulator` in the
+    //! state the rendering would have. Only a frame with `burstStart` set,
+    //! the first one after the lead flags, is looked up or stored.
+    //! \return samples written; `bodySamples` is set to those of the body alone
+    FwSizeType render(AX25::Modulator& modulator,
+                      const Key& key,
+                      bool burstStart,
+                      I16* out,
+                      FwSizeType capacity,
+                      FwSizeType& bodySamples);
+
+    U32 getHits() const { return m_hits; }
+    U32 getMisses() const { return m_misses; }
+    U32 getEvictions() const { return m_evictions; }
+    FwSizeType getBytes() const { return m_bytes; }
+    //! Rendering time the hits avoided
+    U64 getSavedNs() const { return m_savedNs; }
+
+  private:
+    //! Recent hashes remembered for admission
+    static constexpr U32 DOORKEEPER_SIZE = 64;
+
+    struct Entry {
+        //! The frame body and its closing flag
+        std::vector<I16> samples;
+        //! Samples of the body alone, without the flag
+        FwSizeType bodySamples;
+        AX25::Modulator::State endState;
+        //! Time the original rendering took
+        U64 renderNs;
+    };
+
+    struct Stored {
+        U64 hash;
+        U8 modulation;
+        bool raw;
+        AX25::Modulator::State startState;
+        std::vector<U8> bytes;
+        Entry entry;
+    };
+    typedef std::list<Stored> Lru;
+
+    //! Entry rendered from `key` and `startState`, now the most recently used, or nullptr
+    const Entry* find(const Key& key, AX25::Modulator::State startState);
+
+    //! Remember `count` samples rendered from `key` and `startState` if it has been seen before
+    void insert(const Key& key,
+                AX25::Modulator::State startState,
+                const I16* samples,
+                FwSizeType count,
+                FwSizeType bodySamples,
+                AX25::Modulator::State endState,
+                U64 renderNs);
+
+    static U64 hash(const Key& key);
+    static bool matches(const Stored& stored, const Key& key, AX25::Modulator::State startState);
+    static FwSizeType footprint(const Stored& stored);
+
+    //! Remember `hash`, returning whether it was already there
+    bool admit(U64 hash);
+    void erase(Lru::iterator it);
+    void evictTo(FwSizeType bytes);
+
+    //! Most recently used first
+    Lru m_lru;
+    std::unordered_map<U64, Lru::iterator> m_index;
+    U64 m_doorkeeper[DOORKEEPER_SIZE];
+    U32 m_doorkeeperNext;
+    FwSizeType m_budget;
+    FwSizeType m_bytes;
+
+    U32 m_hits;
+    U32 m_misses;
+    U32 m_evictions;
+    U64 m_savedNs;
+};
+
+}  // namespace RadioBridge
+
+#endif
@@ -0,0 +1,211 @@
+// ======================================================================
+// \title  FrameSpoolTest.cpp
+// \author madisonw
+// \brief  FrameSpool tests: wrapping, recovery on reopen, damaged records
+// ======================================================================
+
+#include "CDHDeployment/RadioBridge/FrameSpool.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+typedef std::vector<U8> Bytes;
+
+const char* const PATH = "FrameSpoolTest.spool";
+//! Smallest data area the spool accepts
+const FwSizeType CAPACITY = 2 * RadioBridge::FrameSpool::MAX_RECORD_SIZE;
+
+// File layout as FrameSpool writes it: a header page, then the data area
+// of records that each start with a 16-byte header and are 8-byte aligned
+const FwSizeType HEADER_SIZE = 4096;
+const FwSizeType RECORD_HEADER_SIZE = 16;
+const U32 PAD_MAGIC = 0x50414444U;
+
+FwSizeType recordSize(FwSizeType payload) {
+    return (RECORD_HEADER_SIZE + payload + 7) / 8 * 8;
+}
+
+Bytes frameBytes(U32 number, FwSizeType size) {
+    Bytes data(size);
+    for (FwSizeType i = 0; i < size; i++) {
+        data[i] = static_cast<U8>(number * 31 + i * 7);
+    }
+    return data;
+}
+
+//! Frame `number` in three pieces, as RadioBridge spools a segment view
+bool append(RadioBridge::FrameSpool& spool, U32 number, FwSizeType size, const Bytes& fx25 = Bytes()) {
+    const Bytes frame = frameBytes(number, size);
+    const FwSizeType third = size / 3;
+    RadioBridge::FrameSpool::Frame pieces = {
+        {frame.data(), &frame[third], &frame[2 * third]},
+        {third, third, size - 2 * third},
+        fx25.empty() ? nullptr : fx25.data(),
+        fx25.size()};
+    return spool.append(pieces);
+}
+
+//! Read frame `number` at the cursor and move past it
+void expectNext(RadioBridge::FrameSpool& spool, U32 number, FwSizeType size, const Bytes& fx25 = Bytes()) {
+    RadioBridge::FrameSpool::Record record;
+    ASSERT_TRUE(spool.peek(record)) << "frame " << number;
+    ASSERT_EQ(record.frameSize, size) << "frame " << number;
+    EXPECT_EQ(Bytes(record.frame, record.frame + record.frameSize), frameBytes(number, size)) << "frame " << number;
+    ASSERT_EQ(record.fx25Size, fx25.size()) << "frame " << number;
+    if (!fx25.empty()) {
+        EXPECT_EQ(Bytes(record.fx25, record.fx25 + record.fx25Size), fx25) << "frame " << number;
+    }
+    spool.next();
+}
+
+class FrameSpoolTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        (void)unlink(PATH);
+        ASSERT_TRUE(m_spool.open(PATH, CAPACITY));
+    }
+
+    void TearDown() override {
+        m_spool.close();
+        (void)unlink(PATH);
+    }
+
+    //! Close the spool and open the same file again, as after a reboot
+    void reopen() {
+        m_spool.close();
+        ASSERT_TRUE(m_spool.open(PATH, CAPACITY));
+    }
+
+    //! Read a word of the closed spool's data area
+    U32 readWord(FwSizeType offset) {
+        U32 word = 0;
+        FILE* file = fopen(PATH, "rb");
+        EXPECT_NE(file, nullptr);
+        if (file != nullptr) {
+            EXPECT_EQ(fseek(file, static_cast<long>(HEADER_SIZE + offset), SEEK_SET), 0);
+            EXPECT_EQ(fread(&word, sizeof(word), 1, file), 1U);
+            fclose(file);
+        }
+        return word;
+    }
+
+    //! Flip bits of one byte in the closed spool's data area
+    void corruptByte(FwSizeType offset) {
+        FILE* file = fopen(PATH, "r+b");
+        ASSERT_NE(file, nullptr);
+        U8 byte = 0;
+        ASSERT_EQ(fseek(file, static_cast<long>(HEADER_SIZE + offset), SEEK_SET), 0);
+        ASSERT_EQ(fread(&byte, 1, 1, file), 1U);
+        byte ^= 0x5A;
+        ASSERT_EQ(fseek(file, static_cast<long>(HEADER_SIZE + offset), SEEK_SET), 0);
+        ASSERT_EQ(fwrite(&byte, 1, 1, file), 1U);
+        fclose(file);
+    }
+
+    RadioBridge::FrameSpool m_spool;
+};
+
+}  // namespace
+
+TEST_F(FrameSpoolTest, WrapLeavesPad) {
+    // Eight records fill all but the last 64 bytes of the data area
+    const FwSizeType size = 1000;
+    const FwSizeType record = recordSize(size);
+    ASSERT_EQ(CAPACITY / record, 8U);
+    for (U32 i = 0; i < 8; i++) {
+        ASSERT_TRUE(append(m_spool, i, size)) << "frame " << i;
+    }
+    EXPECT_FALSE(append(m_spool, 8, size));
+
+    // Releasing two makes room at the start, so the next record wraps
+    expectNext(m_spool, 0, size);
+    expectNext(m_spool, 1, size);
+    m_spool.release(m_spool.getReadPosition());
+    ASSERT_TRUE(append(m_spool, 8, size));
+    const FwSizeType pad = CAPACITY - 8 * record;
+    EXPECT_EQ(m_spool.getBacklogFrames(), 7U);
+    EXPECT_EQ(m_spool.getBacklogBytes(), 6 * record + pad + record);
+
+    m_spool.close();
+    EXPECT_EQ(readWord(8 * record), PAD_MAGIC);
+
+    // The wrapped spool comes back as it was left, pad and all
+    ASSERT_TRUE(m_spool.open(PATH, CAPACITY));
+    EXPECT_EQ(m_spool.getRecovered(), 7U);
+    EXPECT_EQ(m_spool.getDiscarded(), 0U);
+    EXPECT_EQ(m_spool.getReadPosition().offset, 2 * record);
+    EXPECT_EQ(m_spool.getReadPosition().sequence, 2U);
+    EXPECT_EQ(m_spool.getBacklogBytes(), 6 * record + pad + record);
+    for (U32 i = 2; i <= 8; i++) {
+        expectNext(m_spool, i, size);
+    }
+    RadioBridge::FrameSpool::Record last;
+    EXPECT_FALSE(m_spool.peek(last));
+}
+
+TEST_F(FrameSpoolTest, ReopenRestoresPositions) {
+    const FwSizeType size = 100;
+    const Bytes fx25 = frameBytes(99, 40);
+    for (U32 i = 0; i < 5; i++) {
+        ASSERT_TRUE(append(m_spool, i, size, (i == 3) ? fx25 : Bytes()));
+    }
+    expectNext(m_spool, 0, size);
+    expectNext(m_spool, 1, size);
+    const RadioBridge::FrameSpool::Position head = m_spool.getReadPosition();
+    m_spool.release(head);
+    // Read but never released: it is sent again after the reboot
+    expectNext(m_spool, 2, size);
+
+    reopen();
+    EXPECT_EQ(m_spool.getRecovered(), 3U);
+    EXPECT_EQ(m_spool.getDiscarded(), 0U);
+    EXPECT_EQ(m_spool.getReadPosition().offset, head.offset);
+    EXPECT_EQ(m_spool.getReadPosition().sequence, head.sequence);
+    EXPECT_EQ(m_spool.getBacklogFrames(), 3U);
+    EXPECT_EQ(m_spool.getBacklogBytes(), 2 * recordSize(size) + recordSize(size + fx25.size()));
+
+    // The tail sequence carried over, so a new record is kept by the next recovery
+    ASSERT_TRUE(append(m_spool, 5, size));
+    reopen();
+    EXPECT_EQ(m_spool.getRecovered(), 4U);
+    EXPECT_EQ(m_spool.getReadPosition().sequence, head.sequence);
+    expectNext(m_spool, 2, size);
+    expectNext(m_spool, 3, size, fx25);
+    expectNext(m_spool, 4, size);
+    expectNext(m_spool, 5, size);
+}
+
+TEST_F(FrameSpoolTest, DamagedLastRecordIsDiscarded) {
+    const FwSizeType size = 100;
+    const FwSizeType record = recordSize(size);
+    for (U32 i = 0; i < 4; i++) {
+        ASSERT_TRUE(append(m_spool, i, size));
+    }
+    m_spool.close();
+    corruptByte(3 * record + RECORD_HEADER_SIZE + 10);
+
+    ASSERT_TRUE(m_spool.open(PATH, CAPACITY));
+    EXPECT_EQ(m_spool.getRecovered(), 3U);
+    EXPECT_EQ(m_spool.getDiscarded(), 1U);
+    EXPECT_EQ(m_spool.getBacklogFrames(), 3U);
+    EXPECT_EQ(m_spool.getBacklogBytes(), 3 * record);
+    for (U32 i = 0; i < 3; i++) {
+        expectNext(m_spool, i, size);
+    }
+    RadioBridge::FrameSpool::Record last;
+    EXPECT_FALSE(m_spool.peek(last));
+
+    // The next frame takes the damaged record's place and sequence
+    ASSERT_TRUE(append(m_spool, 4, size));
+    reopen();
+    EXPECT_EQ(m_spool.getRecovered(), 4U);
+    EXPECT_EQ(m_spool.getDiscarded(), 0U);
+    for (U32 i = 0; i < 3; i++) {
+        expectNext(m_spool, i, size);
+    }
+    expectNext(m_spool, 4, size);
+}
@@ -0,0 +1,12 @@
+// ======================================================================
+// \title  Main.cpp
+// \author madisonw
+// \brief  Unit test entry point for the RadioBridge helpers
+// ======================================================================
+
+#include <gtest/gtest.h>
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,275 @@
+// ======================================================================
+// \title  WaveformCacheTest.cpp
+// \author madisonw
+// \brief  WaveformCache tests: repeated beacons framed and rendered as on the downlink
+// ======================================================================
+
+#include "CDHDeployment/AX25/AfskDemodulator.hpp"
+#include "CDHDeployment/AX25/AfskModulator.hpp"
+#include "CDHDeployment/AX25/Crc16.hpp"
+#include "CDHDeployment/AX25/FrameView.hpp"
+#include "CDHDeployment/AX25/G3ruhDemodulator.hpp"
+#include "CDHDeployment/AX25/G3ruhModulator.hpp"
+#include "CDHDeployment/AX25/HdlcDeframer.hpp"
+#include "CDHDeployment/RadioBridge/WaveformCache.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+typedef std::vector<U8> Bytes;
+typedef std::vector<AX25::FrameView> Burst;
+
+const U8 FLAG = AX25::Modulator::HDLC_FLAG;
+//! Key-up and key-down padding, as TxSink plays it around the bursts
+const U32 TX_DELAY_FLAGS = 32;
+const U32 TX_TAIL_FLAGS = 4;
+const FwSizeType BUDGET = 1024 * 1024;
+
+Bytes message(FwSizeType size, U8 seed) {
+    Bytes data(size);
+    for (FwSizeType i = 0; i < size; i++) {
+        data[i] = static_cast<U8>(seed + i * 13);
+    }
+    return data;
+}
+
+void putAddress(U8* out, const char* callsign, U8 ssid, bool last) {
+    const FwSizeType length = strlen(callsign);
+    for (FwSizeType i = 0; i < 6; i++) {
+        out[i] = static_cast<U8>(((i < length) ? callsign[i] : ' ') << 1);
+    }
+    out[6] = static_cast<U8>(0x60 | ((ssid & 0x0F) << 1) | (last ? 0x01 : 0x00));
+}
+
+//! Segments com buffers into frame views the way AMSATFramer does: one
+//! route header, numbered messages, the FCS carried over the borrowed info
+class Framer {
+  public:
+    Framer() : m_nextMessage(0), m_headerSize(AX25::MIN_HEADER_SIZE) {
+        putAddress(&m_header[0], "CQ", 0, false);
+        putAddress(&m_header[7], "N0CALL", 1, true);
+        m_header[14] = 0x03;
+        m_header[15] = 0xF0;
+        m_headerCrc = AX25::Crc16::update(AX25::Crc16::INITIAL, m_header, m_headerSize);
+    }
+
+    //! Views of every segment of `data`, which has to outlive them
+    Burst segment(const Bytes& data) {
+        const FwSizeType count = AX25::segmentCount(data.size());
+        const U16 number = AX25::SegmentHeader::number(m_nextMessage, count);
+        Burst views(count);
+        for (FwSizeType i = 0; i < count; i++) {
+            AX25::FrameView& view = views[i];
+            const FwSizeType offset = i * AX25::MAX_SEGMENT_PAYLOAD;
+            view.marker = AX25::FrameView::MARKER;
+            view.prefixSize = static_cast<U8>(1 + m_headerSize + AX25::SegmentHeader::SIZE);
+            view.info = data.data() + offset;
+            view.infoSize = FW_MIN(data.size() - offset, AX25::MAX_SEGMENT_PAYLOAD);
+            view.fx25Size = 0;
+
+            AX25::SegmentHeader header;
+            header.message = number;
+            header.packed = false;
+            header.compressed = false;
+            header.index = static_cast<U8>(i);
+            header.count = static_cast<U8>(count);
+            view.prefix[0] = FLAG;
+            memcpy(&view.prefix[1], m_header, m_headerSize);
+            header.serialize(&view.prefix[1 + m_headerSize]);
+
+            U16 crc = AX25::Crc16::update(m_headerCrc, &view.prefix[1 + m_headerSize], AX25::SegmentHeader::SIZE);
+            crc = AX25::Crc16::finish(AX25::Crc16::update(crc, view.info, view.infoSize));
+            view.suffix[0] = static_cast<U8>(crc & 0xFF);
+            view.suffix[1] = static_cast<U8>((crc >> 8) & 0xFF);
+            view.suffix[2] = FLAG;
+        }
+        return views;
+    }
+
+  private:
+    std::atomic<U16> m_nextMessage;
+    U8 m_header[AX25::MAX_HEADER_SIZE];
+    FwSizeType m_headerSize;
+    U16 m_headerCrc;
+};
+
+//! The frame of a view between its flags, without FCS: what the deframer delivers
+Bytes contents(const AX25::FrameView& view) {
+    Bytes frame(&view.prefix[1], &view.prefix[view.prefixSize]);
+    frame.insert(frame.end(), view.info, view.info + view.infoSize);
+    return frame;
+}
+
+//! The whole frame as it goes on air
+Bytes onAir(const AX25::FrameView& view) {
+    Bytes frame(view.prefix, view.prefix + view.prefixSize);
+    frame.insert(frame.end(), view.info, view.info + view.infoSize);
+    frame.insert(frame.end(), view.suffix, view.suffix + AX25::FrameView::SUFFIX_SIZE);
+    return frame;
+}
+
+//! Append one burst as RadioBridge renders it: a reset modulator behind its
+//! lead flags, each frame through the cache, then the trail flags
+void renderBurst(RadioBridge::WaveformCache& cache,
+                 U8 modulation,
+                 AX25::Modulator& modulator,
+                 const Burst& burst,
+                 std::vector<I16>& pcm) {
+    FwSizeType capacity = modulator.maxSamples(0, modulator.getLeadFlags() + modulator.getTrailFlags());
+    for (const AX25::FrameView& view : burst) {
+        capacity += modulator.maxSamples(view.prefixSize - 1, 1) + modulator.maxSamples(view.infoSize, 0) +
+                    modulator.maxSamples(AX25::FrameView::SUFFIX_SIZE - 1, 0);
+    }
+    std::vector<I16> out(capacity);
+
+    modulator.reset();
+    FwSizeType used = modulator.renderFlags(modulator.getLeadFlags(), out.data(), out.size());
+    for (FwSizeType i = 0; i < burst.size(); i++) {
+        const AX25::FrameView& view = burst[i];
+        RadioBridge::WaveformCache::Key key;
+        key.modulation = modulation;
+        key.raw = false;
+        key.pieces[0] = &view.prefix[1];
+        key.sizes[0] = view.prefixSize - 1;
+        key.pieces[1] = view.info;
+        key.sizes[1] = view.infoSize;
+        key.pieces[2] = view.suffix;
+        key.sizes[2] = AX25::FrameView::SUFFIX_SIZE - 1;
+        FwSizeType bodySamples = 0;
+        used += cache.render(modulator, key, i == 0, &out[used], out.size() - used, bodySamples);
+        EXPECT_GT(bodySamples, 0U) << "frame " << i;
+    }
+    used += modulator.renderFlags(modulator.getTrailFlags(), &out[used], out.size() - used);
+    pcm.insert(pcm.end(), out.begin(), out.begin() + used);
+}
+
+//! Key-up padding, the bursts, key-down padding, each a break in the waveform
+std::vector<I16> transmit(RadioBridge::WaveformCache& cache,
+                          U8 modulation,
+                          AX25::Modulator& modulator,
+                          const std::vector<Burst>& bursts) {
+    std::vector<I16> pcm(modulator.maxSamples(0, TX_DELAY_FLAGS));
+    modulator.reset();
+    EXPECT_GT(modulator.renderFlags(TX_DELAY_FLAGS, pcm.data(), pcm.size()), 0U);
+    for (const Burst& burst : bursts) {
+        renderBurst(cache, modulation, modulator, burst, pcm);
+    }
+    std::vector<I16> tail(modulator.maxSamples(0, TX_TAIL_FLAGS));
+    modulator.reset();
+    EXPECT_GT(modulator.renderFlags(TX_TAIL_FLAGS, tail.data(), tail.size()), 0U);
+    pcm.insert(pcm.end(), tail.begin(), tail.end());
+    return pcm;
+}
+
+void frameReceived(void* context, const U8* frame, FwSizeType size) {
+    static_cast<std::vector<Bytes>*>(context)->emplace_back(frame, frame + size);
+}
+
+//! Beacons sent again and again, alone and ahead of a longer message, are
+//! rendered once, replayed from then on, and all still decode
+template <typename Modulator, typename Demodulator>
+void repeatedBeacons(U8 modulation) {
+    Framer framer;
+    const Bytes beacon = message(40, 1);
+    const Bytes file = message(600, 2);
+
+    // The framer numbers only the longer message, so every beacon frame is the same
+    std::vector<Burst> bursts;
+    for (U32 i = 0; i < 3; i++) {
+        bursts.push_back(framer.segment(beacon));
+    }
+    Burst mixed = framer.segment(beacon);
+    const Burst segments = framer.segment(file);
+    ASSERT_EQ(segments.size(), 3U);
+    mixed.insert(mixed.end(), segments.begin(), segments.end());
+    bursts.push_back(mixed);
+    for (const Burst& burst : bursts) {
+        EXPECT_EQ(onAir(burst[0]), onAir(bursts[0][0]));
+    }
+
+    Modulator modulator;
+    RadioBridge::WaveformCache cache;
+    cache.setBudget(BUDGET);
+    const std::vector<I16> pcm = transmit(cache, modulation, modulator, bursts);
+
+    // Seen once, stored the second time, replayed the third and fourth;
+    // the frames later in a burst are never looked up
+    EXPECT_EQ(cache.getMisses(), 2U);
+    EXPECT_EQ(cache.getHits(), 2U);
+    EXPECT_EQ(cache.getEvictions(), 0U);
+    EXPECT_GT(cache.getBytes(), 0U);
+
+    // The replayed audio is what the modulator renders without the cache
+    RadioBridge::WaveformCache off;
+    EXPECT_EQ(pcm, transmit(off, modulation, modulator, bursts));
+    EXPECT_EQ(off.getHits() + off.getMisses(), 0U);
+
+    std::vector<Bytes> received;
+    AX25::HdlcDeframer deframer(frameReceived, &received);
+    Demodulator demodulator;
+    demodulator.process(pcm.data(), pcm.size(), deframer);
+    std::vector<Bytes> expected;
+    for (const Burst& burst : bursts) {
+        for (const AX25::FrameView& view : burst) {
+            expected.push_back(contents(view));
+        }
+    }
+    EXPECT_EQ(received, expected);
+    EXPECT_EQ(deframer.getFcsErrorCount(), 0U);
+
+    // Every beacon copy is delivered, and the longer message after one
+    AX25::Reassembler reassembler;
+    const FwSizeType infoOffset = AX25::MIN_HEADER_SIZE;
+    U32 beacons = 0;
+    for (const Bytes& frame : received) {
+        if (reassembler.push(&frame[infoOffset], frame.size() - infoOffset) ==
+            AX25::Reassembler::Status::COMPLETE) {
+            const Bytes delivered(reassembler.getMessage(),
+                                  reassembler.getMessage() + reassembler.getMessageSize());
+            if (delivered == beacon) {
+                beacons++;
+            } else {
+                EXPECT_EQ(delivered, file);
+            }
+        }
+    }
+    EXPECT_EQ(beacons, 4U);
+    EXPECT_EQ(reassembler.getCompleteCount(), 5U);
+}
+
+}  // namespace
+
+TEST(WaveformCache, RepeatedAfskBeacons) {
+    repeatedBeacons<AX25::AfskModulator, AX25::AfskDemodulator>(0);
+}
+
+TEST(WaveformCache, RepeatedG3ruhBeacons) {
+    repeatedBeacons<AX25::G3ruhModulator, AX25::G3ruhDemodulator>(1);
+}
+
+TEST(WaveformCache, ModulationIsPartOfTheKey) {
+    Framer framer;
+    const Bytes beacon = message(40, 3);
+    const std::vector<Burst> bursts(2, framer.segment(beacon));
+
+    // The same frame at the other modulation is a different rendering
+    AX25::AfskModulator afsk;
+    AX25::G3ruhModulator g3ruh;
+    RadioBridge::WaveformCache cache;
+    cache.setBudget(BUDGET);
+    (void)transmit(cache, 0, afsk, bursts);
+    EXPECT_EQ(cache.getHits(), 0U);
+    (void)transmit(cache, 1, g3ruh, bursts);
+    EXPECT_EQ(cache.getHits(), 0U);
+    (void)transmit(cache, 0, afsk, bursts);
+    EXPECT_EQ(cache.getHits(), 2U);
+    EXPECT_EQ(cache.getMisses(), 4U);
+
+    // A budget too small for one rendering keeps nothing
+    cache.setBudget(sizeof(I16));
+    EXPECT_EQ(cache.getBytes(), 0U);
+    EXPECT_GT(cache.getEvictions(), 0U);
+}
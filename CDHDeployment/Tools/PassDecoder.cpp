@@ -0,0 +1,642 @@
+// ======================================================================
+// \title  PassDecoder.cpp
+// \author madisonw
+// \brief  Decodes a recorded pass into F´ packets on every core
+//
+// Usage: PassDecoder [-m afsk|g3ruh] [-f pcm|iq] [-r rate] [-d deviation]
+//                    [-j threads] [-c chunk_seconds] [-o framed_file] recording
+//
+// A .wav recording carries its own rate: mono is audio as it comes out of
+// the receiver and stereo is I/Q baseband. Anything else is raw 16-bit
+// native-endian samples at -r Hz (default 48000), either audio (-f pcm,
+// the default, as AX25Receiver reads) or interleaved I/Q (-f iq). I/Q is
+// FM-demodulated with the given peak deviation (default 3000 Hz), and
+// audio at other rates is resampled to the 48 kHz the demodulators run at.
+//
+// The recording is memory-mapped and cut into chunks (default 30 s) that
+// worker threads (default one per core) demodulate on their own. Each
+// chunk starts early by the air time of the longest frame, so a frame
+// straddling a boundary is whole in the later chunk. Frames are merged in
+// time order, copies decoded by two chunks are dropped, and the info
+// fields are reassembled and unpacked as AX25Receiver does.
+//
+// Prints one CSV line per F´ packet:
+//
+//   seconds,bytes,packet_hex
+//
+// seconds is the end of the frame that completed the packet, from the
+// start of the recording. With -o the packets are also written F´-framed,
+// as FprimeFramer does, so fprime-gds or an FprimeDeframer can read them.
+// Decode statistics go to stderr, including the realtime factor
+// (recording length over wall time).
+// ======================================================================
+
+#include "CDHDeployment/AX25/AfskDemodulator.hpp"
+#include "CDHDeployment/AX25/Compression.hpp"
+#include "CDHDeployment/AX25/Crc16.hpp"
+#include "CDHDeployment/AX25/Dsp.hpp"
+#include "CDHDeployment/AX25/G3ruhDemodulator.hpp"
+#include "CDHDeployment/AX25/HdlcDeframer.hpp"
+#include "CDHDeployment/AX25/Modulator.hpp"
+#include "CDHDeployment/AX25/Packing.hpp"
+#include "CDHDeployment/AX25/Resampler.hpp"
+#include "CDHDeployment/AX25/Segmentation.hpp"
+#include "Utils/Hash/Hash.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <mutex>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+//! Rate the demodulators run at
+const U32 OUTPUT_RATE = AX25::Modulator::SAMPLE_RATE;
+//! Demodulated FM at the peak deviation, leaving headroom for noise
+const F32 PCM_PEAK = 16384.0f;
+//! Air time of the longest HDLC frame with every fifth bit stuffed, plus
+//! flags for the demodulator to lock on, in bits
+const U32 MAX_FRAME_BITS = static_cast<U32>(AX25::HdlcDeframer::MAX_FRAME_SIZE * 8 * 6 / 5 + 32 * 8);
+
+const U8 AX25_CONTROL_UI = 0x03;
+const U8 AX25_CONTROL_PF = 0x10;
+const U8 AX25_PID_NO_L3 = 0xF0;
+
+//! FprimeProtocol::FrameHeader start word
+const U32 FPRIME_START_WORD = 0xDEADBEEF;
+
+struct Options {
+    bool g3ruh;
+    bool iq;
+    U32 rate;
+    F32 deviation;
+    U32 threads;
+    F64 chunkSeconds;
+    const char* framedPath;
+    const char* path;
+
+    Options()
+        : g3ruh(false),
+          iq(false),
+          rate(OUTPUT_RATE),
+          deviation(3000.0f),
+          threads(0),
+          chunkSeconds(30.0),
+          framedPath(nullptr),
+          path(nullptr) {}
+};
+
+//! Samples of a mapped recording; a sample of I/Q is one pair
+struct Recording {
+    const U8* samples;
+    U64 count;
+    U32 rate;
+    bool iq;
+
+    FwSizeType sampleSize() const { return iq ? 4 : 2; }
+};
+
+//! Input samples [from, to) demodulated for one chunk, including the
+//! lead-in the previous chunk covers too
+struct Chunk {
+    U64 from;
+    U64 to;
+};
+
+struct DecodedFrame {
+    //! End of the block the closing flag was in, in output samples
+    U64 position;
+    U16 hash;
+    std::vector<U8> bytes;
+};
+
+typedef std::vector<DecodedFrame> DecodedFrames;
+
+U16 getU16le(const U8* in) {
+    return static_cast<U16>(in[0] | (in[1] << 8));
+}
+
+U32 getU32le(const U8* in) {
+    return static_cast<U32>(in[0]) | (static_cast<U32>(in[1]) << 8) | (static_cast<U32>(in[2]) << 16) |
+           (static_cast<U32>(in[3]) << 24);
+}
+
+void putU32(U8* out, U32 value) {
+    out[0] = static_cast<U8>(value >> 24);
+    out[1] = static_cast<U8>(value >> 16);
+    out[2] = static_cast<U8>(value >> 8);
+    out[3] = static_cast<U8>(value);
+}
+
+//! Find the 16-bit PCM data of a RIFF WAVE file
+bool parseWav(const U8* map, U64 size, Recording& recording) {
+    if ((size < 12) || (memcmp(map, "RIFF", 4) != 0) || (memcmp(&map[8], "WAVE", 4) != 0)) {
+        fprintf(stderr, "# not a RIFF WAVE file\n");
+        return false;
+    }
+    U16 channels = 0;
+    U16 bits = 0;
+    bool haveFormat = false;
+    U64 offset = 12;
+    while (offset + 8 <= size) {
+        const U8* chunk = &map[offset];
+        const U64 chunkSize = getU32le(&chunk[4]);
+        const U64 body = offset + 8;
+        if ((memcmp(chunk, "fmt ", 4) == 0) && (chunkSize >= 16) && (body + 16 <= size)) {
+            const U16 format = getU16le(&map[body]);
+            channels = getU16le(&map[body + 2]);
+            recording.rate = getU32le(&map[body + 4]);
+            bits = getU16le(&map[body + 14]);
+            // 0xFFFE is WAVE_FORMAT_EXTENSIBLE, which SDR programs write for plain PCM too
+            if (((format != 1) && (format != 0xFFFE)) || (bits != 16) || (channels < 1) || (channels > 2) ||
+                (recording.rate == 0)) {
+                fprintf(stderr, "# WAV must be 16-bit PCM, mono audio or stereo I/Q (format %u, %u bits, %u channels)\n",
+                        format, bits, channels);
+                return false;
+            }
+            haveFormat = true;
+        } else if ((memcmp(chunk, "data", 4) == 0) && haveFormat) {
+            // A recorder stopped before it could patch the header leaves 0
+            // or 0xFFFFFFFF; either way the data runs to the end of the file
+            U64 dataSize = size - body;
+            if ((chunkSize != 0) && (chunkSize < dataSize)) {
+                dataSize = chunkSize;
+            }
+            recording.iq = (channels == 2);
+            recording.samples = &map[body];
+            recording.count = dataSize / recording.sampleSize();
+            return true;
+        }
+        offset = body + chunkSize + (chunkSize & 1);
+    }
+    fprintf(stderr, "# WAV has no %s chunk\n", haveFormat ? "data" : "fmt");
+    return false;
+}
+
+//! Chunk indices of one worker. The owner takes from the front and idle
+//! workers steal from the back, so a thief takes the chunk the owner
+//! would have reached last and the owner keeps reading forward.
+class ChunkDeque {
+  public:
+    void push(U32 chunk) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_chunks.push_back(chunk);
+    }
+
+    bool popFront(U32& chunk) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_chunks.empty()) {
+            return false;
+        }
+        chunk = m_chunks.front();
+        m_chunks.pop_front();
+        return true;
+    }
+
+    bool popBack(U32& chunk) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_chunks.empty()) {
+            return false;
+        }
+        chunk = m_chunks.back();
+        m_chunks.pop_back();
+        return true;
+    }
+
+  private:
+    std::mutex m_lock;
+    std::deque<U32> m_chunks;
+};
+
+//! One worker's demodulator chain, from mapped samples to HDLC frames
+class ChunkDecoder {
+  public:
+    ChunkDecoder(const Recording& recording, const Options& options)
+        : m_recording(recording),
+          m_options(options),
+          m_deframer(ChunkDecoder::frameReceived, this),
+          m_resampling(recording.iq || (recording.rate != OUTPUT_RATE)),
+          m_gain(1.0f),
+          m_frames(nullptr),
+          m_position(0),
+          m_lastI(0.0f),
+          m_lastQ(0.0f) {
+        if (m_resampling) {
+            m_resampler.configure(recording.rate, OUTPUT_RATE);
+        }
+        if (recording.iq) {
+            // Phase step in radians to PCM, PCM_PEAK at the peak deviation
+            m_gain = static_cast<F32>(recording.rate / (2.0 * M_PI)) * PCM_PEAK / options.deviation;
+        }
+        m_input.resize(AX25::Resampler::BLOCK * 2);
+        m_float.resize(m_resampling ? m_resampler.maxOutput(AX25::Resampler::BLOCK) : 0);
+        m_pcm.resize(m_resampling ? m_float.size() : AX25::Resampler::BLOCK);
+    }
+
+    void decode(const Chunk& chunk, DecodedFrames& frames) {
+        m_afsk.reset();
+        m_g3ruh.reset();
+        m_deframer.reset();
+        if (m_resampling) {
+            m_resampler.reset();
+        }
+        m_lastI = 0.0f;
+        m_lastQ = 0.0f;
+        m_frames = &frames;
+
+        for (U64 at = chunk.from; at < chunk.to; at += AX25::Resampler::BLOCK) {
+            const FwSizeType count = static_cast<FwSizeType>(FW_MIN(chunk.to - at, AX25::Resampler::BLOCK));
+            const FwSizeType produced = this->convert(at, count);
+            // Chunks start on block boundaries, so every chunk that decodes
+            // a frame stamps it with the same block
+            m_position = (at + count) * OUTPUT_RATE / m_recording.rate;
+            if (m_options.g3ruh) {
+                m_g3ruh.process(m_pcm.data(), produced, m_deframer);
+            } else {
+                m_afsk.process(m_pcm.data(), produced, m_deframer);
+            }
+        }
+        m_frames = nullptr;
+    }
+
+    U32 getFrameCount() const { return m_deframer.getFrameCount(); }
+    U32 getFcsErrorCount() const { return m_deframer.getFcsErrorCount(); }
+
+  private:
+    //! Turn `count` input samples starting at `at` into 48 kHz PCM in m_pcm
+    FwSizeType convert(U64 at, FwSizeType count) {
+        // Copied out of the mapping: the data chunk of a WAV file need not
+        // be 16-bit aligned
+        const FwSizeType words = m_recording.iq ? count * 2 : count;
+        memcpy(m_input.data(), &m_recording.samples[at * m_recording.sampleSize()], words * sizeof(I16));
+        if (!m_resampling) {
+            memcpy(m_pcm.data(), m_input.data(), count * sizeof(I16));
+            return count;
+        }
+
+        F32* block = m_resampler.block();
+        if (m_recording.iq) {
+            // FM discriminator: the phase step from the previous sample
+            for (FwSizeType n = 0; n < count; n++) {
+                const F32 i = m_input[2 * n];
+                const F32 q = m_input[2 * n + 1];
+                block[n] = std::atan2(q * m_lastI - i * m_lastQ, i * m_lastI + q * m_lastQ) * m_gain;
+                m_lastI = i;
+                m_lastQ = q;
+            }
+        } else {
+            AX25::Dsp::toFloat(m_input.data(), count, 1.0f, block);
+        }
+        const FwSizeType produced = m_resampler.process(count, m_float.data());
+        for (FwSizeType n = 0; n < produced; n++) {
+            const F32 sample = FW_MAX(-32768.0f, FW_MIN(32767.0f, m_float[n]));
+            m_pcm[n] = static_cast<I16>(sample);
+        }
+        return produced;
+    }
+
+    static void frameReceived(void* decoder, const U8* frame, FwSizeType size) {
+        ChunkDecoder* self = static_cast<ChunkDecoder*>(decoder);
+        DecodedFrame decoded;
+        decoded.position = self->m_position;
+        decoded.hash = AX25::Crc16::compute(frame, size);
+        decoded.bytes.assign(frame, frame + size);
+        self->m_frames->push_back(std::move(decoded));
+    }
+
+    const Recording& m_recording;
+    const Options& m_options;
+    AX25::HdlcDeframer m_deframer;
+    AX25::AfskDemodulator m_afsk;
+    AX25::G3ruhDemodulator m_g3ruh;
+    AX25::Resampler m_resampler;
+    bool m_resampling;
+    F32 m_gain;
+    std::vector<I16> m_input;
+    std::vector<F32> m_float;
+    std::vector<I16> m_pcm;
+    DecodedFrames* m_frames;
+    U64 m_position;
+    F32 m_lastI;
+    F32 m_lastQ;
+};
+
+//! Reassembles merged frames into F´ packets, as AX25Receiver::forwardFrame
+class PacketWriter {
+  public:
+    explicit PacketWriter(FILE* framed) : m_framed(framed), m_ignored(0), m_packets(0), m_invalid(0) {}
+
+    void push(const DecodedFrame& decoded) {
+        const U8* frame = decoded.bytes.data();
+        const FwSizeType size = decoded.bytes.size();
+        FwSizeType addressLen = 0;
+        while (addressLen < size && (frame[addressLen] & 0x01) == 0) {
+            addressLen++;
+        }
+        addressLen++;
+        if ((addressLen % 7) != 0 || addressLen < 14 || addressLen + 2 > size ||
+            (frame[addressLen] & ~AX25_CONTROL_PF) != AX25_CONTROL_UI || frame[addressLen + 1] != AX25_PID_NO_L3) {
+            m_ignored++;
+            return;
+        }
+
+        const FwSizeType infoOffset = addressLen + 2;
+        if (m_reassembler.push(&frame[infoOffset], size - infoOffset) != AX25::Reassembler::Status::COMPLETE) {
+            return;
+        }
+        const F64 seconds = static_cast<F64>(decoded.position) / OUTPUT_RATE;
+        const U8* message = m_reassembler.getMessage();
+        FwSizeType messageSize = m_reassembler.getMessageSize();
+        if (m_reassembler.isCompressed()) {
+            messageSize = AX25::Compressor::expand(message, messageSize, m_expanded, sizeof(m_expanded));
+            if (messageSize == 0) {
+                m_invalid++;
+                return;
+            }
+            message = m_expanded;
+        }
+
+        if (!m_reassembler.isPacked()) {
+            this->write(seconds, message, messageSize);
+            return;
+        }
+        AX25::PackReader reader(message, messageSize);
+        const U8* packet = nullptr;
+        FwSizeType packetSize = 0;
+        while (reader.next(packet, packetSize)) {
+            this->write(seconds, packet, packetSize);
+        }
+        if (!reader.isComplete()) {
+            m_invalid++;
+        }
+    }
+
+    const AX25::Reassembler& getReassembler() const { return m_reassembler; }
+    U32 getIgnoredCount() const { return m_ignored; }
+    U32 getPacketCount() const { return m_packets; }
+    U32 getInvalidCount() const { return m_invalid; }
+
+  private:
+    void write(F64 seconds, const U8* packet, FwSizeType size) {
+        m_packets++;
+        printf("%.3f,%lu,", seconds, static_cast<unsigned long>(size));
+        for (FwSizeType i = 0; i < size; i++) {
+            printf("%02x", packet[i]);
+        }
+        printf("\n");
+        if (m_framed == nullptr) {
+            return;
+        }
+
+        // Start word and length, the packet, then a CRC-32 over both
+        U8 header[8];
+        putU32(&header[0], FPRIME_START_WORD);
+        putU32(&header[4], static_cast<U32>(size));
+        Utils::Hash hash;
+        hash.init();
+        hash.update(header, sizeof(header));
+        hash.update(packet, size);
+        Utils::HashBuffer crc;
+        hash.final(crc);
+        U8 trailer[4];
+        putU32(trailer, crc.asBigEndianU32());
+        (void)fwrite(header, 1, sizeof(header), m_framed);
+        (void)fwrite(packet, 1, size, m_framed);
+        (void)fwrite(trailer, 1, sizeof(trailer), m_framed);
+    }
+
+    FILE* m_framed;
+    AX25::Reassembler m_reassembler;
+    U8 m_expanded[AX25::Compressor::MAX_INPUT];
+    U32 m_ignored;
+    U32 m_packets;
+    U32 m_invalid;
+};
+
+void usage() {
+    fprintf(stderr,
+            "usage: PassDecoder [-m afsk|g3ruh] [-f pcm|iq] [-r rate] [-d deviation] [-j threads] "
+            "[-c chunk_seconds] [-o framed_file] recording\n");
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    int option = 0;
+    while ((option = getopt(argc, argv, "m:f:r:d:j:c:o:")) != -1) {
+        switch (option) {
+            case 'm':
+                if (strcmp(optarg, "g3ruh") != 0 && strcmp(optarg, "afsk") != 0) {
+                    return false;
+                }
+                options.g3ruh = (strcmp(optarg, "g3ruh") == 0);
+                break;
+            case 'f':
+                if (strcmp(optarg, "iq") != 0 && strcmp(optarg, "pcm") != 0) {
+                    return false;
+                }
+                options.iq = (strcmp(optarg, "iq") == 0);
+                break;
+            case 'r':
+                options.rate = static_cast<U32>(strtoul(optarg, nullptr, 0));
+                break;
+            case 'd':
+                options.deviation = static_cast<F32>(strtod(optarg, nullptr));
+                break;
+            case 'j':
+                options.threads = static_cast<U32>(strtoul(optarg, nullptr, 0));
+                break;
+            case 'c':
+                options.chunkSeconds = strtod(optarg, nullptr);
+                break;
+            case 'o':
+                options.framedPath = optarg;
+                break;
+            default:
+                return false;
+        }
+    }
+    if (optind != argc - 1 || options.rate == 0 || options.deviation <= 0.0f || options.chunkSeconds <= 0.0) {
+        return false;
+    }
+    options.path = argv[optind];
+    if (options.threads == 0) {
+        options.threads = FW_MAX(1U, std::thread::hardware_concurrency());
+    }
+    return true;
+}
+
+bool isWav(const char* path) {
+    const FwSizeType length = strlen(path);
+    return (length >= 4) && (strcasecmp(&path[length - 4], ".wav") == 0);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+
+    const int fd = open(options.path, O_RDONLY | O_CLOEXEC);
+    struct stat status;
+    if (fd < 0 || fstat(fd, &status) != 0 || status.st_size == 0) {
+        fprintf(stderr, "# cannot open %s: %s\n", options.path, (fd < 0) ? strerror(errno) : "empty file");
+        return 1;
+    }
+    const U64 mapSize = static_cast<U64>(status.st_size);
+    void* map = mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    (void)close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "# cannot map %s: %s\n", options.path, strerror(errno));
+        return 1;
+    }
+    // Workers sweep their chunks front to back; let the kernel read ahead
+    (void)madvise(map, mapSize, MADV_SEQUENTIAL);
+
+    Recording recording;
+    if (isWav(options.path)) {
+        if (!parseWav(static_cast<const U8*>(map), mapSize, recording)) {
+            return 1;
+        }
+    } else {
+        recording.samples = static_cast<const U8*>(map);
+        recording.rate = options.rate;
+        recording.iq = options.iq;
+        recording.count = mapSize / recording.sampleSize();
+    }
+    if (recording.iq && (recording.rate < OUTPUT_RATE)) {
+        fprintf(stderr, "# I/Q must be sampled at %u Hz or more\n", OUTPUT_RATE);
+        return 1;
+    }
+
+    FILE* framed = nullptr;
+    if (options.framedPath != nullptr) {
+        framed = fopen(options.framedPath, "wb");
+        if (framed == nullptr) {
+            fprintf(stderr, "# cannot open %s: %s\n", options.framedPath, strerror(errno));
+            return 1;
+        }
+    }
+
+    // Chunks much shorter than the lead-in would spend most of their time
+    // decoding samples the previous chunk already covered
+    const U32 baudRate = options.g3ruh ? 9600 : 1200;
+    const U64 block = AX25::Resampler::BLOCK;
+    const U64 overlap = ((static_cast<U64>(MAX_FRAME_BITS) * recording.rate / baudRate) / block + 1) * block;
+    const U64 chunkSize =
+        FW_MAX((static_cast<U64>(options.chunkSeconds * recording.rate) / block + 1) * block, 4 * overlap);
+    std::vector<Chunk> chunks;
+    for (U64 start = 0; start < recording.count; start += chunkSize) {
+        Chunk chunk;
+        chunk.from = (start > overlap) ? start - overlap : 0;
+        chunk.to = FW_MIN(start + chunkSize, recording.count);
+        chunks.push_back(chunk);
+    }
+    const U32 threads = static_cast<U32>(FW_MIN(static_cast<FwSizeType>(options.threads), chunks.size()));
+
+    // Each worker starts with a contiguous run of chunks, stealing once its
+    // own run is done
+    std::vector<ChunkDeque> queues(FW_MAX(threads, 1U));
+    for (U32 chunk = 0; chunk < chunks.size(); chunk++) {
+        queues[static_cast<U64>(chunk) * queues.size() / chunks.size()].push(chunk);
+    }
+
+    std::vector<DecodedFrames> results(chunks.size());
+    std::atomic<U32> frameCount(0);
+    std::atomic<U32> fcsErrors(0);
+    std::atomic<U32> stolen(0);
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::thread> workers;
+        for (U32 self = 0; self < threads; self++) {
+            workers.emplace_back([&, self]() {
+                ChunkDecoder decoder(recording, options);
+                U32 chunk = 0;
+                for (;;) {
+                    bool found = queues[self].popFront(chunk);
+                    for (U32 other = 1; !found && (other < threads); other++) {
+                        found = queues[(self + other) % threads].popBack(chunk);
+                        if (found) {
+                            stolen++;
+                        }
+                    }
+                    if (!found) {
+                        break;
+                    }
+                    decoder.decode(chunks[chunk], results[chunk]);
+                }
+                frameCount += decoder.getFrameCount();
+                fcsErrors += decoder.getFcsErrorCount();
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    DecodedFrames frames;
+    for (DecodedFrames& result : results) {
+        for (DecodedFrame& frame : result) {
+            frames.push_back(std::move(frame));
+        }
+    }
+    std::stable_sort(frames.begin(), frames.end(), [](const DecodedFrame& a, const DecodedFrame& b) {
+        return a.position < b.position;
+    });
+
+    // Copies from two chunks share a stamp, or a neighbouring one if the
+    // demodulators had not quite settled to the same bit timing; a frame
+    // really sent twice is a whole frame's air time apart
+    const U64 window = 2 * (block * OUTPUT_RATE / recording.rate + 1);
+    PacketWriter writer(framed);
+    DecodedFrames kept;
+    U32 duplicates = 0;
+    for (DecodedFrame& frame : frames) {
+        bool duplicate = false;
+        for (FwSizeType k = kept.size(); k > 0 && kept[k - 1].position + window >= frame.position; k--) {
+            if (kept[k - 1].hash == frame.hash && kept[k - 1].bytes == frame.bytes) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (duplicate) {
+            duplicates++;
+            continue;
+        }
+        writer.push(frame);
+        kept.push_back(std::move(frame));
+    }
+    const F64 seconds = std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+
+    if (framed != nullptr) {
+        (void)fclose(framed);
+    }
+    (void)munmap(map, mapSize);
+
+    const F64 recordingSeconds = static_cast<F64>(recording.count) / recording.rate;
+    const AX25::Reassembler& reassembler = writer.getReassembler();
+    fprintf(stderr, "# %.1f s of %s at %u Hz in %.2f s on %u threads: %.1fx realtime\n", recordingSeconds,
+            recording.iq ? "I/Q" : "audio", recording.rate, seconds, threads, recordingSeconds / seconds);
+    fprintf(stderr, "# %lu chunks (%u stolen), %u frames decoded, %u duplicates dropped, %u FCS errors\n",
+            static_cast<unsigned long>(chunks.size()), stolen.load(), frameCount.load(), duplicates,
+            fcsErrors.load());
+    fprintf(stderr,
+            "# %u frames ignored, %u messages reassembled, %u abandoned, %u segments invalid, %u packets, "
+            "%u invalid\n",
+            writer.getIgnoredCount(), reassembler.getCompleteCount(), reassembler.getAbandonedCount(),
+            reassembler.getInvalidCount(), writer.getPacketCount(), writer.getInvalidCount());
+    return 0;
+}
@@ -15,6 +15,8 @@
 
 // Used for 1Hz synthetic cycling
 #include <Os/Mutex.hpp>
+#include <CDHDeployment/DebugLog/DebugLog.hpp>
+#include <cstring>
 
 // Allows easy reference to objects in FPP/autocoder required namespaces
 using namespace CDHDeployment;
@@ -28,6 +30,9 @@ Svc::FrameDetectors::FprimeFrameDetector frameDetector;
 
 Svc::ComQueue::QueueConfigurationTable configurationTable;
 
+// Receive sources starting with this prefix are streamed from a TCP server rather than opened as a file
+static const char* const RX_TCP_PREFIX = "tcp:";
+
 // The reference topology divides the incoming clock signal (1Hz) into sub-signals: 1Hz, 1/2Hz, and 1/4Hz with 0 offset
 Svc::RateGroupDriver::DividerSet rateGroupDivisorsSet{{{1, 0}, {2, 0}, {4, 0}}};
 
@@ -46,6 +51,12 @@ enum TopologyConstants {
     FILE_DOWNLINK_FILE_QUEUE_DEPTH = 10,
     HEALTH_WATCHDOG_CODE = 0x123,
     COMM_PRIORITY = 100,
+    // Diagnostics drain below everything else so they never delay the data path
+    DEBUG_LOG_PRIORITY = 1,
+    // Data area of the radioBridge spool file, tens of thousands of frames
+    RADIO_SPOOL_SIZE = 16 * 1024 * 1024,
+    // Threads running ax25Receiver's demodulator variants next to its reader
+    RX_DECODER_WORKERS = 3,
     // bufferManager constants
     FRAMER_BUFFER_SIZE = FW_MAX(FW_COM_BUFFER_MAX_SIZE, FW_FILE_BUFFER_MAX_SIZE) + Svc::FprimeProtocol::FrameHeader::SERIALIZED_SIZE + Svc::FprimeProtocol::FrameTrailer::SERIALIZED_SIZE,
     FRAMER_BUFFER_COUNT = 30,
@@ -53,7 +64,11 @@ enum TopologyConstants {
     DEFRAMER_BUFFER_COUNT = 30,
     COM_DRIVER_BUFFER_SIZE = 3000,
     COM_DRIVER_BUFFER_COUNT = 30,
-    BUFFER_MANAGER_ID = 200
+    BUFFER_MANAGER_ID = 200,
+    // ax25BufferPool constants; the count is in ChainConstants
+    AX25_BUFFER_POOL_ID = 201,
+    // Audio radioBridge renders ahead of a pass, sized by its PASS_STAGE_BYTES
+    RADIO_STAGE_ID = 202
 };
 
 // Ping entries are autocoded, however; this code is not properly exported. Thus, it is copied here.
@@ -90,6 +105,9 @@ void configureTopology(const TopologyState& state) {
     bufferMgrBins.bins[2].numBuffers = COM_DRIVER_BUFFER_COUNT;
     bufferManager.setup(BUFFER_MANAGER_ID, 0, mallocator, bufferMgrBins);
 
+    // AMSATFramer draws from its own arena of AX.25-sized buffers
+    ax25BufferPool.setup(AX25_BUFFER_POOL_ID, AX25_BUFFER_COUNT, mallocator);
+
     // Frame accumulator needs to be passed a frame detector (default F Prime frame detector)
     frameAccumulator.configure(frameDetector, 1, mallocator, 2048);
 
@@ -133,6 +151,39 @@ void configureTopology(const TopologyState& state) {
     if (state.hostname != nullptr && state.port != 0) {
         comDriver.configure(state.hostname, state.port);
     }
+
+    // RadioBridge streams PCM into one long-lived sink: a raw file for hardware-free runs, a command reading
+    // PCM, or by default rpitx fed RF samples converted in process
+    if (state.txSinkFile != nullptr) {
+        radioBridge.configureSink(RadioBridge::TxSink::Kind::FILE, state.txSinkFile);
+    } else if (state.txSinkCommand != nullptr) {
+        radioBridge.configureSink(RadioBridge::TxSink::Kind::COMMAND, state.txSinkCommand);
+    } else {
+        radioBridge.configureSink(RadioBridge::TxSink::Kind::RPITX, RadioBridge::RadioBridge::DEFAULT_SINK_COMMAND);
+    }
+
+    radioBridge.configureRing(RADIO_RING_CAPACITY);
+    radioBridge.configureStage(RADIO_STAGE_ID, mallocator);
+    if (state.spoolFile != nullptr) {
+        radioBridge.configureSpool(state.spoolFile, RADIO_SPOOL_SIZE);
+    }
+    // Events go out ahead of telemetry, which shares the rest of the airtime with file downlink
+    radioBridge.setQueueClass(Ports_ComPacketQueue::EVENTS, RadioBridge::TxClass::URGENT);
+    radioBridge.setQueueClass(Ports_ComPacketQueue::TELEMETRY, RadioBridge::TxClass::ROUTINE);
+    radioBridge.setQueueClass(Ports_ComPacketQueue::NUM_CONSTANTS, RadioBridge::TxClass::BULK);
+
+    // comQueue buffer queues (file downlink) follow the packet queues; only
+    // their buffers outlive dataIn, so only they are segmented without a copy
+    amsatFramer.setBorrowedQueues(Ports_ComPacketQueue::NUM_CONSTANTS);
+
+    // AX25Receiver demodulates a PCM capture or live stream into the uplink when a source is given
+    if (state.rxSource != nullptr) {
+        if (strncmp(state.rxSource, RX_TCP_PREFIX, strlen(RX_TCP_PREFIX)) == 0) {
+            ax25Receiver.configureSource(AX25Receiver::PcmSource::Kind::TCP, state.rxSource + strlen(RX_TCP_PREFIX));
+        } else {
+            ax25Receiver.configureSource(AX25Receiver::PcmSource::Kind::FILE, state.rxSource);
+        }
+    }
 }
 
 // Public functions for use in main program are namespaced with deployment name CDHDeployment
@@ -152,6 +203,10 @@ void setupTopology(const TopologyState& state) {
     regCommands();
     // Autocoded parameter loading. Function provided by autocoder.
     loadParameters();
+#if AMSAT_LOG_LEVEL > AMSAT_LOG_LEVEL_NONE
+    Os::TaskString logName("DebugLog");
+    DebugLog::RingLogger::getInstance().start(logName, DEBUG_LOG_PRIORITY, Default::STACK_SIZE);
+#endif
     // Autocoded task kick-off (active components). Function provided by autocoder.
     startTasks(state);
     // Initialize socket communication if and only if there is a valid specification
@@ -160,6 +215,13 @@ void setupTopology(const TopologyState& state) {
         // Uplink is configured for receive so a socket task is started
         comDriver.start(name, COMM_PRIORITY, Default::STACK_SIZE);
     }
+    // The transmit sink writer owns the radio pipeline for the life of the deployment
+    Os::TaskString sinkName("TxSink");
+    radioBridge.startSink(sinkName, COMM_PRIORITY, Default::STACK_SIZE);
+    if (state.rxSource != nullptr) {
+        Os::TaskString sourceName("RxSource");
+        ax25Receiver.startSource(sourceName, COMM_PRIORITY, Default::STACK_SIZE, RX_DECODER_WORKERS);
+    }
 }
 
 // Variables used for cycle simulation
@@ -182,9 +244,18 @@ void teardownTopology(const TopologyState& state) {
     // Other task clean-up.
     comDriver.stop();
     (void)comDriver.join();
+    radioBridge.stopSink();
+    if (state.rxSource != nullptr) {
+        ax25Receiver.stopSource();
+    }
+#if AMSAT_LOG_LEVEL > AMSAT_LOG_LEVEL_NONE
+    DebugLog::RingLogger::getInstance().stop();
+#endif
 
     // Resource deallocation
     cmdSeq.deallocateBuffer(mallocator);
     bufferManager.cleanup();
+    ax25BufferPool.cleanup();
+    radioBridge.cleanupStage();
 }
 };  // namespace CDHDeployment
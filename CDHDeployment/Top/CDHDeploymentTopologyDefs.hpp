@@ -24,6 +24,23 @@ namespace CDHDeployment {
 struct TopologyState {
     const CHAR* hostname;
     U16 port;
+    const CHAR* txSinkCommand;  //!< Shell command fed raw PCM by RadioBridge (nullptr: rpitx default)
+    const CHAR* txSinkFile;     //!< File receiving raw PCM instead of a command, e.g. /dev/null
+    const CHAR* rxSource;       //!< PCM file/FIFO or "tcp:host:port" demodulated by AX25Receiver (nullptr: off)
+    const CHAR* spoolFile;      //!< RadioBridge store-and-forward spool (nullptr: frames wait in the queues)
+};
+
+/**
+ * \brief sizes of the AMSAT downlink chain
+ *
+ * Used by the topology setup and by Benchmarks/ChainBenchmark, which builds amsatFramer, ax25BufferPool and radioBridge
+ * without the rest of the deployment and should measure them as configured here.
+ */
+enum ChainConstants {
+    // Frame handles buffered between amsatFramer and radioBridge
+    RADIO_RING_CAPACITY = 32,
+    // ax25BufferPool buffers; they are sized by the pool itself
+    AX25_BUFFER_COUNT = 32,
 };
 
 /**